@@ -0,0 +1,87 @@
+#include "profileparser.h"
+#include "tester.h"
+#include <memory>
+#include <sstream>
+#include <stdio.h>
+#include <wx/init.h>
+#include <wx/log.h>
+
+TEST_FUNC(test_perf_script_parser)
+{
+    std::string profile = "prog 1234 1000.000001:     100 cycles:\n"
+                          "\t    4005d0 compute+0x10 (/tmp/prog)\n"
+                          "\t    400600 main+0x20 (/tmp/prog)\n"
+                          "\t    7f0000 __libc_start_main+0xf0 (/usr/lib/libc.so.6)\n"
+                          "\n"
+                          "prog 1234 1000.000002:     50 cycles:\n"
+                          "\t    400600 main+0x20 (/tmp/prog)\n"
+                          "\t    7f0000 __libc_start_main+0xf0 (/usr/lib/libc.so.6)\n"
+                          "\n";
+    std::istringstream detect(profile);
+    CHECK_BOOL(ProfileParser::DetectFormat("perf.txt", detect) == ProfileParser::kPerfScript);
+
+    std::istringstream in(profile);
+    std::unique_ptr<ProfileParser> parser(ProfileParser::Create(ProfileParser::kPerfScript));
+    ProfileTree tree;
+    CHECK_BOOL(parser->Parse(in, tree));
+    CHECK_SIZE(tree.GetTotal(), 150);
+    CHECK_BOOL(tree.GetEventName() == "cycles");
+
+    std::vector<int> hottest;
+    tree.GetHottestPaths(1, hottest);
+    CHECK_SIZE(hottest.size(), 1);
+    CHECK_BOOL(tree.GetPath(hottest[0]) == "__libc_start_main > main > compute");
+    CHECK_SIZE(tree.GetNode(hottest[0]).self, 100);
+    return true;
+}
+
+TEST_FUNC(test_callgrind_parser)
+{
+    std::string profile = "events: Ir\n"
+                          "fn=main\n"
+                          "5 10\n"
+                          "cfn=compute\n"
+                          "calls=1 1\n"
+                          "6 90\n"
+                          "fn=compute\n"
+                          "1 90\n";
+    std::istringstream detect(profile);
+    CHECK_BOOL(ProfileParser::DetectFormat("profile.txt", detect) == ProfileParser::kCallgrind);
+
+    std::istringstream in(profile);
+    std::unique_ptr<ProfileParser> parser(ProfileParser::Create(ProfileParser::kCallgrind));
+    ProfileTree tree;
+    CHECK_BOOL(parser->Parse(in, tree));
+    CHECK_SIZE(tree.GetTotal(), 100);
+
+    const ProfileTree::Node& root = tree.GetNode(tree.GetRoot());
+    CHECK_SIZE(root.children.size(), 1);
+    const ProfileTree::Node& mainNode = tree.GetNode(root.children[0]);
+    CHECK_BOOL(tree.GetFunctionName(root.children[0]) == "main");
+    CHECK_SIZE(mainNode.self, 10);
+    CHECK_SIZE(mainNode.children.size(), 1);
+    CHECK_BOOL(tree.GetFunctionName(mainNode.children[0]) == "compute");
+    CHECK_SIZE(tree.GetNode(mainNode.children[0]).inclusive, 90);
+    return true;
+}
+
+TEST_FUNC(test_unknown_profile)
+{
+    std::istringstream detect("hello world\n");
+    CHECK_BOOL(ProfileParser::DetectFormat("notes.txt", detect) == ProfileParser::kUnknown);
+
+    std::istringstream in("events: Ir\n");
+    std::unique_ptr<ProfileParser> parser(ProfileParser::Create(ProfileParser::kCallgrind));
+    ProfileTree tree;
+    CHECK_BOOL(!parser->Parse(in, tree));
+    CHECK_BOOL(!parser->GetError().empty());
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    wxInitializer initializer(argc, argv);
+    wxLogNull NOLOG;
+    Tester::Instance()->RunTests();
+    return 0;
+}
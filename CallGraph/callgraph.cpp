@@ -28,6 +28,7 @@
 #include "string.h"
 #include "toolbaricons.h"
 #include "uicallgraphpanel.h"
+#include "uiprofilepanel.h"
 #include "uisettingsdlg.h"
 #include "workspace.h"
 #include <wx/aboutdlg.h>
@@ -92,6 +93,7 @@ CL_PLUGIN_API PluginInfo* GetPluginInfo()
     info.SetDescription(_("Create application call graph from profiling information provided by gprof tool."));
     info.SetVersion(wxT("v1.1.0"));
     info.EnableFlag(PluginInfo::kDisabledByDefault, true);
+    info.EnableFlag(PluginInfo::kLazyActivation, true);
     return &info;
 }
 
@@ -115,6 +117,8 @@ CallGraph::CallGraph(IManager* manager)
 
     m_mgr->GetTheApp()->Connect(XRCID("cg_show_callgraph"), wxEVT_COMMAND_TOOL_CLICKED,
                                 wxCommandEventHandler(CallGraph::OnShowCallGraph), NULL, this);
+    m_mgr->GetTheApp()->Connect(XRCID("cg_import_profile"), wxEVT_COMMAND_MENU_SELECTED,
+                                wxCommandEventHandler(CallGraph::OnImportProfile), NULL, this);
 }
 
 //---- DTOR -------------------------------------------------------------------
@@ -128,6 +132,8 @@ CallGraph::~CallGraph()
 
     m_mgr->GetTheApp()->Disconnect(XRCID("cg_show_callgraph"), wxEVT_COMMAND_TOOL_CLICKED,
                                    wxCommandEventHandler(CallGraph::OnShowCallGraph), NULL, this);
+    m_mgr->GetTheApp()->Disconnect(XRCID("cg_import_profile"), wxEVT_COMMAND_MENU_SELECTED,
+                                   wxCommandEventHandler(CallGraph::OnImportProfile), NULL, this);
 
     wxDELETE(m_LogFile);
 }
@@ -152,6 +158,9 @@ void CallGraph::CreatePluginMenu(wxMenu* pluginsMenu)
     item = new wxMenuItem(menu, XRCID("cg_show_callgraph"), _("Show call graph"),
                           _("Show call graph for selected/active project"), wxITEM_NORMAL);
     menu->Append(item);
+    item = new wxMenuItem(menu, XRCID("cg_import_profile"), _("Import profile (callgrind / perf script)..."),
+                          _("Show a flame graph and the hottest paths of a callgrind or perf profile"), wxITEM_NORMAL);
+    menu->Append(item);
     menu->AppendSeparator();
     item = new wxMenuItem(menu, XRCID("cg_settings"), _("Settings..."), wxEmptyString, wxITEM_NORMAL);
     menu->Append(item);
@@ -502,6 +511,24 @@ void CallGraph::OnShowCallGraph(wxCommandEvent& event)
     m_mgr->AddEditorPage(panel, title);
 }
 
+//---- Import Profile ---------------------------------------------------------
+
+void CallGraph::OnImportProfile(wxCommandEvent& event)
+{
+    wxString defaultDir;
+    clCxxWorkspace* ws = m_mgr->GetWorkspace();
+    if(ws && ws->IsOpen()) { defaultDir = ws->GetWorkspaceFileName().GetPath(); }
+
+    wxString path = ::wxFileSelector(_("Select a callgrind output file or the output of 'perf script'"), defaultDir,
+                                     wxEmptyString, wxEmptyString, wxFileSelectorDefaultWildcardStr,
+                                     wxFD_OPEN | wxFD_FILE_MUST_EXIST, m_mgr->GetTheApp()->GetTopWindow());
+    if(path.IsEmpty()) return;
+
+    // the profile is parsed in the background by the panel
+    uiprofilepanel* panel = new uiprofilepanel(m_mgr->GetEditorPaneNotebook(), m_mgr, path);
+    m_mgr->AddEditorPage(panel, _("Profile: ") + wxFileName(path).GetFullName());
+}
+
 //---- Show Settings Dialog ---------------------------------------------------
 
 void CallGraph::OnSettings(wxCommandEvent& event)
@@ -117,6 +117,11 @@ protected:
      * @param event Reference to event class
      */
     void OnShowCallGraph(wxCommandEvent& event);
+    /**
+     * @brief Function import a callgrind or 'perf script' profile and show it as a flame graph in a new tab page.
+     * @param event Reference to event class
+     */
+    void OnImportProfile(wxCommandEvent& event);
     /**
      * @brief Handle function to open dialog with settings for Call graph plugin.
      * @param event Reference to event class
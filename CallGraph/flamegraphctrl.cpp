@@ -0,0 +1,257 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : flamegraphctrl.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "flamegraphctrl.h"
+#include <algorithm>
+#include <functional>
+#include <wx/control.h>
+#include <wx/dcbuffer.h>
+#include <wx/intl.h>
+#include <wx/settings.h>
+
+wxDEFINE_EVENT(wxEVT_FLAMEGRAPH_NODE_ACTIVATED, wxCommandEvent);
+
+FlameGraphCtrl::FlameGraphCtrl(wxWindow* parent, wxWindowID id)
+    : wxScrolledCanvas(parent, id, wxDefaultPosition, wxDefaultSize, wxVSCROLL | wxWANTS_CHARS)
+    , m_tree(NULL)
+    , m_zoomNode(wxNOT_FOUND)
+    , m_hoverNode(wxNOT_FOUND)
+{
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    m_rowHeight = GetCharHeight() + 4;
+    SetScrollRate(0, m_rowHeight);
+
+    Bind(wxEVT_PAINT, &FlameGraphCtrl::OnPaint, this);
+    Bind(wxEVT_SIZE, &FlameGraphCtrl::OnSize, this);
+    Bind(wxEVT_LEFT_DOWN, &FlameGraphCtrl::OnLeftDown, this);
+    Bind(wxEVT_LEFT_DCLICK, &FlameGraphCtrl::OnLeftDClick, this);
+    Bind(wxEVT_RIGHT_DOWN, &FlameGraphCtrl::OnRightDown, this);
+    Bind(wxEVT_MOTION, &FlameGraphCtrl::OnMotion, this);
+    Bind(wxEVT_KEY_DOWN, &FlameGraphCtrl::OnKeyDown, this);
+}
+
+FlameGraphCtrl::~FlameGraphCtrl()
+{
+    Unbind(wxEVT_PAINT, &FlameGraphCtrl::OnPaint, this);
+    Unbind(wxEVT_SIZE, &FlameGraphCtrl::OnSize, this);
+    Unbind(wxEVT_LEFT_DOWN, &FlameGraphCtrl::OnLeftDown, this);
+    Unbind(wxEVT_LEFT_DCLICK, &FlameGraphCtrl::OnLeftDClick, this);
+    Unbind(wxEVT_RIGHT_DOWN, &FlameGraphCtrl::OnRightDown, this);
+    Unbind(wxEVT_MOTION, &FlameGraphCtrl::OnMotion, this);
+    Unbind(wxEVT_KEY_DOWN, &FlameGraphCtrl::OnKeyDown, this);
+}
+
+void FlameGraphCtrl::SetTree(const ProfileTree* tree)
+{
+    m_tree = tree;
+    m_zoomNode = m_tree ? m_tree->GetRoot() : wxNOT_FOUND;
+    m_hoverNode = wxNOT_FOUND;
+    m_frames.clear();
+    DoUpdateVirtualSize();
+    Refresh();
+}
+
+void FlameGraphCtrl::ZoomTo(int node)
+{
+    if(!m_tree || node == wxNOT_FOUND || node == m_zoomNode) { return; }
+    m_zoomNode = node;
+    Refresh();
+}
+
+void FlameGraphCtrl::ZoomOut()
+{
+    if(!m_tree || m_zoomNode == wxNOT_FOUND) { return; }
+    ZoomTo(m_tree->GetNode(m_zoomNode).parent);
+}
+
+int FlameGraphCtrl::GetZoomDepth() const
+{
+    return (m_tree && m_zoomNode != wxNOT_FOUND) ? m_tree->GetNode(m_zoomNode).depth : 0;
+}
+
+void FlameGraphCtrl::DoUpdateVirtualSize()
+{
+    int rows = m_tree ? (m_tree->GetMaxDepth() + 1) : 0;
+    SetVirtualSize(GetClientSize().GetWidth(), rows * m_rowHeight);
+}
+
+void FlameGraphCtrl::OnSize(wxSizeEvent& event)
+{
+    event.Skip();
+    DoUpdateVirtualSize();
+    Refresh();
+}
+
+void FlameGraphCtrl::OnPaint(wxPaintEvent& event)
+{
+    wxUnusedVar(event);
+    wxAutoBufferedPaintDC dc(this);
+    DoPrepareDC(dc);
+    dc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOW)));
+    dc.Clear();
+    m_frames.clear();
+    if(!m_tree || m_zoomNode == wxNOT_FOUND) { return; }
+
+    dc.SetFont(GetFont());
+    dc.SetTextForeground(*wxBLACK);
+    wxRect visible(CalcUnscrolledPosition(wxPoint(0, 0)), GetClientSize());
+    int width = GetClientSize().GetWidth();
+
+    // the path to the zoomed frame is drawn dimmed, full width
+    std::vector<int> path;
+    for(int node = m_tree->GetNode(m_zoomNode).parent; node != wxNOT_FOUND; node = m_tree->GetNode(node).parent) {
+        path.push_back(node);
+    }
+    std::reverse(path.begin(), path.end());
+    for(size_t row = 0; row < path.size(); ++row) {
+        DoDrawFrame(dc, path[row], wxRect(0, row * m_rowHeight, width, m_rowHeight - 1), true);
+    }
+    DoDrawNode(dc, m_zoomNode, 0.0, width, path.size(), visible);
+}
+
+void FlameGraphCtrl::DoDrawNode(wxDC& dc, int node, double x, double width, int row, const wxRect& visible)
+{
+    int top = row * m_rowHeight;
+    if(top > visible.GetBottom()) { return; }
+
+    int left = (int)x;
+    wxRect rect(left, top, std::max((int)(x + width) - left, 1), m_rowHeight - 1);
+    if(rect.GetBottom() >= visible.GetTop()) { DoDrawFrame(dc, node, rect, false); }
+
+    const ProfileTree::Node& n = m_tree->GetNode(node);
+    if(n.inclusive == 0) { return; }
+    double scale = width / n.inclusive;
+    for(size_t i = 0; i < n.children.size(); ++i) {
+        int child = n.children[i];
+        double childWidth = m_tree->GetNode(child).inclusive * scale;
+        // the children are sorted by cost, the rest are narrower than a pixel
+        if(childWidth < 1.0) { break; }
+        DoDrawNode(dc, child, x, childWidth, row + 1, visible);
+        x += childWidth;
+    }
+}
+
+void FlameGraphCtrl::DoDrawFrame(wxDC& dc, int node, const wxRect& rect, bool dimmed)
+{
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(wxBrush(GetFrameColour(node, dimmed)));
+    dc.DrawRectangle(rect);
+    m_frames.push_back(Frame());
+    m_frames.back().rect = rect;
+    m_frames.back().node = node;
+
+    if(rect.GetWidth() < 3 * dc.GetCharWidth()) { return; }
+    wxString label = wxControl::Ellipsize(wxString::FromUTF8(m_tree->GetFunctionName(node).c_str()), dc,
+                                          wxELLIPSIZE_END, rect.GetWidth() - 4);
+    dc.DrawText(label, rect.GetX() + 2, rect.GetY() + (rect.GetHeight() - dc.GetCharHeight()) / 2);
+}
+
+wxColour FlameGraphCtrl::GetFrameColour(int node, bool dimmed) const
+{
+    // a stable warm colour per function, like the classic flame graphs
+    size_t hash = std::hash<std::string>()(m_tree->GetFunctionName(node));
+    unsigned char red = 205 + (hash % 50);
+    unsigned char green = (hash / 50) % 200;
+    unsigned char blue = (hash / 10000) % 55;
+    wxColour colour(red, green, blue);
+    return dimmed ? colour.ChangeLightness(160) : colour;
+}
+
+int FlameGraphCtrl::HitTest(const wxPoint& pt) const
+{
+    wxPoint pos = CalcUnscrolledPosition(pt);
+    for(size_t i = 0; i < m_frames.size(); ++i) {
+        if(m_frames[i].rect.Contains(pos)) { return m_frames[i].node; }
+    }
+    return wxNOT_FOUND;
+}
+
+wxString FlameGraphCtrl::GetNodeDescription(int node) const
+{
+    if(!m_tree || node == wxNOT_FOUND) { return wxEmptyString; }
+    const ProfileTree::Node& n = m_tree->GetNode(node);
+    double total = m_tree->GetTotal() ? (double)m_tree->GetTotal() : 1.0;
+    wxString desc;
+    desc << wxString::FromUTF8(m_tree->GetFunctionName(node).c_str()) << "\n"
+         << wxString::Format(_("Inclusive: %.2f%% (%llu %s)"), n.inclusive * 100.0 / total,
+                             (unsigned long long)n.inclusive, m_tree->GetEventName().c_str())
+         << "\n"
+         << wxString::Format(_("Self: %.2f%% (%llu %s)"), n.self * 100.0 / total, (unsigned long long)n.self,
+                             m_tree->GetEventName().c_str());
+    return desc;
+}
+
+void FlameGraphCtrl::OnLeftDown(wxMouseEvent& event)
+{
+    event.Skip();
+    SetFocus();
+    ZoomTo(HitTest(event.GetPosition()));
+}
+
+void FlameGraphCtrl::OnLeftDClick(wxMouseEvent& event)
+{
+    int node = HitTest(event.GetPosition());
+    if(node == wxNOT_FOUND) { return; }
+
+    wxCommandEvent activated(wxEVT_FLAMEGRAPH_NODE_ACTIVATED, GetId());
+    activated.SetEventObject(this);
+    activated.SetInt(node);
+    GetEventHandler()->ProcessEvent(activated);
+}
+
+void FlameGraphCtrl::OnRightDown(wxMouseEvent& event)
+{
+    wxUnusedVar(event);
+    ZoomOut();
+}
+
+void FlameGraphCtrl::OnMotion(wxMouseEvent& event)
+{
+    event.Skip();
+    int node = HitTest(event.GetPosition());
+    if(node == m_hoverNode) { return; }
+    m_hoverNode = node;
+    if(node == wxNOT_FOUND) {
+        UnsetToolTip();
+    } else {
+        SetToolTip(GetNodeDescription(node));
+    }
+}
+
+void FlameGraphCtrl::OnKeyDown(wxKeyEvent& event)
+{
+    switch(event.GetKeyCode()) {
+    case WXK_ESCAPE:
+    case WXK_BACK:
+        ZoomOut();
+        break;
+    case WXK_HOME:
+        if(m_tree) { ZoomTo(m_tree->GetRoot()); }
+        break;
+    default:
+        event.Skip();
+        break;
+    }
+}
@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : flamegraphctrl.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef FLAMEGRAPHCTRL_H
+#define FLAMEGRAPHCTRL_H
+
+#include "profiletree.h"
+#include <vector>
+#include <wx/event.h>
+#include <wx/scrolwin.h>
+
+/// sent (as a wxCommandEvent) when a frame is double clicked, event.GetInt() is the node
+wxDECLARE_EVENT(wxEVT_FLAMEGRAPH_NODE_ACTIVATED, wxCommandEvent);
+
+/**
+ * @class FlameGraphCtrl
+ * @brief draws a ProfileTree as a flame graph (icicle layout): the root is the top row and every frame is as wide
+ * as its inclusive cost. Only the frames that are at least one pixel wide are drawn, so the cost of a paint does not
+ * depend on the size of the profile. Clicking a frame zooms into it, a right click (or Escape) zooms out
+ */
+class FlameGraphCtrl : public wxScrolledCanvas
+{
+    struct Frame {
+        wxRect rect;
+        int node;
+    };
+
+    const ProfileTree* m_tree;
+    int m_zoomNode;
+    int m_hoverNode;
+    int m_rowHeight;
+    std::vector<Frame> m_frames; // the frames drawn by the last paint
+
+protected:
+    void OnPaint(wxPaintEvent& event);
+    void OnSize(wxSizeEvent& event);
+    void OnLeftDown(wxMouseEvent& event);
+    void OnLeftDClick(wxMouseEvent& event);
+    void OnRightDown(wxMouseEvent& event);
+    void OnMotion(wxMouseEvent& event);
+    void OnKeyDown(wxKeyEvent& event);
+
+    void DoDrawNode(wxDC& dc, int node, double x, double width, int row, const wxRect& visible);
+    void DoDrawFrame(wxDC& dc, int node, const wxRect& rect, bool dimmed);
+    void DoUpdateVirtualSize();
+    wxColour GetFrameColour(int node, bool dimmed) const;
+    int GetZoomDepth() const;
+
+public:
+    FlameGraphCtrl(wxWindow* parent, wxWindowID id = wxID_ANY);
+    virtual ~FlameGraphCtrl();
+
+    /**
+     * @brief set the tree to display. The tree is not owned by the control and must outlive it (or be reset)
+     */
+    void SetTree(const ProfileTree* tree);
+
+    void ZoomTo(int node);
+    void ZoomOut();
+    int GetZoomNode() const { return m_zoomNode; }
+
+    /**
+     * @brief return the node drawn at 'pt' (client coordinates) or wxNOT_FOUND
+     */
+    int HitTest(const wxPoint& pt) const;
+
+    /**
+     * @brief a one line description of a node: name, inclusive and self cost
+     */
+    wxString GetNodeDescription(int node) const;
+};
+
+#endif // FLAMEGRAPHCTRL_H
@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : profileloaderthread.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "profileloaderthread.h"
+#include "profileparser.h"
+#include "uiprofilepanel.h"
+#include <fstream>
+#include <memory>
+#include <wx/intl.h>
+
+// the number of entries in the "hottest paths" list
+static const size_t HOTTEST_PATHS_COUNT = 200;
+
+ProfileLoaderThread::ProfileLoaderThread(uiprofilepanel* owner)
+    : m_owner(owner)
+{
+}
+
+ProfileLoaderThread::~ProfileLoaderThread() {}
+
+void ProfileLoaderThread::ProcessRequest(ThreadRequest* request)
+{
+    ProfileLoadRequest* req = dynamic_cast<ProfileLoadRequest*>(request);
+    if(!req) { return; }
+
+    ProfileLoadReply::Ptr_t reply(new ProfileLoadReply());
+    reply->filename = req->m_filename;
+
+    std::string filename = req->m_filename.ToStdString();
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if(!in.is_open()) {
+        reply->errorMessage << _("Could not open file: ") << req->m_filename;
+        m_owner->CallAfter(&uiprofilepanel::OnProfileLoaded, reply);
+        return;
+    }
+
+    ProfileParser::eFormat format = ProfileParser::DetectFormat(filename, in);
+    std::unique_ptr<ProfileParser> parser(ProfileParser::Create(format));
+    if(!parser) {
+        reply->errorMessage << _("Unknown profile format, expected a callgrind output file or the output of 'perf "
+                                 "script' for a profile recorded with 'perf record -g'");
+        m_owner->CallAfter(&uiprofilepanel::OnProfileLoaded, reply);
+        return;
+    }
+
+    // start over, DetectFormat() consumed the first lines
+    in.clear();
+    in.seekg(0);
+    parser->SetShouldStop([this]() { return TestDestroy(); });
+
+    reply->tree = new ProfileTree();
+    if(!parser->Parse(in, *reply->tree)) {
+        if(TestDestroy()) {
+            // the panel is going down
+            return;
+        }
+        reply->errorMessage = parser->GetError();
+        wxDELETE(reply->tree);
+    } else {
+        reply->tree->GetHottestPaths(HOTTEST_PATHS_COUNT, reply->hottestPaths);
+    }
+    m_owner->CallAfter(&uiprofilepanel::OnProfileLoaded, reply);
+}
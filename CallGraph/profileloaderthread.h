@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : profileloaderthread.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILELOADERTHREAD_H
+#define PROFILELOADERTHREAD_H
+
+#include "profiletree.h"
+#include "worker_thread.h"
+#include <memory>
+#include <vector>
+#include <wx/string.h>
+
+class uiprofilepanel;
+
+class ProfileLoadRequest : public ThreadRequest
+{
+public:
+    wxString m_filename;
+
+    ProfileLoadRequest(const wxString& filename)
+        : m_filename(filename.c_str()) // the string is used by the worker thread, make our own copy
+    {
+    }
+    virtual ~ProfileLoadRequest() {}
+};
+
+/**
+ * @class ProfileLoadReply
+ * @brief the result of loading a profile. It is shared, so it is freed even if the panel is destroyed before the
+ * reply is delivered
+ */
+class ProfileLoadReply
+{
+public:
+    typedef std::shared_ptr<ProfileLoadReply> Ptr_t;
+
+    wxString filename;
+    wxString errorMessage;
+    ProfileTree* tree = nullptr;
+    std::vector<int> hottestPaths; // nodes, most expensive first
+
+    ~ProfileLoadReply() { wxDELETE(tree); }
+};
+
+/**
+ * @class ProfileLoaderThread
+ * @brief parses a callgrind or perf script profile and aggregates it into a call tree away from the UI thread.
+ * The reply is delivered to the panel with CallAfter
+ */
+class ProfileLoaderThread : public WorkerThread
+{
+    uiprofilepanel* m_owner;
+
+public:
+    ProfileLoaderThread(uiprofilepanel* owner);
+    virtual ~ProfileLoaderThread();
+
+    virtual void ProcessRequest(ThreadRequest* request);
+};
+
+#endif // PROFILELOADERTHREAD_H
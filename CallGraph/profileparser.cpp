@@ -0,0 +1,520 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : profileparser.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "profileparser.h"
+#include <algorithm>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+// the maximum depth of the tree built from a call graph
+const int MAX_EXPAND_DEPTH = 256;
+// paths that cost less than this fraction of the total are not expanded
+const double MIN_EXPAND_COST = 0.0001;
+
+void Trim(std::string& str)
+{
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if(first == std::string::npos) {
+        str.clear();
+        return;
+    }
+    size_t last = str.find_last_not_of(" \t\r\n");
+    str.erase(last + 1);
+    str.erase(0, first);
+}
+
+bool StartsWith(const std::string& str, const char* prefix) { return str.compare(0, ::strlen(prefix), prefix) == 0; }
+
+void Split(const std::string& str, std::vector<std::string>& tokens)
+{
+    tokens.clear();
+    size_t pos = 0;
+    while(pos < str.length()) {
+        size_t start = str.find_first_not_of(" \t", pos);
+        if(start == std::string::npos) { break; }
+        size_t end = str.find_first_of(" \t", start);
+        if(end == std::string::npos) { end = str.length(); }
+        tokens.push_back(str.substr(start, end - start));
+        pos = end;
+    }
+}
+
+bool IsNumber(const std::string& str)
+{
+    if(str.empty()) { return false; }
+    for(size_t i = 0; i < str.length(); ++i) {
+        if(!isdigit((unsigned char)str[i])) { return false; }
+    }
+    return true;
+}
+
+bool IsHexNumber(const char* str, size_t len)
+{
+    size_t start = (len > 2 && str[0] == '0' && str[1] == 'x') ? 2 : 0;
+    if(len <= start) { return false; }
+    for(size_t i = start; i < len; ++i) {
+        if(!isxdigit((unsigned char)str[i])) { return false; }
+    }
+    return true;
+}
+
+void ReadLine(std::istream& in, std::string& line)
+{
+    std::getline(in, line);
+    if(!line.empty() && line[line.length() - 1] == '\r') { line.erase(line.length() - 1); }
+}
+} // namespace
+
+//---------------------------------------------------------------------------
+// ProfileParser
+//---------------------------------------------------------------------------
+
+ProfileParser::eFormat ProfileParser::DetectFormat(const std::string& filename, std::istream& in)
+{
+    size_t sep = filename.find_last_of("/\\");
+    std::string name = (sep == std::string::npos) ? filename : filename.substr(sep + 1);
+    if(StartsWith(name, "callgrind.out") || StartsWith(name, "cachegrind.out")) { return kCallgrind; }
+
+    std::string line;
+    for(size_t i = 0; i < 100 && in.good(); ++i) {
+        ReadLine(in, line);
+        if(StartsWith(line, "# callgrind format") || StartsWith(line, "events:") || StartsWith(line, "fn=")) {
+            return kCallgrind;
+        }
+        // a frame of a perf sample: "<tab>4004f1 main+0x11 (/tmp/a.out)"
+        if(!line.empty() && isspace((unsigned char)line[0])) {
+            std::string frame = line;
+            Trim(frame);
+            size_t space = frame.find(' ');
+            if(space != std::string::npos && IsHexNumber(frame.c_str(), space)) { return kPerfScript; }
+        }
+    }
+    return kUnknown;
+}
+
+ProfileParser* ProfileParser::Create(eFormat format)
+{
+    switch(format) {
+    case kCallgrind:
+        return new CallgrindParser();
+    case kPerfScript:
+        return new PerfScriptParser();
+    default:
+        return NULL;
+    }
+}
+
+//---------------------------------------------------------------------------
+// CallgrindParser
+//---------------------------------------------------------------------------
+
+std::string CallgrindParser::Resolve(const std::string& value, NameMap_t& names) const
+{
+    if(value.empty() || value[0] != '(') { return value; }
+    size_t close = value.find(')');
+    if(close == std::string::npos) { return value; }
+
+    std::string id = value.substr(0, close + 1);
+    std::string name = value.substr(close + 1);
+    Trim(name);
+    if(!name.empty()) {
+        names[id] = name;
+        return name;
+    }
+    NameMap_t::const_iterator iter = names.find(id);
+    return (iter == names.end()) ? id : iter->second;
+}
+
+bool CallgrindParser::ParseCostLine(const std::string& line, long& lineNumber, uint64_t& cost)
+{
+    // "<positions> <costs>", the positions may be relative to the previous cost line ("+n", "-n" or "*")
+    std::vector<std::string> tokens;
+    Split(line, tokens);
+    if(tokens.size() < m_positionCount) { return false; }
+
+    m_lastPositions.resize(m_positionCount, 0);
+    for(size_t i = 0; i < m_positionCount; ++i) {
+        const std::string& token = tokens[i];
+        if(token == "*") { continue; }
+        if(token[0] == '+' || token[0] == '-') {
+            m_lastPositions[i] += ::strtol(token.c_str(), NULL, 0);
+        } else {
+            m_lastPositions[i] = ::strtol(token.c_str(), NULL, 0);
+        }
+    }
+
+    lineNumber = (m_linePosition == wxNOT_FOUND) ? 0 : m_lastPositions[m_linePosition];
+    cost = (tokens.size() > m_positionCount) ? ::strtoull(tokens[m_positionCount].c_str(), NULL, 10) : 0;
+    return true;
+}
+
+void CallgrindParser::EnsureFunction(int function)
+{
+    if((size_t)function >= m_self.size()) {
+        m_self.resize(function + 1, 0);
+        m_calls.resize(function + 1);
+    }
+}
+
+uint64_t CallgrindParser::GetInclusive(int function) const
+{
+    uint64_t inclusive = m_self[function];
+    for(CallMap_t::const_iterator iter = m_calls[function].begin(); iter != m_calls[function].end(); ++iter) {
+        inclusive += iter->second;
+    }
+    return inclusive;
+}
+
+bool CallgrindParser::Parse(std::istream& in, ProfileTree& tree)
+{
+    std::string line;
+    std::string file;
+    std::string calleeFile;
+    std::string inlineFile;
+    int function = wxNOT_FOUND;
+    int callee = wxNOT_FOUND;
+    bool callCost = false; // the next cost line is the inclusive cost of a call
+    bool jumpCost = false; // the next cost line describes a jump, it has no cost of its own
+    bool hasCost = false;
+
+    for(size_t lineNumber = 1; in.good(); ++lineNumber) {
+        if(ShouldStop(lineNumber)) {
+            m_error = "Cancelled";
+            return false;
+        }
+
+        ReadLine(in, line);
+        if(line.empty() || line[0] == '#') { continue; }
+
+        char ch = line[0];
+        if(isdigit((unsigned char)ch) || ch == '+' || ch == '-' || ch == '*') {
+            long sourceLine = 0;
+            uint64_t cost = 0;
+            if(!ParseCostLine(line, sourceLine, cost)) { continue; }
+            if(jumpCost) {
+                jumpCost = false;
+
+            } else if(callCost) {
+                callCost = false;
+                if(function != wxNOT_FOUND && callee != wxNOT_FOUND && callee != function) {
+                    // recursive calls are already part of the caller's own cost
+                    m_calls[function][callee] += cost;
+                }
+                calleeFile = file;
+
+            } else if(function != wxNOT_FOUND) {
+                m_self[function] += cost;
+                if(sourceLine > 0 && (inlineFile.empty() || inlineFile == file)) {
+                    tree.SetLocation(function, file, sourceLine);
+                }
+            }
+            hasCost = true;
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        size_t colon = line.find(':');
+        if(eq != std::string::npos && (colon == std::string::npos || eq < colon)) {
+            std::string key = line.substr(0, eq);
+            std::string value = line.substr(eq + 1);
+            Trim(value);
+            if(key == "fl") {
+                file = Resolve(value, m_fileNames);
+                calleeFile = file;
+                inlineFile.clear();
+            } else if(key == "fi" || key == "fe") {
+                // inlined code, the cost still belongs to the current function
+                inlineFile = Resolve(value, m_fileNames);
+            } else if(key == "fn") {
+                function = tree.AddFunction(Resolve(value, m_functionNames), file);
+                EnsureFunction(function);
+                calleeFile = file;
+                inlineFile.clear();
+            } else if(key == "cfl" || key == "cfi") {
+                calleeFile = Resolve(value, m_fileNames);
+            } else if(key == "cfn") {
+                callee = tree.AddFunction(Resolve(value, m_functionNames), calleeFile);
+                EnsureFunction(callee);
+            } else if(key == "ob" || key == "cob") {
+                Resolve(value, m_objectNames);
+            } else if(key == "calls") {
+                // "calls=<count> <target position>"
+                std::vector<std::string> tokens;
+                Split(value, tokens);
+                if(callee != wxNOT_FOUND && m_linePosition != wxNOT_FOUND &&
+                   tokens.size() > (size_t)m_linePosition + 1) {
+                    tree.SetLocation(callee, calleeFile, ::atoi(tokens[m_linePosition + 1].c_str()));
+                }
+                callCost = true;
+            } else if(key == "jump" || key == "jcnd") {
+                jumpCost = true;
+            }
+            continue;
+        }
+
+        if(colon != std::string::npos) {
+            std::string key = line.substr(0, colon);
+            std::string value = line.substr(colon + 1);
+            Trim(value);
+            if(key == "events") {
+                std::vector<std::string> events;
+                Split(value, events);
+                if(!events.empty()) { tree.SetEventName(events[0]); }
+            } else if(key == "positions") {
+                std::vector<std::string> positions;
+                Split(value, positions);
+                m_positionCount = std::max<size_t>(positions.size(), 1);
+                std::vector<std::string>::iterator iter = std::find(positions.begin(), positions.end(), "line");
+                m_linePosition = (iter == positions.end()) ? wxNOT_FOUND : (int)(iter - positions.begin());
+                m_lastPositions.assign(m_positionCount, 0);
+            }
+        }
+    }
+
+    if(!hasCost) {
+        m_error = "No cost lines found, this is not a callgrind profile";
+        return false;
+    }
+    BuildTree(tree);
+    tree.Finalize();
+    return true;
+}
+
+void CallgrindParser::BuildTree(ProfileTree& tree)
+{
+    std::vector<char> called(m_self.size(), 0);
+    std::vector<uint64_t> inclusive(m_self.size(), 0);
+    for(size_t i = 0; i < m_self.size(); ++i) {
+        inclusive[i] = GetInclusive(i);
+        for(CallMap_t::const_iterator iter = m_calls[i].begin(); iter != m_calls[i].end(); ++iter) {
+            called[iter->first] = 1;
+        }
+    }
+
+    // the entry points are the functions that are never called
+    std::vector<int> roots;
+    uint64_t total = 0;
+    for(size_t i = 0; i < m_self.size(); ++i) {
+        if(!called[i] && inclusive[i]) {
+            roots.push_back(i);
+            total += inclusive[i];
+        }
+    }
+    if(roots.empty()) {
+        // everything is part of a cycle, start from the most expensive function
+        std::vector<uint64_t>::iterator iter = std::max_element(inclusive.begin(), inclusive.end());
+        if(iter == inclusive.end() || *iter == 0) { return; }
+        roots.push_back(iter - inclusive.begin());
+        total = *iter;
+    }
+
+    std::vector<char> onStack(m_self.size(), 0);
+    for(size_t i = 0; i < roots.size(); ++i) {
+        Expand(tree, tree.GetRoot(), roots[i], inclusive[roots[i]], total * MIN_EXPAND_COST, 0, onStack);
+    }
+    tree.AddCost(tree.GetRoot(), total, 0);
+}
+
+void CallgrindParser::Expand(ProfileTree& tree, int parent, int function, double budget, double minCost, int depth,
+                             std::vector<char>& onStack)
+{
+    int node = tree.GetChild(parent, function);
+    uint64_t inclusive = GetInclusive(function);
+    double scale = inclusive ? (budget / inclusive) : 0.0;
+    tree.AddCost(node, (uint64_t)(budget + 0.5), (uint64_t)(m_self[function] * scale + 0.5));
+    if(depth >= MAX_EXPAND_DEPTH) { return; }
+
+    onStack[function] = 1;
+    const CallMap_t& calls = m_calls[function];
+    for(CallMap_t::const_iterator iter = calls.begin(); iter != calls.end(); ++iter) {
+        double childBudget = iter->second * scale;
+        // a call back into the current path is a cycle: its cost is already accounted for by the caller
+        if(onStack[iter->first] || childBudget < minCost) { continue; }
+        Expand(tree, node, iter->first, childBudget, minCost, depth + 1, onStack);
+    }
+    onStack[function] = 0;
+}
+
+//---------------------------------------------------------------------------
+// PerfScriptParser
+//---------------------------------------------------------------------------
+
+uint64_t PerfScriptParser::ParseHeader(const std::string& line, std::string& eventName, std::string& remainder) const
+{
+    // "<comm> <tid> [<cpu>] <time>: [<period>] <event>: [<ip> <sym> (<dso>)]"
+    remainder.clear();
+    std::string previous;
+    size_t pos = line.find_first_not_of(" \t");
+    bool first = true;
+    while(pos != std::string::npos) {
+        size_t end = line.find_first_of(" \t", pos);
+        if(end == std::string::npos) { end = line.length(); }
+        std::string token = line.substr(pos, end - pos);
+        // the command name (first token) may end with a colon as well
+        if(!first && token.length() > 1 && token[token.length() - 1] == ':' && isalpha((unsigned char)token[0])) {
+            eventName = token.substr(0, token.length() - 1);
+            remainder = line.substr(end);
+            Trim(remainder);
+            return IsNumber(previous) ? ::strtoull(previous.c_str(), NULL, 10) : 1;
+        }
+        previous.swap(token);
+        first = false;
+        pos = line.find_first_not_of(" \t", end);
+    }
+    return 1;
+}
+
+bool PerfScriptParser::ParseFrame(const std::string& line, std::string& symbol) const
+{
+    // "<ip> <symbol>+<offset> (<dso>)". This is called for every frame, avoid temporary strings
+    size_t space = line.find(' ');
+    if(space == std::string::npos || !IsHexNumber(line.c_str(), space)) { return false; }
+
+    size_t start = line.find_first_not_of(' ', space);
+    size_t end = line.find_last_not_of(" \t");
+    if(start == std::string::npos) { return false; }
+    ++end;
+
+    size_t dsoStart = end;
+    size_t dsoEnd = end;
+    if(line[end - 1] == ')') {
+        size_t open = line.rfind('(', end - 1);
+        if(open != std::string::npos && open >= start) {
+            dsoStart = open + 1;
+            dsoEnd = end - 1;
+            end = open;
+            while(end > start && line[end - 1] == ' ') {
+                --end;
+            }
+        }
+    }
+
+    // strip the offset
+    size_t offset = line.rfind("+0x", end);
+    if(offset != std::string::npos && offset >= start && IsHexNumber(line.c_str() + offset + 1, end - offset - 1)) {
+        end = offset;
+    }
+
+    if(end == start || line.compare(start, end - start, "[unknown]") == 0) {
+        // no symbol, use the module instead
+        size_t sep = line.find_last_of("/\\", dsoEnd);
+        if(sep != std::string::npos && sep >= dsoStart) { dsoStart = sep + 1; }
+        if(dsoEnd > dsoStart && line.compare(dsoStart, dsoEnd - dsoStart, "unknown") != 0) {
+            symbol = "[" + line.substr(dsoStart, dsoEnd - dsoStart) + "]";
+        } else {
+            symbol = "[unknown]";
+        }
+        return true;
+    }
+    symbol.assign(line, start, end - start);
+    return true;
+}
+
+bool PerfScriptParser::ParseSourceLine(const std::string& line, std::string& file, int& lineNumber) const
+{
+    // "<file>:<line>", "??:0" when unknown
+    size_t colon = line.rfind(':');
+    if(colon == std::string::npos || colon == 0) { return false; }
+    std::string number = line.substr(colon + 1);
+    if(!IsNumber(number)) { return false; }
+
+    file = line.substr(0, colon);
+    lineNumber = ::atoi(number.c_str());
+    return file != "??" && lineNumber > 0;
+}
+
+bool PerfScriptParser::Parse(std::istream& in, ProfileTree& tree)
+{
+    std::string line;
+    std::string eventName;
+    std::string remainder;
+    std::string symbol;
+    std::string file;
+    std::vector<int> frames; // innermost first
+    uint64_t weight = 0;
+    bool inSample = false;
+    size_t samples = 0;
+
+    std::function<void()> flushSample = [&]() {
+        if(inSample && !frames.empty()) {
+            std::reverse(frames.begin(), frames.end());
+            tree.AddStack(frames, weight);
+            ++samples;
+        }
+        frames.clear();
+        inSample = false;
+    };
+
+    for(size_t lineNumber = 1; in.good(); ++lineNumber) {
+        if(ShouldStop(lineNumber)) {
+            m_error = "Cancelled";
+            return false;
+        }
+
+        ReadLine(in, line);
+        if(line.empty()) {
+            flushSample();
+            continue;
+        }
+        if(line[0] == '#') { continue; }
+
+        if(!isspace((unsigned char)line[0])) {
+            // a new sample
+            flushSample();
+            weight = ParseHeader(line, eventName, remainder);
+            inSample = true;
+            if(tree.GetEventName().empty() && !eventName.empty()) { tree.SetEventName(eventName); }
+            // a sample without a call graph has its address on the header line
+            if(!remainder.empty() && ParseFrame(remainder, symbol)) { frames.push_back(tree.AddFunction(symbol)); }
+            continue;
+        }
+
+        if(!inSample) { continue; }
+        Trim(line);
+        if(ParseFrame(line, symbol)) {
+            if(frames.size() == 1 && !remainder.empty()) {
+                // the call graph starts with the sample address again
+                frames.clear();
+                remainder.clear();
+            }
+            frames.push_back(tree.AddFunction(symbol));
+        } else if(!frames.empty()) {
+            int sourceLine = 0;
+            if(ParseSourceLine(line, file, sourceLine)) { tree.SetLocation(frames.back(), file, sourceLine); }
+        }
+    }
+    flushSample();
+
+    if(samples == 0) {
+        m_error = "No samples found, this is not the output of 'perf script'";
+        return false;
+    }
+    if(tree.GetEventName().empty()) { tree.SetEventName("samples"); }
+    tree.Finalize();
+    return true;
+}
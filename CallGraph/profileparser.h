@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : profileparser.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILEPARSER_H
+#define PROFILEPARSER_H
+
+#include "profiletree.h"
+#include <functional>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class ProfileParser
+ * @brief base class for the parsers that build a ProfileTree out of a profiler's output. The parsers read the input
+ * line by line and only keep the aggregated tree in memory, so they can handle profiles with millions of samples
+ */
+class ProfileParser
+{
+public:
+    enum eFormat { kUnknown = 0, kCallgrind, kPerfScript };
+
+protected:
+    std::function<bool()> m_shouldStop;
+    std::string m_error;
+
+protected:
+    /**
+     * @brief poll the stop callback every few thousand lines
+     */
+    bool ShouldStop(size_t lineNumber) const { return ((lineNumber & 0xFFF) == 0) && m_shouldStop && m_shouldStop(); }
+
+public:
+    ProfileParser() {}
+    virtual ~ProfileParser() {}
+
+    /**
+     * @brief read the profile from 'in' into 'tree'. Return false if the input is not valid or the parsing was
+     * stopped. The tree is finalized on success
+     */
+    virtual bool Parse(std::istream& in, ProfileTree& tree) = 0;
+
+    /**
+     * @brief a callback that is polled while parsing, returning true stops the parser
+     */
+    void SetShouldStop(const std::function<bool()>& shouldStop) { this->m_shouldStop = shouldStop; }
+    const std::string& GetError() const { return m_error; }
+
+    /**
+     * @brief guess the format of a profile from its file name and its first lines
+     */
+    static eFormat DetectFormat(const std::string& filename, std::istream& in);
+
+    /**
+     * @brief create a parser for 'format'. Return NULL for kUnknown
+     */
+    static ProfileParser* Create(eFormat format);
+};
+
+/**
+ * @class CallgrindParser
+ * @brief parses the callgrind (and cachegrind compatible) format. Only the first event is used. Callgrind records
+ * a call graph rather than call stacks: the tree is built by expanding the graph from the functions that are never
+ * called, splitting the cost of every function between its callers in proportion to the cost of their calls.
+ * Recursive calls are not expanded and paths that cost less than 0.01% of the total are pruned
+ */
+class CallgrindParser : public ProfileParser
+{
+    typedef std::unordered_map<std::string, std::string> NameMap_t;
+    typedef std::unordered_map<int, uint64_t> CallMap_t;
+
+    // name compression: "(id) name" defines a name, "(id)" refers to it
+    NameMap_t m_fileNames;
+    NameMap_t m_functionNames;
+    NameMap_t m_objectNames;
+
+    // the costs, indexed by the function index in the tree
+    std::vector<uint64_t> m_self;
+    std::vector<CallMap_t> m_calls;
+
+    size_t m_positionCount = 1;
+    int m_linePosition = 0; // wxNOT_FOUND: no line information
+    std::vector<long> m_lastPositions;
+
+protected:
+    std::string Resolve(const std::string& value, NameMap_t& names) const;
+    bool ParseCostLine(const std::string& line, long& lineNumber, uint64_t& cost);
+    void BuildTree(ProfileTree& tree);
+    void Expand(ProfileTree& tree, int parent, int function, double budget, double minCost, int depth,
+                std::vector<char>& onStack);
+    uint64_t GetInclusive(int function) const;
+    void EnsureFunction(int function);
+
+public:
+    CallgrindParser() {}
+    virtual ~CallgrindParser() {}
+    virtual bool Parse(std::istream& in, ProfileTree& tree);
+};
+
+/**
+ * @class PerfScriptParser
+ * @brief parses the output of "perf script" for a profile recorded with call graphs ("perf record -g"). Every
+ * sample is a header line followed by its stack, innermost frame first, and an empty line. When perf prints the
+ * sample period it is used as the weight of the sample. The source lines ("perf script -F +srcline") are used to
+ * locate the functions
+ */
+class PerfScriptParser : public ProfileParser
+{
+protected:
+    uint64_t ParseHeader(const std::string& line, std::string& eventName, std::string& remainder) const;
+    bool ParseFrame(const std::string& line, std::string& symbol) const;
+    bool ParseSourceLine(const std::string& line, std::string& file, int& lineNumber) const;
+
+public:
+    PerfScriptParser() {}
+    virtual ~PerfScriptParser() {}
+    virtual bool Parse(std::istream& in, ProfileTree& tree);
+};
+
+#endif // PROFILEPARSER_H
@@ -0,0 +1,167 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : profiletree.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "profiletree.h"
+#include <algorithm>
+
+ProfileTree::ProfileTree()
+{
+    m_functions.push_back(Function());
+    m_functions.back().name = "all";
+    m_nodes.push_back(Node());
+    m_nodes.back().function = 0;
+}
+
+ProfileTree::~ProfileTree() {}
+
+int ProfileTree::AddFunction(const std::string& name, const std::string& file, int line)
+{
+    std::unordered_map<std::string, int>::iterator iter = m_functionIndex.find(name);
+    if(iter != m_functionIndex.end()) {
+        SetLocation(iter->second, file, line);
+        return iter->second;
+    }
+
+    int function = (int)m_functions.size();
+    m_functions.push_back(Function());
+    m_functions.back().name = name;
+    m_functions.back().file = file;
+    m_functions.back().line = line;
+    m_functionIndex.insert(std::make_pair(name, function));
+    return function;
+}
+
+void ProfileTree::SetLocation(int function, const std::string& file, int line)
+{
+    Function& func = m_functions[function];
+    if(func.file.empty() && !file.empty()) {
+        func.file = file;
+        func.line = line;
+    } else if(func.line <= 0 && line > 0 && (file.empty() || func.file == file)) {
+        func.line = line;
+    }
+}
+
+int ProfileTree::GetChild(int node, int function)
+{
+    uint64_t key = ((uint64_t)node << 32) | (uint32_t)function;
+    std::unordered_map<uint64_t, int>::iterator iter = m_childIndex.find(key);
+    if(iter != m_childIndex.end()) { return iter->second; }
+
+    int child = (int)m_nodes.size();
+    m_nodes.push_back(Node());
+    Node& childNode = m_nodes.back();
+    childNode.function = function;
+    childNode.parent = node;
+    childNode.depth = m_nodes[node].depth + 1;
+    m_nodes[node].children.push_back(child);
+    m_childIndex.insert(std::make_pair(key, child));
+    m_maxDepth = std::max(m_maxDepth, childNode.depth);
+    return child;
+}
+
+void ProfileTree::AddStack(const std::vector<int>& frames, uint64_t weight)
+{
+    int node = GetRoot();
+    m_nodes[node].inclusive += weight;
+    for(size_t i = 0; i < frames.size(); ++i) {
+        node = GetChild(node, frames[i]);
+        m_nodes[node].inclusive += weight;
+    }
+    m_nodes[node].self += weight;
+}
+
+void ProfileTree::AddCost(int node, uint64_t inclusive, uint64_t self)
+{
+    m_nodes[node].inclusive += inclusive;
+    m_nodes[node].self += self;
+}
+
+void ProfileTree::Finalize()
+{
+    // the lookup table is only needed while building the tree
+    m_childIndex.clear();
+    m_functionIndex.clear();
+
+    for(size_t i = 0; i < m_functions.size(); ++i) {
+        m_functions[i].self = 0;
+        m_functions[i].inclusive = 0;
+    }
+
+    // iterative DFS: a recursive function is only counted by its outermost frame
+    std::vector<int> onStack(m_functions.size(), 0);
+    std::vector<std::pair<int, size_t> > stack;
+    stack.push_back(std::make_pair(GetRoot(), 0));
+    ++onStack[m_nodes[GetRoot()].function];
+    while(!stack.empty()) {
+        int node = stack.back().first;
+        size_t& next = stack.back().second;
+        Node& n = m_nodes[node];
+        if(next == 0) {
+            std::sort(n.children.begin(), n.children.end(),
+                      [this](int a, int b) { return m_nodes[a].inclusive > m_nodes[b].inclusive; });
+            Function& func = m_functions[n.function];
+            func.self += n.self;
+            if(onStack[n.function] == 1) { func.inclusive += n.inclusive; }
+        }
+
+        if(next < n.children.size()) {
+            int child = n.children[next++];
+            ++onStack[m_nodes[child].function];
+            stack.push_back(std::make_pair(child, 0));
+        } else {
+            --onStack[n.function];
+            stack.pop_back();
+        }
+    }
+}
+
+void ProfileTree::GetHottestPaths(size_t count, std::vector<int>& nodes) const
+{
+    nodes.clear();
+    for(size_t i = 1; i < m_nodes.size(); ++i) {
+        if(m_nodes[i].self) { nodes.push_back((int)i); }
+    }
+
+    count = std::min(count, nodes.size());
+    std::partial_sort(nodes.begin(), nodes.begin() + count, nodes.end(),
+                      [this](int a, int b) { return m_nodes[a].self > m_nodes[b].self; });
+    nodes.resize(count);
+}
+
+std::string ProfileTree::GetPath(int node, const std::string& separator) const
+{
+    std::vector<int> path;
+    for(; node > 0; node = m_nodes[node].parent) {
+        path.push_back(node);
+    }
+
+    std::string result;
+    for(std::vector<int>::reverse_iterator iter = path.rbegin(); iter != path.rend(); ++iter) {
+        if(!result.empty()) { result += separator; }
+        result += GetFunctionName(*iter);
+    }
+    return result;
+}
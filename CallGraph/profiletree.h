@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : profiletree.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILETREE_H
+#define PROFILETREE_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wx/defs.h>
+
+/**
+ * @class ProfileTree
+ * @brief an aggregated call tree built from a sampling or an instrumentation profile (callgrind, perf script).
+ * Every node is a unique call path from the root, its inclusive cost is the cost of the path and its self
+ * (exclusive) cost is the cost spent in the function itself. The function names are interned so a node only keeps
+ * an index into the function table. The root node is the pseudo function "all". The tree does not use any GUI
+ * object and can be built from a worker thread
+ */
+class ProfileTree
+{
+public:
+    struct Function {
+        std::string name;
+        std::string file;
+        int line = 0;
+        uint64_t self = 0;
+        uint64_t inclusive = 0; // recursive calls are only counted once
+    };
+
+    struct Node {
+        int function = wxNOT_FOUND;
+        int parent = wxNOT_FOUND;
+        int depth = 0;
+        uint64_t inclusive = 0;
+        uint64_t self = 0;
+        std::vector<int> children; // sorted by inclusive cost after Finalize()
+    };
+
+protected:
+    std::vector<Function> m_functions;
+    std::unordered_map<std::string, int> m_functionIndex;
+    std::vector<Node> m_nodes;
+    // (parent node << 32 | function) -> child node
+    std::unordered_map<uint64_t, int> m_childIndex;
+    std::string m_eventName;
+    int m_maxDepth = 0;
+
+public:
+    ProfileTree();
+    virtual ~ProfileTree();
+
+    /**
+     * @brief return the index of the function 'name', adding it to the function table if needed. The location
+     * is only recorded the first time it is known
+     */
+    int AddFunction(const std::string& name, const std::string& file = "", int line = 0);
+
+    /**
+     * @brief record the location of a function, unless it is already known
+     */
+    void SetLocation(int function, const std::string& file, int line);
+
+    /**
+     * @brief return the child of 'node' for 'function', creating it if needed
+     */
+    int GetChild(int node, int function);
+
+    /**
+     * @brief add a sample. 'frames' are function indexes, starting with the outermost caller
+     */
+    void AddStack(const std::vector<int>& frames, uint64_t weight);
+
+    /**
+     * @brief add cost to a node (and only to it). Used when the tree is built from a call graph rather than stacks
+     */
+    void AddCost(int node, uint64_t inclusive, uint64_t self);
+
+    /**
+     * @brief sort the children and compute the per function totals. Call this once the tree is complete
+     */
+    void Finalize();
+
+    /**
+     * @brief the nodes with the highest self cost, most expensive first
+     */
+    void GetHottestPaths(size_t count, std::vector<int>& nodes) const;
+
+    /**
+     * @brief the call path to 'node', e.g. "main > run > compute"
+     */
+    std::string GetPath(int node, const std::string& separator = " > ") const;
+
+    int GetRoot() const { return 0; }
+    uint64_t GetTotal() const { return m_nodes[0].inclusive; }
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    int GetMaxDepth() const { return m_maxDepth; }
+    const Node& GetNode(int node) const { return m_nodes[node]; }
+    const Function& GetFunction(int function) const { return m_functions[function]; }
+    const std::vector<Function>& GetFunctions() const { return m_functions; }
+    const std::string& GetFunctionName(int node) const { return m_functions[m_nodes[node].function].name; }
+    void SetEventName(const std::string& eventName) { this->m_eventName = eventName; }
+    const std::string& GetEventName() const { return m_eventName; }
+};
+
+#endif // PROFILETREE_H
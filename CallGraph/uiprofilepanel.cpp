@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : uiprofilepanel.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "uiprofilepanel.h"
+#include "file_logger.h"
+#include <wx/filename.h>
+#include <wx/sizer.h>
+
+uiprofilepanel::uiprofilepanel(wxWindow* parent, IManager* mgr, const wxString& filename)
+    : wxPanel(parent)
+    , m_mgr(mgr)
+    , m_filename(filename)
+    , m_thread(NULL)
+{
+    wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
+    SetSizer(mainSizer);
+
+    m_staticTextInfo = new wxStaticText(this, wxID_ANY, _("Loading ") + filename + "...");
+    mainSizer->Add(m_staticTextInfo, 0, wxALL | wxEXPAND, 5);
+
+    m_splitter = new wxSplitterWindow(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxSP_3D | wxSP_LIVE_UPDATE);
+    m_splitter->SetSashGravity(0.7);
+    m_splitter->SetMinimumPaneSize(50);
+    mainSizer->Add(m_splitter, 1, wxALL | wxEXPAND, 0);
+
+    m_flameGraph = new FlameGraphCtrl(m_splitter);
+    m_listCtrlPaths = new wxListCtrl(m_splitter, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+                                     wxLC_REPORT | wxLC_SINGLE_SEL);
+    m_listCtrlPaths->AppendColumn(_("Self %"), wxLIST_FORMAT_RIGHT, 70);
+    m_listCtrlPaths->AppendColumn(_("Inclusive %"), wxLIST_FORMAT_RIGHT, 90);
+    m_listCtrlPaths->AppendColumn(_("Function"), wxLIST_FORMAT_LEFT, 250);
+    m_listCtrlPaths->AppendColumn(_("Location"), wxLIST_FORMAT_LEFT, 250);
+    m_listCtrlPaths->AppendColumn(_("Call path"), wxLIST_FORMAT_LEFT, 600);
+    m_splitter->SplitHorizontally(m_flameGraph, m_listCtrlPaths);
+
+    m_flameGraph->Bind(wxEVT_FLAMEGRAPH_NODE_ACTIVATED, &uiprofilepanel::OnFlameGraphNodeActivated, this);
+    m_listCtrlPaths->Bind(wxEVT_LIST_ITEM_SELECTED, &uiprofilepanel::OnPathSelected, this);
+    m_listCtrlPaths->Bind(wxEVT_LIST_ITEM_ACTIVATED, &uiprofilepanel::OnPathActivated, this);
+
+    m_thread = new ProfileLoaderThread(this);
+    m_thread->Start();
+    m_thread->Add(new ProfileLoadRequest(filename));
+}
+
+uiprofilepanel::~uiprofilepanel()
+{
+    // stop the parser (if still running) before the tree goes away
+    m_thread->Stop();
+    wxDELETE(m_thread);
+
+    m_flameGraph->Unbind(wxEVT_FLAMEGRAPH_NODE_ACTIVATED, &uiprofilepanel::OnFlameGraphNodeActivated, this);
+    m_listCtrlPaths->Unbind(wxEVT_LIST_ITEM_SELECTED, &uiprofilepanel::OnPathSelected, this);
+    m_listCtrlPaths->Unbind(wxEVT_LIST_ITEM_ACTIVATED, &uiprofilepanel::OnPathActivated, this);
+    m_flameGraph->SetTree(NULL);
+}
+
+void uiprofilepanel::OnProfileLoaded(ProfileLoadReply::Ptr_t reply)
+{
+    m_profile = reply;
+    if(!m_profile->tree) {
+        clWARNING() << "CallGraph: failed to load profile" << m_profile->filename << ":" << m_profile->errorMessage
+                    << clEndl;
+        m_staticTextInfo->SetLabel(m_profile->filename + ": " + m_profile->errorMessage);
+        return;
+    }
+
+    const ProfileTree* tree = m_profile->tree;
+    wxString info;
+    info << m_profile->filename << " - " << tree->GetTotal() << " " << tree->GetEventName() << ", "
+         << (tree->GetFunctions().size() - 1) << _(" functions, ") << (tree->GetNodeCount() - 1)
+         << _(" call paths. Click a frame to zoom in, right click to zoom out, double click to open the source");
+    m_staticTextInfo->SetLabel(info);
+    clDEBUG() << "CallGraph: loaded profile" << m_profile->filename << "with" << tree->GetNodeCount() << "nodes"
+              << clEndl;
+
+    m_flameGraph->SetTree(tree);
+    DoPopulatePaths();
+    Layout();
+}
+
+void uiprofilepanel::DoPopulatePaths()
+{
+    m_listCtrlPaths->DeleteAllItems();
+    const ProfileTree* tree = m_profile->tree;
+    double total = tree->GetTotal() ? (double)tree->GetTotal() : 1.0;
+
+    m_listCtrlPaths->Freeze();
+    for(size_t i = 0; i < m_profile->hottestPaths.size(); ++i) {
+        int node = m_profile->hottestPaths[i];
+        const ProfileTree::Node& n = tree->GetNode(node);
+        const ProfileTree::Function& func = tree->GetFunction(n.function);
+        wxString location;
+        if(!func.file.empty()) {
+            location << wxString::FromUTF8(func.file.c_str());
+            if(func.line > 0) { location << ":" << func.line; }
+        }
+
+        long item = m_listCtrlPaths->InsertItem(i, wxString::Format("%.2f", n.self * 100.0 / total));
+        m_listCtrlPaths->SetItem(item, 1, wxString::Format("%.2f", n.inclusive * 100.0 / total));
+        m_listCtrlPaths->SetItem(item, 2, wxString::FromUTF8(func.name.c_str()));
+        m_listCtrlPaths->SetItem(item, 3, location);
+        m_listCtrlPaths->SetItem(item, 4, wxString::FromUTF8(tree->GetPath(node).c_str()));
+        m_listCtrlPaths->SetItemData(item, node);
+    }
+    m_listCtrlPaths->Thaw();
+}
+
+void uiprofilepanel::OnFlameGraphNodeActivated(wxCommandEvent& event) { DoOpenSource(event.GetInt()); }
+
+void uiprofilepanel::OnPathSelected(wxListEvent& event)
+{
+    // show the path in the flame graph
+    int node = (int)m_listCtrlPaths->GetItemData(event.GetIndex());
+    if(m_profile && m_profile->tree && m_profile->tree->GetNode(node).parent != wxNOT_FOUND) {
+        m_flameGraph->ZoomTo(m_profile->tree->GetNode(node).parent);
+    }
+}
+
+void uiprofilepanel::OnPathActivated(wxListEvent& event)
+{
+    DoOpenSource((int)m_listCtrlPaths->GetItemData(event.GetIndex()));
+}
+
+void uiprofilepanel::DoOpenSource(int node)
+{
+    if(!m_profile || !m_profile->tree || node == wxNOT_FOUND) { return; }
+    const ProfileTree::Function& func = m_profile->tree->GetFunction(m_profile->tree->GetNode(node).function);
+    if(func.file.empty()) {
+        m_mgr->SetStatusMessage(_("No source information for ") + wxString::FromUTF8(func.name.c_str()), 5);
+        return;
+    }
+
+    // relative paths are relative to the directory the profile was recorded in
+    wxFileName fn(wxString::FromUTF8(func.file.c_str()));
+    if(fn.IsRelative()) { fn.MakeAbsolute(wxFileName(m_filename).GetPath()); }
+    if(!fn.FileExists()) {
+        m_mgr->SetStatusMessage(_("Could not find file: ") + fn.GetFullPath(), 5);
+        return;
+    }
+    m_mgr->OpenFile(fn.GetFullPath(), wxEmptyString, func.line > 0 ? (func.line - 1) : wxNOT_FOUND);
+}
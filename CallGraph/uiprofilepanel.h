@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2014 Eran Ifrah
+// file name            : uiprofilepanel.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef UIPROFILEPANEL_H
+#define UIPROFILEPANEL_H
+
+#include "flamegraphctrl.h"
+#include "plugin.h"
+#include "profileloaderthread.h"
+#include <wx/listctrl.h>
+#include <wx/panel.h>
+#include <wx/splitter.h>
+#include <wx/stattext.h>
+
+/**
+ * @class uiprofilepanel
+ * @brief an editor page displaying an imported profile (callgrind or perf script): a flame graph of the aggregated
+ * call tree and the list of the hottest call paths. The profile is loaded by a worker thread so large profiles
+ * don't block the UI. Double clicking a frame or a path opens the function's source
+ */
+class uiprofilepanel : public wxPanel
+{
+    IManager* m_mgr;
+    wxString m_filename;
+    ProfileLoaderThread* m_thread;
+    ProfileLoadReply::Ptr_t m_profile;
+    wxStaticText* m_staticTextInfo;
+    wxSplitterWindow* m_splitter;
+    FlameGraphCtrl* m_flameGraph;
+    wxListCtrl* m_listCtrlPaths;
+
+protected:
+    void OnFlameGraphNodeActivated(wxCommandEvent& event);
+    void OnPathSelected(wxListEvent& event);
+    void OnPathActivated(wxListEvent& event);
+    void DoPopulatePaths();
+    void DoOpenSource(int node);
+
+public:
+    uiprofilepanel(wxWindow* parent, IManager* mgr, const wxString& filename);
+    virtual ~uiprofilepanel();
+
+    /**
+     * @brief called by the loader thread (using CallAfter) once the profile is parsed
+     */
+    void OnProfileLoaded(ProfileLoadReply::Ptr_t reply);
+};
+
+#endif // UIPROFILEPANEL_H
@@ -3,12 +3,14 @@
 
 #include "tester.h"
 #include <algorithm>
+#include <clIncludeGraphCache.h>
 #include <cpptoken.h>
 #include <cppwordscanner.h>
 #include <memory>
 #include <parse_thread.h>
 #include <refactorengine.h>
 #include <stringsearcher.h>
+#include <tags_storage_sqlite3.h>
 #include <vector>
 #include <wx/event.h>
 #include <wx/ffile.h>
@@ -486,6 +488,67 @@ TEST_FUNC(testUnorderedMapIterator)
     return true;
 }
 
+TEST_FUNC(testScanIncludes)
+{
+    std::string content = "#include <vector>\n"
+                          "  #  include \"local.h\"\n"
+                          "// #include \"commented.h\"\n"
+                          "/* #include \"block.h\"\n"
+                          "   #include \"block2.h\" */\n"
+                          "const char* s = \"#include \\\"string.h\\\"\";\n"
+                          "#define HEADER \"macro.h\"\n"
+                          "#include_next <limits.h>\n"
+                          "#import \"objc.h\"\n";
+    wxArrayString names;
+    clIncludeGraphCache::ScanIncludes(content, names);
+    CHECK_SIZE(names.size(), 4);
+    CHECK_CONDITION(names.Item(0) == "vector", "Expected 'vector'");
+    CHECK_CONDITION(names.Item(1) == "local.h", "Expected 'local.h'");
+    CHECK_CONDITION(names.Item(2) == "limits.h", "Expected 'limits.h'");
+    CHECK_CONDITION(names.Item(3) == "objc.h", "Expected 'objc.h'");
+    return true;
+}
+
+TEST_FUNC(testSqliteArgList)
+{
+    wxArrayString values;
+    values.Add("a");
+    values.Add("b");
+    values.Add("c");
+    clSqliteQuery query("select * from tags where name in (");
+    query.AddArgList(values) << ")";
+    CHECK_CONDITION(query.GetSql() == "select * from tags where name in (?,?,?,?)", "List not padded to 4 values");
+    CHECK_CONDITION(query.IsCacheable(), "A short list should be cacheable");
+
+    // lists of a similar size share the statement, not the results
+    values.Add("d");
+    clSqliteQuery other("select * from tags where name in (");
+    other.AddArgList(values) << ")";
+    CHECK_CONDITION(other.GetSql() == query.GetSql(), "Lists of 3 and 4 values should share the statement");
+    CHECK_CONDITION(other.GetKey() != query.GetKey(), "Different values should have different keys");
+
+    // very long lists are written as literals
+    wxArrayString many;
+    for(size_t i = 0; i < 300; ++i) {
+        many.Add(wxString::Format("n%u", (unsigned)i));
+    }
+    many.Item(0) = "it's";
+    clSqliteQuery literal;
+    literal.AddArgList(many);
+    CHECK_CONDITION(!literal.IsCacheable(), "A long list should not be cacheable");
+    CHECK_CONDITION(literal.GetSql().StartsWith("'it''s','n1','n2'"), "Literals are not quoted");
+    CHECK_CONDITION(literal.GetSql().Find("?") == wxNOT_FOUND, "A long list should not use placeholders");
+
+    // the statistics share a single text for all the long lists
+    clSqliteQuery stats("select * from tags where name in (");
+    stats.AddArgList(many) << ") and kind=";
+    stats.AddArg(1);
+    CHECK_CONDITION(stats.GetStatsSql() == "select * from tags where name in (<literal list>) and kind=?",
+                    "The literal list should be replaced in the statistics text");
+    CHECK_CONDITION(query.GetStatsSql() == query.GetSql(), "A cacheable query should use its SQL as statistics text");
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
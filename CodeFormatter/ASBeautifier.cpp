@@ -18,7 +18,8 @@
 namespace astyle {
 //
 // this must be global
-static int g_preprocessorCppExternCBrace;
+// (thread local: CodeFormatter runs several formatters in parallel when formatting many files)
+static thread_local int g_preprocessorCppExternCBrace;
 
 //-----------------------------------------------------------------------------
 // ASBeautifier class
@@ -2300,7 +2301,7 @@ void ASBeautifier::adjustObjCMethodDefinitionIndentation(const string& line_)
 
 void ASBeautifier::adjustObjCMethodCallIndentation(const string& line_)
 {
-	static int keywordIndentObjCMethodAlignment = 0;
+	static thread_local int keywordIndentObjCMethodAlignment = 0;
 	if (shouldAlignMethodColon && objCColonAlignSubsequent != -1)
 	{
 		if (isInObjCMethodCallFirst)
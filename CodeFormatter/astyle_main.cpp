@@ -3649,7 +3649,7 @@ size_t ASEncoding::utf16ToUtf8(char* utf16In, size_t inLen, bool isBigEndian,
 	ubyte* pCur = reinterpret_cast<ubyte*>(utf8Out);
 	const ubyte* pEnd = pRead + inLen;
 	const ubyte* pCurStart = pCur;
-	static eState state = eStart;	// state is retained for subsequent blocks
+	static thread_local eState state = eStart;	// state is retained for subsequent blocks
 	if (firstBlock)
 		state = eStart;
 
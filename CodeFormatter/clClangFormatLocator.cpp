@@ -2,6 +2,9 @@
 #include "cl_standard_paths.h"
 #include "globals.h"
 #include "procutils.h"
+#include "wxStringHash.h"
+#include <mutex>
+#include <unordered_map>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/regex.h>
@@ -57,6 +60,15 @@ double clClangFormatLocator::GetVersion(const wxString& clangFormat) const
     //    clang-format version 3.6.0 (217570) // Windows
     double_version = 3.3;
 
+    // the version is requested for every file we format, don't launch a process each time
+    static std::unordered_map<wxString, double> versionCache;
+    static std::mutex versionCacheMutex;
+    {
+        std::lock_guard<std::mutex> lock(versionCacheMutex);
+        auto iter = versionCache.find(clangFormat);
+        if(iter != versionCache.end()) { return iter->second; }
+    }
+
     static wxRegEx reClangFormatVersion("version ([0-9]+\\.[0-9]+)");
     wxString command;
     command << clangFormat;
@@ -70,9 +82,12 @@ double clClangFormatLocator::GetVersion(const wxString& clangFormat) const
             wxString version = reClangFormatVersion.GetMatch(lines.Item(i), 1);
             // clLogMessage("clang-format version is %s", version);
             version.ToCDouble(&double_version);
-            return double_version;
+            break;
         }
     }
+
+    std::lock_guard<std::mutex> lock(versionCacheMutex);
+    versionCache[clangFormat] = double_version;
 #elif defined(__WXMSW__)
     double_version = 3.6;
 #else
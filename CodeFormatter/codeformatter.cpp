@@ -28,6 +28,7 @@
 #include "clSTCLineKeeper.h"
 #include "clWorkspaceManager.h"
 #include "codeformatter.h"
+#include "codeformatterbatch.h"
 #include "codeformatterdlg.h"
 #include "editor_config.h"
 #include "event_notifier.h"
@@ -45,6 +46,7 @@
 #include "wx/log.h"
 #include "wx/menu.h"
 #include <algorithm>
+#include <map>
 #include <wx/app.h> //wxInitialize/wxUnInitialize
 #include <wx/ffile.h>
 #include <wx/filename.h>
@@ -444,7 +446,7 @@ void CodeFormatter::DoFormatWithClang(wxString& content, const wxFileName& fileN
     if(selStart != wxNOT_FOUND) { content = content.Mid(selStart, content.length() - tailLength - selStart); }
 }
 
-void CodeFormatter::DoFormatWithAstyle(wxString& content, const bool& appendEOL)
+wxString CodeFormatter::DoGetAstyleOptions()
 {
     wxString options = m_options.AstyleOptionsAsString();
 
@@ -453,7 +455,11 @@ void CodeFormatter::DoFormatWithAstyle(wxString& content, const bool& appendEOL)
     int tabWidth = m_mgr->GetEditorSettings()->GetTabWidth();
     int indentWidth = m_mgr->GetEditorSettings()->GetIndentWidth();
     options << (useTabs && tabWidth == indentWidth ? wxT(" -t") : wxT(" -s")) << indentWidth;
+    return options;
+}
 
+void CodeFormatter::FormatWithAstyle(wxString& content, const wxString& options)
+{
     char* textOut = AStyleMain(_C(content), _C(options), ASErrorHandler, ASMemoryAlloc);
     content.clear();
     if(textOut) {
@@ -461,6 +467,11 @@ void CodeFormatter::DoFormatWithAstyle(wxString& content, const bool& appendEOL)
         content.Trim();
         delete[] textOut;
     }
+}
+
+void CodeFormatter::DoFormatWithAstyle(wxString& content, const bool& appendEOL)
+{
+    FormatWithAstyle(content, DoGetAstyleOptions());
     if(content.IsEmpty() || !appendEOL) { return; }
 
     content << DoGetGlobalEOLString();
@@ -565,6 +576,11 @@ void CodeFormatter::HookPopupMenu(wxMenu* menu, MenuType type)
 
 void CodeFormatter::UnPlug()
 {
+    if(m_batch) {
+        m_batch->Cancel();
+        wxDELETE(m_batch);
+    }
+
     m_mgr->GetTheApp()->Disconnect(XRCID("format_source"), wxEVT_COMMAND_MENU_SELECTED,
                                    wxCommandEventHandler(CodeFormatter::OnFormat), NULL, (wxEvtHandler*)this);
     m_mgr->GetTheApp()->Disconnect(XRCID("formatter_options"), wxEVT_COMMAND_MENU_SELECTED,
@@ -700,25 +716,119 @@ void CodeFormatter::BatchFormat(const std::vector<wxFileName>& files, bool silen
         return;
     }
 
-    wxProgressDialog* dlg = nullptr;
     if(!silent) {
         wxString msg;
         msg << _("You are about to beautify ") << files.size() << _(" files\nContinue?");
         if(wxYES != ::wxMessageBox(msg, _("Source Code Formatter"), wxYES_NO | wxCANCEL | wxCENTER)) { return; }
+    }
 
-        dlg = new wxProgressDialog(_("Source Code Formatter"), _("Formatting files..."), (int)files.size(),
-                                   m_mgr->GetTheApp()->GetTopWindow());
+    if(files.size() == 1) {
+        // a single file is formatted synchronously: the caller expects the file to be formatted when we return
+        FormatterEngine engine = FindFormatter(files.at(0).GetFullPath());
+        DoFormatFile(files.at(0).GetFullPath(), engine);
+        EventNotifier::Get()->PostReloadExternallyModifiedEvent(false);
+        return;
     }
-    for(size_t i = 0; i < files.size(); ++i) {
-        wxString msg;
-        msg << "[ " << i << " / " << files.size() << " ] " << files.at(i).GetFullName();
-        if(dlg) { dlg->Update(i, msg); }
+    DoBatchFormatAsync(files);
+}
+
+void CodeFormatter::DoBatchFormatAsync(const std::vector<wxFileName>& files)
+{
+    if(m_batch) {
+        ::wxMessageBox(_("Source Code Formatter is already formatting files. Please wait for it to complete"),
+                       _("Source Code Formatter"), wxOK | wxCENTER | wxICON_WARNING);
+        return;
+    }
+
+    // Resolve everything that requires the IDE settings here, on the main thread
+    m_batch = new CodeFormatterBatch(this, m_formattedFiles);
+    wxString astyleOptions = DoGetAstyleOptions();
+    wxString eol = DoGetGlobalEOLString();
+    m_batch->SetAstyleOptions(astyleOptions, eol);
 
-        FormatterEngine engine = FindFormatter(files.at(i).GetFullPath());
-        DoFormatFile(files.at(i).GetFullPath(), engine);
+    PHPFormatterOptions phpOptions;
+    phpOptions.flags = m_options.GetPHPFormatterOptions();
+    if(m_mgr->GetEditorSettings()->GetIndentUsesTabs()) { phpOptions.flags |= kPFF_UseTabs; }
+    phpOptions.indentSize = m_mgr->GetEditorSettings()->GetTabWidth();
+    phpOptions.eol = m_mgr->GetEditorSettings()->GetEOLAsString();
+    m_batch->SetPhpOptions(phpOptions);
+
+    int xmlIndent = m_mgr->GetEditorSettings()->GetIndentWidth();
+    m_batch->SetXmlIndent(xmlIndent);
+
+    wxString phpSettings;
+    phpSettings << phpOptions.flags << "|" << phpOptions.indentSize << "|" << phpOptions.eol;
+
+    // clang-format files are grouped by style, so a single process can format many files
+    std::map<wxString, std::vector<wxFileName>> clangFormatFiles;
+    for(const wxFileName& file : files) {
+        FormatterEngine engine = FindFormatter(file);
+        std::vector<wxFileName> single(1, file);
+        wxString command;
+        switch(engine) {
+        case kFormatEngineClangFormat:
+            if(m_options.GetClangFormatExe().IsEmpty()) {
+                clWARNING() << "CodeFormatter: Missing clang_format exec" << clEndl;
+                break;
+            }
+            clangFormatFiles[m_options.GetClangFormatStyleAsString(file)].push_back(file);
+            break;
+        case kFormatEngineAStyle:
+            m_batch->AddTask(engine, single, wxEmptyString, astyleOptions + "|" + eol);
+            break;
+        case kFormatEngineBuildInPhp:
+            m_batch->AddTask(engine, single, wxEmptyString, phpSettings);
+            break;
+        case kFormatEngineWxXmlDocument:
+            m_batch->AddTask(engine, single, wxEmptyString, wxString() << xmlIndent);
+            break;
+        case kFormatEnginePhpCsFixer:
+            if(m_options.GetPhpFixerCommand(file, command)) { m_batch->AddTask(engine, single, command, command); }
+            break;
+        case kFormatEnginePhpcbf:
+            if(m_options.GetPhpcbfCommand(file, command)) { m_batch->AddTask(engine, single, command, command); }
+            break;
+        default:
+            break;
+        }
+    }
+
+    for(const auto& vt : clangFormatFiles) {
+        wxString command = m_options.ClangFormatBatchCommand(vt.first);
+        const std::vector<wxFileName>& styleFiles = vt.second;
+        for(size_t i = 0; i < styleFiles.size(); i += CodeFormatterBatch::kClangFormatFilesPerProcess) {
+            size_t last = std::min(styleFiles.size(), i + CodeFormatterBatch::kClangFormatFilesPerProcess);
+            std::vector<wxFileName> chunk(styleFiles.begin() + i, styleFiles.begin() + last);
+            m_batch->AddTask(kFormatEngineClangFormat, chunk, command, command);
+        }
     }
 
-    if(dlg) { dlg->Destroy(); }
+    m_mgr->SetStatusMessage(_("Code Formatter: formatting files..."));
+    m_batch->Start();
+}
+
+void CodeFormatter::OnBatchProgress(size_t done, size_t total)
+{
+    if(!m_batch) { return; }
+    wxString msg;
+    msg << _("Code Formatter: formatting files... [ ") << done << " / " << total << " ]";
+    m_mgr->SetStatusMessage(msg);
+}
+
+void CodeFormatter::OnBatchCompleted()
+{
+    if(!m_batch) { return; }
+    m_batch->Wait();
+    m_formattedFiles = m_batch->GetCache();
+
+    size_t total = m_batch->GetFilesTotal();
+    size_t formatted = m_batch->GetFilesFormatted();
+    wxDELETE(m_batch);
+
+    wxString msg;
+    msg << _("Code Formatter: ") << formatted << _(" files formatted, ") << (total - formatted)
+        << _(" unchanged files skipped");
+    m_mgr->SetStatusMessage(msg, 5);
     EventNotifier::Get()->PostReloadExternallyModifiedEvent(false);
 }
 
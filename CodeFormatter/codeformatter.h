@@ -29,6 +29,8 @@
 #include "fileextmanager.h"
 #include "formatoptions.h"
 #include "plugin.h"
+#include "wxStringHash.h"
+#include <unordered_map>
 
 enum FormatterEngine {
     kFormatEngineNone,
@@ -40,10 +42,14 @@ enum FormatterEngine {
     kFormatEngineWxXmlDocument,
 };
 
+class CodeFormatterBatch;
 class CodeFormatter : public IPlugin
 {
     static FormatOptions m_options;
     PhpOptions m_optionsPhp;
+    CodeFormatterBatch* m_batch = nullptr;
+    /// the files formatted by previous batches (see CodeFormatterBatch::Cache_t)
+    std::unordered_map<wxString, wxUint64> m_formattedFiles;
 
 protected:
     wxString m_selectedFolder;
@@ -74,6 +80,8 @@ private:
     void DoFormatWithClang(wxString& content, const wxFileName& fileName, int& cursorPosition,
                            const int& selStart = wxNOT_FOUND, const int& selEnd = wxNOT_FOUND);
     void DoFormatWithAstyle(wxString& content, const bool& appendEOL = true);
+    wxString DoGetAstyleOptions();
+    void DoBatchFormatAsync(const std::vector<wxFileName>& files);
     void DoFormatWithWxXmlDocument(const wxFileName& fileName);
 
     void OnPhpSettingsChanged(clCommandEvent& event);
@@ -82,6 +90,11 @@ private:
 public:
     wxString RunCommand(const wxString& command);
 
+    /**
+     * @brief format 'content' with astyle. This function is thread safe
+     */
+    static void FormatWithAstyle(wxString& content, const wxString& options);
+
     /**
      * @brief format list of files
      */
@@ -108,6 +121,8 @@ public:
     void OnFormatFiles(wxCommandEvent& e);
     void OnFormatProject(wxCommandEvent& e);
     void OnBeforeFileSave(clCommandEvent& e);
+    void OnBatchProgress(size_t done, size_t total);
+    void OnBatchCompleted();
 };
 
 #endif // CODEFORMATTER_H
@@ -0,0 +1,190 @@
+#include "codeformatterbatch.h"
+#include "clFileIdentity.h"
+#include "file_logger.h"
+#include "fileutils.h"
+#include "globals.h"
+#include "procutils.h"
+#include <algorithm>
+#include <wx/xml/xml.h>
+
+CodeFormatterBatch::CodeFormatterBatch(CodeFormatter* owner, const Cache_t& cache)
+    : m_owner(owner)
+    , m_cache(cache)
+    , m_cancelled(false)
+    , m_filesDone(0)
+    , m_filesFormatted(0)
+{
+}
+
+CodeFormatterBatch::~CodeFormatterBatch() { Cancel(); }
+
+wxUint64 CodeFormatterBatch::CacheValue(wxUint64 contentHash, wxUint64 recipe)
+{
+    wxUint64 values[2] = { contentHash, recipe };
+    return clFileHasher::Hash(values, sizeof(values));
+}
+
+void CodeFormatterBatch::AddTask(FormatterEngine engine, const std::vector<wxFileName>& files, const wxString& command,
+                                 const wxString& settings)
+{
+    Task task;
+    task.engine = engine;
+    task.files = files;
+    task.command = command;
+
+    wxString recipe;
+    recipe << (int)engine << "|" << settings;
+    const wxCharBuffer cb = recipe.mb_str(wxConvUTF8);
+    task.recipe = clFileHasher::Hash(cb.data(), cb.length());
+
+    m_filesTotal += files.size();
+    m_tasks.push_back(task);
+}
+
+void CodeFormatterBatch::Start()
+{
+    if(m_thread) { return; }
+    m_thread = new std::thread(&CodeFormatterBatch::Run, this);
+}
+
+void CodeFormatterBatch::Cancel()
+{
+    m_cancelled = true;
+    Wait();
+}
+
+void CodeFormatterBatch::Wait()
+{
+    if(m_thread) {
+        m_thread->join();
+        wxDELETE(m_thread);
+    }
+}
+
+void CodeFormatterBatch::Run()
+{
+    clDEBUG() << "CodeFormatter: batch started." << m_filesTotal << "files," << m_tasks.size() << "tasks" << clEndl;
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t index;
+        while(!m_cancelled && (index = next++) < m_tasks.size()) {
+            ProcessTask(m_tasks[index]);
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(m_tasks.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& t : threads) {
+        t.join();
+    }
+
+    clDEBUG() << "CodeFormatter: batch completed." << (size_t)m_filesFormatted << "files formatted" << clEndl;
+    if(!m_cancelled) { m_owner->CallAfter(&CodeFormatter::OnBatchCompleted); }
+}
+
+void CodeFormatterBatch::FilterUnchanged(Task& task)
+{
+    std::vector<wxFileName> files;
+    files.reserve(task.files.size());
+    for(const wxFileName& file : task.files) {
+        wxUint64 hash = 0;
+        if(clFileIdentity::HashFile(file.GetFullPath(), hash)) {
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+            Cache_t::const_iterator iter = m_cache.find(file.GetFullPath());
+            if(iter != m_cache.end() && iter->second == CacheValue(hash, task.recipe)) { continue; }
+        }
+        files.push_back(file);
+    }
+    task.files.swap(files);
+}
+
+void CodeFormatterBatch::UpdateCache(const Task& task)
+{
+    for(const wxFileName& file : task.files) {
+        wxUint64 hash = 0;
+        if(!clFileIdentity::HashFile(file.GetFullPath(), hash)) { continue; }
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_cache[file.GetFullPath()] = CacheValue(hash, task.recipe);
+    }
+}
+
+bool CodeFormatterBatch::FormatInProcess(const wxFileName& file, FormatterEngine engine)
+{
+    if(engine == kFormatEngineWxXmlDocument) {
+        wxXmlDocument doc;
+        wxString filePath = file.GetFullPath();
+        if(!doc.Load(filePath) || !doc.Save(filePath, m_xmlIndent)) {
+            clWARNING() << "CodeFormatter: Failed to format XML file: " << file << clEndl;
+            return false;
+        }
+        return true;
+    }
+
+    wxString content;
+    if(!FileUtils::ReadFileContent(file, content)) {
+        clWARNING() << "CodeFormatter: Failed to load file: " << file << clEndl;
+        return false;
+    }
+
+    wxString formatted = content;
+    if(engine == kFormatEngineAStyle) {
+        CodeFormatter::FormatWithAstyle(formatted, m_astyleOptions);
+        if(!formatted.IsEmpty()) { formatted << m_eol; }
+    } else if(engine == kFormatEngineBuildInPhp) {
+        PHPFormatterBuffer buffer(formatted, m_phpOptions);
+        buffer.format();
+        formatted = buffer.GetBuffer();
+    }
+
+    // don't touch files that are already formatted
+    if(formatted.IsEmpty() || formatted == content) { return true; }
+    if(!FileUtils::WriteFileContent(file, formatted)) {
+        clWARNING() << "CodeFormatter: Failed to save file: " << file << clEndl;
+        return false;
+    }
+    return true;
+}
+
+void CodeFormatterBatch::ProcessTask(Task& task)
+{
+    size_t fileCount = task.files.size();
+    FilterUnchanged(task);
+
+    if(!task.files.empty()) {
+        switch(task.engine) {
+        case kFormatEngineClangFormat: {
+            // a single clang-format process formats all the files of the task
+            wxString command = task.command;
+            for(const wxFileName& file : task.files) {
+                wxString filePath = file.GetFullPath();
+                ::WrapWithQuotes(filePath);
+                command << " " << filePath;
+            }
+            clDEBUG() << "CodeFormatter running: " << command << clEndl;
+            ProcUtils::SafeExecuteCommand(command);
+            break;
+        }
+        case kFormatEnginePhpCsFixer:
+        case kFormatEnginePhpcbf:
+            clDEBUG() << "CodeFormatter running: " << task.command << clEndl;
+            ProcUtils::SafeExecuteCommand(task.command);
+            break;
+        default:
+            for(const wxFileName& file : task.files) {
+                if(m_cancelled) { break; }
+                FormatInProcess(file, task.engine);
+            }
+            break;
+        }
+        UpdateCache(task);
+        m_filesFormatted += task.files.size();
+    }
+
+    m_filesDone += fileCount;
+    m_owner->CallAfter(&CodeFormatter::OnBatchProgress, (size_t)m_filesDone, m_filesTotal);
+}
@@ -0,0 +1,105 @@
+#ifndef CODEFORMATTERBATCH_H
+#define CODEFORMATTERBATCH_H
+
+#include "PHPFormatterBuffer.h"
+#include "codeformatter.h"
+#include "wxStringHash.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <wx/filename.h>
+
+/**
+ * @class CodeFormatterBatch
+ * @brief format a list of files in the background.
+ * The batch is prepared on the main thread: the engine, options and commands of every file are resolved upfront, so
+ * the worker threads never touch the IDE objects. The tasks are then executed by a pool of worker threads: astyle, the
+ * built-in PHP formatter and the XML formatter run in-process (one file per task) while clang-format is invoked with
+ * many files per process. Files that were not modified since they were last formatted with the same settings are
+ * skipped
+ */
+class CodeFormatterBatch
+{
+public:
+    /// file path -> hash of the formatted content combined with the hash of the settings used to format it
+    typedef std::unordered_map<wxString, wxUint64> Cache_t;
+
+    enum { kClangFormatFilesPerProcess = 50 };
+
+    struct Task {
+        FormatterEngine engine = kFormatEngineNone;
+        std::vector<wxFileName> files;
+        /// the command to execute. For clang-format, the file names are appended to it
+        wxString command;
+        /// a hash of the settings used to format the files
+        wxUint64 recipe = 0;
+    };
+
+protected:
+    CodeFormatter* m_owner;
+    std::vector<Task> m_tasks;
+    Cache_t m_cache;
+    std::mutex m_cacheMutex;
+    wxString m_astyleOptions;
+    wxString m_eol;
+    PHPFormatterOptions m_phpOptions;
+    int m_xmlIndent = 4;
+    std::thread* m_thread = nullptr;
+    std::atomic<bool> m_cancelled;
+    std::atomic<size_t> m_filesDone;
+    std::atomic<size_t> m_filesFormatted;
+    size_t m_filesTotal = 0;
+
+protected:
+    void Run();
+    void ProcessTask(Task& task);
+    /// remove the files that did not change since the last time they were formatted
+    void FilterUnchanged(Task& task);
+    void UpdateCache(const Task& task);
+    bool FormatInProcess(const wxFileName& file, FormatterEngine engine);
+    static wxUint64 CacheValue(wxUint64 contentHash, wxUint64 recipe);
+
+public:
+    CodeFormatterBatch(CodeFormatter* owner, const Cache_t& cache);
+    virtual ~CodeFormatterBatch();
+
+    void SetAstyleOptions(const wxString& astyleOptions, const wxString& eol)
+    {
+        this->m_astyleOptions = astyleOptions;
+        this->m_eol = eol;
+    }
+    void SetPhpOptions(const PHPFormatterOptions& phpOptions) { this->m_phpOptions = phpOptions; }
+    void SetXmlIndent(int xmlIndent) { this->m_xmlIndent = xmlIndent; }
+
+    /**
+     * @brief add a task. The recipe is computed from the engine and 'settings'
+     */
+    void AddTask(FormatterEngine engine, const std::vector<wxFileName>& files, const wxString& command,
+                 const wxString& settings);
+
+    /**
+     * @brief start the background processing. CodeFormatter::OnBatchProgress is called as files are processed and
+     * CodeFormatter::OnBatchCompleted is called when done
+     */
+    void Start();
+
+    /**
+     * @brief cancel the batch and wait for the worker threads to exit
+     */
+    void Cancel();
+
+    /**
+     * @brief wait for the background processing to complete
+     */
+    void Wait();
+
+    const Cache_t& GetCache() const { return m_cache; }
+    size_t GetFilesTotal() const { return m_filesTotal; }
+    size_t GetFilesFormatted() const { return m_filesFormatted; }
+    size_t GetFilesDone() const { return m_filesDone; }
+    bool IsCancelled() const { return m_cancelled; }
+};
+
+#endif // CODEFORMATTERBATCH_H
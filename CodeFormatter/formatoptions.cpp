@@ -277,6 +277,15 @@ wxString FormatOptions::ClangFormatCommand(const wxFileName& fileName, wxString
     return command;
 }
 
+wxString FormatOptions::ClangFormatBatchCommand(const wxString& style) const
+{
+    wxString command;
+    command << GetClangFormatExe();
+    ::WrapWithQuotes(command);
+    command << " -i -style=" << style;
+    return command;
+}
+
 wxString FormatOptions::GetClangFormatStyleAsString(const wxFileName& fileName) const
 {
     // If the rules file option is enabled it overrides everything here
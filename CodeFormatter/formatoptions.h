@@ -261,6 +261,11 @@ public:
                                 const int& cursorPosition = wxNOT_FOUND, const int& selStart = wxNOT_FOUND,
                                 const int& selEnd = wxNOT_FOUND) const;
     wxString GetClangFormatStyleAsString(const wxFileName& fileName) const;
+    /**
+     * @brief return a clang-format command that formats files in place with the given style. The caller appends
+     * the files to format
+     */
+    wxString ClangFormatBatchCommand(const wxString& style) const;
     void SetClangFormatExe(const wxString& clangFormatExe)
     {
         this->m_clangFormatExe = clangFormatExe;
@@ -11,24 +11,12 @@ PHPDocComment::PHPDocComment(PHPSourceFile& sourceFile, const wxString& comment)
     : m_sourceFile(sourceFile)
     , m_comment(comment)
 {
-    static std::unordered_set<wxString> nativeTypes;
-    if(nativeTypes.empty()) {
-        nativeTypes.insert("int");
-        nativeTypes.insert("integer");
-        nativeTypes.insert("real");
-        nativeTypes.insert("double");
-        nativeTypes.insert("float");
-        nativeTypes.insert("string");
-        nativeTypes.insert("binary");
-        nativeTypes.insert("array");
-        nativeTypes.insert("object");
-        nativeTypes.insert("bool");
-        nativeTypes.insert("boolean");
-        nativeTypes.insert("mixed");
-        nativeTypes.insert("null");
-    }
+    // comments are parsed by multiple threads: the set is initialized once and the regex keeps the match state
+    static const std::unordered_set<wxString> nativeTypes = { "int",    "integer", "real",  "double", "float",
+                                                              "string", "binary",  "array", "object", "bool",
+                                                              "boolean", "mixed",  "null" };
 
-    static wxRegEx reReturnStatement(wxT("@(return)[ \t]+([\\a-zA-Z_]{1}[\\|\\a-zA-Z0-9_]*)"));
+    static thread_local wxRegEx reReturnStatement(wxT("@(return)[ \t]+([\\a-zA-Z_]{1}[\\|\\a-zA-Z0-9_]*)"));
     if(reReturnStatement.IsValid() && reReturnStatement.Matches(m_comment)) {
         wxString returnValue = reReturnStatement.GetMatch(m_comment, 2);
         wxArrayString types = ::wxStringTokenize(returnValue, "|", wxTOKEN_STRTOK);
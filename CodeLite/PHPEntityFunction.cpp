@@ -53,7 +53,7 @@ void PHPEntityFunction::Store(PHPLookupTable* lookup)
 
     try {
         wxSQLite3Database& db = lookup->Database();
-        wxSQLite3Statement statement = db.PrepareStatement(
+        wxSQLite3Statement& statement = lookup->PrepareCachedStatement(
             "INSERT OR REPLACE INTO FUNCTION_TABLE VALUES(NULL, :SCOPE_ID, :NAME, :FULLNAME, :SCOPE, :SIGNATURE, "
             ":RETURN_VALUE, :FLAGS, :DOC_COMMENT, :LINE_NUMBER, :FILE_NAME)");
         statement.Bind(statement.GetParamIndex(":SCOPE_ID"), Parent()->GetDbId());
@@ -4,11 +4,17 @@
 #include "PHPEntityNamespace.h"
 #include "PHPEntityVariable.h"
 #include "PHPLookupTable.h"
+#include "clParallel.h"
 #include "event_notifier.h"
 #include "file_logger.h"
 #include "fileextmanager.h"
 #include "fileutils.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/stopwatch.h>
@@ -21,6 +27,88 @@ wxDEFINE_EVENT(wxPHP_PARSE_PROGRESS, clParseEvent);
 
 static wxString PHP_SCHEMA_VERSION = "9.3.0.1";
 
+namespace
+{
+// the number of parsed files that are handed to the writer at once
+const size_t PARSE_BATCH_SIZE = 32;
+// the parser threads wait when that many batches are waiting to be stored
+const size_t MAX_PENDING_BATCHES = 16;
+// the minimum time between two wxPHP_PARSE_PROGRESS events
+const long PROGRESS_INTERVAL_MS = 100;
+
+typedef std::vector<PHPSourceFile::Ptr_t> PHPParseBatch_t;
+
+/**
+ * @brief a bounded queue of parsed files, filled by the parser threads and consumed by the database writer
+ */
+class PHPParseQueue
+{
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<PHPParseBatch_t> m_batches;
+    size_t m_producers;
+    bool m_cancelled = false;
+
+public:
+    PHPParseQueue(size_t producers)
+        : m_producers(producers)
+    {
+    }
+
+    void Push(PHPParseBatch_t& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_cancelled || m_batches.size() < MAX_PENDING_BATCHES; });
+        if(m_cancelled) { return; }
+        m_batches.push_back(PHPParseBatch_t());
+        m_batches.back().swap(batch);
+        m_cv.notify_all();
+    }
+
+    void ProducerDone()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_producers;
+        m_cv.notify_all();
+    }
+
+    void Cancel()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+        m_batches.clear();
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief wait up to 'timeoutMs' for a batch. Return false once all the producers are done and the queue is
+     * empty
+     */
+    bool Pop(PHPParseBatch_t& batch, long timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                      [&]() { return !m_batches.empty() || m_producers == 0; });
+        if(!m_batches.empty()) {
+            batch.swap(m_batches.front());
+            m_batches.pop_front();
+            m_cv.notify_all();
+            return true;
+        }
+        return m_producers != 0;
+    }
+};
+
+void PostParseEvent(const wxEventType& type, size_t totalFiles, size_t index, const wxString& filename = "")
+{
+    clParseEvent event(type);
+    event.SetTotalFiles(totalFiles);
+    event.SetCurfileIndex(index);
+    event.SetFileName(filename);
+    EventNotifier::Get()->AddPendingEvent(event);
+}
+} // namespace
+
 //------------------------------------------------
 // Metadata table
 //------------------------------------------------
@@ -213,6 +301,7 @@ void PHPLookupTable::Open(const wxFileName& dbfile)
         }
 
         wxFileName::Mkdir(dbfile.GetPath(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        m_statements.clear(); // prepared for the previous connection
         m_db.Open(dbfile.GetFullPath());
         m_db.SetBusyTimeout(10); // Don't lock when we cant access to the database
         m_filename = dbfile;
@@ -759,7 +848,7 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
             wxString sql;
             sql << "delete from SCOPE_TABLE where FILE_NAME=:FILE_NAME AND SCOPE_TYPE != "
                 << (int)kPhpScopeTypeNamespace;
-            wxSQLite3Statement st = m_db.PrepareStatement(sql);
+            wxSQLite3Statement& st = PrepareCachedStatement(sql);
             st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
             st.ExecuteUpdate();
         }
@@ -767,7 +856,7 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
         {
             wxString sql;
             sql << "delete from FUNCTION_TABLE where FILE_NAME=:FILE_NAME";
-            wxSQLite3Statement st = m_db.PrepareStatement(sql);
+            wxSQLite3Statement& st = PrepareCachedStatement(sql);
             st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
             st.ExecuteUpdate();
         }
@@ -775,7 +864,7 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
         {
             wxString sql;
             sql << "delete from FUNCTION_ALIAS_TABLE where FILE_NAME=:FILE_NAME";
-            wxSQLite3Statement st = m_db.PrepareStatement(sql);
+            wxSQLite3Statement& st = PrepareCachedStatement(sql);
             st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
             st.ExecuteUpdate();
         }
@@ -783,7 +872,7 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
         {
             wxString sql;
             sql << "delete from VARIABLES_TABLE where FILE_NAME=:FILE_NAME";
-            wxSQLite3Statement st = m_db.PrepareStatement(sql);
+            wxSQLite3Statement& st = PrepareCachedStatement(sql);
             st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
             st.ExecuteUpdate();
         }
@@ -791,7 +880,7 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
         {
             wxString sql;
             sql << "delete from FILES_TABLE where FILE_NAME=:FILE_NAME";
-            wxSQLite3Statement st = m_db.PrepareStatement(sql);
+            wxSQLite3Statement& st = PrepareCachedStatement(sql);
             st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
             st.ExecuteUpdate();
         }
@@ -799,7 +888,7 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
         {
             wxString sql;
             sql << "delete from PHPDOC_VAR_TABLE where FILE_NAME=:FILE_NAME";
-            wxSQLite3Statement st = m_db.PrepareStatement(sql);
+            wxSQLite3Statement& st = PrepareCachedStatement(sql);
             st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
             st.ExecuteUpdate();
         }
@@ -814,8 +903,11 @@ void PHPLookupTable::DeleteFileEntries(const wxFileName& filename, bool autoComm
 void PHPLookupTable::Close()
 {
     try {
+        // the statements must be finalized before the database is closed
+        m_statements.clear();
         if(m_db.IsOpen()) { m_db.Close(); }
         m_filename.Clear();
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
         m_allClasses.clear();
 
     } catch(wxSQLite3Exception& e) {
@@ -944,10 +1036,22 @@ wxLongLong PHPLookupTable::GetFileLastParsedTimestamp(const wxFileName& filename
     return 0;
 }
 
+void PHPLookupTable::LoadFilesLastParsedTimestamp(std::unordered_map<wxString, time_t>& timestamps)
+{
+    try {
+        wxSQLite3ResultSet res = m_db.ExecuteQuery("SELECT FILE_NAME, LAST_UPDATED FROM FILES_TABLE");
+        while(res.NextRow()) {
+            timestamps[res.GetString("FILE_NAME")] = res.GetInt64("LAST_UPDATED").ToLong();
+        }
+    } catch(wxSQLite3Exception& e) {
+        CL_WARNING("PHPLookupTable::LoadFilesLastParsedTimestamp: %s", e.GetMessage());
+    }
+}
+
 void PHPLookupTable::UpdateFileLastParsedTimestamp(const wxFileName& filename)
 {
     try {
-        wxSQLite3Statement st = m_db.PrepareStatement(
+        wxSQLite3Statement& st = PrepareCachedStatement(
             "REPLACE INTO FILES_TABLE (ID, FILE_NAME, LAST_UPDATED) VALUES (NULL, :FILE_NAME, :LAST_UPDATED)");
         st.Bind(st.GetParamIndex(":FILE_NAME"), filename.GetFullPath());
         st.Bind(st.GetParamIndex(":LAST_UPDATED"), (wxLongLong)time(NULL));
@@ -1296,16 +1400,28 @@ void PHPLookupTable::DoFixVarsDocComment(PHPEntityBase::List_t& matches, wxLongL
 
 void PHPLookupTable::UpdateClassCache(const wxString& classname)
 {
-    if(m_allClasses.count(classname) == 0) { m_allClasses.insert(classname); }
+    std::lock_guard<std::mutex> lock(m_allClassesMutex);
+    if(m_allClassesFrozen) {
+        m_pendingClasses.insert(classname);
+    } else {
+        m_allClasses.insert(classname);
+    }
 }
 
-bool PHPLookupTable::ClassExists(const wxString& classname) const { return m_allClasses.count(classname) != 0; }
+bool PHPLookupTable::ClassExists(const wxString& classname) const
+{
+    std::lock_guard<std::mutex> lock(m_allClassesMutex);
+    return m_allClasses.count(classname) != 0;
+}
 
 void PHPLookupTable::RebuildClassCache()
 {
     // locate the scope
     clDEBUG() << "Rebuilding PHP class cache..." << clEndl;
-    m_allClasses.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
+        m_allClasses.clear();
+    }
     size_t count = 0;
     try {
         wxString sql;
@@ -1424,3 +1540,168 @@ void PHPLookupTable::ParseFolder(const wxString& folder, const wxString& filemas
         }
     });
 }
+
+wxSQLite3Statement& PHPLookupTable::PrepareCachedStatement(const wxString& sql)
+{
+    std::unordered_map<wxString, wxSQLite3Statement>::iterator iter = m_statements.find(sql);
+    if(iter == m_statements.end()) {
+        iter = m_statements.insert(std::make_pair(sql, m_db.PrepareStatement(sql))).first;
+    }
+    return iter->second;
+}
+
+bool PHPLookupTable::DoReadFile(const wxString& filename, eUpdateMode updateMode,
+                                const std::unordered_map<wxString, time_t>& lastParsed, wxString& content)
+{
+    wxFileName fnFile(filename);
+
+    // Parse only valid PHP files
+    if(FileExtManager::GetType(fnFile.GetFullName()) != FileExtManager::TypePhp) { return false; }
+
+    // Ensure that the file exists
+    if(!fnFile.Exists()) { return false; }
+
+    if(updateMode == kUpdateMode_Fast) {
+        // Check to see if we need to re-parse this file and store it to the database
+        std::unordered_map<wxString, time_t>::const_iterator iter = lastParsed.find(fnFile.GetFullPath());
+        if(iter != lastParsed.end() && fnFile.GetModificationTime().GetTicks() <= iter->second) { return false; }
+    }
+
+    // For performance reaons, load the file into memory and then parse it
+    if(!FileUtils::ReadFileContent(fnFile, content, wxConvISO8859_1)) {
+        clWARNING() << "PHP: Failed to read file:" << fnFile << "for parsing" << clEndl;
+        return false;
+    }
+    return true;
+}
+
+PHPSourceFile::Ptr_t PHPLookupTable::DoParseFile(const wxString& filename, eUpdateMode updateMode,
+                                                 const std::unordered_map<wxString, time_t>& lastParsed,
+                                                 bool parseFuncBodies)
+{
+    wxString content;
+    if(!DoReadFile(filename, updateMode, lastParsed, content)) { return PHPSourceFile::Ptr_t(); }
+
+    PHPSourceFile::Ptr_t sourceFile(new PHPSourceFile(content, this));
+    sourceFile->SetFilename(wxFileName(filename));
+    sourceFile->SetParseFunctionBody(parseFuncBodies);
+    sourceFile->Parse();
+    return sourceFile;
+}
+
+void PHPLookupTable::DoRecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode,
+                                               const std::function<bool()>& goingDown, bool parseFuncBodies)
+{
+    // The files are parsed by a pool of threads which hand the parsed files to this thread in batches. Only this
+    // thread accesses the database, it stores the batches in a single transaction as they arrive
+    PostParseEvent(wxPHP_PARSE_STARTED, files.GetCount(), 0);
+
+    wxStopWatch sw;
+    sw.Start();
+
+    // Load the timestamps once instead of querying the database per file
+    std::unordered_map<wxString, time_t> lastParsed;
+    if(updateMode == kUpdateMode_Fast) { LoadFilesLastParsedTimestamp(lastParsed); }
+    FileExtManager::Init();
+
+    // The parser resolves an unqualified type to the current namespace only if it knows a class by that name. So
+    // before parsing, collect the classes declared by the files we are about to parse (a lexer only pass) and add
+    // them to the ones already in the database. The cache is then frozen until the parser threads are done: the
+    // way a type is resolved does not depend on the order in which the files are parsed
+    RebuildClassCache();
+    {
+        std::vector<std::vector<wxString> > classes(files.GetCount());
+        clParallelFor(files.GetCount(), [&](size_t index) {
+            wxString content;
+            if(DoReadFile(files.Item(index), updateMode, lastParsed, content)) {
+                PHPSourceFile::FindClassNames(content, classes[index]);
+            }
+        });
+
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
+        for(size_t i = 0; i < classes.size(); ++i) {
+            m_allClasses.insert(classes[i].begin(), classes[i].end());
+        }
+        m_allClassesFrozen = true;
+    }
+    clDEBUG() << "PHP: collected the class names in" << sw.Time() << "milliseconds" << clEndl;
+
+    // this thread is busy writing to the database
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if(threadCount > 1) { --threadCount; }
+    threadCount = std::max<size_t>(std::min<size_t>(threadCount, files.GetCount()), 1);
+
+    PHPParseQueue queue(threadCount);
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> processed(0);
+    std::atomic<bool> stop(false);
+    auto parser = [&]() {
+        PHPParseBatch_t batch;
+        size_t index;
+        while(!stop && (index = next++) < files.GetCount()) {
+            PHPSourceFile::Ptr_t sourceFile = DoParseFile(files.Item(index), updateMode, lastParsed, parseFuncBodies);
+            ++processed;
+            if(!sourceFile) { continue; }
+            batch.push_back(sourceFile);
+            if(batch.size() >= PARSE_BATCH_SIZE) { queue.Push(batch); }
+        }
+        if(!batch.empty()) { queue.Push(batch); }
+        queue.ProducerDone();
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < threadCount; ++i) {
+        threads.push_back(std::thread(parser));
+    }
+
+    size_t stored = 0;
+    try {
+        wxStopWatch progressTimer;
+        m_db.Begin();
+        while(true) {
+            PHPParseBatch_t batch;
+            bool more = queue.Pop(batch, PROGRESS_INTERVAL_MS);
+            if(goingDown()) { break; }
+
+            for(size_t i = 0; i < batch.size(); ++i) {
+                UpdateSourceFile(*batch[i], false);
+            }
+            stored += batch.size();
+
+            if(!batch.empty() && progressTimer.Time() >= PROGRESS_INTERVAL_MS) {
+                PostParseEvent(wxPHP_PARSE_PROGRESS, files.GetCount(), processed,
+                               batch.back()->GetFilename().GetFullPath());
+                progressTimer.Start();
+            }
+            if(!more) { break; }
+        }
+        m_db.Commit();
+
+    } catch(wxSQLite3Exception& e) {
+        try {
+            m_db.Rollback();
+
+        } catch(...) {
+        }
+        clWARNING() << "PHPLookupTable::UpdateSourceFiles:" << e.GetMessage() << clEndl;
+    }
+
+    stop = true;
+    queue.Cancel();
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_allClassesMutex);
+        m_allClassesFrozen = false;
+        m_allClasses.insert(m_pendingClasses.begin(), m_pendingClasses.end());
+        m_pendingClasses.clear();
+    }
+
+    clDEBUG() << "PHP: parsed" << files.GetCount() << "files (" << stored << "stored) using" << threadCount
+              << "threads in" << sw.Time() << "milliseconds" << clEndl;
+
+    // always make sure that the end event is sent
+    PostParseEvent(wxPHP_PARSE_ENDED, files.GetCount(), files.GetCount());
+}
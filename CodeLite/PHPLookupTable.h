@@ -36,7 +36,10 @@
 #include "fileutils.h"
 #include "smart_ptr.h"
 #include "wx/wxsqlite3.h"
+#include <functional>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <wx/longlong.h>
@@ -65,6 +68,12 @@ class WXDLLIMPEXP_CL PHPLookupTable
     wxFileName m_filename;
     size_t m_sizeLimit;
     std::unordered_set<wxString> m_allClasses;
+    // while the parser threads run, the class cache is frozen: the classes stored meanwhile are kept aside, so the way
+    // a type is resolved does not depend on the order in which the threads parse the files
+    bool m_allClassesFrozen = false;
+    std::unordered_set<wxString> m_pendingClasses;
+    mutable std::mutex m_allClassesMutex;
+    std::unordered_map<wxString, wxSQLite3Statement> m_statements;
 
 public:
     enum eLookupFlags {
@@ -146,11 +155,34 @@ private:
      */
     wxLongLong GetFileLastParsedTimestamp(const wxFileName& filename);
 
+    /**
+     * @brief load the last parse timestamp of all the files in the database
+     */
+    void LoadFilesLastParsedTimestamp(std::unordered_map<wxString, time_t>& timestamps);
+
     /**
      * @brief update the file's last updated timestamp
      */
     void UpdateFileLastParsedTimestamp(const wxFileName& filename);
 
+    /**
+     * @brief read 'filename' into 'content' if it needs to be parsed. Called from the parser threads, so it must not
+     * access the database
+     * @return false if the file should be skipped
+     */
+    bool DoReadFile(const wxString& filename, eUpdateMode updateMode,
+                    const std::unordered_map<wxString, time_t>& lastParsed, wxString& content);
+
+    /**
+     * @brief parse 'filename' if needed. Called from the parser threads, so it must not access the database
+     * @return the parsed file or NULL if the file was skipped
+     */
+    PHPSourceFile::Ptr_t DoParseFile(const wxString& filename, eUpdateMode updateMode,
+                                     const std::unordered_map<wxString, time_t>& lastParsed, bool parseFuncBodies);
+
+    void DoRecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode,
+                                   const std::function<bool()>& goingDown, bool parseFuncBodies);
+
     /**
      * @brief check the database disk image to see if it corrupted
      */
@@ -282,7 +314,7 @@ public:
     void UpdateSourceFile(PHPSourceFile& source, bool autoCommit = true);
 
     /**
-     * @brief update list of source files
+     * @brief update list of source files. The files are parsed in parallel and stored by the calling thread
      */
     template <typename GoindDownFunc>
     void RecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode, GoindDownFunc pFuncGoingDown,
@@ -310,101 +342,19 @@ public:
      * @brief return reference to the underlying database
      */
     wxSQLite3Database& Database() { return m_db; }
+
+    /**
+     * @brief return a prepared statement for 'sql'. The statement is compiled once and kept until the database is
+     * closed, so only use it for statements that are executed with ExecuteUpdate() and bind all their parameters
+     */
+    wxSQLite3Statement& PrepareCachedStatement(const wxString& sql);
 };
 
 template <typename GoindDownFunc>
 void PHPLookupTable::RecreateSymbolsDatabase(const wxArrayString& files, eUpdateMode updateMode,
                                              GoindDownFunc pFuncGoingDown, bool parseFuncBodies)
 {
-    try {
-
-        {
-            clParseEvent event(wxPHP_PARSE_STARTED);
-            event.SetTotalFiles(files.GetCount());
-            event.SetCurfileIndex(0);
-            EventNotifier::Get()->AddPendingEvent(event);
-        }
-
-        wxStopWatch sw;
-        sw.Start();
-
-        m_allClasses.clear(); // clear the cache
-        m_db.Begin();
-        for(size_t i = 0; i < files.GetCount(); ++i) {
-            if(pFuncGoingDown()) { break; }
-            {
-                clParseEvent event(wxPHP_PARSE_PROGRESS);
-                event.SetTotalFiles(files.GetCount());
-                event.SetCurfileIndex(i);
-                event.SetFileName(files.Item(i));
-                EventNotifier::Get()->AddPendingEvent(event);
-            }
-
-            wxFileName fnFile(files.Item(i));
-            bool reParseNeeded(true);
-
-            if(updateMode == kUpdateMode_Fast) {
-                // Check to see if we need to re-parse this file
-                // and store it to the database
-
-                if(!fnFile.Exists()) {
-                    reParseNeeded = false;
-                } else {
-                    time_t lastModifiedOnDisk = fnFile.GetModificationTime().GetTicks();
-                    wxLongLong lastModifiedInDB = GetFileLastParsedTimestamp(fnFile);
-                    if(lastModifiedOnDisk <= lastModifiedInDB.ToLong()) { reParseNeeded = false; }
-                }
-            }
-
-            // Ensure that the file exists
-            if(!fnFile.Exists()) { reParseNeeded = false; }
-
-            // Parse only valid PHP files
-            if(FileExtManager::GetType(fnFile.GetFullName()) != FileExtManager::TypePhp) { reParseNeeded = false; }
-
-            if(reParseNeeded) {
-                // For performance reaons, load the file into memory and then parse it
-                wxFileName fnSourceFile(files.Item(i));
-                wxString content;
-                if(!FileUtils::ReadFileContent(fnSourceFile, content, wxConvISO8859_1)) {
-                    clWARNING() << "PHP: Failed to read file:" << fnSourceFile << "for parsing" << clEndl;
-                    continue;
-                }
-                PHPSourceFile sourceFile(content, this);
-                sourceFile.SetFilename(fnSourceFile);
-                sourceFile.SetParseFunctionBody(parseFuncBodies);
-                sourceFile.Parse();
-                UpdateSourceFile(sourceFile, false);
-            }
-        }
-        m_db.Commit();
-        long elapsedMs = sw.Time();
-        clDEBUG1() << _("PHP: parsed ") << files.GetCount() << " in " << elapsedMs << " milliseconds" << clEndl;
-
-        {
-            clParseEvent event(wxPHP_PARSE_ENDED);
-            event.SetTotalFiles(files.GetCount());
-            event.SetCurfileIndex(files.GetCount());
-            EventNotifier::Get()->AddPendingEvent(event);
-        }
-
-    } catch(wxSQLite3Exception& e) {
-        try {
-            m_db.Rollback();
-
-        } catch(...) {
-        }
-
-        {
-            // always make sure that the end event is sent
-            clParseEvent event(wxPHP_PARSE_ENDED);
-            event.SetTotalFiles(files.GetCount());
-            event.SetCurfileIndex(files.GetCount());
-            EventNotifier::Get()->AddPendingEvent(event);
-        }
-
-        clWARNING() << "PHPLookupTable::UpdateSourceFiles:" << e.GetMessage() << clEndl;
-    }
+    DoRecreateSymbolsDatabase(files, updateMode, std::function<bool()>(pFuncGoingDown), parseFuncBodies);
 }
 
 #endif // PHPLOOKUPTABLE_H
@@ -71,6 +71,34 @@ bool PHPSourceFile::IsInPHPSection(const wxString& buffer)
     return inPhp;
 }
 
+void PHPSourceFile::FindClassNames(const wxString& content, std::vector<wxString>& classes)
+{
+    PHPScannerLocker locker(content);
+    if(!locker.scanner) { return; }
+
+    // Same rules as OnNamespace() and OnClass(): only the first namespace statement is honoured
+    wxString ns = "\\";
+    bool hasNamespace = false;
+    phpLexerToken token;
+    while(::phpLexerNext(locker.scanner, token)) {
+        if(token.type == kPHP_T_NAMESPACE && !hasNamespace) {
+            hasNamespace = true;
+            wxString path;
+            while(::phpLexerNext(locker.scanner, token) && token.type != ';') {
+                if(path.IsEmpty() && token.type != kPHP_T_NS_SEPARATOR) { path << "\\"; }
+                path << token.Text();
+            }
+            ns = path.IsEmpty() ? wxString("\\") : path;
+            if(!ns.EndsWith("\\")) { ns << "\\"; }
+
+        } else if(token.type == kPHP_T_CLASS || token.type == kPHP_T_INTERFACE || token.type == kPHP_T_TRAIT) {
+            if(::phpLexerNext(locker.scanner, token) && token.type == kPHP_T_IDENTIFIER) {
+                classes.push_back(ns + token.Text());
+            }
+        }
+    }
+}
+
 void PHPSourceFile::Parse(int exitDepth)
 {
     int retDepth = exitDepth;
@@ -1304,7 +1332,8 @@ void PHPSourceFile::OnConstant(const phpLexerToken& tok)
 
 phpLexerToken& PHPSourceFile::GetPreviousToken()
 {
-    static phpLexerToken NullToken;
+    // files are parsed by multiple threads
+    static thread_local phpLexerToken NullToken;
     if(m_lookBackTokens.size() >= 2) {
         // The last token in the list is the current one. We want the previous one
         return m_lookBackTokens.at(m_lookBackTokens.size() - 2);
@@ -1357,19 +1386,10 @@ wxString PHPSourceFile::DoMakeIdentifierAbsolute(const wxString& type, bool exac
 {
     if(m_converter) { return m_converter->MakeIdentifierAbsolute(type); }
 
-    static std::unordered_set<std::string> phpKeywords;
-    if(phpKeywords.empty()) {
-        phpKeywords.insert("string");
-        phpKeywords.insert("array");
-        phpKeywords.insert("mixed");
-        phpKeywords.insert("bool");
-        phpKeywords.insert("integer");
-        phpKeywords.insert("boolean");
-        phpKeywords.insert("double");
-        phpKeywords.insert("float");
-        phpKeywords.insert("float");
-        phpKeywords.insert("void");
-    }
+    // initialized once, files are parsed by multiple threads
+    static const std::unordered_set<std::string> phpKeywords = { "string",  "array",  "mixed", "bool",
+                                                                 "integer", "boolean", "double", "float",
+                                                                 "void" };
     wxString typeWithNS(type);
     typeWithNS.Trim().Trim(false);
 
@@ -246,6 +246,12 @@ public:
      */
     static bool IsInPHPSection(const wxString& buffer);
 
+    /**
+     * @brief scan 'content' for the classes, interfaces and traits it declares and add their full names to 'classes'.
+     * This only runs the lexer, the names are the ones Parse() would store
+     */
+    static void FindClassNames(const wxString& content, std::vector<wxString>& classes);
+
     /**
      * @brief return list of aliases (their short name) that appears on this file
      */
@@ -254,6 +254,17 @@ void clSocketBase::DestroySocket()
 }
 
 int clSocketBase::ReadMessage(wxString& message, int timeout)
+{
+    std::string buffer;
+    int rc = ReadMessage(buffer, timeout);
+    if(rc != kSuccess) {
+        return rc;
+    }
+    message.assign(buffer.c_str(), buffer.length());
+    return kSuccess;
+}
+
+int clSocketBase::ReadMessage(std::string& message, int timeout)
 {
     // send the length in string form to avoid binary / arch differences between remote and local machine
     char msglen[11];
@@ -270,14 +281,14 @@ int clSocketBase::ReadMessage(wxString& message, int timeout)
     // convert the string to int
     message_len = ::atoi(msglen);
 
+    // read the entire amount we need directly into the output buffer
+    message.clear();
+    message.resize(message_len);
     bytesRead = 0;
-    std::unique_ptr<char> pBuff(new char[message_len]);
-
-    // read the entire amount we need
     int bytesLeft = message_len;
     int totalRead = 0;
     while(bytesLeft > 0) {
-        rc = Read(pBuff.get() + totalRead, bytesLeft, bytesRead, timeout);
+        rc = Read(&message[totalRead], bytesLeft, bytesRead, timeout);
         if(rc != kSuccess) {
             return rc;
 
@@ -287,20 +298,23 @@ int clSocketBase::ReadMessage(wxString& message, int timeout)
             bytesRead = 0;
         }
     }
-
-    message.assign(pBuff.get(), message_len);
     return kSuccess;
 }
 
 void clSocketBase::WriteMessage(const wxString& message)
+{
+    std::string c_str = message.mb_str(wxConvUTF8).data();
+    WriteMessage(c_str);
+}
+
+void clSocketBase::WriteMessage(const std::string& message)
 {
     if(m_socket == INVALID_SOCKET) {
         throw clSocketException("Invalid socket!");
     }
 
     // Write the message length
-    std::string c_str = message.mb_str(wxConvUTF8).data();
-    int len = c_str.length();
+    int len = message.length();
 
     // send the length in string form to avoid binary / arch differences between remote and local machine
     char msglen[11];
@@ -312,7 +326,7 @@ void clSocketBase::WriteMessage(const wxString& message)
     }
 
     // now send the actual data
-    Send(c_str);
+    Send(message);
 }
 
 socket_t clSocketBase::Release()
@@ -176,12 +176,22 @@ public:
      */
     int ReadMessage(wxString& message, int timeout);
 
+    /**
+     * @brief same as above, but return the message raw bytes (UTF-8) without any conversion
+     */
+    int ReadMessage(std::string& message, int timeout);
+
     /**
      * @brief write a full message
      * @param message
      */
     void WriteMessage(const wxString& message);
 
+    /**
+     * @brief write a full message. The message is expected to be UTF-8 encoded
+     */
+    void WriteMessage(const std::string& message);
+
 protected:
     /**
      * @brief
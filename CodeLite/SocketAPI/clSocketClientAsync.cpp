@@ -196,7 +196,7 @@ void clSocketAsyncThread::MessageLoop(clSocketBase::Ptr_t socket)
             } else {
                 // Make sure that the socket is still alive
                 if((counter % 10) == 0) {
-                    socket->WriteMessage("");
+                    socket->WriteMessage(std::string());
                     counter = 0;
                 }
             }
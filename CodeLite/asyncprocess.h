@@ -188,6 +188,7 @@ public:
     void SetHardKill(bool hardKill) { this->m_hardKill = hardKill; }
     bool GetHardKill() const { return m_hardKill; }
     IProcessCallback* GetCallback() { return m_callback; }
+    size_t GetFlags() const { return m_flags; }
     
     /**
      * @brief send signal to the process
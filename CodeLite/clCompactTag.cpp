@@ -0,0 +1,131 @@
+#include "clCompactTag.h"
+#include <string.h>
+
+clCompactTagStore::clCompactTagStore() { Clear(); }
+
+wxUint32 clCompactTagStore::DoAdd(const char* str, size_t len)
+{
+    if(len == 0) { return 0; }
+    wxUint32 offset = m_buffer.size();
+    m_buffer.insert(m_buffer.end(), str, str + len);
+    m_buffer.push_back(0);
+    return offset;
+}
+
+wxUint32 clCompactTagStore::AddText(const wxString& str)
+{
+    if(str.IsEmpty()) { return 0; }
+    const wxCharBuffer cb = str.mb_str(wxConvUTF8);
+    return DoAdd(cb.data(), cb.length());
+}
+
+wxUint32 clCompactTagStore::DoIntern(const char* str, size_t len)
+{
+    if(len == 0) { return 0; }
+    std::string key(str, len);
+    std::unordered_map<std::string, wxUint32>::iterator iter = m_interned.find(key);
+    if(iter != m_interned.end()) { return iter->second; }
+
+    wxUint32 offset = DoAdd(key.c_str(), key.length());
+    m_interned.insert(std::make_pair(key, offset));
+    return offset;
+}
+
+wxUint32 clCompactTagStore::Intern(const wxString& str)
+{
+    if(str.IsEmpty()) { return 0; }
+    const wxCharBuffer cb = str.mb_str(wxConvUTF8);
+    return DoIntern(cb.data(), cb.length());
+}
+
+clCompactTag clCompactTagStore::Add(const TagEntry& tag)
+{
+    clCompactTag compact;
+    compact.name = AddText(tag.GetName());
+    compact.path = AddText(tag.GetPath());
+    compact.pattern = AddText(tag.m_pattern);
+    compact.signature = AddText(tag.GetSignature());
+    compact.inherits = AddText(tag.GetInheritsAsString());
+    compact.typeref = AddText(tag.GetTyperef());
+    compact.returnValue = AddText(tag.GetExtField("returns"));
+    compact.file = Intern(tag.GetFile());
+    compact.kind = Intern(tag.m_kind);
+    compact.scope = Intern(tag.GetScope());
+    compact.parent = Intern(tag.GetParent());
+    compact.access = Intern(tag.GetAccess());
+    compact.line = tag.GetLine();
+    compact.id = tag.GetId();
+    return compact;
+}
+
+clCompactTag clCompactTagStore::Copy(const clCompactTag& tag, const clCompactTagStore& from)
+{
+    auto text = [&](wxUint32 offset) {
+        const char* str = from.m_buffer.data() + offset;
+        return DoAdd(str, strlen(str));
+    };
+    auto interned = [&](wxUint32 offset) {
+        const char* str = from.m_buffer.data() + offset;
+        return DoIntern(str, strlen(str));
+    };
+
+    clCompactTag compact = tag;
+    compact.name = text(tag.name);
+    compact.path = text(tag.path);
+    compact.pattern = text(tag.pattern);
+    compact.signature = text(tag.signature);
+    compact.inherits = text(tag.inherits);
+    compact.typeref = text(tag.typeref);
+    compact.returnValue = text(tag.returnValue);
+    compact.file = interned(tag.file);
+    compact.kind = interned(tag.kind);
+    compact.scope = interned(tag.scope);
+    compact.parent = interned(tag.parent);
+    compact.access = interned(tag.access);
+    return compact;
+}
+
+TagEntryPtr clCompactTagStore::ToTagEntry(const clCompactTag& tag) const
+{
+    // Same fields as TagsStorageSQLite::FromSQLite3ResultSet
+    TagEntry* entry = new TagEntry();
+    entry->SetId(tag.id);
+    entry->SetName(DoGet(tag.name));
+    entry->SetFile(DoGet(tag.file));
+    entry->SetLine(tag.line);
+    entry->SetKind(DoGet(tag.kind));
+    entry->SetAccess(DoGet(tag.access));
+    entry->SetSignature(DoGet(tag.signature));
+    entry->SetPattern(DoGet(tag.pattern));
+    entry->SetParent(DoGet(tag.parent));
+    entry->SetInherits(DoGet(tag.inherits));
+    entry->SetPath(DoGet(tag.path));
+    entry->SetTyperef(DoGet(tag.typeref));
+    entry->SetScope(DoGet(tag.scope));
+    entry->SetReturnValue(DoGet(tag.returnValue));
+    return TagEntryPtr(entry);
+}
+
+size_t clCompactTagStore::GetMemoryUsage() const
+{
+    size_t total = m_buffer.capacity();
+    // the interned strings are stored twice: once in the buffer and once as the map key
+    for(const auto& vt : m_interned) {
+        total += vt.first.capacity() + sizeof(vt);
+    }
+    return total;
+}
+
+void clCompactTagStore::Swap(clCompactTagStore& other)
+{
+    m_buffer.swap(other.m_buffer);
+    m_interned.swap(other.m_interned);
+}
+
+void clCompactTagStore::Clear()
+{
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_buffer.push_back(0);
+    m_interned.clear();
+}
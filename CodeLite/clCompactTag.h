@@ -0,0 +1,105 @@
+#ifndef CLCOMPACTTAG_H
+#define CLCOMPACTTAG_H
+
+#include "codelite_exports.h"
+#include "entry.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class clCompactTag
+ * @brief a compact, POD representation of a TagEntry. All the strings are stored as UTF-8 in the owning
+ * clCompactTagStore and are referenced by offset. The highly repetitive fields (file, kind, scope, parent, access) are
+ * interned, so a file name used by thousands of tags is stored once. The extension fields that are saved in the
+ * database (access, signature, inherits, typeref and return value) have a fixed slot each.
+ * Records can be kept in contiguous arrays and copied with memcpy
+ */
+struct clCompactTag {
+    // text (not interned)
+    wxUint32 name = 0;
+    wxUint32 path = 0;
+    wxUint32 pattern = 0;
+    wxUint32 signature = 0;
+    wxUint32 inherits = 0;
+    wxUint32 typeref = 0;
+    wxUint32 returnValue = 0;
+    // interned
+    wxUint32 file = 0;
+    wxUint32 kind = 0;
+    wxUint32 scope = 0;
+    wxUint32 parent = 0;
+    wxUint32 access = 0;
+    wxInt32 line = wxNOT_FOUND;
+    wxInt32 id = wxNOT_FOUND;
+};
+
+/**
+ * @class clCompactTagStore
+ * @brief owns the strings referenced by clCompactTag records. The store is append only: Clear() invalidates all the
+ * records created by it. This class is not thread safe
+ */
+class WXDLLIMPEXP_CL clCompactTagStore
+{
+    /// NUL terminated UTF-8 strings. Offset 0 is the empty string
+    std::vector<char> m_buffer;
+    /// the interned strings, mapped to their offset in m_buffer
+    std::unordered_map<std::string, wxUint32> m_interned;
+
+protected:
+    wxUint32 DoAdd(const char* str, size_t len);
+    wxUint32 DoIntern(const char* str, size_t len);
+    wxUint32 AddText(const wxString& str);
+    wxUint32 Intern(const wxString& str);
+    wxString DoGet(wxUint32 offset) const { return wxString::FromUTF8(m_buffer.data() + offset); }
+
+public:
+    clCompactTagStore();
+    ~clCompactTagStore() {}
+
+    /**
+     * @brief convert a tag into its compact form. The tag comment and flags are not kept
+     */
+    clCompactTag Add(const TagEntry& tag);
+
+    /**
+     * @brief copy a record created by another store, with its strings, into this store
+     */
+    clCompactTag Copy(const clCompactTag& tag, const clCompactTagStore& from);
+
+    /**
+     * @brief create a TagEntry from a compact record
+     */
+    TagEntryPtr ToTagEntry(const clCompactTag& tag) const;
+
+    wxString GetName(const clCompactTag& tag) const { return DoGet(tag.name); }
+    wxString GetPath(const clCompactTag& tag) const { return DoGet(tag.path); }
+    wxString GetFile(const clCompactTag& tag) const { return DoGet(tag.file); }
+    wxString GetKind(const clCompactTag& tag) const { return DoGet(tag.kind); }
+    wxString GetScope(const clCompactTag& tag) const { return DoGet(tag.scope); }
+    wxString GetParent(const clCompactTag& tag) const { return DoGet(tag.parent); }
+    wxString GetAccess(const clCompactTag& tag) const { return DoGet(tag.access); }
+    wxString GetSignature(const clCompactTag& tag) const { return DoGet(tag.signature); }
+    wxString GetPattern(const clCompactTag& tag) const { return DoGet(tag.pattern); }
+
+    /**
+     * @brief the name of a tag, without decoding it. Useful for filtering large arrays
+     */
+    const char* GetNameUTF8(const clCompactTag& tag) const { return m_buffer.data() + tag.name; }
+
+    /**
+     * @brief return the number of bytes used by the strings of the store
+     */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * @brief the number of bytes of strings in the store (live or not)
+     */
+    size_t GetStringsSize() const { return m_buffer.size(); }
+
+    void Swap(clCompactTagStore& other);
+    void Clear();
+};
+
+#endif // CLCOMPACTTAG_H
@@ -3,6 +3,7 @@
 #include "ctags_manager.h"
 #include "event_notifier.h"
 #include "file_logger.h"
+#include "macros.h"
 #include "parse_thread.h"
 #include "worker_thread.h"
 #include <algorithm>
@@ -15,6 +16,49 @@ class SourceToTagsThread : public wxThread
 {
     clCxxFileCacheSymbols* m_cache;
     wxMessageQueue<wxString> m_queue;
+    wxMessageQueue<clCxxFileCacheBufferRequest> m_buffersQueue;
+
+    /**
+     * @brief return true if 'line' is the start of the declaration written below it (a comment, a template
+     * declaration or the return type of a function)
+     */
+    static bool IsDeclarationPrefix(const wxString& line)
+    {
+        wxString trimmed = line;
+        trimmed.Trim().Trim(false);
+        if(trimmed.IsEmpty() || trimmed.StartsWith("#")) { return false; }
+        wxChar last = trimmed.Last();
+        return last != ';' && last != '{' && last != '}';
+    }
+
+    void DoParseBuffer(const clCxxFileCacheBufferRequest& req)
+    {
+        clCxxFileCacheBufferReply* reply = new clCxxFileCacheBufferReply();
+        reply->filename = req.filename;
+        reply->id = req.id;
+
+        wxString content;
+        if(req.fromLine <= 1 && req.toLine == wxNOT_FOUND) {
+            content = req.buffer;
+
+        } else {
+            wxArrayString lines = ::wxStringTokenize(req.buffer, "\n", wxTOKEN_RET_EMPTY_ALL);
+            int fromLine = std::max(1, std::min(req.fromLine, (int)lines.size()));
+            int toLine = (req.toLine == wxNOT_FOUND) ? (int)lines.size() : std::min(req.toLine, (int)lines.size());
+            while(fromLine > 1 && IsDeclarationPrefix(lines.Item(fromLine - 2))) {
+                --fromLine;
+            }
+            reply->fromLine = fromLine;
+
+            // Keep the line numbers: the lines above the declarations are left empty
+            content.Append('\n', fromLine - 1);
+            for(int i = fromLine; i <= toLine; ++i) {
+                content << lines.Item(i - 1) << "\n";
+            }
+        }
+        reply->tags = TagsManagerST::Get()->ParseBuffer(content, req.filename);
+        m_cache->CallAfter(&clCxxFileCacheSymbols::OnBufferParsed, reply);
+    }
 
 public:
     SourceToTagsThread(clCxxFileCacheSymbols* cache)
@@ -46,6 +90,9 @@ public:
     virtual void* Entry()
     {
         while(true) {
+            clCxxFileCacheBufferRequest bufferRequest;
+            if(m_buffersQueue.ReceiveTimeout(0, bufferRequest) == wxMSGQUEUE_NO_ERROR) { DoParseBuffer(bufferRequest); }
+
             wxString filename;
             if(m_queue.ReceiveTimeout(50, filename) == wxMSGQUEUE_NO_ERROR) {
                 TagsOptionsData tod;
@@ -63,11 +110,13 @@ public:
     }
 
     void ParseFile(const wxString& filename) { m_queue.Post(filename); }
+    void ParseBuffer(const clCxxFileCacheBufferRequest& req) { m_buffersQueue.Post(req); }
 };
 
 clCxxFileCacheSymbols::clCxxFileCacheSymbols()
 {
     EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &clCxxFileCacheSymbols::OnFileSave, this);
+    EventNotifier::Get()->Bind(wxEVT_FILE_CLOSED, &clCxxFileCacheSymbols::OnFileClosed, this);
     EventNotifier::Get()->Bind(wxEVT_WORKSPACE_CLOSED, &clCxxFileCacheSymbols::OnWorkspaceAction, this);
     EventNotifier::Get()->Bind(wxEVT_WORKSPACE_LOADED, &clCxxFileCacheSymbols::OnWorkspaceAction, this);
     m_helperThread = new SourceToTagsThread(this);
@@ -81,6 +130,7 @@ clCxxFileCacheSymbols::~clCxxFileCacheSymbols()
     wxDELETE(m_helperThread);
 
     EventNotifier::Get()->Unbind(wxEVT_FILE_SAVED, &clCxxFileCacheSymbols::OnFileSave, this);
+    EventNotifier::Get()->Unbind(wxEVT_FILE_CLOSED, &clCxxFileCacheSymbols::OnFileClosed, this);
     EventNotifier::Get()->Unbind(wxEVT_WORKSPACE_CLOSED, &clCxxFileCacheSymbols::OnWorkspaceAction, this);
     EventNotifier::Get()->Unbind(wxEVT_WORKSPACE_LOADED, &clCxxFileCacheSymbols::OnWorkspaceAction, this);
 }
@@ -98,6 +148,8 @@ void clCxxFileCacheSymbols::Clear()
     // wxCriticalSectionLocker locker(m_cs);
     m_cache.clear();
     m_pendingFiles.clear();
+    m_pendingBuffers.clear();
+    m_bufferFiles.clear();
     clDEBUG1() << "Symbols cache cleared" << clEndl;
 }
 
@@ -113,6 +165,8 @@ void clCxxFileCacheSymbols::Delete(const wxFileName& filename)
 {
     // wxCriticalSectionLocker locker(m_cs);
     m_cache.erase(filename.GetFullPath());
+    m_pendingBuffers.erase(filename.GetFullPath());
+    m_bufferFiles.erase(filename.GetFullPath());
     clDEBUG1() << "Deleting Symbols cache for file:" << filename << clEndl;
 
     // Notify that the symbols for this file were invalidated
@@ -155,6 +209,17 @@ void clCxxFileCacheSymbols::OnFileSave(clCommandEvent& e)
     Delete(e.GetFileName());
 }
 
+void clCxxFileCacheSymbols::OnFileClosed(clCommandEvent& e)
+{
+    e.Skip();
+    // The unsaved content is gone, so are its symbols
+    if(m_bufferFiles.count(e.GetFileName())) {
+        m_cache.erase(e.GetFileName());
+        m_pendingBuffers.erase(e.GetFileName());
+        m_bufferFiles.erase(e.GetFileName());
+    }
+}
+
 void clCxxFileCacheSymbols::OnWorkspaceAction(wxCommandEvent& e)
 {
     e.Skip();
@@ -175,6 +240,12 @@ void clCxxFileCacheSymbols::RequestSymbols(const wxFileName& filename)
 
 void clCxxFileCacheSymbols::OnPraseCompleted(const wxString& filename, const wxString& strTags)
 {
+    if(m_bufferFiles.count(filename)) {
+        // The editor content was parsed meanwhile, it is more recent than the file on the disk
+        m_pendingFiles.erase(filename);
+        return;
+    }
+
     TagEntryPtrVector_t tags;
     // Convert the string into array of tags
     wxArrayString lines = ::wxStringTokenize(strTags, "\n", wxTOKEN_STRTOK);
@@ -195,3 +266,106 @@ void clCxxFileCacheSymbols::OnPraseCompleted(const wxString& filename, const wxS
 
     m_pendingFiles.erase(filename);
 }
+
+bool clCxxFileCacheSymbols::RequestSymbols(const wxFileName& filename, const wxString& buffer, int firstLine,
+                                           int lastLine, int linesAdded)
+{
+    wxString path = filename.GetFullPath();
+    if(m_pendingBuffers.count(path)) { return false; }
+
+    PendingBuffer pending;
+    pending.id = ++m_nextBufferId;
+    pending.linesAdded = linesAdded;
+    std::unordered_map<wxString, std::vector<TagEntryPtr> >::iterator iter = m_cache.find(path);
+    if(iter != m_cache.end() && !iter->second.empty() && firstLine != wxNOT_FOUND) {
+        // Only the declarations that contain the modified lines are parsed, the other symbols are kept (and moved
+        // by the number of lines added)
+        pending.base = iter->second;
+        int first = firstLine + 1;
+        int last = std::max(first, lastLine + 1 - linesAdded);
+        int nextLine = wxNOT_FOUND;
+        GetDeclarationsRange(pending.base, first, last, pending.fromLine, nextLine);
+        pending.toLine = (nextLine == wxNOT_FOUND) ? wxNOT_FOUND : (nextLine - 1 + linesAdded);
+    }
+
+    clCxxFileCacheBufferRequest req;
+    req.filename = path.c_str(); // the strings are used by the helper thread, make our own copy
+    req.buffer = buffer.c_str();
+    req.id = pending.id;
+    req.fromLine = pending.fromLine;
+    req.toLine = pending.toLine;
+    clDEBUG1() << "Parsing lines" << req.fromLine << "-" << req.toLine << "of editor:" << path << clEndl;
+
+    m_pendingBuffers[path] = pending;
+    m_helperThread->ParseBuffer(req);
+    return true;
+}
+
+void clCxxFileCacheSymbols::GetDeclarationsRange(const TagEntryPtrVector_t& tags, int firstLine, int lastLine,
+                                                 int& fromLine, int& nextLine)
+{
+    // A declaration is at the top level when its scope is not declared in this file (e.g. the implementation of a
+    // class method in a source file). The parser state is the same at the start of every top level declaration
+    wxStringSet_t paths;
+    for(const TagEntryPtr& tag : tags) {
+        paths.insert(tag->GetPath());
+    }
+
+    fromLine = 1;
+    nextLine = wxNOT_FOUND;
+    for(const TagEntryPtr& tag : tags) {
+        if(!tag->IsScopeGlobal() && paths.count(tag->GetScope())) { continue; }
+        int line = tag->GetLine();
+        if(line <= 0) { continue; }
+        if(line <= firstLine) {
+            fromLine = std::max(fromLine, line);
+        } else if(line > lastLine && (nextLine == wxNOT_FOUND || line < nextLine)) {
+            nextLine = line;
+        }
+    }
+}
+
+void clCxxFileCacheSymbols::OnBufferParsed(clCxxFileCacheBufferReply* reply)
+{
+    std::unordered_map<wxString, PendingBuffer>::iterator iter = m_pendingBuffers.find(reply->filename);
+    if(iter == m_pendingBuffers.end() || iter->second.id != reply->id) {
+        // The file was saved or the cache was cleared meanwhile
+        wxDELETE(reply);
+        return;
+    }
+
+    PendingBuffer pending;
+    std::swap(pending, iter->second);
+    m_pendingBuffers.erase(iter);
+
+    // The last line of the parsed declarations in the previous content
+    int oldToLine = (pending.toLine == wxNOT_FOUND) ? wxNOT_FOUND : (pending.toLine - pending.linesAdded);
+    TagEntryPtrVector_t tags;
+    tags.reserve(pending.base.size() + reply->tags.size());
+    for(const TagEntryPtr& tag : pending.base) {
+        int line = tag->GetLine();
+        if(line < reply->fromLine) {
+            tags.push_back(tag);
+
+        } else if(oldToLine != wxNOT_FOUND && line > oldToLine) {
+            if(pending.linesAdded == 0) {
+                tags.push_back(tag);
+            } else {
+                // The tags are shared with the users of the cache, move a copy
+                TagEntryPtr moved(new TagEntry(*tag));
+                moved->SetLine(line + pending.linesAdded);
+                tags.push_back(moved);
+            }
+        }
+    }
+    tags.insert(tags.end(), reply->tags.begin(), reply->tags.end());
+    std::stable_sort(tags.begin(), tags.end(),
+                     [](const TagEntryPtr& a, const TagEntryPtr& b) { return a->GetLine() < b->GetLine(); });
+
+    m_bufferFiles.insert(reply->filename);
+    Update(reply->filename, tags);
+    clCommandEvent event(wxEVT_CXX_SYMBOLS_CACHE_UPDATED);
+    event.SetFileName(reply->filename);
+    EventNotifier::Get()->AddPendingEvent(event);
+    wxDELETE(reply);
+}
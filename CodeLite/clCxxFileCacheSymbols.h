@@ -12,19 +12,64 @@
 #include <wx/thread.h>
 
 class SourceToTagsThread;
+
+/**
+ * @brief a request to parse the lines [fromLine, toLine] (1 based) of an unsaved editor content
+ */
+struct clCxxFileCacheBufferRequest {
+    wxString filename;
+    wxString buffer;
+    size_t id = 0;
+    int fromLine = 1;
+    int toLine = wxNOT_FOUND; // wxNOT_FOUND: until the end of the buffer
+};
+
+struct clCxxFileCacheBufferReply {
+    wxString filename;
+    size_t id = 0;
+    int fromLine = 1; // the first line that was actually parsed
+    TagEntryPtrVector_t tags;
+};
+
 class WXDLLIMPEXP_CL clCxxFileCacheSymbols : public wxEvtHandler
 {
+    /**
+     * @brief a buffer parse request that was not merged into the cache yet
+     */
+    struct PendingBuffer {
+        size_t id = 0;
+        // the cached symbols the lines were computed against
+        TagEntryPtrVector_t base;
+        int fromLine = 1;
+        int toLine = wxNOT_FOUND;
+        int linesAdded = 0;
+    };
+
     std::unordered_map<wxString, std::vector<TagEntryPtr> > m_cache;
     std::unordered_set<wxString> m_pendingFiles;
+    std::unordered_map<wxString, PendingBuffer> m_pendingBuffers;
+    // files whose cached symbols were taken from an unsaved editor
+    std::unordered_set<wxString> m_bufferFiles;
+    size_t m_nextBufferId = 0;
     wxCriticalSection m_cs;
     SourceToTagsThread* m_helperThread;
 
 protected:
     void OnFileSave(clCommandEvent& e);
+    void OnFileClosed(clCommandEvent& e);
     void OnWorkspaceAction(wxCommandEvent& e);
 
+    /**
+     * @brief find the top level declarations of 'tags' that contain the lines [firstLine, lastLine] (1 based)
+     * of the previous content. On return 'fromLine' is the first line of the first declaration and 'nextLine' the line
+     * of the declaration that follows the last one (wxNOT_FOUND if none)
+     */
+    static void GetDeclarationsRange(const TagEntryPtrVector_t& tags, int firstLine, int lastLine, int& fromLine,
+                                     int& nextLine);
+
 public:
     void OnPraseCompleted(const wxString& filename, const wxString& strTags);
+    void OnBufferParsed(clCxxFileCacheBufferReply* reply);
 
 public:
     enum eFilter {
@@ -53,6 +98,16 @@ public:
      * and an event 'clCommandEvent' is fired to notify that the cache was updated
      */
     void RequestSymbols(const wxFileName& filename);
+
+    /**
+     * @brief Request parsing of the unsaved content of an editor. 'firstLine' and 'lastLine' (0 based) are the lines
+     * modified since the previous request for this file and 'linesAdded' is the number of lines added (negative when
+     * removed) by these modifications. Only the top level declarations that contain the modified lines are parsed
+     * again and merged into the cached symbols. 'wxEVT_CXX_SYMBOLS_CACHE_UPDATED' is fired when the cache is updated
+     * @return false if a previous request for this file was not completed yet, the caller should try again later
+     */
+    bool RequestSymbols(const wxFileName& filename, const wxString& buffer, int firstLine, int lastLine,
+                        int linesAdded);
 };
 
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_CXX_SYMBOLS_CACHE_UPDATED, clCommandEvent);
@@ -0,0 +1,263 @@
+#include "clFileIdentity.h"
+#include "file_logger.h"
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <thread>
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/tokenzr.h>
+
+namespace
+{
+const wxUint64 PRIME1 = 0x9E3779B185EBCA87ULL;
+const wxUint64 PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+const wxUint64 PRIME3 = 0x165667B19E3779F9ULL;
+const wxUint64 PRIME4 = 0x85EBCA77C2B2AE63ULL;
+const wxUint64 PRIME5 = 0x27D4EB2F165667C5ULL;
+
+inline wxUint64 Rotl(wxUint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+} // namespace
+
+//===------------------------------------------------
+// clFileHasher
+//===------------------------------------------------
+
+clFileHasher::clFileHasher()
+    : m_hash(PRIME5)
+{
+}
+
+void clFileHasher::Round(wxUint64 word)
+{
+    m_hash ^= Rotl(word * PRIME2, 31) * PRIME1;
+    m_hash = Rotl(m_hash, 27) * PRIME1 + PRIME4;
+}
+
+void clFileHasher::Update(const void* data, size_t len)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    m_totalLen += len;
+
+    // complete the word left over from the previous call
+    if(m_tailLen) {
+        size_t count = std::min(len, sizeof(m_tail) - m_tailLen);
+        memcpy(m_tail + m_tailLen, p, count);
+        m_tailLen += count;
+        p += count;
+        len -= count;
+        if(m_tailLen < sizeof(m_tail)) { return; }
+
+        wxUint64 word;
+        memcpy(&word, m_tail, sizeof(word));
+        Round(word);
+        m_tailLen = 0;
+    }
+
+    while(len >= sizeof(wxUint64)) {
+        wxUint64 word;
+        memcpy(&word, p, sizeof(word));
+        Round(word);
+        p += sizeof(word);
+        len -= sizeof(word);
+    }
+
+    if(len) {
+        memcpy(m_tail, p, len);
+        m_tailLen = len;
+    }
+}
+
+wxUint64 clFileHasher::Digest() const
+{
+    wxUint64 h = m_hash;
+    for(size_t i = 0; i < m_tailLen; ++i) {
+        h ^= m_tail[i] * PRIME5;
+        h = Rotl(h, 11) * PRIME1;
+    }
+    h ^= m_totalLen;
+
+    // final avalanche
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+wxUint64 clFileHasher::Hash(const void* data, size_t len)
+{
+    clFileHasher hasher;
+    hasher.Update(data, len);
+    return hasher.Digest();
+}
+
+//===------------------------------------------------
+// clFileIdentity
+//===------------------------------------------------
+
+bool clFileIdentity::ReadMetadata(const wxString& path)
+{
+    m_ok = false;
+    m_hasHash = false;
+    wxStructStat st;
+    if(wxStat(path, &st) != 0) { return false; }
+
+    m_inode = st.st_ino;
+    m_size = st.st_size;
+    m_mtime = st.st_mtime;
+#if defined(__linux__)
+    m_mtimeNsec = st.st_mtim.tv_nsec;
+#elif defined(__WXMAC__)
+    m_mtimeNsec = st.st_mtimespec.tv_nsec;
+#else
+    m_mtimeNsec = 0;
+#endif
+    m_ok = true;
+    return true;
+}
+
+bool clFileIdentity::SameMetadata(const clFileIdentity& other) const
+{
+    return m_inode == other.m_inode && m_size == other.m_size && m_mtime == other.m_mtime &&
+           m_mtimeNsec == other.m_mtimeNsec;
+}
+
+bool clFileIdentity::HashFile(const wxString& path, wxUint64& hash)
+{
+    wxFile file(path, wxFile::read);
+    if(!file.IsOpened()) { return false; }
+
+    clFileHasher hasher;
+    std::vector<char> buffer(1024 * 1024);
+    while(true) {
+        ssize_t bytesRead = file.Read(buffer.data(), buffer.size());
+        if(bytesRead == wxInvalidOffset) { return false; }
+        if(bytesRead == 0) { break; }
+        hasher.Update(buffer.data(), bytesRead);
+    }
+    hash = hasher.Digest();
+    return true;
+}
+
+clFileIdentity clFileIdentity::FromFile(const wxString& path)
+{
+    clFileIdentity identity;
+    if(identity.ReadMetadata(path)) { identity.m_hasHash = HashFile(path, identity.m_hash); }
+    return identity;
+}
+
+clFileIdentity clFileIdentity::FromFile(const wxString& path, wxUint64 hash)
+{
+    clFileIdentity identity;
+    if(identity.ReadMetadata(path)) {
+        identity.m_hash = hash;
+        identity.m_hasHash = true;
+    }
+    return identity;
+}
+
+wxString clFileIdentity::ToString() const
+{
+    if(!IsOk()) { return wxEmptyString; }
+    return wxString::Format("%" wxLongLongFmtSpec "x:%" wxLongLongFmtSpec "x:%" wxLongLongFmtSpec "x:%lx:%"
+                            wxLongLongFmtSpec "x:%d",
+                            (wxULongLong_t)m_inode, (wxULongLong_t)m_size, (wxULongLong_t)m_mtime,
+                            (unsigned long)m_mtimeNsec, (wxULongLong_t)m_hash, m_hasHash ? 1 : 0);
+}
+
+clFileIdentity clFileIdentity::FromString(const wxString& str)
+{
+    clFileIdentity identity;
+    wxArrayString parts = ::wxStringTokenize(str, ":", wxTOKEN_RET_EMPTY_ALL);
+    if(parts.size() != 6) { return identity; }
+
+    wxULongLong_t values[5];
+    for(size_t i = 0; i < 5; ++i) {
+        if(!parts.Item(i).ToULongLong(&values[i], 16)) { return identity; }
+    }
+    identity.m_inode = values[0];
+    identity.m_size = values[1];
+    identity.m_mtime = (wxInt64)values[2];
+    identity.m_mtimeNsec = (long)values[3];
+    identity.m_hash = values[4];
+    identity.m_hasHash = (parts.Item(5) == "1");
+    identity.m_ok = true;
+    return identity;
+}
+
+clFileIdentity::eState clFileIdentity::CheckMetadata(const wxString& path, clFileIdentity& current) const
+{
+    if(!current.ReadMetadata(path)) {
+        // keep the last known content: if the file comes back, it is compared with it
+        current.m_size = m_size;
+        current.m_hash = m_hash;
+        current.m_hasHash = m_hasHash;
+        // a file that was already missing is not reported again
+        return IsOk() ? kDeleted : kUnchanged;
+    }
+
+    if(IsOk() && SameMetadata(current)) {
+        current.m_hash = m_hash;
+        current.m_hasHash = m_hasHash;
+        return kUnchanged;
+    }
+
+    // an identity recorded while the file could not be read tells nothing about its content (unless the file was
+    // deleted: in that case it holds the last known content)
+    if(!HasHash()) { return kUnknown; }
+
+    // the size changed: no need to read the file, we know it was modified
+    if(m_size != current.m_size) { return kModified; }
+
+    // we need to compare the content
+    return kTouched;
+}
+
+clFileIdentity::eState clFileIdentity::CheckContent(const wxString& path, clFileIdentity& current) const
+{
+    current.m_hasHash = HashFile(path, current.m_hash);
+    if(!current.m_hasHash) { return kDeleted; }
+    return (current.m_hash == m_hash) ? kTouched : kModified;
+}
+
+clFileIdentity::eState clFileIdentity::Check(const wxString& path, clFileIdentity& current) const
+{
+    eState state = CheckMetadata(path, current);
+    return (state == kTouched) ? CheckContent(path, current) : state;
+}
+
+void clFileIdentity::CheckBatch(std::vector<BatchEntry>& entries)
+{
+    // Step 1: metadata only
+    std::vector<size_t> toHash;
+    for(size_t i = 0; i < entries.size(); ++i) {
+        BatchEntry& entry = entries[i];
+        entry.state = entry.identity.CheckMetadata(entry.path, entry.current);
+        if(entry.state == kTouched) { toHash.push_back(i); }
+    }
+
+    if(toHash.empty()) { return; }
+
+    // Step 2: hash the remaining files
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t index;
+        while((index = next++) < toHash.size()) {
+            BatchEntry& entry = entries[toHash[index]];
+            entry.state = entry.identity.CheckContent(entry.path, entry.current);
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(toHash.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& t : threads) {
+        t.join();
+    }
+    clDEBUG1() << "clFileIdentity: hashed" << toHash.size() << "files out of" << entries.size() << clEndl;
+}
@@ -0,0 +1,127 @@
+#ifndef CLFILEIDENTITY_H
+#define CLFILEIDENTITY_H
+
+#include "codelite_exports.h"
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class clFileHasher
+ * @brief a fast, streaming, 64-bit non-cryptographic hash (xxHash64 style word loop).
+ * The result of hashing a buffer does not depend on how the buffer was split between Update() calls
+ */
+class WXDLLIMPEXP_CL clFileHasher
+{
+    wxUint64 m_hash;
+    wxUint64 m_totalLen = 0;
+    unsigned char m_tail[8];
+    size_t m_tailLen = 0;
+
+protected:
+    void Round(wxUint64 word);
+
+public:
+    clFileHasher();
+    ~clFileHasher() {}
+
+    void Update(const void* data, size_t len);
+    wxUint64 Digest() const;
+
+    /**
+     * @brief hash a buffer in one go
+     */
+    static wxUint64 Hash(const void* data, size_t len);
+};
+
+/**
+ * @class clFileIdentity
+ * @brief identifies the content of a file on disk: (inode, size, mtime) plus a 64-bit hash of the raw bytes.
+ * Comparing identities is cheap: the file content is read and hashed only when its metadata changed, and the content
+ * is never decoded
+ */
+class WXDLLIMPEXP_CL clFileIdentity
+{
+public:
+    enum eState {
+        kUnchanged = 0, // metadata is unchanged
+        kTouched,       // metadata changed, but the content is identical (e.g. after "git stash && git stash pop")
+        kModified,      // the content is different
+        kDeleted,       // the file no longer exists (or can not be read)
+        kUnknown,       // the recorded identity is incomplete (e.g. the file could not be read), nothing to compare
+    };
+
+    struct BatchEntry;
+
+protected:
+    wxUint64 m_inode = 0;
+    wxUint64 m_size = 0;
+    wxInt64 m_mtime = 0;
+    long m_mtimeNsec = 0;
+    wxUint64 m_hash = 0;
+    bool m_ok = false;      // metadata is valid
+    bool m_hasHash = false; // m_hash is valid
+
+    bool ReadMetadata(const wxString& path);
+    bool SameMetadata(const clFileIdentity& other) const;
+    /// returns kTouched when the content must be compared to decide
+    eState CheckMetadata(const wxString& path, clFileIdentity& current) const;
+    eState CheckContent(const wxString& path, clFileIdentity& current) const;
+
+public:
+    clFileIdentity() {}
+    ~clFileIdentity() {}
+
+    bool IsOk() const { return m_ok; }
+    bool HasHash() const { return m_hasHash; }
+    wxUint64 GetHash() const { return m_hash; }
+    wxUint64 GetSize() const { return m_size; }
+
+    /**
+     * @brief record the identity of a file, hashing its content
+     */
+    static clFileIdentity FromFile(const wxString& path);
+
+    /**
+     * @brief record the identity of a file whose content we just wrote (or read), without reading it again
+     * @param hash the hash of the raw bytes, as computed by clFileHasher
+     */
+    static clFileIdentity FromFile(const wxString& path, wxUint64 hash);
+
+    /**
+     * @brief hash the raw content of a file
+     */
+    static bool HashFile(const wxString& path, wxUint64& hash);
+
+    /**
+     * @brief serialize the identity into a compact string, so it can be stored in the on-disk caches
+     */
+    wxString ToString() const;
+
+    /**
+     * @brief restore an identity serialized with ToString(). Returns an invalid identity on error
+     */
+    static clFileIdentity FromString(const wxString& str);
+
+    /**
+     * @brief compare this identity with the file on disk
+     * @param current [output] the identity of the file on disk. Its content hash is copied from this object when the
+     * metadata is unchanged, and it is not computed at all when the size changed. Storing 'current' as the new
+     * reference means that the same change is not reported again
+     */
+    eState Check(const wxString& path, clFileIdentity& current) const;
+
+    /**
+     * @brief check a list of files. Metadata is checked for all the files first, then the files whose metadata
+     * changed are hashed in parallel
+     */
+    static void CheckBatch(std::vector<BatchEntry>& entries);
+};
+
+struct clFileIdentity::BatchEntry {
+    wxString path;
+    clFileIdentity identity; // the recorded identity
+    clFileIdentity current;  // [output] the identity of the file on disk
+    eState state = kUnchanged;
+};
+
+#endif // CLFILEIDENTITY_H
@@ -0,0 +1,474 @@
+#include "clIncludeGraphCache.h"
+#include "clParallel.h"
+#include "cl_standard_paths.h"
+#include "file_logger.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <wx/ffile.h>
+#include <wx/tokenzr.h>
+
+// the same limit as the crawler
+static const size_t MAX_DEPTH = 20;
+
+// a new snapshot is written when the journal has more records than this (or than half of the entries)
+static const size_t MIN_JOURNAL_SIZE_TO_COMPACT = 1000;
+
+namespace
+{
+wxString ToHex(wxUint64 value) { return wxString::Format("%" wxLongLongFmtSpec "x", (wxULongLong_t)value); }
+
+void HashPaths(clFileHasher& hasher, const wxArrayString& paths)
+{
+    for(const wxString& path : paths) {
+        wxCharBuffer cb = path.mb_str(wxConvUTF8);
+        hasher.Update(cb.data(), cb.length() + 1); // include the terminating null
+    }
+    hasher.Update("|", 1);
+}
+
+wxArrayString NormalizePaths(const wxArrayString& paths)
+{
+    // see fcFileOpener::AddSearchPath()
+    wxArrayString result;
+    for(const wxString& path : paths) {
+        wxFileName fn(path, "");
+        if(wxFileName::DirExists(fn.GetPath())) { result.Add(fn.GetPath()); }
+    }
+    return result;
+}
+
+bool IsDirectiveChar(char ch) { return (ch >= 'a' && ch <= 'z') || ch == '_'; }
+} // namespace
+
+void clIncludeGraphCache::ScanIncludes(const std::string& content, wxArrayString& names)
+{
+    enum eState { kCode, kLineComment, kBlockComment, kString, kChar };
+    eState state = kCode;
+    bool lineStart = true;
+    size_t len = content.length();
+    for(size_t i = 0; i < len; ++i) {
+        char ch = content[i];
+        char next = (i + 1) < len ? content[i + 1] : 0;
+        switch(state) {
+        case kLineComment:
+            if(ch == '\n') {
+                state = kCode;
+                lineStart = true;
+            }
+            break;
+        case kBlockComment:
+            if(ch == '*' && next == '/') {
+                state = kCode;
+                ++i;
+            } else if(ch == '\n') {
+                lineStart = true;
+            }
+            break;
+        case kString:
+        case kChar:
+            if(ch == '\\') {
+                ++i;
+            } else if(ch == '\n' || (state == kString && ch == '"') || (state == kChar && ch == '\'')) {
+                lineStart = (ch == '\n');
+                state = kCode;
+            }
+            break;
+        case kCode:
+            if(ch == '\n') {
+                lineStart = true;
+            } else if(ch == ' ' || ch == '\t' || ch == '\r') {
+                // keep 'lineStart'
+            } else if(ch == '/' && next == '/') {
+                state = kLineComment;
+                ++i;
+            } else if(ch == '/' && next == '*') {
+                state = kBlockComment;
+                ++i;
+            } else if(ch == '"') {
+                state = kString;
+                lineStart = false;
+            } else if(ch == '\'') {
+                state = kChar;
+                lineStart = false;
+            } else if(ch == '#' && lineStart) {
+                lineStart = false;
+                size_t pos = i + 1;
+                while(pos < len && (content[pos] == ' ' || content[pos] == '\t')) {
+                    ++pos;
+                }
+                size_t start = pos;
+                while(pos < len && IsDirectiveChar(content[pos])) {
+                    ++pos;
+                }
+                std::string directive = content.substr(start, pos - start);
+                if(directive != "include" && directive != "include_next" && directive != "import") {
+                    // scan the rest of the line as usual
+                    i = pos - 1;
+                    break;
+                }
+                while(pos < len && (content[pos] == ' ' || content[pos] == '\t')) {
+                    ++pos;
+                }
+                if(pos >= len || (content[pos] != '"' && content[pos] != '<')) {
+                    i = pos - 1;
+                    break;
+                }
+                char close = (content[pos] == '"') ? '"' : '>';
+                start = ++pos;
+                while(pos < len && content[pos] != close && content[pos] != '\n') {
+                    ++pos;
+                }
+                if(pos < len && content[pos] == close) {
+                    wxString name(content.c_str() + start, wxConvUTF8, pos - start);
+                    name.Trim().Trim(false);
+                    if(!name.IsEmpty()) { names.Add(name); }
+                }
+                i = pos;
+                if(pos < len && content[pos] == '\n') { lineStart = true; }
+            } else {
+                lineStart = false;
+            }
+            break;
+        }
+    }
+}
+
+clIncludeGraphCache& clIncludeGraphCache::Get()
+{
+    static clIncludeGraphCache cache;
+    return cache;
+}
+
+bool clIncludeGraphCache::Crawl(const wxArrayString& files, const wxArrayString& searchPaths,
+                                const wxArrayString& excludePaths, wxStringSet_t& included,
+                                const CancelFunc_t& cancelled)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DoSetPaths(searchPaths, excludePaths);
+    ++m_crawlId;
+
+    wxStringSet_t visited, reached, missing;
+    wxArrayString level;
+    for(const wxString& file : files) {
+        wxFileName fn(file);
+        fn.MakeAbsolute();
+        fn.Normalize(wxPATH_NORM_DOTS);
+        if(visited.insert(fn.GetFullPath()).second) { level.Add(fn.GetFullPath()); }
+    }
+
+    // walk the include tree one level at a time, so the files of each level can be validated in parallel
+    for(size_t depth = 0; !level.IsEmpty() && depth < MAX_DEPTH; ++depth) {
+        if(cancelled && cancelled()) { return false; }
+        DoValidate(level);
+
+        wxArrayString nextLevel;
+        for(const wxString& file : level) {
+            EntryMap_t::const_iterator iter = m_entries.find(file);
+            if(iter == m_entries.end()) {
+                // the file was deleted since its includer was scanned
+                missing.insert(file);
+                continue;
+            }
+            for(const wxString& include : iter->second.includes) {
+                reached.insert(include);
+                if(visited.insert(include).second) { nextLevel.Add(include); }
+            }
+        }
+        level.swap(nextLevel);
+    }
+
+    for(const wxString& file : reached) {
+        if(missing.count(file) == 0) { included.insert(file); }
+    }
+
+    DoSaveChanges();
+    return true;
+}
+
+void clIncludeGraphCache::DoValidate(const wxArrayString& files)
+{
+    std::vector<Entry*> entries;
+    std::vector<wxString> paths;
+    for(const wxString& file : files) {
+        Entry& entry = m_entries[file];
+        if(entry.crawlId == m_crawlId) { continue; }
+        entry.crawlId = m_crawlId;
+        entries.push_back(&entry);
+        paths.push_back(file);
+    }
+    if(entries.empty()) { return; }
+
+    // 0: valid, 1: scanned, 2: the file can not be read, 3: valid with a new identity
+    std::vector<int> results(entries.size(), 0);
+    clParallelFor(entries.size(), [&](size_t index) {
+        Entry& entry = *entries[index];
+        const wxString& path = paths[index];
+
+        bool needScan = !entry.identity.IsOk();
+        if(!needScan) {
+            clFileIdentity current;
+            switch(entry.identity.Check(path, current)) {
+            case clFileIdentity::kTouched:
+                entry.identity = current;
+                results[index] = 3;
+                break;
+            case clFileIdentity::kModified:
+            case clFileIdentity::kDeleted:
+            case clFileIdentity::kUnknown:
+                needScan = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        // a header that was missing the last time might exist now
+        wxString dir = wxFileName(path).GetPath();
+        for(size_t i = 0; !needScan && i < entry.unresolved.size(); ++i) {
+            wxString fullpath;
+            needScan = DoResolve(dir, entry.unresolved.Item(i), fullpath);
+        }
+
+        if(needScan) { results[index] = DoScanFile(path, entry) ? 1 : 2; }
+    });
+
+    size_t scanned = 0;
+    for(size_t i = 0; i < results.size(); ++i) {
+        if(results[i] == 0) { continue; }
+        if(results[i] == 1) {
+            ++scanned;
+        } else if(results[i] == 2) {
+            m_entries.erase(paths[i]);
+        }
+        m_changed.insert(paths[i]);
+    }
+    clDEBUG1() << "clIncludeGraphCache: validated" << entries.size() << "files, scanned" << scanned << clEndl;
+}
+
+bool clIncludeGraphCache::DoScanFile(const wxString& filename, Entry& entry) const
+{
+    entry.identity = clFileIdentity();
+    entry.includes.clear();
+    entry.unresolved.clear();
+
+    wxFFile fp(filename, "rb");
+    if(!fp.IsOpened()) { return false; }
+
+    wxFileOffset length = fp.Length();
+    if(length == wxInvalidOffset) { return false; }
+
+    std::string content;
+    content.resize(length);
+    if(!content.empty() && fp.Read(&content[0], content.length()) != content.length()) { return false; }
+    fp.Close();
+
+    entry.identity = clFileIdentity::FromFile(filename, clFileHasher::Hash(content.c_str(), content.length()));
+
+    wxArrayString names;
+    ScanIncludes(content, names);
+
+    wxString dir = wxFileName(filename).GetPath();
+    wxStringSet_t unique;
+    for(const wxString& name : names) {
+        if(!unique.insert(name).second) { continue; }
+        wxString fullpath;
+        if(DoResolve(dir, name, fullpath)) {
+            entry.includes.Add(fullpath);
+        } else {
+            entry.unresolved.Add(name);
+        }
+    }
+    return true;
+}
+
+bool clIncludeGraphCache::DoResolve(const wxString& dir, const wxString& name, wxString& fullpath) const
+{
+    // same order as the crawler: the folder of the including file first, then the search paths
+    for(size_t i = 0; i <= m_searchPaths.size(); ++i) {
+        const wxString& path = (i == 0) ? dir : m_searchPaths.Item(i - 1);
+        wxFileName fn(path + wxFileName::GetPathSeparator() + name);
+        if(!fn.FileExists()) { continue; }
+        fn.Normalize(wxPATH_NORM_DOTS);
+
+        bool excluded = false;
+        wxString pathPart = fn.GetPath();
+        for(size_t j = 0; !excluded && j < m_excludePaths.size(); ++j) {
+            excluded = pathPart.StartsWith(m_excludePaths.Item(j));
+        }
+        if(excluded) { continue; }
+
+        fullpath = fn.GetFullPath();
+        return true;
+    }
+    return false;
+}
+
+void clIncludeGraphCache::DoSetPaths(const wxArrayString& searchPaths, const wxArrayString& excludePaths)
+{
+    wxArrayString search = NormalizePaths(searchPaths);
+    wxArrayString exclude = NormalizePaths(excludePaths);
+
+    clFileHasher hasher;
+    HashPaths(hasher, search);
+    HashPaths(hasher, exclude);
+    wxUint64 key = hasher.Digest();
+    if(m_loaded && key == m_key) { return; }
+
+    if(m_loaded) { DoSaveChanges(); }
+    m_entries.clear();
+    m_changed.clear();
+    m_journalSize = 0;
+    m_key = key;
+    m_searchPaths.swap(search);
+    m_excludePaths.swap(exclude);
+    DoLoad();
+    m_loaded = true;
+}
+
+wxFileName clIncludeGraphCache::GetCacheFile() const
+{
+    // one file per search paths set
+    wxFileName fn(clStandardPaths::Get().GetUserDataDir(), ToHex(m_key) + ".json");
+    fn.AppendDir("cache");
+    fn.AppendDir("includes");
+    return fn;
+}
+
+wxFileName clIncludeGraphCache::GetJournalFile() const
+{
+    wxFileName fn = GetCacheFile();
+    fn.SetExt("journal");
+    return fn;
+}
+
+JSONItem clIncludeGraphCache::EntryToJSON(const Entry& entry)
+{
+    JSONItem item = JSONItem::createObject();
+    item.addProperty("id", entry.identity.ToString());
+    item.addProperty("includes", entry.includes);
+    item.addProperty("unresolved", entry.unresolved);
+    return item;
+}
+
+bool clIncludeGraphCache::EntryFromJSON(const JSONItem& item, Entry& entry)
+{
+    entry.identity = clFileIdentity::FromString(item.namedObject("id").toString());
+    if(!entry.identity.IsOk()) { return false; }
+    entry.includes = item.namedObject("includes").toArrayString();
+    entry.unresolved = item.namedObject("unresolved").toArrayString();
+    return true;
+}
+
+void clIncludeGraphCache::DoLoad()
+{
+    wxFileName fn = GetCacheFile();
+    if(!fn.FileExists()) { return; }
+
+    JSON root(fn);
+    if(!root.isOk()) { return; }
+    JSONItem json = root.toElement();
+    // a different set with the same hash
+    if(json.namedObject("searchPaths").toArrayString() != m_searchPaths ||
+       json.namedObject("excludePaths").toArrayString() != m_excludePaths) {
+        return;
+    }
+
+    JSONItem files = json.namedObject("files");
+    JSONItem item = files.firstChild();
+    while(item.isOk()) {
+        Entry entry;
+        if(EntryFromJSON(item, entry)) { m_entries[item.namedObject("file").toString()] = entry; }
+        item = files.nextChild();
+    }
+    DoLoadJournal();
+    clDEBUG() << "clIncludeGraphCache: loaded" << m_entries.size() << "entries from" << fn.GetFullPath() << "and"
+              << m_journalSize << "journal records" << clEndl;
+}
+
+void clIncludeGraphCache::DoLoadJournal()
+{
+    wxFFile fp(GetJournalFile().GetFullPath(), "rb");
+    if(!fp.IsOpened()) { return; }
+
+    wxString content;
+    if(!fp.ReadAll(&content, wxConvUTF8)) { return; }
+
+    // one record per line, the last record wins. A partial last line (e.g. after a crash) is ignored
+    wxArrayString lines = ::wxStringTokenize(content, "\n", wxTOKEN_STRTOK);
+    for(const wxString& line : lines) {
+        JSON record(line);
+        if(!record.isOk()) { continue; }
+        JSONItem item = record.toElement();
+        wxString file = item.namedObject("file").toString();
+        if(file.IsEmpty()) { continue; }
+
+        Entry entry;
+        if(EntryFromJSON(item, entry)) {
+            m_entries[file] = entry;
+        } else {
+            m_entries.erase(file);
+        }
+        ++m_journalSize;
+    }
+}
+
+void clIncludeGraphCache::DoSaveChanges()
+{
+    if(m_changed.empty()) { return; }
+
+    // the snapshot is only written again once the journal is large: most crawls only change a few entries
+    if(!GetCacheFile().FileExists() ||
+       (m_journalSize + m_changed.size()) > std::max(MIN_JOURNAL_SIZE_TO_COMPACT, m_entries.size() / 2)) {
+        DoSave();
+        return;
+    }
+
+    wxFFile fp(GetJournalFile().GetFullPath(), "ab");
+    if(!fp.IsOpened()) { return; }
+
+    wxString records;
+    for(const wxString& file : m_changed) {
+        EntryMap_t::const_iterator iter = m_entries.find(file);
+        JSONItem item = (iter == m_entries.end()) ? JSONItem::createObject() : EntryToJSON(iter->second);
+        // an entry without an identity is a removed entry
+        item.addProperty("file", file);
+        records << item.format(false) << "\n";
+        cJSON_Delete(item.release());
+    }
+    fp.Write(records, wxConvUTF8);
+    m_journalSize += m_changed.size();
+    m_changed.clear();
+}
+
+void clIncludeGraphCache::DoSave()
+{
+    wxFileName fn = GetCacheFile();
+    fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    JSON root(cJSON_Object);
+    JSONItem json = root.toElement();
+    json.addProperty("searchPaths", m_searchPaths);
+    json.addProperty("excludePaths", m_excludePaths);
+    JSONItem files = json.AddArray("files");
+    for(const EntryMap_t::value_type& vt : m_entries) {
+        if(!vt.second.identity.IsOk()) { continue; }
+        JSONItem item = EntryToJSON(vt.second);
+        item.addProperty("file", vt.first);
+        files.arrayAppend(item);
+    }
+
+    // write to a temporary file first, so a reader never loads a partial cache
+    wxFileName tmpfile = fn;
+    tmpfile.SetExt("tmp");
+    root.save(tmpfile);
+    if(!wxRenameFile(tmpfile.GetFullPath(), fn.GetFullPath(), true)) {
+        wxRemoveFile(tmpfile.GetFullPath());
+        return;
+    }
+
+    // the snapshot includes all the changes
+    wxRemoveFile(GetJournalFile().GetFullPath());
+    m_journalSize = 0;
+    m_changed.clear();
+}
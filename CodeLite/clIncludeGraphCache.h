@@ -0,0 +1,99 @@
+#ifndef CLINCLUDEGRAPHCACHE_H
+#define CLINCLUDEGRAPHCACHE_H
+
+#include "JSON.h"
+#include "clFileIdentity.h"
+#include "codelite_exports.h"
+#include "macros.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class clIncludeGraphCache
+ * @brief a persistent cache of the "#include" statements of the source files. For every file we keep its identity
+ * (see clFileIdentity), the files it includes directly (resolved using the search paths) and the include statements
+ * that could not be resolved. An entry is valid for a given set of search / exclude paths, each set is stored in its
+ * own file under the user data directory: a snapshot of all the entries, followed by a journal of the entries that
+ * changed since the snapshot was written (so a crawl only appends the few entries it re-scanned).
+ * Crawling the includes of a file only reads the files that were modified since they were last scanned, and the
+ * modified files are scanned in parallel. This class replaces the flex based crawler (which is not thread safe and
+ * always reads the complete include tree) for the parser thread. All the methods are thread safe
+ */
+class WXDLLIMPEXP_CL clIncludeGraphCache
+{
+public:
+    typedef std::function<bool()> CancelFunc_t;
+
+protected:
+    struct Entry {
+        clFileIdentity identity;
+        wxArrayString includes;   // the resolved files, full paths
+        wxArrayString unresolved; // the include statements that we could not resolve
+        size_t crawlId = 0;       // the last crawl that validated this entry
+    };
+    typedef std::unordered_map<wxString, Entry> EntryMap_t;
+
+    std::mutex m_mutex;
+    wxUint64 m_key = 0;
+    bool m_loaded = false;
+    wxStringSet_t m_changed; // the entries changed (or removed) since they were last written
+    size_t m_journalSize = 0; // the number of records in the journal file
+    size_t m_crawlId = 0;
+    wxArrayString m_searchPaths;
+    wxArrayString m_excludePaths;
+    EntryMap_t m_entries;
+
+protected:
+    clIncludeGraphCache() {}
+    ~clIncludeGraphCache() {}
+
+    /**
+     * @brief select the entries of a search paths set, loading them from the disk if needed
+     */
+    void DoSetPaths(const wxArrayString& searchPaths, const wxArrayString& excludePaths);
+    wxFileName GetCacheFile() const;
+    wxFileName GetJournalFile() const;
+    void DoLoad();
+    void DoLoadJournal();
+    /**
+     * @brief write the changed entries: append them to the journal, or write a new snapshot once the journal is large
+     */
+    void DoSaveChanges();
+    void DoSave();
+
+    /**
+     * @brief validate the entries of 'files', re-scanning the files that were modified (in parallel)
+     */
+    void DoValidate(const wxArrayString& files);
+    bool DoScanFile(const wxString& filename, Entry& entry) const;
+    static JSONItem EntryToJSON(const Entry& entry);
+    static bool EntryFromJSON(const JSONItem& item, Entry& entry);
+    bool DoResolve(const wxString& dir, const wxString& name, wxString& fullpath) const;
+
+public:
+    static clIncludeGraphCache& Get();
+
+    /**
+     * @brief collect the names of the files included by 'content' (#include, #include_next and #import). Comments
+     * and strings are skipped
+     */
+    static void ScanIncludes(const std::string& content, wxArrayString& names);
+
+    /**
+     * @brief collect the files included (directly or not) by 'files'
+     * @param searchPaths the include search paths
+     * @param excludePaths files under these folders are not returned and their includes are not followed
+     * @param included [output] the included files (full paths)
+     * @param cancelled called between the levels of the include tree, the crawl stops when it returns true
+     * @return false if the crawl was cancelled
+     */
+    bool Crawl(const wxArrayString& files, const wxArrayString& searchPaths, const wxArrayString& excludePaths,
+               wxStringSet_t& included, const CancelFunc_t& cancelled = nullptr);
+};
+
+#endif // CLINCLUDEGRAPHCACHE_H
@@ -0,0 +1,804 @@
+#include "clJSONDocument.h"
+#include <algorithm>
+#include <locale.h>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wx/ffile.h>
+
+// Documents nested deeper than this are rejected (protects the parser stack)
+#define JSON_MAX_DEPTH 512
+
+// Objects with more members than this get a hash index, smaller ones are scanned linearly
+#define JSON_INDEX_THRESHOLD 8
+
+namespace
+{
+inline unsigned int HashName(const char* str, size_t len)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for(size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline int HexValue(char ch)
+{
+    if(ch >= '0' && ch <= '9') { return ch - '0'; }
+    if(ch >= 'a' && ch <= 'f') { return ch - 'a' + 10; }
+    if(ch >= 'A' && ch <= 'F') { return ch - 'A' + 10; }
+    return wxNOT_FOUND;
+}
+
+inline char* EncodeUTF8(char* out, unsigned int cp)
+{
+    if(cp < 0x80) {
+        *out++ = (char)cp;
+    } else if(cp < 0x800) {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if(cp < 0x10000) {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+const clJSONNode* FindMember(const clJSONNode* node, const char* name, size_t len)
+{
+    if(!node || node->type != kJSONObject || node->count == 0) { return nullptr; }
+    unsigned int hash = HashName(name, len);
+    if(node->buckets) {
+        unsigned int index = hash & node->bucketsMask;
+        while(node->buckets[index]) {
+            const clJSONNode* child = node->children + (node->buckets[index] - 1);
+            if(child->nameHash == hash && child->nameLen == len && memcmp(child->name, name, len) == 0) {
+                return child;
+            }
+            index = (index + 1) & node->bucketsMask;
+        }
+        return nullptr;
+    }
+
+    for(unsigned int i = 0; i < node->count; ++i) {
+        const clJSONNode* child = node->children + i;
+        if(child->nameHash == hash && child->nameLen == len && memcmp(child->name, name, len) == 0) { return child; }
+    }
+    return nullptr;
+}
+} // namespace
+
+//===---------------------------------------------------------------------------
+// clJSONArena
+//===---------------------------------------------------------------------------
+
+clJSONArena::clJSONArena(size_t blockSize)
+    : m_blockSize(blockSize)
+{
+}
+
+clJSONArena::~clJSONArena() { Clear(); }
+
+void* clJSONArena::Allocate(size_t bytes)
+{
+    // keep every allocation pointer aligned
+    const size_t align = sizeof(void*) > sizeof(double) ? sizeof(void*) : sizeof(double);
+    bytes = (bytes + align - 1) & ~(align - 1);
+    if(bytes > m_bytesLeft) {
+        size_t blockSize = std::max(bytes, m_blockSize);
+        char* block = (char*)malloc(blockSize);
+        if(!block) { return nullptr; }
+        m_blocks.push_back(block);
+        m_cursor = block;
+        m_bytesLeft = blockSize;
+    }
+    void* mem = m_cursor;
+    m_cursor += bytes;
+    m_bytesLeft -= bytes;
+    return mem;
+}
+
+void clJSONArena::Clear()
+{
+    for(char* block : m_blocks) {
+        free(block);
+    }
+    m_blocks.clear();
+    m_cursor = nullptr;
+    m_bytesLeft = 0;
+}
+
+//===---------------------------------------------------------------------------
+// clJSONDocument
+//===---------------------------------------------------------------------------
+
+clJSONDocument::clJSONDocument() {}
+
+clJSONDocument::~clJSONDocument() {}
+
+void clJSONDocument::Clear()
+{
+    m_root = nullptr;
+    m_arena.Clear();
+    m_stack.clear();
+    m_buffer.clear();
+    m_errorString.clear();
+    m_cur = nullptr;
+    m_end = nullptr;
+}
+
+bool clJSONDocument::Parse(const wxString& text)
+{
+    const wxScopedCharBuffer cb = text.mb_str(wxConvUTF8);
+    return Parse(cb.data(), cb.length());
+}
+
+bool clJSONDocument::Parse(const char* buffer, size_t len) { return Parse(std::string(buffer, len)); }
+
+bool clJSONDocument::Load(const wxFileName& filename)
+{
+    wxFFile fp(filename.GetFullPath(), "rb");
+    if(!fp.IsOpened()) {
+        Clear();
+        return SetError(wxString() << "Could not open file: " << filename.GetFullPath());
+    }
+
+    std::string buffer;
+    wxFileOffset size = fp.Length();
+    if(size > 0) {
+        buffer.resize((size_t)size);
+        if(fp.Read(&buffer[0], buffer.size()) != buffer.size()) {
+            Clear();
+            return SetError(wxString() << "Failed to read file: " << filename.GetFullPath());
+        }
+    }
+    fp.Close();
+    return Parse(std::move(buffer));
+}
+
+bool clJSONDocument::Parse(std::string&& buffer)
+{
+    Clear();
+    m_buffer.swap(buffer);
+    if(m_buffer.empty()) { return SetError("Empty JSON text"); }
+
+    m_cur = &m_buffer[0];
+    m_end = m_cur + m_buffer.size();
+
+    // skip UTF-8 BOM
+    if(m_buffer.size() >= 3 && (unsigned char)m_cur[0] == 0xEF && (unsigned char)m_cur[1] == 0xBB &&
+       (unsigned char)m_cur[2] == 0xBF) {
+        m_cur += 3;
+    }
+
+    clJSONNode* root = (clJSONNode*)m_arena.Allocate(sizeof(clJSONNode));
+    new(root) clJSONNode();
+    bool ok = ParseValue(*root, 0);
+    if(ok) {
+        // only whitespace may follow the root value
+        SkipWhitespace();
+        if(m_cur < m_end) { ok = SetError("Unexpected data after the root value"); }
+    }
+    if(!ok) {
+        m_arena.Clear();
+        m_stack.clear();
+        return false;
+    }
+    m_root = root;
+
+    // the scratch stack is only needed during the parse
+    std::vector<clJSONNode> empty;
+    m_stack.swap(empty);
+    return true;
+}
+
+bool clJSONDocument::SetError(const wxString& message)
+{
+    m_errorString = message;
+    if(m_cur && !m_buffer.empty()) { m_errorString << ". At offset: " << (size_t)(m_cur - m_buffer.c_str()); }
+    return false;
+}
+
+void clJSONDocument::SkipWhitespace()
+{
+    while(m_cur < m_end && (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r')) {
+        ++m_cur;
+    }
+}
+
+bool clJSONDocument::ParseLiteral(const char* literal, size_t len)
+{
+    if((size_t)(m_end - m_cur) < len || strncmp(m_cur, literal, len) != 0) {
+        return SetError(wxString() << "Invalid literal, expected: " << literal);
+    }
+    m_cur += len;
+    return true;
+}
+
+bool clJSONDocument::ParseValue(clJSONNode& node, int depth)
+{
+    if(depth > JSON_MAX_DEPTH) { return SetError("Maximum nesting depth exceeded"); }
+
+    SkipWhitespace();
+    if(m_cur >= m_end) { return SetError("Unexpected end of input"); }
+
+    switch(*m_cur) {
+    case '{':
+        return ParseContainer(node, true, depth);
+    case '[':
+        return ParseContainer(node, false, depth);
+    case '"':
+        node.type = kJSONString;
+        return ParseString(node.str, node.strLen);
+    case 't':
+        node.type = kJSONTrue;
+        return ParseLiteral("true", 4);
+    case 'f':
+        node.type = kJSONFalse;
+        return ParseLiteral("false", 5);
+    case 'n':
+        node.type = kJSONNull;
+        return ParseLiteral("null", 4);
+    default:
+        if(*m_cur == '-' || (*m_cur >= '0' && *m_cur <= '9')) { return ParseNumber(node); }
+        break;
+    }
+    return SetError("Unexpected character");
+}
+
+bool clJSONDocument::ParseString(const char*& str, unsigned int& len)
+{
+    // skip the opening quote
+    ++m_cur;
+
+    // Strings are decoded in-place: the decoded form of an escape sequence is never longer than the escape
+    // sequence itself, so the write cursor never overtakes the read cursor
+    char* start = m_cur;
+    char* out = m_cur;
+    while(m_cur < m_end) {
+        char ch = *m_cur;
+        if(ch == '"') {
+            str = start;
+            len = (unsigned int)(out - start);
+            ++m_cur;
+            return true;
+
+        } else if(ch != '\\') {
+            *out++ = ch;
+            ++m_cur;
+            continue;
+        }
+
+        // escape sequence
+        ++m_cur;
+        if(m_cur >= m_end) { break; }
+        switch(*m_cur) {
+        case '"':
+        case '\\':
+        case '/':
+            *out++ = *m_cur;
+            break;
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'u': {
+            unsigned int cp = 0;
+            for(int i = 1; i <= 4; ++i) {
+                int hex = (m_cur + i) < m_end ? HexValue(m_cur[i]) : wxNOT_FOUND;
+                if(hex == wxNOT_FOUND) { return SetError("Invalid unicode escape sequence"); }
+                cp = (cp << 4) | hex;
+            }
+            m_cur += 4;
+
+            // A surrogate must be part of a pair (high followed by low), a lone surrogate has no UTF-8 encoding
+            if(cp >= 0xDC00 && cp <= 0xDFFF) { return SetError("Invalid unicode surrogate pair"); }
+            if(cp >= 0xD800 && cp <= 0xDBFF) {
+                unsigned int low = 0;
+                bool valid = (m_end - m_cur) > 6 && m_cur[1] == '\\' && m_cur[2] == 'u';
+                for(int i = 3; i <= 6 && valid; ++i) {
+                    int hex = HexValue(m_cur[i]);
+                    valid = (hex != wxNOT_FOUND);
+                    low = (low << 4) | hex;
+                }
+                if(!valid || low < 0xDC00 || low > 0xDFFF) { return SetError("Invalid unicode surrogate pair"); }
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                m_cur += 6;
+            }
+            out = EncodeUTF8(out, cp);
+            break;
+        }
+        default:
+            return SetError("Invalid escape sequence");
+        }
+        ++m_cur;
+    }
+    return SetError("Unterminated string");
+}
+
+bool clJSONDocument::SkipDigits()
+{
+    const char* start = m_cur;
+    while(m_cur < m_end && *m_cur >= '0' && *m_cur <= '9') {
+        ++m_cur;
+    }
+    return m_cur != start;
+}
+
+bool clJSONDocument::ParseNumber(clJSONNode& node)
+{
+    // Find the end of the token (checking the JSON number grammar), strtod() does the conversion
+    const char* start = m_cur;
+    if(*m_cur == '-') { ++m_cur; }
+    if(!SkipDigits()) { return SetError("Invalid number"); }
+    if(m_cur < m_end && *m_cur == '.') {
+        ++m_cur;
+        if(!SkipDigits()) { return SetError("Invalid number"); }
+    }
+    if(m_cur < m_end && (*m_cur == 'e' || *m_cur == 'E')) {
+        ++m_cur;
+        if(m_cur < m_end && (*m_cur == '+' || *m_cur == '-')) { ++m_cur; }
+        if(!SkipDigits()) { return SetError("Invalid number"); }
+    }
+
+    // strtod() expects the decimal separator of the current locale. The token is copied anyway: the buffer is not
+    // null terminated after the number
+    std::string token(start, m_cur - start);
+    const char* point = localeconv()->decimal_point;
+    if(point && point[0] != '.') {
+        size_t where = token.find('.');
+        if(where != std::string::npos) { token.replace(where, 1, point); }
+    }
+
+    char* endptr = nullptr;
+    double value = strtod(token.c_str(), &endptr);
+    if(endptr != token.c_str() + token.length()) { return SetError("Invalid number"); }
+    node.type = kJSONNumber;
+    node.number = value;
+    return true;
+}
+
+bool clJSONDocument::ParseContainer(clJSONNode& node, bool isObject, int depth)
+{
+    const char closeChar = isObject ? '}' : ']';
+    node.type = isObject ? kJSONObject : kJSONArray;
+
+    // skip the open brace
+    ++m_cur;
+    SkipWhitespace();
+    if(m_cur < m_end && *m_cur == closeChar) {
+        ++m_cur;
+        return true;
+    }
+
+    // Children are collected on the shared scratch stack and copied into a contiguous arena array once the
+    // container is closed
+    size_t base = m_stack.size();
+    while(true) {
+        clJSONNode child;
+        if(isObject) {
+            SkipWhitespace();
+            if(m_cur >= m_end || *m_cur != '"') { return SetError("Expected a member name"); }
+            if(!ParseString(child.name, child.nameLen)) { return false; }
+            child.nameHash = HashName(child.name, child.nameLen);
+            SkipWhitespace();
+            if(m_cur >= m_end || *m_cur != ':') { return SetError("Expected ':'"); }
+            ++m_cur;
+        }
+
+        if(!ParseValue(child, depth + 1)) { return false; }
+        m_stack.push_back(child);
+
+        SkipWhitespace();
+        if(m_cur < m_end && *m_cur == ',') {
+            ++m_cur;
+            continue;
+
+        } else if(m_cur < m_end && *m_cur == closeChar) {
+            ++m_cur;
+            break;
+        }
+        return SetError(isObject ? "Expected ',' or '}'" : "Expected ',' or ']'");
+    }
+
+    size_t count = m_stack.size() - base;
+    node.children = (clJSONNode*)m_arena.Allocate(count * sizeof(clJSONNode));
+    std::copy(m_stack.begin() + base, m_stack.end(), node.children);
+    node.count = (unsigned int)count;
+    m_stack.resize(base);
+
+    if(isObject) { BuildIndex(node); }
+    return true;
+}
+
+void clJSONDocument::BuildIndex(clJSONNode& node)
+{
+    if(node.count <= JSON_INDEX_THRESHOLD) { return; }
+
+    // keep the load factor below 0.5
+    unsigned int size = 16;
+    while(size < node.count * 2) {
+        size <<= 1;
+    }
+
+    node.buckets = (unsigned int*)m_arena.Allocate(size * sizeof(unsigned int));
+    memset(node.buckets, 0, size * sizeof(unsigned int));
+    node.bucketsMask = size - 1;
+
+    // insert in document order so that on duplicate names the first member wins
+    for(unsigned int i = 0; i < node.count; ++i) {
+        unsigned int index = node.children[i].nameHash & node.bucketsMask;
+        while(node.buckets[index]) {
+            index = (index + 1) & node.bucketsMask;
+        }
+        node.buckets[index] = i + 1;
+    }
+}
+
+//===---------------------------------------------------------------------------
+// clJSONValue
+//===---------------------------------------------------------------------------
+
+wxString clJSONValue::getName() const
+{
+    if(!m_node || !m_node->name) { return wxEmptyString; }
+    return wxString::FromUTF8(m_node->name, m_node->nameLen);
+}
+
+clJSONValue clJSONValue::firstChild()
+{
+    m_walker = 0;
+    if(!m_node || (m_node->type != kJSONArray && m_node->type != kJSONObject) || m_node->count == 0) {
+        return clJSONValue();
+    }
+    m_walker = 1;
+    return clJSONValue(m_node->children);
+}
+
+clJSONValue clJSONValue::nextChild()
+{
+    if(!m_node || m_walker == 0 || m_walker >= m_node->count) { return clJSONValue(); }
+    return clJSONValue(m_node->children + (m_walker++));
+}
+
+clJSONValue clJSONValue::namedObject(const char* name) const { return FindMember(m_node, name, strlen(name)); }
+
+clJSONValue clJSONValue::namedObject(const std::string& name) const
+{
+    return FindMember(m_node, name.c_str(), name.length());
+}
+
+clJSONValue clJSONValue::namedObject(const wxString& name) const
+{
+    const wxScopedCharBuffer cb = name.mb_str(wxConvUTF8);
+    return FindMember(m_node, cb.data(), cb.length());
+}
+
+bool clJSONValue::toBool(bool defaultValue) const
+{
+    if(!isBool()) { return defaultValue; }
+    return m_node->type == kJSONTrue;
+}
+
+wxString clJSONValue::toString(const wxString& defaultValue) const
+{
+    if(!isString()) { return defaultValue; }
+    return wxString::FromUTF8(m_node->str, m_node->strLen);
+}
+
+std::string clJSONValue::toStdString(const std::string& defaultValue) const
+{
+    if(!isString()) { return defaultValue; }
+    return std::string(m_node->str, m_node->strLen);
+}
+
+wxArrayString clJSONValue::toArrayString(const wxArrayString& defaultValue) const
+{
+    if(!isArray()) { return defaultValue; }
+
+    wxArrayString arr;
+    arr.Alloc(m_node->count);
+    for(unsigned int i = 0; i < m_node->count; ++i) {
+        arr.Add(clJSONValue(m_node->children + i).toString());
+    }
+    return arr;
+}
+
+wxStringMap_t clJSONValue::toStringMap() const
+{
+    // same layout as JSONItem::toStringMap(): an array of { "key": .., "value": .. }
+    wxStringMap_t res;
+    if(!isArray()) { return res; }
+
+    for(unsigned int i = 0; i < m_node->count; ++i) {
+        clJSONValue item(m_node->children + i);
+        res.insert({ item.namedObject("key").toString(), item.namedObject("value").toString() });
+    }
+    return res;
+}
+
+clJSONValue clJSONValue::arrayItem(int pos) const
+{
+    if(!isArray() || pos < 0 || pos >= (int)m_node->count) { return clJSONValue(); }
+    return clJSONValue(m_node->children + pos);
+}
+
+int clJSONValue::arraySize() const
+{
+    if(!isArray()) { return 0; }
+    return (int)m_node->count;
+}
+
+int clJSONValue::toInt(int defaultVal) const
+{
+    if(!isNumber()) { return defaultVal; }
+    return (int)m_node->number;
+}
+
+size_t clJSONValue::toSize_t(size_t defaultVal) const
+{
+    if(!isNumber()) { return defaultVal; }
+    return (size_t)m_node->number;
+}
+
+double clJSONValue::toDouble(double defaultVal) const
+{
+    if(!isNumber()) { return defaultVal; }
+    return m_node->number;
+}
+
+wxFileName clJSONValue::toFileName() const
+{
+    if(!isString()) { return wxFileName(); }
+    return wxFileName(toString());
+}
+
+wxString clJSONValue::format() const
+{
+    if(!m_node) { return wxEmptyString; }
+    clJSONWriter writer;
+    writer.Value(*this);
+    return wxString::FromUTF8(writer.GetBuffer().c_str(), writer.GetBuffer().length());
+}
+
+//===---------------------------------------------------------------------------
+// clJSONWriter
+//===---------------------------------------------------------------------------
+
+void clJSONWriter::BeforeValue()
+{
+    if(m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if(!m_hasElements.empty()) {
+        if(m_hasElements.back()) { m_buffer += ','; }
+        m_hasElements.back() = true;
+    }
+}
+
+void clJSONWriter::WriteEscaped(const char* str, size_t len)
+{
+    static const char* hexDigits = "0123456789abcdef";
+    m_buffer.reserve(m_buffer.size() + len + 2);
+    m_buffer += '"';
+    const char* start = str;
+    for(size_t i = 0; i < len; ++i) {
+        unsigned char ch = (unsigned char)str[i];
+        if(ch >= 0x20 && ch != '"' && ch != '\\') { continue; }
+
+        // flush the pending run of plain characters
+        m_buffer.append(start, (str + i) - start);
+        start = str + i + 1;
+        switch(ch) {
+        case '"':
+            m_buffer += "\\\"";
+            break;
+        case '\\':
+            m_buffer += "\\\\";
+            break;
+        case '\n':
+            m_buffer += "\\n";
+            break;
+        case '\r':
+            m_buffer += "\\r";
+            break;
+        case '\t':
+            m_buffer += "\\t";
+            break;
+        case '\b':
+            m_buffer += "\\b";
+            break;
+        case '\f':
+            m_buffer += "\\f";
+            break;
+        default:
+            m_buffer += "\\u00";
+            m_buffer += hexDigits[ch >> 4];
+            m_buffer += hexDigits[ch & 0xF];
+            break;
+        }
+    }
+    m_buffer.append(start, (str + len) - start);
+    m_buffer += '"';
+}
+
+clJSONWriter& clJSONWriter::StartObject()
+{
+    BeforeValue();
+    m_buffer += '{';
+    m_hasElements.push_back(false);
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::EndObject()
+{
+    m_buffer += '}';
+    if(!m_hasElements.empty()) { m_hasElements.pop_back(); }
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::StartArray()
+{
+    BeforeValue();
+    m_buffer += '[';
+    m_hasElements.push_back(false);
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::EndArray()
+{
+    m_buffer += ']';
+    if(!m_hasElements.empty()) { m_hasElements.pop_back(); }
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Key(const char* name)
+{
+    BeforeValue();
+    WriteEscaped(name, strlen(name));
+    m_buffer += ':';
+    m_afterKey = true;
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Key(const wxString& name)
+{
+    BeforeValue();
+    const wxScopedCharBuffer cb = name.mb_str(wxConvUTF8);
+    WriteEscaped(cb.data(), cb.length());
+    m_buffer += ':';
+    m_afterKey = true;
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(const char* value)
+{
+    BeforeValue();
+    WriteEscaped(value, strlen(value));
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(const std::string& value)
+{
+    BeforeValue();
+    WriteEscaped(value.c_str(), value.length());
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(const wxString& value)
+{
+    BeforeValue();
+    const wxScopedCharBuffer cb = value.mb_str(wxConvUTF8);
+    WriteEscaped(cb.data(), cb.length());
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(bool value)
+{
+    BeforeValue();
+    m_buffer += value ? "true" : "false";
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(long value)
+{
+    BeforeValue();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%ld", value);
+    m_buffer += buf;
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(size_t value)
+{
+    BeforeValue();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long)value);
+    m_buffer += buf;
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(double value)
+{
+    BeforeValue();
+    char buf[64];
+    if(value != value || value == HUGE_VAL || value == -HUGE_VAL) {
+        // NaN and infinity are not representable in JSON
+        m_buffer += "null";
+        return *this;
+    } else if(floor(value) == value && fabs(value) < 1.0e15) {
+        snprintf(buf, sizeof(buf), "%.0f", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%.17g", value);
+        // the decimal separator depends on the locale
+        for(char* p = buf; *p; ++p) {
+            if(*p == ',') { *p = '.'; }
+        }
+    }
+    m_buffer += buf;
+    return *this;
+}
+
+clJSONWriter& clJSONWriter::Value(const clJSONValue& value)
+{
+    switch(value.getType()) {
+    case kJSONTrue:
+    case kJSONFalse:
+        return Value(value.toBool());
+    case kJSONNumber:
+        return Value(value.toDouble());
+    case kJSONString:
+        BeforeValue();
+        WriteEscaped(value.GetStringPtr(), value.GetStringLength());
+        return *this;
+    case kJSONArray: {
+        StartArray();
+        clJSONValue walker = value;
+        for(clJSONValue child = walker.firstChild(); child.isOk(); child = walker.nextChild()) {
+            Value(child);
+        }
+        return EndArray();
+    }
+    case kJSONObject: {
+        StartObject();
+        clJSONValue walker = value;
+        for(clJSONValue child = walker.firstChild(); child.isOk(); child = walker.nextChild()) {
+            Key(child.getName());
+            Value(child);
+        }
+        return EndObject();
+    }
+    default:
+        return Null();
+    }
+}
+
+clJSONWriter& clJSONWriter::Null()
+{
+    BeforeValue();
+    m_buffer += "null";
+    return *this;
+}
@@ -0,0 +1,260 @@
+#ifndef CLJSONDOCUMENT_H
+#define CLJSONDOCUMENT_H
+
+#include "codelite_exports.h"
+#include "macros.h"
+#include <string>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/// The JSON value types. The values are identical to the cJSON_* constants so code that
+/// switches on JSONItem::getType() works unmodified with clJSONValue::getType()
+enum eJSONType {
+    kJSONFalse = 0,
+    kJSONTrue = 1,
+    kJSONNull = 2,
+    kJSONNumber = 3,
+    kJSONString = 4,
+    kJSONArray = 5,
+    kJSONObject = 6,
+};
+
+/**
+ * @class clJSONArena
+ * @brief a simple bump allocator. Memory is released only when the arena is cleared or destroyed
+ */
+class WXDLLIMPEXP_CL clJSONArena
+{
+    std::vector<char*> m_blocks;
+    char* m_cursor = nullptr;
+    size_t m_bytesLeft = 0;
+    size_t m_blockSize = 0;
+
+public:
+    clJSONArena(size_t blockSize = 64 * 1024);
+    ~clJSONArena();
+
+    /**
+     * @brief allocate 'bytes' of memory aligned to pointer size
+     */
+    void* Allocate(size_t bytes);
+
+    /**
+     * @brief release all the blocks allocated by this arena
+     */
+    void Clear();
+
+private:
+    clJSONArena(const clJSONArena&);
+    clJSONArena& operator=(const clJSONArena&);
+};
+
+/**
+ * @brief a single DOM node. All the nodes are allocated from the document arena and all the strings
+ * (names and values) are pointing into the document buffer
+ */
+struct clJSONNode {
+    const char* name = nullptr;
+    const char* str = nullptr;
+    clJSONNode* children = nullptr; // array of 'count' nodes, stored contiguously
+    unsigned int* buckets = nullptr; // open addressing hash table over the object members (large objects only)
+    double number = 0.0;
+    unsigned int nameLen = 0;
+    unsigned int nameHash = 0;
+    unsigned int strLen = 0;
+    unsigned int count = 0;
+    unsigned int bucketsMask = 0;
+    int type = kJSONNull;
+};
+
+/**
+ * @class clJSONValue
+ * @brief a lightweight, read only, view into a clJSONDocument node.
+ * The API follows JSONItem so code can be migrated by replacing the type name. A clJSONValue is valid as long as
+ * the clJSONDocument that created it is alive
+ */
+class WXDLLIMPEXP_CL clJSONValue
+{
+    const clJSONNode* m_node = nullptr;
+    unsigned int m_walker = 0;
+
+public:
+    clJSONValue(const clJSONNode* node = nullptr)
+        : m_node(node)
+    {
+    }
+    ~clJSONValue() {}
+
+    bool isOk() const { return m_node != nullptr; }
+    int getType() const { return m_node ? m_node->type : wxNOT_FOUND; }
+    wxString getName() const;
+
+    // Walkers
+    clJSONValue firstChild();
+    clJSONValue nextChild();
+
+    // Readers
+    ////////////////////////////////////////////////
+    /**
+     * @brief find a member by name. The "const char*" versions do not allocate and should be preferred
+     */
+    clJSONValue namedObject(const char* name) const;
+    clJSONValue namedObject(const std::string& name) const;
+    clJSONValue namedObject(const wxString& name) const;
+    bool hasNamedObject(const char* name) const { return namedObject(name).isOk(); }
+    bool hasNamedObject(const wxString& name) const { return namedObject(name).isOk(); }
+
+    clJSONValue operator[](int index) const { return arrayItem(index); }
+    clJSONValue operator[](const char* name) const { return namedObject(name); }
+    clJSONValue operator[](const wxString& name) const { return namedObject(name); }
+
+    bool toBool(bool defaultValue = false) const;
+    wxString toString(const wxString& defaultValue = wxEmptyString) const;
+    /**
+     * @brief return the string value as UTF-8 bytes (no conversion takes place)
+     */
+    std::string toStdString(const std::string& defaultValue = "") const;
+    wxArrayString toArrayString(const wxArrayString& defaultValue = wxArrayString()) const;
+    wxStringMap_t toStringMap() const;
+    clJSONValue arrayItem(int pos) const;
+    int arraySize() const;
+    int toInt(int defaultVal = -1) const;
+    size_t toSize_t(size_t defaultVal = 0) const;
+    double toDouble(double defaultVal = -1.0) const;
+    wxFileName toFileName() const;
+
+    /**
+     * @brief direct access to the string value, not NULL terminated
+     */
+    const char* GetStringPtr() const { return (m_node && m_node->type == kJSONString) ? m_node->str : nullptr; }
+    size_t GetStringLength() const { return (m_node && m_node->type == kJSONString) ? m_node->strLen : 0; }
+
+    bool isNull() const { return m_node && m_node->type == kJSONNull; }
+    bool isBool() const { return m_node && (m_node->type == kJSONTrue || m_node->type == kJSONFalse); }
+    bool isString() const { return m_node && m_node->type == kJSONString; }
+    bool isNumber() const { return m_node && m_node->type == kJSONNumber; }
+    bool isArray() const { return m_node && m_node->type == kJSONArray; }
+    bool isObject() const { return m_node && m_node->type == kJSONObject; }
+
+    /**
+     * @brief serialize this value (and its children) back to JSON
+     */
+    wxString format() const;
+};
+
+/**
+ * @class clJSONDocument
+ * @brief a JSON DOM parsed directly from UTF-8 bytes.
+ * The document owns the input buffer and decodes the strings in-place, so strings are never copied. The nodes are
+ * allocated from an arena and freed in one go when the document is destroyed
+ */
+class WXDLLIMPEXP_CL clJSONDocument
+{
+    std::string m_buffer;
+    clJSONArena m_arena;
+    std::vector<clJSONNode> m_stack;
+    clJSONNode* m_root = nullptr;
+    wxString m_errorString;
+    char* m_cur = nullptr;
+    char* m_end = nullptr;
+
+protected:
+    bool ParseValue(clJSONNode& node, int depth);
+    bool ParseString(const char*& str, unsigned int& len);
+    bool ParseNumber(clJSONNode& node);
+    bool ParseContainer(clJSONNode& node, bool isObject, int depth);
+    bool ParseLiteral(const char* literal, size_t len);
+    void SkipWhitespace();
+    /**
+     * @brief skip a sequence of decimal digits, return false if there is none
+     */
+    bool SkipDigits();
+    void BuildIndex(clJSONNode& node);
+    bool SetError(const wxString& message);
+
+public:
+    clJSONDocument();
+    virtual ~clJSONDocument();
+
+    /**
+     * @brief parse UTF-8 JSON text. The buffer is moved into the document
+     */
+    bool Parse(std::string&& buffer);
+    bool Parse(const char* buffer, size_t len);
+    bool Parse(const wxString& text);
+
+    /**
+     * @brief load and parse a file. The content is expected to be UTF-8
+     */
+    bool Load(const wxFileName& filename);
+
+    bool isOk() const { return m_root != nullptr; }
+    clJSONValue toElement() const { return clJSONValue(m_root); }
+    const wxString& errorString() const { return m_errorString; }
+
+    void Clear();
+
+private:
+    clJSONDocument(const clJSONDocument&);
+    clJSONDocument& operator=(const clJSONDocument&);
+};
+
+/**
+ * @class clJSONWriter
+ * @brief a streaming JSON writer. The output is written directly as UTF-8 into a std::string without
+ * building an intermediate DOM
+ */
+class WXDLLIMPEXP_CL clJSONWriter
+{
+    std::string m_buffer;
+    std::vector<bool> m_hasElements;
+    bool m_afterKey = false;
+
+protected:
+    void BeforeValue();
+    void WriteEscaped(const char* str, size_t len);
+
+public:
+    clJSONWriter() {}
+    ~clJSONWriter() {}
+
+    clJSONWriter& StartObject();
+    clJSONWriter& EndObject();
+    clJSONWriter& StartArray();
+    clJSONWriter& EndArray();
+    clJSONWriter& Key(const char* name);
+    clJSONWriter& Key(const wxString& name);
+
+    clJSONWriter& Value(const char* value);
+    clJSONWriter& Value(const std::string& value);
+    clJSONWriter& Value(const wxString& value);
+    clJSONWriter& Value(bool value);
+    clJSONWriter& Value(int value) { return Value((long)value); }
+    clJSONWriter& Value(long value);
+    clJSONWriter& Value(size_t value);
+    clJSONWriter& Value(double value);
+    clJSONWriter& Value(const clJSONValue& value);
+    clJSONWriter& Null();
+
+    /**
+     * @brief write "name": value
+     */
+    template <typename T> clJSONWriter& Property(const char* name, const T& value)
+    {
+        Key(name);
+        return Value(value);
+    }
+
+    const std::string& GetBuffer() const { return m_buffer; }
+    std::string& GetBuffer() { return m_buffer; }
+    void Clear()
+    {
+        m_buffer.clear();
+        m_hasElements.clear();
+        m_afterKey = false;
+    }
+};
+
+#endif // CLJSONDOCUMENT_H
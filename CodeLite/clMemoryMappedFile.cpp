@@ -0,0 +1,90 @@
+#include "clMemoryMappedFile.h"
+#include "file_logger.h"
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+clMemoryMappedFile::~clMemoryMappedFile() { Close(); }
+
+#ifdef __WXMSW__
+bool clMemoryMappedFile::Open(const wxString& path)
+{
+    Close();
+    HANDLE file = ::CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER size;
+    if(!::GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(!mapping) {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!data) {
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = (const char*)data;
+    m_size = (size_t)size.QuadPart;
+    return true;
+}
+
+void clMemoryMappedFile::Close()
+{
+    if(m_data) { ::UnmapViewOfFile(m_data); }
+    if(m_mapping) { ::CloseHandle((HANDLE)m_mapping); }
+    if(m_file) { ::CloseHandle((HANDLE)m_file); }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+#else
+bool clMemoryMappedFile::Open(const wxString& path)
+{
+    Close();
+    int fd = ::open(path.mb_str(wxConvUTF8).data(), O_RDONLY);
+    if(fd < 0) { return false; }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if(data == MAP_FAILED) {
+        clDEBUG() << "Failed to map file:" << path << clEndl;
+        return false;
+    }
+    m_data = (const char*)data;
+    m_size = (size_t)st.st_size;
+    return true;
+}
+
+void clMemoryMappedFile::Close()
+{
+    if(m_data) { ::munmap((void*)m_data, m_size); }
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef CLMEMORYMAPPEDFILE_H
+#define CLMEMORYMAPPEDFILE_H
+
+#include "codelite_exports.h"
+#include <wx/string.h>
+
+/**
+ * @class clMemoryMappedFile
+ * @brief a read-only view of a file mapped into memory. The pages are loaded by the OS on first access and are shared
+ * between the processes that map the same file
+ */
+class WXDLLIMPEXP_CL clMemoryMappedFile
+{
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef __WXMSW__
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+
+public:
+    clMemoryMappedFile() {}
+    ~clMemoryMappedFile();
+
+    /**
+     * @brief map 'path' into memory. An empty file can not be mapped
+     */
+    bool Open(const wxString& path);
+    void Close();
+
+    bool IsOpened() const { return m_data != nullptr; }
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+};
+
+#endif // CLMEMORYMAPPEDFILE_H
@@ -0,0 +1,55 @@
+#include "clOutputThrottle.h"
+
+clOutputThrottle::clOutputThrottle(long interval, const FlushFunc_t& flush)
+    : m_interval(interval)
+    , m_flush(flush)
+    , m_notified(false)
+{
+    m_timer.SetOwner(this);
+    Bind(wxEVT_TIMER, &clOutputThrottle::OnTimer, this, m_timer.GetId());
+    m_sinceFlush.Start();
+}
+
+clOutputThrottle::~clOutputThrottle()
+{
+    Stop();
+    Unbind(wxEVT_TIMER, &clOutputThrottle::OnTimer, this, m_timer.GetId());
+}
+
+void clOutputThrottle::Notify()
+{
+    if(!m_notified.exchange(true)) { CallAfter(&clOutputThrottle::OnNotified); }
+}
+
+void clOutputThrottle::OnNotified()
+{
+    // a flush is already scheduled
+    if(m_timer.IsRunning()) { return; }
+    long elapsed = m_sinceFlush.Time();
+    if(elapsed >= m_interval) {
+        Flush();
+    } else {
+        m_timer.Start(m_interval - elapsed, wxTIMER_ONE_SHOT);
+    }
+}
+
+void clOutputThrottle::OnTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
+    Flush();
+}
+
+void clOutputThrottle::Flush()
+{
+    m_timer.Stop();
+    m_sinceFlush.Start();
+    // cleared before the output is taken: output that is added while we flush triggers another flush
+    m_notified = false;
+    if(m_flush) { m_flush(); }
+}
+
+void clOutputThrottle::Stop()
+{
+    m_timer.Stop();
+    m_flush = nullptr;
+}
@@ -0,0 +1,54 @@
+#ifndef CLOUTPUTTHROTTLE_H
+#define CLOUTPUTTHROTTLE_H
+
+#include "codelite_exports.h"
+#include <atomic>
+#include <functional>
+#include <wx/event.h>
+#include <wx/stopwatch.h>
+#include <wx/timer.h>
+
+/**
+ * @class clOutputThrottle
+ * @brief limit the rate at which the output of a worker thread is displayed.
+ * The worker accumulates its output and calls Notify() (from any thread). The flush function, which takes the
+ * accumulated output and displays it, is then called on the main thread, at most once every 'interval' milliseconds.
+ * Only the first Notify() after a flush posts an event to the main thread
+ */
+class WXDLLIMPEXP_CL clOutputThrottle : public wxEvtHandler
+{
+public:
+    typedef std::function<void()> FlushFunc_t;
+
+protected:
+    long m_interval;
+    FlushFunc_t m_flush;
+    wxTimer m_timer;
+    wxStopWatch m_sinceFlush;
+    std::atomic<bool> m_notified;
+
+protected:
+    void OnNotified();
+    void OnTimer(wxTimerEvent& event);
+
+public:
+    clOutputThrottle(long interval, const FlushFunc_t& flush);
+    virtual ~clOutputThrottle();
+
+    /**
+     * @brief new output is waiting to be displayed. This method is thread safe
+     */
+    void Notify();
+
+    /**
+     * @brief call the flush function now. Called from the main thread
+     */
+    void Flush();
+
+    /**
+     * @brief stop the pending flush (e.g. before the flush function becomes invalid)
+     */
+    void Stop();
+};
+
+#endif // CLOUTPUTTHROTTLE_H
@@ -0,0 +1,37 @@
+#ifndef CLPARALLEL_H
+#define CLPARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief call fn(i) for every i in [0, count) using up to "hardware concurrency" threads. The calling thread takes
+ * part in the work and the function returns once all the calls completed. 'fn' must be safe to call concurrently
+ * for different indexes
+ */
+template <typename Func> void clParallelFor(size_t count, Func fn)
+{
+    if(count == 0) { return; }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t index;
+        while((index = next++) < count) {
+            fn(index);
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& t : threads) {
+        t.join();
+    }
+}
+
+#endif // CLPARALLEL_H
@@ -0,0 +1,350 @@
+#include "clFileIdentity.h"
+#include "clParseResultCache.h"
+#include "cl_standard_paths.h"
+#include "file_logger.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/thread.h>
+
+// bump when the format of the entries (or the way they are computed) changes
+static const char* CACHE_VERSION = "2";
+static const char* PACK_HEADER = "CodeLite parse cache pack 1\n";
+
+// the size limit of the local entries, pruning removes entries until they use less than PRUNE_TARGET_PERCENT of it
+static const wxULongLong_t MAX_CACHE_SIZE = 512 * 1024 * 1024;
+static const wxULongLong_t PRUNE_TARGET_PERCENT = 80;
+// the cache size is checked once every this many stores (and on the first one)
+static const size_t PRUNE_INTERVAL = 1000;
+
+namespace
+{
+wxString ToHex(wxUint64 value) { return wxString::Format("%016" wxLongLongFmtSpec "x", (wxULongLong_t)value); }
+
+bool ReadFile(const wxString& path, std::string& data)
+{
+    wxFFile fp(path, "rb");
+    if(!fp.IsOpened()) { return false; }
+    wxFileOffset len = fp.Length();
+    if(len < 0) { return false; }
+    data.resize((size_t)len);
+    return len == 0 || fp.Read(&data[0], (size_t)len) == (size_t)len;
+}
+
+bool WriteFile(const wxFileName& fn, const std::string& data)
+{
+    // write to a temporary file first, so a reader never gets a partial entry
+    wxFileName tmpfile = fn;
+    tmpfile.SetName(fn.GetName() + wxString::Format("-%lu", (unsigned long)wxThread::GetCurrentId()));
+    tmpfile.SetExt("tmp");
+    {
+        wxFFile fp(tmpfile.GetFullPath(), "wb");
+        if(!fp.IsOpened()) { return false; }
+        if(!data.empty() && fp.Write(data.c_str(), data.length()) != data.length()) {
+            fp.Close();
+            wxRemoveFile(tmpfile.GetFullPath());
+            return false;
+        }
+    }
+    if(!wxRenameFile(tmpfile.GetFullPath(), fn.GetFullPath(), true)) {
+        wxRemoveFile(tmpfile.GetFullPath());
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+clParseResultCache& clParseResultCache::Get()
+{
+    static clParseResultCache cache;
+    return cache;
+}
+
+wxFileName clParseResultCache::GetCacheDir() const
+{
+    wxFileName dir(clStandardPaths::Get().GetUserDataDir(), "");
+    dir.AppendDir("cache");
+    dir.AppendDir("parse");
+    return dir;
+}
+
+wxFileName clParseResultCache::GetPacksDir() const
+{
+    wxFileName dir = GetCacheDir();
+    dir.AppendDir("packs");
+    return dir;
+}
+
+wxFileName clParseResultCache::GetEntryFile(const wxString& key) const
+{
+    // spread the entries over 256 folders
+    wxFileName fn = GetCacheDir();
+    fn.AppendDir(key.Left(2));
+    fn.SetFullName(key + ".tags");
+    return fn;
+}
+
+bool clParseResultCache::GetKey(const wxString& filename, const wxString& options, wxString& key)
+{
+    clFileIdentity identity = clFileIdentity::FromFile(filename);
+    if(!identity.IsOk() || !identity.HasHash()) { return false; }
+
+    clFileHasher hasher;
+    hasher.Update(CACHE_VERSION, strlen(CACHE_VERSION));
+    wxCharBuffer cb = options.mb_str(wxConvUTF8);
+    hasher.Update(cb.data(), cb.length());
+    // the same content is indexed as C or as C++ depending on the extension (it is case sensitive: ".C" is C++)
+    wxCharBuffer ext = ("|" + wxFileName(filename).GetExt()).mb_str(wxConvUTF8);
+    hasher.Update(ext.data(), ext.length());
+
+    key.Clear();
+    key << ToHex(identity.GetHash()) << ToHex(identity.GetSize()) << ToHex(hasher.Digest());
+    return true;
+}
+
+std::string clParseResultCache::Normalize(const wxString& tags)
+{
+    std::string input = tags.ToStdString(wxConvUTF8);
+    std::string output;
+    output.reserve(input.length());
+
+    size_t start = 0;
+    while(start < input.length()) {
+        size_t end = input.find('\n', start);
+        if(end == std::string::npos) { end = input.length(); }
+
+        // "name <TAB> file <TAB> pattern..." => "name <TAB> pattern..."
+        size_t tab1 = input.find('\t', start);
+        size_t tab2 = (tab1 < end) ? input.find('\t', tab1 + 1) : std::string::npos;
+        if(tab2 < end) {
+            output.append(input, start, tab1 + 1 - start);
+            output.append(input, tab2 + 1, end - tab2 - 1);
+            output.append(1, '\n');
+        }
+        // lines without a file field are not tags, the parser ignores them anyway
+        start = end + 1;
+    }
+    return output;
+}
+
+wxString clParseResultCache::Expand(const std::string& data, const wxString& filename)
+{
+    std::string file = filename.ToStdString(wxConvUTF8);
+    std::string output;
+    output.reserve(data.length() + (file.length() + 1) * 64);
+
+    size_t start = 0;
+    while(start < data.length()) {
+        size_t end = data.find('\n', start);
+        if(end == std::string::npos) { end = data.length(); }
+
+        size_t tab = data.find('\t', start);
+        if(tab < end) {
+            output.append(data, start, tab + 1 - start);
+            output.append(file);
+            output.append(1, '\t');
+            output.append(data, tab + 1, end - tab - 1);
+            output.append(1, '\n');
+        }
+        start = end + 1;
+    }
+    return wxString::FromUTF8(output.c_str(), output.length());
+}
+
+bool clParseResultCache::Lookup(const wxString& key, const wxString& filename, wxString& tags)
+{
+    std::string data;
+    wxFileName fn = GetEntryFile(key);
+    if(fn.FileExists() && ReadFile(fn.GetFullPath(), data)) {
+        // the modification time of an entry is its last use, see DoPrune()
+        fn.Touch();
+    } else if(!DoReadFromPack(key, data)) {
+        return false;
+    }
+
+    // the indexer reports the full path of the file
+    tags = Expand(data, wxFileName(filename).GetFullPath());
+    return true;
+}
+
+void clParseResultCache::Store(const wxString& key, const wxString& tags)
+{
+    wxFileName fn = GetEntryFile(key);
+    fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+    if(!WriteFile(fn, Normalize(tags))) {
+        clDEBUG() << "clParseResultCache: failed to write" << fn.GetFullPath() << clEndl;
+    }
+    if((m_storeCount++ % PRUNE_INTERVAL) == 0) { DoPrune(); }
+}
+
+void clParseResultCache::DoPrune()
+{
+    // one thread prunes, the others don't wait for it
+    if(m_pruning.exchange(true)) { return; }
+
+    wxArrayString files;
+    wxString dir = GetCacheDir().GetPath();
+    if(wxFileName::DirExists(dir)) { wxDir::GetAllFiles(dir, &files, "*.tags"); }
+
+    struct Entry {
+        time_t lastUsed;
+        wxULongLong_t size;
+        wxString path;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(files.size());
+    wxULongLong_t totalSize = 0;
+    for(const wxString& file : files) {
+        wxStructStat st;
+        if(wxStat(file, &st) != 0) { continue; }
+        totalSize += st.st_size;
+        entries.push_back({ st.st_mtime, (wxULongLong_t)st.st_size, file });
+    }
+
+    if(totalSize > MAX_CACHE_SIZE) {
+        // least recently used first
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+        wxULongLong_t target = MAX_CACHE_SIZE / 100 * PRUNE_TARGET_PERCENT;
+        size_t removed = 0;
+        for(size_t i = 0; i < entries.size() && totalSize > target; ++i) {
+            if(wxRemoveFile(entries[i].path)) {
+                totalSize -= entries[i].size;
+                ++removed;
+            }
+        }
+        clDEBUG() << "clParseResultCache: removed" << removed << "entries, the cache size is now" << totalSize
+                  << "bytes" << clEndl;
+    }
+    m_pruning = false;
+}
+
+size_t clParseResultCache::Clear()
+{
+    wxString dir = GetCacheDir().GetPath();
+    if(!wxFileName::DirExists(dir)) { return 0; }
+
+    wxArrayString files;
+    wxDir::GetAllFiles(dir, &files, "*.tags");
+    size_t removed = 0;
+    for(const wxString& file : files) {
+        if(wxRemoveFile(file)) { ++removed; }
+    }
+    clDEBUG() << "clParseResultCache: cleared" << removed << "entries" << clEndl;
+    return removed;
+}
+
+void clParseResultCache::DoLoadPacks()
+{
+    if(m_packsLoaded) { return; }
+    m_packsLoaded = true;
+
+    wxString dir = GetPacksDir().GetPath();
+    if(!wxFileName::DirExists(dir)) { return; }
+
+    wxArrayString packs;
+    wxDir::GetAllFiles(dir, &packs, "*.clpack", wxDIR_FILES);
+    packs.Sort();
+    for(const wxString& pack : packs) {
+        DoLoadPack(pack);
+    }
+    clDEBUG() << "clParseResultCache: loaded" << m_packEntries.size() << "entries from" << m_packs.size() << "packs"
+              << clEndl;
+}
+
+void clParseResultCache::DoLoadPack(const wxString& path)
+{
+    wxFFile fp(path, "rb");
+    if(!fp.IsOpened()) { return; }
+
+    char line[256];
+    if(!fgets(line, sizeof(line), fp.fp()) || strcmp(line, PACK_HEADER) != 0) {
+        clWARNING() << "clParseResultCache:" << path << "is not a parse cache pack" << clEndl;
+        return;
+    }
+
+    size_t packIndex = m_packs.size();
+    m_packs.push_back(path);
+    wxFileOffset fileLen = fp.Length();
+
+    // every entry is: "<key> <length>\n" followed by 'length' bytes
+    while(fgets(line, sizeof(line), fp.fp())) {
+        wxString header(line, wxConvUTF8);
+        header.Trim();
+        unsigned long length = 0;
+        if(!header.AfterLast(' ').ToULong(&length)) { break; }
+
+        PackEntry entry;
+        entry.pack = packIndex;
+        entry.offset = fp.Tell();
+        entry.length = length;
+        if(entry.offset + (wxFileOffset)length > fileLen) { break; }
+
+        // the first pack wins
+        m_packEntries.insert({ header.BeforeLast(' '), entry });
+        if(!fp.Seek(entry.offset + length)) { break; }
+    }
+}
+
+bool clParseResultCache::DoReadFromPack(const wxString& key, std::string& data)
+{
+    PackEntry entry;
+    wxString path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DoLoadPacks();
+        std::unordered_map<wxString, PackEntry>::const_iterator iter = m_packEntries.find(key);
+        if(iter == m_packEntries.end()) { return false; }
+        entry = iter->second;
+        path = m_packs[entry.pack];
+    }
+
+    wxFFile fp(path, "rb");
+    if(!fp.IsOpened() || !fp.Seek(entry.offset)) { return false; }
+    data.resize(entry.length);
+    return entry.length == 0 || fp.Read(&data[0], entry.length) == entry.length;
+}
+
+bool clParseResultCache::ExportPack(const wxFileName& packFile, size_t& count)
+{
+    count = 0;
+    wxString dir = GetCacheDir().GetPath();
+    if(!wxFileName::DirExists(dir)) { return false; }
+
+    wxArrayString entries;
+    wxDir::GetAllFiles(dir, &entries, "*.tags");
+    entries.Sort();
+
+    wxFileName tmpfile = packFile;
+    tmpfile.SetExt("tmp");
+    {
+        wxFFile fp(tmpfile.GetFullPath(), "wb");
+        if(!fp.IsOpened()) { return false; }
+        fp.Write(PACK_HEADER, strlen(PACK_HEADER));
+
+        std::string data;
+        for(const wxString& entry : entries) {
+            if(!ReadFile(entry, data)) { continue; }
+            wxString header;
+            header << wxFileName(entry).GetName() << " " << data.length() << "\n";
+            fp.Write(header);
+            if(!data.empty()) { fp.Write(data.c_str(), data.length()); }
+            ++count;
+        }
+        if(fp.Error()) {
+            fp.Close();
+            wxRemoveFile(tmpfile.GetFullPath());
+            return false;
+        }
+    }
+    if(!wxRenameFile(tmpfile.GetFullPath(), packFile.GetFullPath(), true)) {
+        wxRemoveFile(tmpfile.GetFullPath());
+        return false;
+    }
+    clDEBUG() << "clParseResultCache: exported" << count << "entries to" << packFile.GetFullPath() << clEndl;
+    return true;
+}
@@ -0,0 +1,108 @@
+#ifndef CLPARSERESULTCACHE_H
+#define CLPARSERESULTCACHE_H
+
+#include "codelite_exports.h"
+#include "wxStringHash.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class clParseResultCache
+ * @brief a content addressed cache of the indexer output. The tags of a file are stored under the hash of its content
+ * (and of the indexer options), so a header shared by several workspaces (or copied to another folder) is parsed only
+ * once. The cache is kept under the user data directory and is shared by all the workspaces.
+ * The entries can be exported into a single "pack" file, which can be shared with other machines: the packs found in
+ * the "packs" folder of the cache are used read-only, they are never modified. The size of the local entries is bounded,
+ * the least recently used entries are removed first. All the methods are thread safe
+ */
+class WXDLLIMPEXP_CL clParseResultCache
+{
+protected:
+    struct PackEntry {
+        size_t pack = 0; // index in m_packs
+        wxFileOffset offset = 0;
+        size_t length = 0;
+    };
+
+    std::mutex m_mutex;
+    bool m_packsLoaded = false;
+    std::vector<wxString> m_packs;
+    std::unordered_map<wxString, PackEntry> m_packEntries;
+    std::atomic<size_t> m_storeCount;
+    std::atomic<bool> m_pruning;
+
+protected:
+    clParseResultCache()
+        : m_storeCount(0)
+        , m_pruning(false)
+    {
+    }
+    ~clParseResultCache() {}
+
+    wxFileName GetCacheDir() const;
+    wxFileName GetEntryFile(const wxString& key) const;
+    void DoLoadPacks();
+    void DoLoadPack(const wxString& path);
+    bool DoReadFromPack(const wxString& key, std::string& data);
+    /**
+     * @brief remove the least recently used local entries until the cache fits its size limit
+     */
+    void DoPrune();
+
+    /**
+     * @brief remove the file name from the indexer output (the second field of every line), so the entry can be used
+     * for a file with the same content in another folder
+     */
+    static std::string Normalize(const wxString& tags);
+    /**
+     * @brief the reverse of Normalize()
+     */
+    static wxString Expand(const std::string& data, const wxString& filename);
+
+public:
+    static clParseResultCache& Get();
+
+    /**
+     * @brief compute the key of a file: the hash of its content, of its extension (the indexer picks the language
+     * by the extension) and of the indexer options
+     * @param options the indexer options and anything else that changes its output (e.g. the file encoding)
+     * @return false if the file can not be read
+     */
+    static bool GetKey(const wxString& filename, const wxString& options, wxString& key);
+
+    /**
+     * @brief find the indexer output of 'filename' in the cache (the local entries first, then the packs)
+     * @param key the file key, see GetKey()
+     * @param tags [output] the tags of 'filename', in the indexer format
+     */
+    bool Lookup(const wxString& key, const wxString& filename, wxString& tags);
+
+    /**
+     * @brief store the indexer output of the file whose content matches 'key'
+     */
+    void Store(const wxString& key, const wxString& tags);
+
+    /**
+     * @brief write all the local entries into a single pack file. To use the pack on another machine, copy it into
+     * the folder returned by GetPacksDir()
+     * @param count [output] the number of entries written
+     */
+    bool ExportPack(const wxFileName& packFile, size_t& count);
+
+    /**
+     * @brief remove all the local entries (the packs are kept)
+     * @return the number of entries removed
+     */
+    size_t Clear();
+
+    /**
+     * @brief the folder of the read-only packs
+     */
+    wxFileName GetPacksDir() const;
+};
+
+#endif // CLPARSERESULTCACHE_H
@@ -0,0 +1,388 @@
+#include "StringUtils.h"
+#include "asyncprocess.h"
+#include "clProcessReactor.h"
+#include "file_logger.h"
+#include "processreaderthread.h"
+#include <mutex>
+#include <wx/time.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+// The epoll user data is built from the channel ID and a bit that tells which descriptor is ready
+#define REACTOR_STDERR_BIT 1
+#define REACTOR_WAKEUP_ID 0
+
+clProcessReactor* clProcessReactor::ms_instance = nullptr;
+bool clProcessReactor::ms_released = false;
+
+namespace
+{
+// guards the creation and the release of the reactor instance
+std::mutex s_instanceMutex;
+
+/// Return the length of the buffer, excluding a trailing *incomplete* UTF-8 sequence
+size_t CompleteUTF8Length(const std::string& buffer)
+{
+    size_t len = buffer.length();
+    // a UTF-8 sequence is at most 4 bytes, so we only need to check the last 3 bytes
+    for(size_t i = 1; i <= 3 && i <= len; ++i) {
+        unsigned char ch = (unsigned char)buffer[len - i];
+        if((ch & 0xC0) == 0x80) {
+            // continuation byte, keep looking for the lead byte
+            continue;
+        }
+        size_t expected = 1;
+        if((ch & 0xE0) == 0xC0) {
+            expected = 2;
+        } else if((ch & 0xF0) == 0xE0) {
+            expected = 3;
+        } else if((ch & 0xF8) == 0xF0) {
+            expected = 4;
+        }
+        return (expected > i) ? (len - i) : len;
+    }
+    return len;
+}
+} // namespace
+
+clProcessReactor::clProcessReactor()
+    : wxThread(wxTHREAD_JOINABLE)
+{
+#ifdef __linux__
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wakeupFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(m_epollFd != wxNOT_FOUND && m_wakeupFd != wxNOT_FOUND) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = REACTOR_WAKEUP_ID;
+        ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeupFd, &ev);
+    } else {
+        clERROR() << "clProcessReactor: failed to create epoll set." << strerror(errno);
+    }
+#endif
+}
+
+clProcessReactor::~clProcessReactor()
+{
+#ifdef __linux__
+    if(m_epollFd != wxNOT_FOUND) { ::close(m_epollFd); }
+    if(m_wakeupFd != wxNOT_FOUND) { ::close(m_wakeupFd); }
+#endif
+}
+
+bool clProcessReactor::IsSupported()
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+clProcessReactor* clProcessReactor::Get()
+{
+    std::lock_guard<std::mutex> lock(s_instanceMutex);
+    if(!ms_instance && !ms_released) {
+        ms_instance = new clProcessReactor();
+        ms_instance->Create();
+        ms_instance->Run();
+    }
+    return ms_instance;
+}
+
+void clProcessReactor::Release()
+{
+    std::lock_guard<std::mutex> lock(s_instanceMutex);
+    if(ms_instance) {
+        ms_instance->Stop();
+        delete ms_instance;
+    }
+    ms_instance = nullptr;
+    ms_released = true;
+}
+
+void clProcessReactor::Stop()
+{
+    {
+        wxMutexLocker locker(m_mutex);
+        m_shutdown = true;
+    }
+    Wakeup();
+    Wait(wxTHREAD_WAIT_BLOCK);
+}
+
+void clProcessReactor::Wakeup()
+{
+#ifdef __linux__
+    if(m_wakeupFd != wxNOT_FOUND) {
+        uint64_t one = 1;
+        if(::write(m_wakeupFd, &one, sizeof(one)) < 0) { clDEBUG1() << "clProcessReactor: wakeup failed" << clEndl; }
+    }
+#endif
+}
+
+bool clProcessReactor::Add(IProcess* process, wxEvtHandler* sink, int stdoutFd, int stderrFd, size_t flags)
+{
+#ifdef __linux__
+    if(m_epollFd == wxNOT_FOUND) { return false; }
+
+    wxMutexLocker locker(m_mutex);
+    wxUint64 id = (m_nextId++) << 1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = id;
+    if(::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, stdoutFd, &ev) < 0) {
+        clERROR() << "clProcessReactor: failed to add process stdout." << strerror(errno);
+        return false;
+    }
+
+    if(stderrFd != wxNOT_FOUND) {
+        ev.data.u64 = id | REACTOR_STDERR_BIT;
+        if(::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, stderrFd, &ev) < 0) {
+            clERROR() << "clProcessReactor: failed to add process stderr." << strerror(errno);
+            ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, stdoutFd, nullptr);
+            return false;
+        }
+    }
+
+    Channel& channel = m_channels[id];
+    channel.process = process;
+    channel.sink = sink;
+    channel.flags = flags;
+    channel.stdoutFd = stdoutFd;
+    channel.stderrFd = stderrFd;
+    m_processToId[process] = id;
+    return true;
+#else
+    wxUnusedVar(process);
+    wxUnusedVar(sink);
+    wxUnusedVar(stdoutFd);
+    wxUnusedVar(stderrFd);
+    wxUnusedVar(flags);
+    return false;
+#endif
+}
+
+void clProcessReactor::Remove(IProcess* process)
+{
+    wxMutexLocker locker(m_mutex);
+    auto iter = m_processToId.find(process);
+    if(iter == m_processToId.end()) { return; }
+    DoRemove(iter->second);
+}
+
+void clProcessReactor::DoRemove(wxUint64 id)
+{
+    // m_mutex must be locked by the caller
+    auto iter = m_channels.find(id);
+    if(iter == m_channels.end()) { return; }
+#ifdef __linux__
+    Channel& channel = iter->second;
+    if(channel.stdoutFd != wxNOT_FOUND) { ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, channel.stdoutFd, nullptr); }
+    if(channel.stderrFd != wxNOT_FOUND) { ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, channel.stderrFd, nullptr); }
+#endif
+    m_processToId.erase(iter->second.process);
+    m_channels.erase(iter);
+}
+
+bool clProcessReactor::ReadChannel(Channel& channel, int fd)
+{
+#ifdef __linux__
+    // The descriptors are shared with the process writer and are left in blocking mode, so we perform a single read
+    // per readiness notification. The epoll set is level triggered, so any remaining data is reported again
+    char buffer[kReadBufferSize];
+    ssize_t bytesRead = ::read(fd, buffer, sizeof(buffer));
+    if(bytesRead > 0) {
+        std::string& output = (fd == channel.stderrFd) ? channel.stderrBuffer : channel.stdoutBuffer;
+        output.append(buffer, bytesRead);
+        return true;
+    }
+    // EIO is what a pty master returns once the slave side is closed
+    return (bytesRead < 0 && (errno == EINTR || errno == EAGAIN));
+#else
+    wxUnusedVar(channel);
+    wxUnusedVar(fd);
+    return false;
+#endif
+}
+
+void clProcessReactor::Drain(Channel& channel, int fd)
+{
+#ifdef __linux__
+    if(fd == wxNOT_FOUND) { return; }
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    while(::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) && ReadChannel(channel, fd)) {
+        pfd.revents = 0;
+    }
+#else
+    wxUnusedVar(channel);
+    wxUnusedVar(fd);
+#endif
+}
+
+void clProcessReactor::CheckAlive()
+{
+    // m_mutex must be locked by the caller
+    std::vector<wxUint64> terminated;
+    for(auto& p : m_channels) {
+        if(!p.second.process->IsAlive()) { terminated.push_back(p.first); }
+    }
+
+    for(wxUint64 id : terminated) {
+        // the process exited but its descendants keep the pipe open: deliver what it wrote and report it
+        Channel& channel = m_channels[id];
+        Drain(channel, channel.stdoutFd);
+        NotifyTerminated(channel);
+        DoRemove(id);
+    }
+}
+
+void clProcessReactor::Deliver(Channel& channel, std::string& buffer, bool isStderr, bool final)
+{
+    if(buffer.empty()) { return; }
+
+    if(isStderr && channel.process->GetCallback()) {
+        // the callback interface only receives the process stdout
+        buffer.clear();
+        return;
+    }
+
+    // Don't split a multibyte character between two events: keep the incomplete tail for the next batch
+    size_t len = final ? buffer.length() : CompleteUTF8Length(buffer);
+    if(len == 0) { return; }
+
+    std::string text;
+    if(!(channel.flags & IProcessRawOutput)) {
+        StringUtils::StripTerminalColouring(buffer.substr(0, len), text);
+    } else {
+        text = buffer.substr(0, len);
+    }
+    buffer.erase(0, len);
+    if(text.empty()) { return; }
+
+    if(channel.process->GetCallback()) {
+        // the callback interface receives text
+        wxString output(text.c_str(), wxConvUTF8, text.length());
+        if(output.IsEmpty()) { output = wxString::From8BitData(text.c_str(), text.length()); }
+        channel.process->GetCallback()->CallAfter(&IProcessCallback::OnProcessOutput, output);
+
+    } else if(channel.sink) {
+        // the event carries the bytes, they are decoded only if the owner asks for the text
+        clProcessEvent event(isStderr ? wxEVT_ASYNC_PROCESS_STDERR : wxEVT_ASYNC_PROCESS_OUTPUT);
+        event.SetProcess(channel.process);
+        event.SetOutputRaw(text);
+        channel.sink->AddPendingEvent(event);
+    }
+}
+
+void clProcessReactor::Flush(Channel& channel, bool final)
+{
+    Deliver(channel, channel.stderrBuffer, true, final);
+    Deliver(channel, channel.stdoutBuffer, false, final);
+    channel.lastFlush = wxGetLocalTimeMillis().GetValue();
+}
+
+void clProcessReactor::NotifyTerminated(Channel& channel)
+{
+    // whatever is left (including an incomplete UTF-8 sequence and the stderr output that was not read yet) is
+    // delivered before the termination notification
+    Drain(channel, channel.stderrFd);
+    Flush(channel, true);
+
+    if(channel.process->GetCallback()) {
+        channel.process->GetCallback()->CallAfter(&IProcessCallback::OnProcessTerminated);
+    } else if(channel.sink) {
+        clProcessEvent event(wxEVT_ASYNC_PROCESS_TERMINATED);
+        event.SetProcess(channel.process);
+        channel.sink->AddPendingEvent(event);
+    }
+}
+
+void* clProcessReactor::Entry()
+{
+#ifdef __linux__
+    if(m_epollFd == wxNOT_FOUND) { return NULL; }
+
+    struct epoll_event events[64];
+    int timeout = -1;
+    while(true) {
+        int count = ::epoll_wait(m_epollFd, events, 64, timeout);
+        if(count < 0 && errno != EINTR) {
+            clERROR() << "clProcessReactor: epoll_wait error." << strerror(errno);
+            break;
+        }
+
+        wxMutexLocker locker(m_mutex);
+        if(m_shutdown) { break; }
+
+        for(int i = 0; i < count; ++i) {
+            wxUint64 data = events[i].data.u64;
+            if(data == REACTOR_WAKEUP_ID) {
+                uint64_t value = 0;
+                if(::read(m_wakeupFd, &value, sizeof(value)) < 0) { clDEBUG1() << "clProcessReactor: read failed" << clEndl; }
+                continue;
+            }
+
+            // the channel might have been removed while we were waiting
+            wxUint64 id = data & ~(wxUint64)REACTOR_STDERR_BIT;
+            auto iter = m_channels.find(id);
+            if(iter == m_channels.end()) { continue; }
+
+            Channel& channel = iter->second;
+            bool isStderr = (data & REACTOR_STDERR_BIT);
+            int fd = isStderr ? channel.stderrFd : channel.stdoutFd;
+            if(ReadChannel(channel, fd)) { continue; }
+
+            if(isStderr) {
+                // stderr was closed, keep reading stdout
+                ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, channel.stderrFd, nullptr);
+                channel.stderrFd = wxNOT_FOUND;
+            } else {
+                // the process terminated
+                NotifyTerminated(channel);
+                DoRemove(id);
+            }
+        }
+
+        wxLongLong_t now = wxGetLocalTimeMillis().GetValue();
+        if(now - m_lastAliveCheck >= kAliveCheckIntervalMs) {
+            CheckAlive();
+            m_lastAliveCheck = now;
+        }
+
+        // Deliver the output of channels that were idle long enough. Channels that are still within their flush
+        // interval determine how long we may block in the next epoll_wait. While there are processes, we wake up
+        // for the next liveness check
+        timeout = m_channels.empty() ? -1 : (int)(kAliveCheckIntervalMs - (now - m_lastAliveCheck));
+        for(auto& p : m_channels) {
+            Channel& channel = p.second;
+            if(channel.stdoutBuffer.empty() && channel.stderrBuffer.empty()) { continue; }
+
+            wxLongLong_t elapsed = now - channel.lastFlush;
+            size_t pending = channel.stdoutBuffer.length() + channel.stderrBuffer.length();
+            if(elapsed >= kFlushIntervalMs || pending >= kMaxBatchSize) {
+                Flush(channel);
+                // an incomplete UTF-8 tail might still be pending
+                if(channel.stdoutBuffer.empty() && channel.stderrBuffer.empty()) { continue; }
+                elapsed = 0;
+            }
+            int wait = (int)(kFlushIntervalMs - elapsed);
+            if(timeout == -1 || wait < timeout) { timeout = wait; }
+        }
+    }
+#endif
+    return NULL;
+}
@@ -0,0 +1,110 @@
+#ifndef CLPROCESSREACTOR_H
+#define CLPROCESSREACTOR_H
+
+#include "codelite_exports.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wx/event.h>
+#include <wx/thread.h>
+
+class IProcess;
+
+/**
+ * @class clProcessReactor
+ * @brief a single thread that multiplexes the output pipes of all the async child processes.
+ * On Linux the reactor waits on an epoll set, reads whatever is available and delivers the output to each process
+ * owner in batches: the first chunk after an idle period is delivered immediately, while sustained output is coalesced
+ * into at most one event per process every kFlushIntervalMs. The events carry the bytes as they were read, the text is
+ * only decoded if the owner asks for it (clProcessEvent::GetOutput()).
+ * A process is reported as terminated when its stdout is closed, or when it is no longer alive: its descendants might
+ * keep the pipe open long after it exited. The liveness is checked every kAliveCheckIntervalMs
+ * On other platforms IsSupported() returns false and processes keep using their own ProcessReaderThread
+ */
+class WXDLLIMPEXP_CL clProcessReactor : public wxThread
+{
+    enum {
+        kFlushIntervalMs = 15,
+        kAliveCheckIntervalMs = 500,
+        kMaxBatchSize = 256 * 1024,
+        kReadBufferSize = 64 * 1024,
+    };
+
+    struct Channel {
+        IProcess* process = nullptr;
+        wxEvtHandler* sink = nullptr;
+        size_t flags = 0;
+        int stdoutFd = wxNOT_FOUND;
+        int stderrFd = wxNOT_FOUND;
+        std::string stdoutBuffer;
+        std::string stderrBuffer;
+        wxLongLong_t lastFlush = 0;
+    };
+
+    std::unordered_map<wxUint64, Channel> m_channels;
+    std::unordered_map<IProcess*, wxUint64> m_processToId;
+    wxUint64 m_nextId = 1;
+    wxMutex m_mutex;
+    int m_epollFd = wxNOT_FOUND;
+    int m_wakeupFd = wxNOT_FOUND;
+    bool m_shutdown = false;
+    wxLongLong_t m_lastAliveCheck = 0;
+
+    static clProcessReactor* ms_instance;
+    static bool ms_released;
+
+protected:
+    clProcessReactor();
+    virtual ~clProcessReactor();
+
+    virtual void* Entry();
+
+    /// read available data from fd into the channel buffer. Return false on EOF / error
+    bool ReadChannel(Channel& channel, int fd);
+    /// read whatever is already available on fd, without blocking
+    void Drain(Channel& channel, int fd);
+    /// report the processes that are no longer alive as terminated
+    void CheckAlive();
+    /// deliver the pending output of the channel to its owner. Unless 'final' is set, an incomplete UTF-8 sequence at
+    /// the end of the buffer is kept for the next flush
+    void Flush(Channel& channel, bool final = false);
+    void Deliver(Channel& channel, std::string& buffer, bool isStderr, bool final);
+    void NotifyTerminated(Channel& channel);
+    void DoRemove(wxUint64 id);
+    void Wakeup();
+    void Stop();
+
+public:
+    /**
+     * @brief return the reactor instance, starting its thread on first use. Returns nullptr once Release() was
+     * called: the processes that are destroyed after it must not start a new reactor. This method is thread safe
+     */
+    static clProcessReactor* Get();
+
+    /**
+     * @brief stop the reactor thread. Call this once on application exit
+     */
+    static void Release();
+
+    /**
+     * @brief can this platform use the reactor?
+     */
+    static bool IsSupported();
+
+    /**
+     * @brief start monitoring process output
+     * @param process the process. Output and termination are reported exactly like ProcessReaderThread does: via the
+     * process callback (if any, it receives stdout only) or by posting clProcessEvent to sink
+     * @param stderrFd separate stderr pipe, or wxNOT_FOUND
+     * @param flags the process creation flags (IProcessRawOutput)
+     */
+    bool Add(IProcess* process, wxEvtHandler* sink, int stdoutFd, int stderrFd, size_t flags);
+
+    /**
+     * @brief stop monitoring the process. When this function returns no more events will be posted for the process.
+     * Must be called before the process file descriptors are closed
+     */
+    void Remove(IProcess* process);
+};
+
+#endif // CLPROCESSREACTOR_H
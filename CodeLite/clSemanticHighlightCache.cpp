@@ -0,0 +1,123 @@
+#include "JSON.h"
+#include "clFileIdentity.h"
+#include "clSemanticHighlightCache.h"
+#include "cl_standard_paths.h"
+#include "file_logger.h"
+#include "fileutils.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <wx/dir.h>
+
+// the entries that were not used for this many days are removed
+static const int MAX_ENTRY_AGE_DAYS = 30;
+// keep at most this many entries (the most recently used)
+static const size_t MAX_ENTRIES = 5000;
+// the folder is pruned once every this many saves
+static const size_t PRUNE_INTERVAL = 200;
+
+namespace
+{
+wxString ToHex(wxUint64 value) { return wxString::Format("%" wxLongLongFmtSpec "x", (wxULongLong_t)value); }
+
+wxUint64 FromHex(const wxString& str)
+{
+    wxULongLong_t value = 0;
+    if(!str.ToULongLong(&value, 16)) { return 0; }
+    return value;
+}
+} // namespace
+
+wxFileName clSemanticHighlightCache::GetCacheDir()
+{
+    wxFileName dir(clStandardPaths::Get().GetUserDataDir(), "");
+    dir.AppendDir("cache");
+    dir.AppendDir("semantic-highlight");
+    return dir;
+}
+
+wxFileName clSemanticHighlightCache::GetEntryFile(const wxString& filename)
+{
+    // one small file per source file, named after the hash of its path
+    wxCharBuffer cb = filename.mb_str(wxConvUTF8);
+    wxFileName fn = GetCacheDir();
+    fn.SetFullName(ToHex(clFileHasher::Hash(cb.data(), cb.length())) + ".json");
+    return fn;
+}
+
+bool clSemanticHighlightCache::Load(const wxString& filename, clSemanticHighlightCache::Entry& entry)
+{
+    wxFileName fn = GetEntryFile(filename);
+    if(!fn.FileExists()) { return false; }
+
+    JSON root(fn);
+    if(!root.isOk()) { return false; }
+    JSONItem json = root.toElement();
+    // a different file with the same hash
+    if(json.namedObject("file").toString() != filename) { return false; }
+
+    entry.contentHash = FromHex(json.namedObject("contentHash").toString());
+    entry.tagsGeneration = FromHex(json.namedObject("tagsGeneration").toString());
+    entry.classes = json.namedObject("classes").toString();
+    entry.locals = json.namedObject("locals").toString();
+
+    // the modification time of the entry is its last use, see Prune()
+    fn.Touch();
+    return true;
+}
+
+void clSemanticHighlightCache::Save(const wxString& filename, const clSemanticHighlightCache::Entry& entry)
+{
+    wxFileName fn = GetEntryFile(filename);
+    fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    JSON root(cJSON_Object);
+    JSONItem json = root.toElement();
+    json.addProperty("file", filename);
+    json.addProperty("contentHash", ToHex(entry.contentHash));
+    json.addProperty("tagsGeneration", ToHex(entry.tagsGeneration));
+    json.addProperty("classes", entry.classes);
+    json.addProperty("locals", entry.locals);
+
+    // write to a temporary file first, so a reader never loads a partial entry
+    wxFileName tmpfile = fn;
+    tmpfile.SetExt("tmp");
+    root.save(tmpfile);
+    if(!wxRenameFile(tmpfile.GetFullPath(), fn.GetFullPath(), true)) { wxRemoveFile(tmpfile.GetFullPath()); }
+
+    static std::atomic<size_t> saveCount(0);
+    if((saveCount++ % PRUNE_INTERVAL) == 0) { Prune(); }
+}
+
+void clSemanticHighlightCache::Prune()
+{
+    wxString dir = GetCacheDir().GetPath();
+    if(!wxFileName::DirExists(dir)) { return; }
+
+    wxArrayString files;
+    wxDir::GetAllFiles(dir, &files, "*.json", wxDIR_FILES);
+
+    std::vector<std::pair<time_t, wxString> > entries;
+    entries.reserve(files.size());
+    time_t oldest = wxDateTime::Now().GetTicks() - (MAX_ENTRY_AGE_DAYS * 24 * 60 * 60);
+    size_t removed = 0;
+    for(const wxString& file : files) {
+        time_t mtime = wxFileModificationTime(file);
+        if(mtime == (time_t)-1) { continue; }
+        if(mtime < oldest) {
+            if(wxRemoveFile(file)) { ++removed; }
+        } else {
+            entries.push_back({ mtime, file });
+        }
+    }
+
+    if(entries.size() > MAX_ENTRIES) {
+        // most recently used first
+        std::sort(entries.begin(), entries.end(), [](const std::pair<time_t, wxString>& a,
+                                                     const std::pair<time_t, wxString>& b) { return a.first > b.first; });
+        for(size_t i = MAX_ENTRIES; i < entries.size(); ++i) {
+            if(wxRemoveFile(entries[i].second)) { ++removed; }
+        }
+    }
+    if(removed) { clDEBUG() << "clSemanticHighlightCache: removed" << removed << "entries" << clEndl; }
+}
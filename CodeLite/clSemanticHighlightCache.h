@@ -0,0 +1,46 @@
+#ifndef CLSEMANTICHIGHLIGHTCACHE_H
+#define CLSEMANTICHIGHLIGHTCACHE_H
+
+#include "codelite_exports.h"
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class clSemanticHighlightCache
+ * @brief an on-disk cache of the semantic highlighting tokens (workspace classes and locals) of a source file.
+ * An entry is valid for a given file content (hash of its raw bytes) and is considered up to date as long as no tags
+ * were written to the database since it was computed (see ITagsStorage::GetTagsGeneration). The entries that were
+ * not used for a while are removed. All the methods are thread safe
+ */
+class WXDLLIMPEXP_CL clSemanticHighlightCache
+{
+public:
+    struct Entry {
+        wxUint64 contentHash = 0;
+        wxUint64 tagsGeneration = 0;
+        wxString classes; // space delimited
+        wxString locals;  // space delimited
+    };
+
+protected:
+    static wxFileName GetCacheDir();
+    static wxFileName GetEntryFile(const wxString& filename);
+    /**
+     * @brief remove the entries that were not used recently, and the oldest entries above the size limit
+     */
+    static void Prune();
+
+public:
+    /**
+     * @brief load the entry of 'filename' (and mark it as recently used)
+     * @return false if there is no entry for this file
+     */
+    static bool Load(const wxString& filename, clSemanticHighlightCache::Entry& entry);
+
+    /**
+     * @brief store the entry of 'filename', replacing the current one
+     */
+    static void Save(const wxString& filename, const clSemanticHighlightCache::Entry& entry);
+};
+
+#endif // CLSEMANTICHIGHLIGHTCACHE_H
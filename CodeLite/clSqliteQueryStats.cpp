@@ -0,0 +1,124 @@
+#include "clSqliteQueryStats.h"
+#include <algorithm>
+#include <vector>
+#include <wx/intl.h>
+
+// the longest SQL text displayed by ToString()
+static const size_t MAX_SQL_LEN = 160;
+// the number of distinct statements kept, the others are counted together
+static const size_t MAX_QUERIES = 1000;
+
+clSqliteQueryStats::Scope::Scope(const wxString& sql)
+    : m_sql(sql)
+    , m_start(std::chrono::steady_clock::now())
+{
+}
+
+clSqliteQueryStats::Scope::~Scope()
+{
+    long long durationUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    clSqliteQueryStats::Get().Add(m_sql, durationUs);
+}
+
+clSqliteQueryStats& clSqliteQueryStats::Get()
+{
+    static clSqliteQueryStats stats;
+    return stats;
+}
+
+size_t clSqliteQueryStats::GetBucket(long long durationUs)
+{
+    size_t bucket = 0;
+    long long limit = 16;
+    while(bucket < (BUCKETS - 1) && durationUs >= limit) {
+        ++bucket;
+        limit *= 2;
+    }
+    return bucket;
+}
+
+long long clSqliteQueryStats::GetPercentile(const Histogram& histogram, double p)
+{
+    size_t target = (size_t)(histogram.count * p);
+    size_t seen = 0;
+    for(size_t i = 0; i < BUCKETS - 1; ++i) {
+        seen += histogram.buckets[i];
+        if(seen > target) { return std::min(16LL << i, histogram.maxUs); }
+    }
+    return histogram.maxUs;
+}
+
+void clSqliteQueryStats::Add(const wxString& sql, long long durationUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<wxString, Histogram>::iterator iter = m_histograms.find(sql);
+    if(iter == m_histograms.end()) {
+        if(m_histograms.size() >= MAX_QUERIES) {
+            iter = m_histograms.insert({ "<other queries>", Histogram() }).first;
+        } else {
+            iter = m_histograms.insert({ sql, Histogram() }).first;
+        }
+    }
+    Histogram& histogram = iter->second;
+    ++histogram.count;
+    histogram.totalUs += durationUs;
+    histogram.maxUs = std::max(histogram.maxUs, durationUs);
+    ++histogram.buckets[GetBucket(durationUs)];
+}
+
+void clSqliteQueryStats::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_histograms.clear();
+}
+
+wxString clSqliteQueryStats::ToString() const
+{
+    std::vector<std::pair<wxString, Histogram>> queries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        queries.insert(queries.end(), m_histograms.begin(), m_histograms.end());
+    }
+    std::sort(queries.begin(), queries.end(),
+              [](const std::pair<wxString, Histogram>& a, const std::pair<wxString, Histogram>& b) {
+                  return a.second.totalUs > b.second.totalUs;
+              });
+
+    // all the queries together
+    Histogram all;
+    for(const std::pair<wxString, Histogram>& query : queries) {
+        all.count += query.second.count;
+        all.totalUs += query.second.totalUs;
+        all.maxUs = std::max(all.maxUs, query.second.maxUs);
+        for(size_t i = 0; i < BUCKETS; ++i) {
+            all.buckets[i] += query.second.buckets[i];
+        }
+    }
+
+    wxString str;
+    str << wxString::Format("%10s %10s %9s %9s %9s %9s %9s  %s\n", "Count", "Total(ms)", "Avg(ms)", "p50(ms)",
+                            "p90(ms)", "p99(ms)", "Max(ms)", "Query");
+    for(const std::pair<wxString, Histogram>& query : queries) {
+        const Histogram& h = query.second;
+        wxString sql = query.first;
+        sql.Replace("\n", " ");
+        if(sql.length() > MAX_SQL_LEN) { sql = sql.Left(MAX_SQL_LEN) + "..."; }
+        str << wxString::Format("%10lu %10.1f %9.3f %9.3f %9.3f %9.3f %9.3f  %s\n", (unsigned long)h.count,
+                                h.totalUs / 1000.0, (h.totalUs / 1000.0) / h.count, GetPercentile(h, 0.5) / 1000.0,
+                                GetPercentile(h, 0.9) / 1000.0, GetPercentile(h, 0.99) / 1000.0, h.maxUs / 1000.0,
+                                sql);
+    }
+
+    str << "\n" << _("Latency histogram (all queries)") << "\n";
+    for(size_t i = 0; i < BUCKETS; ++i) {
+        if(all.buckets[i] == 0) { continue; }
+        if(i == (BUCKETS - 1)) {
+            str << wxString::Format(">= %9.3f ms: %lu\n", (16LL << (i - 1)) / 1000.0, (unsigned long)all.buckets[i]);
+        } else {
+            str << wxString::Format(" < %9.3f ms: %lu\n", (16LL << i) / 1000.0, (unsigned long)all.buckets[i]);
+        }
+    }
+    str << wxString::Format("\n%lu queries, %.1f ms\n", (unsigned long)all.count, all.totalUs / 1000.0);
+    return str;
+}
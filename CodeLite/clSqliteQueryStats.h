@@ -0,0 +1,65 @@
+#ifndef CLSQLITEQUERYSTATS_H
+#define CLSQLITEQUERYSTATS_H
+
+#include "codelite_exports.h"
+#include "wxStringHash.h"
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <wx/string.h>
+
+/**
+ * @class clSqliteQueryStats
+ * @brief collects the latency of the tags database queries: one histogram per SQL statement. The statements use
+ * '?' placeholders (and a marker instead of the literal lists, see clSqliteQuery::GetStatsSql), so all the executions
+ * of a query share the same histogram. At most MAX_QUERIES statements are kept. The methods are thread safe
+ */
+class WXDLLIMPEXP_CL clSqliteQueryStats
+{
+public:
+    // bucket 'i' counts the queries that took less than 2^(i+4) microseconds, the last bucket counts the rest
+    static const size_t BUCKETS = 20;
+
+    struct Histogram {
+        size_t count = 0;
+        long long totalUs = 0;
+        long long maxUs = 0;
+        size_t buckets[BUCKETS] = {};
+    };
+
+    /**
+     * @brief measure the time from the construction to the destruction of the object. 'sql' must outlive the object
+     */
+    class WXDLLIMPEXP_CL Scope
+    {
+        const wxString& m_sql;
+        std::chrono::steady_clock::time_point m_start;
+
+    public:
+        Scope(const wxString& sql);
+        ~Scope();
+    };
+
+protected:
+    mutable std::mutex m_mutex;
+    std::unordered_map<wxString, Histogram> m_histograms;
+
+protected:
+    clSqliteQueryStats() {}
+    static size_t GetBucket(long long durationUs);
+    /// an upper bound of the percentile 'p' (0-1), in microseconds
+    static long long GetPercentile(const Histogram& histogram, double p);
+
+public:
+    static clSqliteQueryStats& Get();
+
+    void Add(const wxString& sql, long long durationUs);
+    void Clear();
+
+    /**
+     * @brief format the statistics as a table, the slowest queries (total time) first
+     */
+    wxString ToString() const;
+};
+
+#endif // CLSQLITEQUERYSTATS_H
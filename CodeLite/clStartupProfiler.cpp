@@ -0,0 +1,114 @@
+#include "clStartupProfiler.h"
+#include "JSON.h"
+#include "file_logger.h"
+#include "fileutils.h"
+#include <algorithm>
+#include <chrono>
+#include <wx/thread.h>
+
+namespace
+{
+std::chrono::steady_clock::time_point& StartTime()
+{
+    static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+} // namespace
+
+clStartupProfiler::Scope::Scope(const wxString& name, const wxString& category)
+    : m_name(name)
+    , m_category(category)
+    , m_start(clStartupProfiler::Get().Now())
+{
+}
+
+clStartupProfiler::Scope::~Scope()
+{
+    clStartupProfiler& profiler = clStartupProfiler::Get();
+    profiler.Add(m_name, m_category, m_start, profiler.Now() - m_start);
+}
+
+clStartupProfiler::clStartupProfiler() { StartTime(); }
+
+clStartupProfiler& clStartupProfiler::Get()
+{
+    static clStartupProfiler profiler;
+    return profiler;
+}
+
+long long clStartupProfiler::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime())
+        .count();
+}
+
+void clStartupProfiler::Add(const wxString& name, const wxString& category, long long startUs, long long durationUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_completed) { return; }
+
+    Phase phase;
+    phase.name = name.c_str(); // make our own copy, the phase can be added by a worker thread
+    phase.category = category.c_str();
+    phase.startUs = startUs;
+    phase.durationUs = durationUs;
+    phase.threadId = (unsigned long)wxThread::GetCurrentId();
+    m_phases.push_back(phase);
+}
+
+bool clStartupProfiler::IsCompleted() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_completed;
+}
+
+void clStartupProfiler::SetCompleted(const wxFileName& fn)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_completed) { return; }
+        m_completed = true;
+        m_totalUs = Now();
+    }
+
+    clSYSTEM() << "Startup completed in" << (m_totalUs / 1000) << "ms" << clEndl;
+    if(!FileUtils::WriteFileContent(fn, ToTraceJSON())) {
+        clWARNING() << "Failed to save startup timeline:" << fn << clEndl;
+    }
+}
+
+wxString clStartupProfiler::ToString() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Phase> phases = m_phases;
+    std::stable_sort(phases.begin(), phases.end(), [](const Phase& a, const Phase& b) { return a.startUs < b.startUs; });
+
+    wxString str;
+    str << wxString::Format("%-12s %10s %10s  %-20s %s\n", "Thread", "Start(ms)", "Time(ms)", "Category", "Phase");
+    for(const Phase& phase : phases) {
+        str << wxString::Format("%-12lu %10.1f %10.1f  %-20s %s\n", phase.threadId, phase.startUs / 1000.0,
+                                phase.durationUs / 1000.0, phase.category, phase.name);
+    }
+    if(m_completed) { str << "\nStartup completed in " << (m_totalUs / 1000) << " ms\n"; }
+    return str;
+}
+
+wxString clStartupProfiler::ToTraceJSON() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    JSON root(cJSON_Object);
+    JSONItem events = JSONItem::createArray("traceEvents");
+    for(const Phase& phase : m_phases) {
+        JSONItem event = JSONItem::createObject();
+        event.addProperty("name", phase.name);
+        event.addProperty("cat", phase.category);
+        event.addProperty("ph", wxString("X"));
+        event.addProperty("ts", (long)phase.startUs);
+        event.addProperty("dur", (long)phase.durationUs);
+        event.addProperty("pid", 1);
+        event.addProperty("tid", (long)phase.threadId);
+        events.arrayAppend(event);
+    }
+    root.toElement().append(events);
+    return root.toElement().format();
+}
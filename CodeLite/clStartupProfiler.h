@@ -0,0 +1,82 @@
+#ifndef CLSTARTUPPROFILER_H
+#define CLSTARTUPPROFILER_H
+
+#include "codelite_exports.h"
+#include <mutex>
+#include <vector>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class clStartupProfiler
+ * @brief records the timeline of CodeLite's startup: one entry per phase (settings, lexers, bitmaps, main frame, each
+ * plugin...). Phases can be recorded from any thread. Once the startup completes, the timeline is saved in the Chrome
+ * trace format (load it in chrome://tracing or https://ui.perfetto.dev) and can be viewed from the Help menu
+ */
+class WXDLLIMPEXP_CL clStartupProfiler
+{
+public:
+    struct Phase {
+        wxString name;
+        wxString category;
+        long long startUs = 0;    // since the profiler was created
+        long long durationUs = 0;
+        unsigned long threadId = 0;
+    };
+
+    /**
+     * @class clStartupProfiler::Scope
+     * @brief records the lifetime of the object as a startup phase
+     */
+    class WXDLLIMPEXP_CL Scope
+    {
+        wxString m_name;
+        wxString m_category;
+        long long m_start;
+
+    public:
+        Scope(const wxString& name, const wxString& category);
+        ~Scope();
+    };
+
+protected:
+    std::vector<Phase> m_phases;
+    mutable std::mutex m_mutex;
+    long long m_totalUs = 0;
+    bool m_completed = false;
+
+protected:
+    clStartupProfiler();
+    ~clStartupProfiler() {}
+
+public:
+    static clStartupProfiler& Get();
+
+    /**
+     * @brief return the time in microseconds since the profiler was created (the first call to Get())
+     */
+    long long Now() const;
+
+    /**
+     * @brief record a phase. Does nothing once the startup completed
+     */
+    void Add(const wxString& name, const wxString& category, long long startUs, long long durationUs);
+
+    /**
+     * @brief mark the startup as completed and save the timeline into 'fn'
+     */
+    void SetCompleted(const wxFileName& fn);
+    bool IsCompleted() const;
+
+    /**
+     * @brief return the timeline as a table, sorted by start time
+     */
+    wxString ToString() const;
+
+    /**
+     * @brief return the timeline in the Chrome trace format
+     */
+    wxString ToTraceJSON() const;
+};
+
+#endif // CLSTARTUPPROFILER_H
@@ -434,9 +434,25 @@ clProcessEvent& clProcessEvent::operator=(const clProcessEvent& src)
     clCommandEvent::operator=(src);
     m_process = src.m_process;
     m_output = src.m_output;
+    m_outputRaw = src.m_outputRaw;
     return *this;
 }
 
+const wxString& clProcessEvent::GetOutput() const
+{
+    if(m_output.IsEmpty() && !m_outputRaw.empty()) {
+        m_output = wxString(m_outputRaw.c_str(), wxConvUTF8, m_outputRaw.length());
+        if(m_output.IsEmpty()) { m_output = wxString::From8BitData(m_outputRaw.c_str(), m_outputRaw.length()); }
+    }
+    return m_output;
+}
+
+std::string clProcessEvent::GetOutputRaw() const
+{
+    if(!m_outputRaw.empty() || m_output.IsEmpty()) { return m_outputRaw; }
+    return std::string(m_output.mb_str(wxConvUTF8).data());
+}
+
 // --------------------------------------------------------------
 // Compiler event
 // --------------------------------------------------------------
@@ -548,7 +548,8 @@ typedef void (wxEvtHandler::*clGotoEventFunction)(clGotoEvent&);
 class IProcess;
 class WXDLLIMPEXP_CL clProcessEvent : public clCommandEvent
 {
-    wxString m_output;
+    mutable wxString m_output;
+    std::string m_outputRaw;
     IProcess* m_process;
 
 public:
@@ -560,7 +561,17 @@ public:
 
     void SetOutput(const wxString& output) { this->m_output = output; }
     void SetProcess(IProcess* process) { this->m_process = process; }
-    const wxString& GetOutput() const { return m_output; }
+    /**
+     * @brief the process output as text. When the event carries raw bytes, they are decoded (UTF-8, falling back to
+     * 8 bit data) on the first call
+     */
+    const wxString& GetOutput() const;
+    void SetOutputRaw(const std::string& outputRaw) { this->m_outputRaw = outputRaw; }
+    /**
+     * @brief the process output as it was read, without decoding it. Events that only carry text return its
+     * UTF-8 encoding
+     */
+    std::string GetOutputRaw() const;
     IProcess* GetProcess() { return m_process; }
 };
 
@@ -336,7 +336,15 @@ void TagsManager::OnIndexerTerminated(clProcessEvent& event)
 //---------------------------------------------------------------------
 // Parsing
 //---------------------------------------------------------------------
-void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
+wxString TagsManager::GetIndexerOptions() const
+{
+    wxString ctagsCmd;
+    ctagsCmd << wxT(" ") << m_tagsOptions.ToString()
+             << wxT(" --excmd=pattern --sort=no --fields=aKmSsnit --c-kinds=+p --C++-kinds=+p ");
+    return ctagsCmd;
+}
+
+bool TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
 {
     std::stringstream s;
     s << wxGetProcessId();
@@ -358,22 +366,20 @@ void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
     req.setFiles(files);
 
     // set ctags options to be used
-    wxString ctagsCmd;
-    ctagsCmd << wxT(" ") << m_tagsOptions.ToString()
-             << wxT(" --excmd=pattern --sort=no --fields=aKmSsnit --c-kinds=+p --C++-kinds=+p ");
+    wxString ctagsCmd = GetIndexerOptions();
     req.setCtagOptions(ctagsCmd.mb_str(wxConvUTF8).data());
 
     // clDEBUG1() << "Sending CTAGS command:" << ctagsCmd << clEndl;
     // connect to the indexer
     if(!client.connect()) {
         clWARNING() << "Failed to connect to indexer process. Indexer ID:" << wxGetProcessId() << clEndl;
-        return;
+        return false;
     }
 
     // send the request
     if(!clIndexerProtocol::SendRequest(&client, req)) {
         clWARNING() << "Failed to send request to indexer. Indexer ID:" << wxGetProcessId() << clEndl;
-        return;
+        return false;
     }
 
     // read the reply
@@ -384,12 +390,12 @@ void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
         if(!clIndexerProtocol::ReadReply(&client, reply, errmsg)) {
             clWARNING() << "Failed to read indexer reply: " << (wxString() << errmsg) << clEndl;
             RestartCodeLiteIndexer();
-            return;
+            return false;
         }
     } catch(std::bad_alloc& ex) {
         clWARNING() << "std::bad_alloc exception caught" << clEndl;
         tags.Clear();
-        return;
+        return false;
     }
 
     // clDEBUG1() << "SourceToTags: [" << reply.getTags() << "]" << clEndl;
@@ -402,6 +408,7 @@ void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
     if(tags.empty()) { tags = wxString::From8BitData(reply.getTags().c_str()); }
 
     // clDEBUG1() << "Tags:\n" << tags << clEndl;
+    return true;
 }
 
 TagTreePtr TagsManager::TreeFromTags(const wxString& tags, int& count)
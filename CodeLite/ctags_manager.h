@@ -226,6 +226,12 @@ public:
     void SetCtagsOptions(const TagsOptionsData& options);
 
     void SetEncoding(const wxFontEncoding& encoding);
+    wxFontEncoding GetEncoding() const { return m_encoding; }
+
+    /**
+     * @brief the ctags options passed to the indexer when parsing a file
+     */
+    wxString GetIndexerOptions() const;
 
     /**
      * Locate symbol by name in database
@@ -529,8 +535,9 @@ public:
      * Pass a source file to ctags process, wait for it to process it and return the output.
      * @param source Source file name
      * @param tags String containing the ctags output
+     * @return false if the indexer could not be reached (in that case 'tags' is not the content of the file)
      */
-    void SourceToTags(const wxFileName& source, wxString& tags);
+    bool SourceToTags(const wxFileName& source, wxString& tags);
 
     /**
      * return list of files from the database(s). The returned list is ordered
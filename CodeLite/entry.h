@@ -92,6 +92,9 @@ class WXDLLIMPEXP_CL TagEntry
     wxString m_formattedComment;
     bool m_isCommentForamtted;
 
+    // reads the raw pattern and kind
+    friend class clCompactTagStore;
+
 public:
     enum {
         Tag_No_Signature_Format = 0x00000001, // Do not attempt to format the signature. Use the GetSignature() as is
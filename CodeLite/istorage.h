@@ -511,6 +511,12 @@ public:
     virtual void RemoveNonWorkspaceSymbols(const std::vector<wxString>& symbols,
                                            std::vector<wxString>& workspaceSymbols,
                                            std::vector<wxString>& nonWorkspaceSymbols) = 0;
+
+    /**
+     * @brief return the generation of the tags: a counter that is incremented whenever tags are added to or removed
+     * from the database. Two calls that return the same value saw the same tags
+     */
+    virtual wxUint64 GetTagsGeneration() = 0;
 };
 
 enum { TagOk = 0, TagExist, TagError };
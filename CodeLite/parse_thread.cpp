@@ -24,6 +24,10 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "CxxScannerTokens.h"
 #include "CxxVariableScanner.h"
+#include "clFileIdentity.h"
+#include "clIncludeGraphCache.h"
+#include "clParseResultCache.h"
+#include "clSemanticHighlightCache.h"
 #include "cl_command_event.h"
 #include "cl_standard_paths.h"
 #include "cpp_scanner.h"
@@ -326,42 +330,46 @@ void ParseThread::GetFileListToParse(const wxString& filename, wxArrayString& ar
         return;
     }
 
-    {
-        wxCriticalSectionLocker locker(TagsManagerST::Get()->m_crawlerLocker);
-
-        wxArrayString includePaths, excludePaths;
-        GetSearchPaths(includePaths, excludePaths);
+    // Skip binary files
+    if(TagsManagerST::Get()->IsBinaryFile(filename, m_tod)) {
+        DEBUG_MESSAGE(wxString::Format(wxT("Skipping binary file %s"), filename.c_str()));
+        return;
+    }
 
-        fcFileOpener::Get()->ClearResults();
-        fcFileOpener::Get()->ClearSearchPath();
-        for(size_t i = 0; i < includePaths.GetCount(); i++) {
-            fcFileOpener::Get()->AddSearchPath(includePaths.Item(i).mb_str(wxConvUTF8).data());
-        }
+    wxArrayString includePaths, excludePaths;
+    GetSearchPaths(includePaths, excludePaths);
 
-        for(size_t i = 0; i < excludePaths.GetCount(); i++) {
-            fcFileOpener::Get()->AddExcludePath(excludePaths.Item(i).mb_str(wxConvUTF8).data());
-        }
+    // only the files that were modified since the last crawl are read again
+    wxStringSet_t fileSet;
+    wxArrayString files;
+    files.Add(filename);
+    clIncludeGraphCache::Get().Crawl(files, includePaths, excludePaths, fileSet);
 
-        // Invoke the crawler
-        const wxCharBuffer cfile = filename.mb_str(wxConvUTF8);
+    arrFiles.Alloc(fileSet.size()); // Make enough room
+    std::for_each(fileSet.begin(), fileSet.end(), [&](const wxString& file) { arrFiles.Add(file); });
+}
 
-        // Skip binary files
-        if(TagsManagerST::Get()->IsBinaryFile(filename, m_tod)) {
-            DEBUG_MESSAGE(wxString::Format(wxT("Skipping binary file %s"), filename.c_str()));
-            return;
-        }
+void ParseThread::DoSourceToTags(const wxString& filename, wxString& tags)
+{
+    TagsManager* tagmgr = TagsManagerST::Get();
+    // the same content parsed with the same options always produces the same tags
+    wxString options;
+    options << tagmgr->GetIndexerOptions() << "|" << (int)tagmgr->GetEncoding();
 
-        // Before using the 'crawlerScan' we lock it, since it is not mt-safe
-        crawlerScan(cfile.data());
+    wxString key;
+    if(!clParseResultCache::GetKey(filename, options, key)) {
+        tagmgr->SourceToTags(filename, tags);
+        return;
     }
+    if(clParseResultCache::Get().Lookup(key, filename, tags)) { return; }
 
-    const fcFileOpener::Set_t& fileSet = fcFileOpener::Get()->GetResults();
-    arrFiles.Alloc(fileSet.size()); // Make enough room
-    std::for_each(fileSet.begin(), fileSet.end(), [&](const wxString& file) {
-        wxFileName fn(file);
-        fn.MakeAbsolute();
-        arrFiles.Add(fn.GetFullPath());
-    });
+    if(!tagmgr->SourceToTags(filename, tags)) { return; }
+
+    // don't cache the output if the file was modified while it was parsed
+    wxString keyAfter;
+    if(clParseResultCache::GetKey(filename, options, keyAfter) && keyAfter == key) {
+        clParseResultCache::Get().Store(key, tags);
+    }
 }
 
 void ParseThread::ParseAndStoreFiles(ParseRequest* req, const wxArrayString& arrFiles, int initalCount,
@@ -376,7 +384,7 @@ void ParseThread::ParseAndStoreFiles(ParseRequest* req, const wxArrayString& arr
         TEST_DESTROY();
 
         wxString tags; // output
-        TagsManagerST::Get()->SourceToTags(arrFiles.Item(i), tags);
+        DoSourceToTags(arrFiles.Item(i), tags);
 
         if(tags.IsEmpty() == false) {
             DoStoreTags(tags, arrFiles.Item(i), totalSymbols, db);
@@ -551,37 +559,16 @@ void ParseThread::FindIncludedFiles(ParseRequest* req, std::set<wxString>* newSe
         filteredFileList.Add(fullpath);
     }
 
-    wxArrayString arrFiles;
-
-    // Clear the results once
-    {
-        // Before using the 'crawlerScan' we lock it, since it is not mt-safe
-        wxCriticalSectionLocker locker(TagsManagerST::Get()->m_crawlerLocker);
-
-        fcFileOpener::Get()->ClearResults();
-        fcFileOpener::Get()->ClearSearchPath();
-
-        for(size_t i = 0; i < searchPaths.GetCount(); i++) {
-            const wxCharBuffer path = _C(searchPaths.Item(i));
-            clDEBUG1() << "Using include path:" << searchPaths.Item(i);
-            fcFileOpener::Get()->AddSearchPath(path.data());
-        }
-
-        for(size_t i = 0; i < excludePaths.GetCount(); i++) {
-            const wxCharBuffer path = _C(excludePaths.Item(i));
-            clDEBUG1() << "Using exclude path:" << excludePaths.Item(i);
-            fcFileOpener::Get()->AddExcludePath(path.data());
-        }
+    clDEBUG1() << "Using include paths:" << searchPaths;
+    clDEBUG1() << "Using exclude paths:" << excludePaths;
 
-        for(size_t i = 0; i < filteredFileList.GetCount(); i++) {
-            const wxCharBuffer cfile = filteredFileList.Item(i).mb_str(wxConvUTF8);
-            crawlerScan(cfile.data());
-            if(TestDestroy()) {
-                return;
-            }
-        }
-        newSet->insert(fcFileOpener::Get()->GetResults().begin(), fcFileOpener::Get()->GetResults().end());
+    // the include lists of the files that were not modified since the last crawl are taken from the cache
+    wxStringSet_t fileSet;
+    if(!clIncludeGraphCache::Get().Crawl(filteredFileList, searchPaths, excludePaths, fileSet,
+                                         [this]() { return TestDestroy(); })) {
+        return;
     }
+    newSet->insert(fileSet.begin(), fileSet.end());
 }
 
 //--------------------------------------------------------------------------------------
@@ -699,6 +686,24 @@ void ParseThread::DoNotifyReady(wxEvtHandler* caller, int requestType)
 void ParseThread::ProcessColourRequest(ParseRequest* req)
 {
     CxxTokenizer tokenizer;
+
+    // Open the database
+    ITagsStoragePtr db(new TagsStorageSQLite());
+    db->OpenDatabase(req->getDbfile());
+
+    // Read these before the file and the tokens, so a change that happens while we work invalidates our result
+    clSemanticHighlightCache::Entry cacheEntry;
+    cacheEntry.tagsGeneration = db->GetTagsGeneration();
+    bool hasHash = clFileIdentity::HashFile(req->getFile(), cacheEntry.contentHash);
+
+    // The tokens computed for this content are still valid if no tags were written since
+    clSemanticHighlightCache::Entry entry;
+    if(hasHash && clSemanticHighlightCache::Load(req->getFile(), entry) &&
+       (entry.contentHash == cacheEntry.contentHash) && (entry.tagsGeneration == cacheEntry.tagsGeneration)) {
+        DoNotifyColourTokens(req, entry.classes, entry.locals);
+        return;
+    }
+
     // read the file content
     wxString content;
     if(FileUtils::ReadFileContent(req->getFile(), content)) {
@@ -725,10 +730,6 @@ void ParseThread::ProcessColourRequest(ParseRequest* req)
             return;
         }
 
-        // Open the database
-        ITagsStoragePtr db(new TagsStorageSQLite());
-        db->OpenDatabase(req->getDbfile());
-
         std::vector<wxString> nonWorkspaceSymbols, workspaceSymbols;
         db->RemoveNonWorkspaceSymbols(tokensArr, workspaceSymbols, nonWorkspaceSymbols);
 
@@ -738,15 +739,26 @@ void ParseThread::ProcessColourRequest(ParseRequest* req)
         std::for_each(nonWorkspaceSymbols.begin(), nonWorkspaceSymbols.end(),
                       [&](const wxString& token) { flatStrLocals << token << " "; });
 
-        if(req->_evtHandler) {
-            clCommandEvent event(wxEVT_PARSE_THREAD_SUGGEST_COLOUR_TOKENS);
-            wxArrayString res;
-            res.Add(flatClasses);
-            res.Add(flatStrLocals);
-            event.SetStrings(res);
-            event.SetFileName(req->getFile());
-            req->_evtHandler->AddPendingEvent(event);
+        if(hasHash) {
+            cacheEntry.classes = flatClasses;
+            cacheEntry.locals = flatStrLocals;
+            clSemanticHighlightCache::Save(req->getFile(), cacheEntry);
         }
+
+        DoNotifyColourTokens(req, flatClasses, flatStrLocals);
+    }
+}
+
+void ParseThread::DoNotifyColourTokens(ParseRequest* req, const wxString& classes, const wxString& locals)
+{
+    if(req->_evtHandler) {
+        clCommandEvent event(wxEVT_PARSE_THREAD_SUGGEST_COLOUR_TOKENS);
+        wxArrayString res;
+        res.Add(classes);
+        res.Add(locals);
+        event.SetStrings(res);
+        event.SetFileName(req->getFile());
+        req->_evtHandler->AddPendingEvent(event);
     }
 }
 
@@ -181,7 +181,12 @@ private:
     void ProcessSimpleNoIncludes(ParseRequest* req);
     void ProcessIncludeStatements(ParseRequest* req);
     void ProcessColourRequest(ParseRequest* req);
+    void DoNotifyColourTokens(ParseRequest* req, const wxString& classes, const wxString& locals);
     void GetFileListToParse(const wxString& filename, wxArrayString& arrFiles);
+    /**
+     * @brief convert a file into tags, using the parse result cache when the same content was already parsed
+     */
+    void DoSourceToTags(const wxString& filename, wxString& tags);
     void ParseAndStoreFiles(ParseRequest* req, const wxArrayString& arrFiles, int initalCount, ITagsStoragePtr db);
 
     void FindIncludedFiles(ParseRequest* req, std::set<wxString>* newSet);
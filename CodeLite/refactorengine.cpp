@@ -30,15 +30,62 @@
 #include "fileextmanager.h"
 #include "event_notifier.h"
 #include "search_thread.h"
+#include "clParallel.h"
+#include "file_logger.h"
+#include <wx/ffile.h>
+#include <wx/stopwatch.h>
 #if wxUSE_GUI
 #include <wx/progdlg.h>
 #include <wx/sizer.h>
 #include "progress_dialog.h"
 #endif
 
+wxDEFINE_EVENT(wxEVT_REFACTOR_ENGINE_REFERENCES_STARTED, clRefactoringEvent);
+wxDEFINE_EVENT(wxEVT_REFACTOR_ENGINE_REFERENCES_PARTIAL, clRefactoringEvent);
 wxDEFINE_EVENT(wxEVT_REFACTOR_ENGINE_REFERENCES, clRefactoringEvent);
 wxDEFINE_EVENT(wxEVT_REFACTOR_ENGINE_RENAME_SYMBOL, clRefactoringEvent);
 
+// the time the main thread spends resolving matches before giving the UI a chance to run
+static const long RESOLVE_SLICE_MS = 50;
+
+/**
+ * @brief collect the names (without the path) of the files included by 'filename'. Return false if the file
+ * includes a macro (#include MACRO), in which case the includes can't be known from the text
+ */
+static bool ReadIncludes(const wxString& filename, wxArrayString& includes)
+{
+    wxFFile fp(filename, "rb");
+    if(!fp.IsOpened()) { return true; }
+    std::string content((size_t)fp.Length(), '\0');
+    content.resize(fp.Read(&content[0], content.length()));
+
+    size_t pos = 0;
+    while(pos < content.length()) {
+        size_t eol = content.find('\n', pos);
+        if(eol == std::string::npos) { eol = content.length(); }
+        // # include "file" or <file>
+        size_t i = content.find_first_not_of(" \t", pos);
+        if(i < eol && content[i] == '#') {
+            i = content.find_first_not_of(" \t", i + 1);
+            if(i < eol && content.compare(i, 7, "include") == 0) {
+                i = content.find_first_not_of(" \t", i + 7);
+                if(i < eol && (content[i] == '"' || content[i] == '<')) {
+                    size_t close = content.find_first_of(content[i] == '"' ? "\"" : ">", i + 1);
+                    if(close < eol) {
+                        size_t start = content.find_last_of("/\\", close);
+                        start = (start == std::string::npos || start < i) ? i + 1 : start + 1;
+                        includes.Add(wxString(content.c_str() + start, wxConvISO8859_1, close - start));
+                    }
+                } else if(i < eol) {
+                    return false;
+                }
+            }
+        }
+        pos = eol + 1;
+    }
+    return true;
+}
+
 RefactoringEngine::RefactoringEngine()
 {
     Bind(wxEVT_SEARCH_THREAD_MATCHFOUND, &RefactoringEngine::OnSearchMatch, this);
@@ -51,6 +98,7 @@ RefactoringEngine::RefactoringEngine()
 
 RefactoringEngine::~RefactoringEngine()
 {
+    DoCleanup();
     wxDELETE(m_seartchThread);
     Unbind(wxEVT_SEARCH_THREAD_MATCHFOUND, &RefactoringEngine::OnSearchMatch, this);
     Unbind(wxEVT_SEARCH_THREAD_SEARCHEND, &RefactoringEngine::OnSearchEnded, this);
@@ -349,6 +397,16 @@ void RefactoringEngine::DoFindReferences(const wxString& symname, const wxFileNa
     m_refactorSource.Reset();
     if(!DoResolveWord(states, fn, pos + symname.Len(), line, symname, &m_refactorSource)) return;
 
+    // a reference to a member is only possible from a file that includes the class declaration. Classes and globals
+    // can be forward / extern declared anywhere, so they are not filtered
+    if(!m_refactorSource.isClass && !m_refactorSource.scope.IsEmpty() && m_refactorSource.scope != "<global>") {
+        std::vector<TagEntryPtr> tags;
+        TagsManagerST::Get()->FindByNameAndScope(m_refactorSource.name, m_refactorSource.scope, tags);
+        for(size_t i = 0; i < tags.size(); ++i) {
+            m_declarationFiles.insert(tags[i]->GetFile());
+        }
+    }
+
     // Now that we got here, ask the search thread to search for this symbol in the list of input files
     SearchData sd;
     sd.SetFindString(symname);
@@ -359,9 +417,10 @@ void RefactoringEngine::DoFindReferences(const wxString& symname, const wxFileNa
     wxArrayString filesArray;
     filesArray.reserve(files.size());
     for(const wxFileName& fn : files) {
-        if(fn.GetFullPath() == "sqlite3.c") { continue; }
+        if(fn.GetFullName() == "sqlite3.c") { continue; }
         filesArray.Add(fn.GetFullPath());
     }
+    m_files = filesArray;
 
     sd.SetFiles(filesArray);
     sd.SetOwner(this); // send back the events here
@@ -423,7 +482,7 @@ TagEntryPtr RefactoringEngine::SyncSignature(const wxFileName& fn, int line, int
 
 void RefactoringEngine::OnSearchStarted(wxCommandEvent& event) { wxUnusedVar(event); }
 
-void RefactoringEngine::OnSearchEnded(wxCommandEvent& event) { DoCompleteFindReferences(); }
+void RefactoringEngine::OnSearchEnded(wxCommandEvent& event) { DoStartScan(); }
 
 void RefactoringEngine::OnSearchMatch(wxCommandEvent& event)
 {
@@ -441,77 +500,270 @@ void RefactoringEngine::OnSearchMatch(wxCommandEvent& event)
     wxDELETE(res);
 }
 
-void RefactoringEngine::DoCompleteFindReferences()
+void RefactoringEngine::DoStartScan()
 {
-    ScopeCleaner cleaner; // ensure that DoCleanup is called when leave this scope
-
-    // Load all tokens, first we need to parse the workspace files...
-    CppToken::Vec_t tokens = std::move(m_tokens);
-
-    RefactorSource target;
-    int counter(0);
+    if(m_currentAction == kNone) { return; }
+
+    // group the matches by file, keeping the search order
+    ++m_generation;
+    std::vector<RefactorFileScan*> files;
+    std::unordered_map<wxString, RefactorFileScan*> fileScans;
+    for(const CppToken& token : m_tokens) {
+        RefactorFileScan*& scan = fileScans[token.getFilename()];
+        if(!scan) {
+            scan = new RefactorFileScan();
+            scan->generation = m_generation;
+            scan->index = files.size();
+            scan->filename = token.getFilename().c_str(); // used by the scanner thread, make our own copy
+            files.push_back(scan);
+        }
+        scan->tokens.push_back(token);
+    }
+    m_tokens.clear();
+    m_filesTotal = files.size();
+    m_filesResolved = 0;
+    m_scannedFiles.assign(files.size(), nullptr);
+    m_scanCompleted = false;
+
+    if(m_currentAction == kFindReferences) {
+        clRefactoringEvent event(wxEVT_REFACTOR_ENGINE_REFERENCES_STARTED);
+        event.SetString(m_symbolName);
+        EventNotifier::Get()->AddPendingEvent(event);
+    }
 
-    TextStatesPtr statesPtr(NULL);
-    wxString statesPtrFileName;
 #if wxUSE_GUI
-    clProgressDlg* prgDlg = CreateProgressDialog(_("Parsing matches..."), (int)tokens.size());
+    m_progressDlg = CreateProgressDialog(_("Parsing matches..."), std::max<int>(m_filesTotal, 1));
 #endif
-    for(CppToken& token : tokens) {
-        wxFileName f(token.getFilename());
+
+    // The includes are only followed through the searched files: a class declared outside of the workspace (e.g.
+    // wxFrame) is reached through headers that are not searched, so its members are not filtered
+    wxStringSet_t searchedFiles(m_files.begin(), m_files.end());
+    for(const wxString& file : m_declarationFiles) {
+        if(searchedFiles.count(file) == 0) {
+            m_declarationFiles.clear();
+            break;
+        }
+    }
+
+    // the headers are needed to follow the includes from the declaration files
+    wxArrayString headers;
+    if(!m_declarationFiles.empty()) {
+        for(const wxString& file : m_files) {
+            if(FileExtManager::GetType(file) == FileExtManager::TypeHeader) { headers.Add(file.c_str()); }
+        }
+    }
+    wxStringSet_t declarationFiles;
+    for(const wxString& file : m_declarationFiles) {
+        declarationFiles.insert(file.c_str());
+    }
+
+    m_cancelScan = false;
+    m_scanThread = new std::thread(&RefactoringEngine::DoScanFiles, this, m_generation, std::move(files),
+                                   std::move(headers), std::move(declarationFiles));
+}
+
+void RefactoringEngine::DoScanFiles(size_t generation, std::vector<RefactorFileScan*> files, wxArrayString headers,
+                                    wxStringSet_t declarationFiles)
+{
+    bool filter = !declarationFiles.empty();
+    wxStringSet_t visibleFiles;
+    if(filter) {
+        for(RefactorFileScan* scan : files) {
+            headers.Add(scan->filename);
+        }
+        filter = DoGetIncludingFiles(headers, declarationFiles, visibleFiles);
+    }
+
+    clParallelFor(files.size(), [&](size_t i) {
+        RefactorFileScan* scan = files[i];
+        if(m_cancelScan) {
+            wxDELETE(scan);
+            return;
+        }
+
+        if(filter && visibleFiles.count(scan->filename) == 0) {
+            // the file doesn't seem to see the declaration of the symbol, no need to resolve its matches. The
+            // include scan can't follow forced includes or headers outside of the searched files, so the matches
+            // are still offered as possible matches
+            scan->unreachable.swap(scan->tokens);
+
+        } else {
+            CppWordScanner scanner(scan->filename);
+            scan->states = scanner.states();
+            CppToken::Vec_t tokens;
+            tokens.swap(scan->tokens);
+            if(scan->states) {
+                const std::vector<ByteState>& states = scan->states->states;
+                for(CppToken& token : tokens) {
+                    size_t offset = token.getOffset();
+                    if(offset < states.size()) {
+                        token.setLineNumber(states[offset].lineNo);
+                        // a match inside a comment or a string is not a reference
+                        short state = states[offset].state;
+                        if(state != CppWordScanner::STATE_NORMAL && state != CppWordScanner::STATE_PRE_PROCESSING) {
+                            scan->possible.push_back(token);
+                            continue;
+                        }
+                    }
+                    scan->tokens.push_back(token);
+                }
+            }
+        }
+        CallAfter(&RefactoringEngine::OnFileScanned, scan);
+    });
+    CallAfter(&RefactoringEngine::OnScanCompleted, generation);
+}
+
+bool RefactoringEngine::DoGetIncludingFiles(const wxArrayString& files, const wxStringSet_t& declarationFiles,
+                                            wxStringSet_t& visibleFiles)
+{
+    std::vector<wxArrayString> includes(files.size());
+    std::atomic_bool complete{ true };
+    clParallelFor(files.size(), [&](size_t i) {
+        if(!m_cancelScan && !ReadIncludes(files.Item(i), includes[i])) { complete = false; }
+    });
+    if(!complete) {
+        clDEBUG() << "Find references: a file includes a macro, the matches are not filtered by includes" << clEndl;
+        return false;
+    }
+
+    // included file name -> the files including it
+    std::unordered_map<wxString, std::vector<size_t> > includedBy;
+    for(size_t i = 0; i < includes.size(); ++i) {
+        for(const wxString& include : includes[i]) {
+            includedBy[include].push_back(i);
+        }
+    }
+
+    // the files are matched by name only, so a few extra files may be resolved. Only the includes of the searched
+    // files are followed, the caller makes sure that the declaration files are among them
+    visibleFiles = declarationFiles;
+    std::vector<wxString> queue(declarationFiles.begin(), declarationFiles.end());
+    while(!queue.empty()) {
+        wxString name = wxFileName(queue.back()).GetFullName();
+        queue.pop_back();
+        std::unordered_map<wxString, std::vector<size_t> >::const_iterator iter = includedBy.find(name);
+        if(iter == includedBy.end()) { continue; }
+        for(size_t index : iter->second) {
+            if(visibleFiles.insert(files.Item(index)).second) { queue.push_back(files.Item(index)); }
+        }
+    }
+    return true;
+}
+
+void RefactoringEngine::OnFileScanned(RefactorFileScan* scan)
+{
+    if(scan->generation != m_generation || m_currentAction == kNone) {
+        // a result of a cancelled request
+        wxDELETE(scan);
+        return;
+    }
+    // the files are resolved (and reported) in the search order, not in the order the scanner completes them
+    m_scannedFiles[scan->index] = scan;
+    DoScheduleResolve();
+}
+
+void RefactoringEngine::OnScanCompleted(size_t generation)
+{
+    if(generation != m_generation || m_currentAction == kNone) { return; }
+    m_scanCompleted = true;
+    DoScheduleResolve();
+}
+
+void RefactoringEngine::DoScheduleResolve()
+{
+    if(m_resolving || m_resolveScheduled) { return; }
+    m_resolveScheduled = true;
+    CallAfter(&RefactoringEngine::DoResolveSlice);
+}
+
+void RefactoringEngine::DoResolveSlice()
+{
+    m_resolveScheduled = false;
+    if(m_currentAction == kNone) { return; }
+
+    // The expression resolver (Language / TagsManager) is not thread safe, so the matches are resolved here. Work
+    // in slices so the confirmed matches reach the UI while the remaining files are being resolved
+    m_resolving = true;
+    wxStopWatch sw;
+    while(m_filesResolved < m_scannedFiles.size() && m_scannedFiles[m_filesResolved] &&
+          sw.Time() < RESOLVE_SLICE_MS) {
+        RefactorFileScan* scan = m_scannedFiles[m_filesResolved];
+        if(scan->next == 0) { scan->firstMatch = m_candidates.size(); }
+        while(scan->next < scan->tokens.size() && sw.Time() < RESOLVE_SLICE_MS) {
+            DoResolveToken(scan, scan->tokens[scan->next++]);
+        }
+        if(scan->next < scan->tokens.size()) { break; }
+
+        // the file is completed
+        if(!m_onlyDefiniteMatches) {
+            m_possibleCandidates.insert(m_possibleCandidates.end(), scan->possible.begin(), scan->possible.end());
+        }
+        m_possibleCandidates.insert(m_possibleCandidates.end(), scan->unreachable.begin(), scan->unreachable.end());
+        if(m_currentAction == kFindReferences && scan->firstMatch < m_candidates.size()) {
+            clRefactoringEvent event(wxEVT_REFACTOR_ENGINE_REFERENCES_PARTIAL);
+            event.SetMatches(CppToken::Vec_t(m_candidates.begin() + scan->firstMatch, m_candidates.end()));
+            event.SetString(m_symbolName);
+            EventNotifier::Get()->AddPendingEvent(event);
+        }
+        m_scannedFiles[m_filesResolved] = nullptr;
+        wxDELETE(scan);
+        ++m_filesResolved;
+    }
+
 #if wxUSE_GUI
+    if(m_progressDlg) {
         wxString msg;
-        msg << _("Parsing expression ") << counter << wxT("/") << tokens.size() << _(" in file: ") << f.GetFullName();
-        if(!prgDlg->Update(counter, msg)) {
+        msg << _("Parsing matches: ") << m_filesResolved << wxT("/") << m_filesTotal << _(" files");
+        if(!m_progressDlg->Update(m_filesResolved, msg)) {
             // user clicked 'Cancel'
             Clear();
-            prgDlg->Destroy();
             return;
         }
+    }
 #endif
-        counter++;
-        // reset the result
-        target.Reset();
-
-        if(!statesPtr || statesPtrFileName != token.getFilename()) {
-            // Create new statesPtr
-            CppWordScanner sc(token.getFilename());
-            statesPtr = sc.states();
-            statesPtrFileName = token.getFilename();
-        }
-
-        if(!statesPtr) continue;
 
-        if(DoResolveWord(statesPtr, wxFileName(token.getFilename()), token.getOffset(), token.getLineNumber(),
-                         m_symbolName, &target)) {
+    m_resolving = false;
+    if(m_filesResolved < m_scannedFiles.size()) {
+        // either the slice is over, or the next file is still being scanned (OnFileScanned will schedule us)
+        if(m_scannedFiles[m_filesResolved]) { DoScheduleResolve(); }
+    } else if(m_scanCompleted) {
+        DoCompleteFindReferences();
+    }
+}
 
-            // set the line number
-            if(statesPtr->states.size() > token.getOffset())
-                token.setLineNumber(statesPtr->states[token.getOffset()].lineNo);
+void RefactoringEngine::DoResolveToken(RefactorFileScan* scan, const CppToken& token)
+{
+    RefactorSource target;
+    if(!scan->states) { return; }
 
-            if(target.name == m_refactorSource.name && target.scope == m_refactorSource.scope) {
-                // full match
-                m_candidates.push_back(token);
+    if(DoResolveWord(scan->states, wxFileName(scan->filename), token.getOffset(), token.getLineNumber(), m_symbolName,
+                     &target)) {
+        if(target.name == m_refactorSource.name && target.scope == m_refactorSource.scope) {
+            // full match
+            m_candidates.push_back(token);
 
-            } else if(target.name == m_refactorSource.scope && !m_refactorSource.isClass) {
-                // source is function, and target is class
-                m_candidates.push_back(token);
+        } else if(target.name == m_refactorSource.scope && !m_refactorSource.isClass) {
+            // source is function, and target is class
+            m_candidates.push_back(token);
 
-            } else if(target.name == m_refactorSource.name && m_refactorSource.isClass) {
-                // source is class, and target is ctor
-                m_candidates.push_back(token);
+        } else if(target.name == m_refactorSource.name && m_refactorSource.isClass) {
+            // source is class, and target is ctor
+            m_candidates.push_back(token);
 
-            } else if(!m_onlyDefiniteMatches) {
-                // add it to the possible match list
-                m_possibleCandidates.push_back(token);
-            }
         } else if(!m_onlyDefiniteMatches) {
-            // resolved word failed, add it to the possible list
+            // add it to the possible match list
             m_possibleCandidates.push_back(token);
         }
+    } else if(!m_onlyDefiniteMatches) {
+        // resolved word failed, add it to the possible list
+        m_possibleCandidates.push_back(token);
     }
-#if wxUSE_GUI
-    prgDlg->Destroy();
-#endif
+}
+
+void RefactoringEngine::DoCompleteFindReferences()
+{
+    ScopeCleaner cleaner; // ensure that DoCleanup is called when leave this scope
 
     clRefactoringEvent event(m_currentAction == kRenameSymbol ? wxEVT_REFACTOR_ENGINE_RENAME_SYMBOL
                                                               : wxEVT_REFACTOR_ENGINE_REFERENCES);
@@ -521,8 +773,32 @@ void RefactoringEngine::DoCompleteFindReferences()
     EventNotifier::Get()->AddPendingEvent(event);
 }
 
+void RefactoringEngine::DoStopScan()
+{
+    if(m_scanThread) {
+        m_cancelScan = true;
+        m_scanThread->join();
+        wxDELETE(m_scanThread);
+    }
+}
+
 void RefactoringEngine::DoCleanup()
 {
+    DoStopScan();
+    for(RefactorFileScan* scan : m_scannedFiles) {
+        wxDELETE(scan);
+    }
+    m_scannedFiles.clear();
+    m_scanCompleted = false;
+    m_resolving = false;
+    m_filesTotal = 0;
+    m_filesResolved = 0;
+#if wxUSE_GUI
+    if(m_progressDlg) {
+        m_progressDlg->Destroy();
+        m_progressDlg = nullptr;
+    }
+#endif
     m_possibleCandidates.clear();
     m_candidates.clear();
     m_currentAction = kNone;
@@ -530,4 +806,6 @@ void RefactoringEngine::DoCleanup()
     m_onlyDefiniteMatches = false;
     m_symbolName.Clear();
     m_tokens.clear();
+    m_files.Clear();
+    m_declarationFiles.clear();
 }
@@ -28,6 +28,8 @@
 
 #include <wx/event.h>
 #include <wx/filename.h>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <list>
 #include "entry.h"
@@ -35,6 +37,7 @@
 #include "cpptoken.h"
 #include "codelite_exports.h"
 #include "cl_command_event.h"
+#include "macros.h"
 
 class SearchThread;
 class clProgressDlg;
@@ -63,6 +66,23 @@ struct RefactorSource {
 
 //-----------------------------------------------------------------------------------
 
+/**
+ * @brief the textual matches of a single file, prepared by the background scanner
+ */
+struct RefactorFileScan {
+    size_t generation = 0;
+    wxString filename;
+    TextStatesPtr states;
+    CppToken::Vec_t tokens;   // the matches that should be resolved
+    CppToken::Vec_t possible;    // the matches that can't be a reference (comments, strings)
+    CppToken::Vec_t unreachable; // the matches in a file that doesn't seem to include the symbol declaration
+    size_t index = 0;            // the file position in the search results
+    size_t next = 0;             // the next token to resolve
+    size_t firstMatch = 0;       // the index of the file's first confirmed match in the engine candidates
+};
+
+//-----------------------------------------------------------------------------------
+
 // --------------------------------------------------------------
 // Refactoring event
 // --------------------------------------------------------------
@@ -96,6 +116,11 @@ public:
 typedef void (wxEvtHandler::*clRefactoringEventFunction)(clRefactoringEvent&);
 #define clRefactoringEventHandler(func) wxEVENT_HANDLER_CAST(clRefactoringEventFunction, func)
 
+// Find references: sent before the first match is resolved, GetString() is the symbol name
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_REFACTOR_ENGINE_REFERENCES_STARTED, clRefactoringEvent);
+// Find references: the confirmed matches of a single file, sent as soon as the file is resolved
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_REFACTOR_ENGINE_REFERENCES_PARTIAL, clRefactoringEvent);
+// Find references: all the matches
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_REFACTOR_ENGINE_REFERENCES, clRefactoringEvent);
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_REFACTOR_ENGINE_RENAME_SYMBOL, clRefactoringEvent);
 
@@ -117,7 +142,24 @@ class WXDLLIMPEXP_CL RefactoringEngine : public wxEvtHandler
     bool m_onlyDefiniteMatches = false;
     friend class ScopeCleaner;
     SearchThread* m_seartchThread = nullptr;
-    
+    wxArrayString m_files;
+    // the files declaring the symbol. When not empty, only the files including them can hold a reference
+    wxStringSet_t m_declarationFiles;
+
+    // the candidate files are scanned in parallel by a background thread, then resolved on the main thread
+    std::thread* m_scanThread = nullptr;
+    std::atomic_bool m_cancelScan{ false };
+    size_t m_generation = 0;
+    std::vector<RefactorFileScan*> m_scannedFiles; // indexed by RefactorFileScan::index, resolved in this order
+    bool m_scanCompleted = false;
+    bool m_resolving = false;
+    bool m_resolveScheduled = false;
+    size_t m_filesTotal = 0;
+    size_t m_filesResolved = 0;
+#if wxUSE_GUI
+    clProgressDlg* m_progressDlg = nullptr;
+#endif
+
     class ScopeCleaner
     {
     public:
@@ -137,6 +179,32 @@ protected:
                           bool onlyDefiniteMatches, eActionType type);
     void DoCompleteFindReferences();
     void DoCleanup();
+    void DoStopScan();
+
+    /**
+     * @brief start the background scan of the files that have textual matches
+     */
+    void DoStartScan();
+
+    /**
+     * @brief background thread: compute the states of every candidate file (in parallel) and drop the matches that
+     * can't be references. The files are delivered one by one with OnFileScanned
+     */
+    void DoScanFiles(size_t generation, std::vector<RefactorFileScan*> files, wxArrayString headers,
+                     wxStringSet_t declarationFiles);
+
+    /**
+     * @brief collect in 'visibleFiles' the files (full path) that include - directly or not - one of
+     * 'declarationFiles'. Return false if the includes can't be trusted (#include MACRO). Runs on the scanner thread
+     */
+    bool DoGetIncludingFiles(const wxArrayString& files, const wxStringSet_t& declarationFiles,
+                             wxStringSet_t& visibleFiles);
+
+    void OnFileScanned(RefactorFileScan* scan);
+    void OnScanCompleted(size_t generation);
+    void DoScheduleResolve();
+    void DoResolveSlice();
+    void DoResolveToken(RefactorFileScan* scan, const CppToken& token);
 
 private:
     RefactoringEngine();
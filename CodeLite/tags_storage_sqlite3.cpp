@@ -22,33 +22,230 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
+#include "clSqliteQueryStats.h"
 #include "file_logger.h"
 #include "fileutils.h"
 #include "precompiled_header.h"
 #include "tags_storage_sqlite3.h"
 #include <algorithm>
+#include <mutex>
 #include <wx/longlong.h>
+#include <wx/thread.h>
 #include <wx/tokenzr.h>
 
+// In WAL mode the readers are never blocked, only a writer waits for the other writer to commit. The main thread
+// does not wait for long: a busy database must not freeze the UI behind a long parser transaction
+static const int BUSY_TIMEOUT_MS = 2000;
+static const int BUSY_TIMEOUT_MAIN_THREAD_MS = 10;
+
+// Longer IN lists are added to the query as literals (SQLite limits the number of parameters to 999)
+static const size_t MAX_ARG_LIST = 256;
+
+// The tags cache keeps at most this many TagEntry objects alive (the other entries are kept in their compact form).
+// A larger entry is converted on every hit and never kept
+static const size_t MAX_MATERIALIZED_TAGS = 10000;
+
+// The strings of the replaced tags cache entries are dropped once they use at least half of the store
+static const size_t MIN_GARBAGE_TO_COMPACT = 1024 * 1024;
+
+// The kinds of the symbols that RemoveNonWorkspaceSymbols() reports
+static const char* WORKSPACE_SYMBOL_KINDS =
+    "('class', 'enum', 'cenum', 'prototype', 'macro', 'namespace', 'function', 'struct','typedef')";
+
+namespace
+{
+struct Connection {
+    std::shared_ptr<clSqliteDB> db;
+    size_t generation = 0;
+};
+typedef std::unordered_map<wxString, Connection> ConnectionMap_t;
+
+ConnectionMap_t& GetThreadConnections()
+{
+    // SQLite connections are not shared between threads: each thread has its own connection to each database,
+    // which is closed when the thread exits
+    static thread_local ConnectionMap_t connections;
+    return connections;
+}
+
+std::mutex s_generationsMutex;
+std::unordered_map<wxString, size_t> s_generations;
+
+size_t GetGeneration(const wxString& path)
+{
+    std::lock_guard<std::mutex> lock(s_generationsMutex);
+    return s_generations[path];
+}
+
+/**
+ * @brief invalidate the connections of all the threads to 'path', they are re-opened on their next OpenDatabase()
+ */
+void BumpGeneration(const wxString& path)
+{
+    std::lock_guard<std::mutex> lock(s_generationsMutex);
+    ++s_generations[path];
+}
+} // namespace
+
+//-------------------------------------------------
+// clSqliteQuery
+//-------------------------------------------------
+clSqliteQuery& clSqliteQuery::AddArg(const wxString& value)
+{
+    Arg arg;
+    arg.str = value;
+    m_args.push_back(arg);
+    m_sql << "?";
+    if(!m_cacheable) { m_statsSql << "?"; }
+    return *this;
+}
+
+clSqliteQuery& clSqliteQuery::AddArg(int value)
+{
+    Arg arg;
+    arg.num = value;
+    arg.isNumber = true;
+    m_args.push_back(arg);
+    m_sql << "?";
+    if(!m_cacheable) { m_statsSql << "?"; }
+    return *this;
+}
+
+clSqliteQuery& clSqliteQuery::AddArgList(const wxArrayString& values)
+{
+    if(values.size() > MAX_ARG_LIST) {
+        // a statement with so many values is not worth keeping
+        if(m_cacheable) { m_statsSql = m_sql; }
+        m_cacheable = false;
+        m_statsSql << "<literal list>";
+        for(size_t i = 0; i < values.size(); ++i) {
+            wxString value = values.Item(i);
+            value.Replace("'", "''");
+            m_sql << (i ? ",'" : "'") << value << "'";
+        }
+        return *this;
+    }
+
+    size_t count = 1;
+    while(count < values.size()) {
+        count *= 2;
+    }
+    for(size_t i = 0; i < count; ++i) {
+        if(i) { m_sql << ","; }
+        if(i < values.size()) {
+            AddArg(values.Item(i));
+        } else {
+            // "x IN (.., NULL)" is never true because of the NULL
+            Arg arg;
+            arg.isNull = true;
+            m_args.push_back(arg);
+            m_sql << "?";
+        }
+    }
+    return *this;
+}
+
+wxString clSqliteQuery::GetKey() const
+{
+    wxString key = m_sql;
+    for(const Arg& arg : m_args) {
+        key << "\x01";
+        if(arg.isNumber) {
+            key << arg.num;
+        } else if(!arg.isNull) {
+            key << arg.str;
+        }
+    }
+    return key;
+}
+
+void clSqliteQuery::Bind(wxSQLite3Statement& statement) const
+{
+    for(size_t i = 0; i < m_args.size(); ++i) {
+        const Arg& arg = m_args[i];
+        if(arg.isNull) {
+            statement.BindNull(i + 1);
+        } else if(arg.isNumber) {
+            statement.Bind(i + 1, arg.num);
+        } else {
+            statement.Bind(i + 1, arg.str);
+        }
+    }
+}
+
+//-------------------------------------------------
+// clSqliteDB
+//-------------------------------------------------
+wxSQLite3Statement& clSqliteDB::GetPrepareStatement(const wxString& sql)
+{
+    std::unordered_map<wxString, wxSQLite3Statement>::iterator iter = m_statements.find(sql);
+    if(iter == m_statements.end()) {
+        // the statement is moved into the map
+        iter = m_statements.insert({ sql, PrepareStatement(sql) }).first;
+    } else {
+        try {
+            // reports the error of the previous execution (if it failed), but resets the statement anyway
+            iter->second.Reset();
+        } catch(wxSQLite3Exception& e) {
+            wxUnusedVar(e);
+        }
+        iter->second.ClearBindings();
+    }
+    return iter->second;
+}
+
 //-------------------------------------------------
 // Tags database class implementation
 //-------------------------------------------------
 TagsStorageSQLite::TagsStorageSQLite()
     : ITagsStorage()
+    , m_db(new clSqliteDB())
 {
-    m_db = new clSqliteDB();
     SetUseCache(true);
 }
 
 TagsStorageSQLite::~TagsStorageSQLite()
 {
-    if(m_db) {
-        m_db->Close();
-        delete m_db;
-        m_db = NULL;
+    // the connection is shared with the other storage objects of this thread: don't leave our transaction open on
+    // it, but never roll back a transaction started by another object
+    try {
+        if(m_transactionStarted && m_db->IsOpen() && !m_db->GetAutoCommit()) { m_db->Rollback(); }
+    } catch(wxSQLite3Exception& e) {
+        wxUnusedVar(e);
     }
 }
 
+std::shared_ptr<clSqliteDB> TagsStorageSQLite::DoGetConnection(const wxFileName& fileName)
+{
+    ConnectionMap_t& connections = GetThreadConnections();
+    // close the connections to other databases that are no longer in use
+    for(ConnectionMap_t::iterator iter = connections.begin(); iter != connections.end();) {
+        if(iter->first != fileName.GetFullPath() && iter->second.db.use_count() == 1) {
+            iter = connections.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    size_t generation = GetGeneration(fileName.GetFullPath());
+    Connection& conn = connections[fileName.GetFullPath()];
+    if(!conn.db || conn.generation != generation) {
+        // the database was re-created (or re-opened) by another thread since this connection was opened: don't
+        // reuse it. The users of the old connection keep it until they re-open the database
+        conn.db.reset(new clSqliteDB());
+        conn.generation = generation;
+    }
+
+    std::shared_ptr<clSqliteDB> db = conn.db;
+    if(!db->IsOpen()) {
+        db->Open(fileName.GetFullPath());
+        db->SetBusyTimeout(wxThread::IsMain() ? BUSY_TIMEOUT_MAIN_THREAD_MS : BUSY_TIMEOUT_MS);
+        m_db = db;
+        CreateSchema();
+    }
+    return db;
+}
+
 void TagsStorageSQLite::OpenDatabase(const wxFileName& fileName)
 {
     if(m_fileName.GetFullPath() == fileName.GetFullPath()) return;
@@ -61,25 +258,12 @@ void TagsStorageSQLite::OpenDatabase(const wxFileName& fileName)
     if(!fileName.IsOk()) return;
 
     try {
-        if(!m_fileName.IsOk()) {
-            // First time we open the db
-            m_db->Open(fileName.GetFullPath());
-            m_db->SetBusyTimeout(10);
-            CreateSchema();
-            m_fileName = fileName;
-
-        } else {
-            // We have both fileName & m_fileName and they
-            // are different, Close previous db
-            m_db->Close();
-            m_db->Open(fileName.GetFullPath());
-            m_db->SetBusyTimeout(10);
-            CreateSchema();
-            m_fileName = fileName;
-        }
+        // the previous connection (if any) stays open for the other users of this thread
+        m_db = DoGetConnection(fileName);
+        m_fileName = fileName;
 
     } catch(wxSQLite3Exception& e) {
-        clWARNING() << "Failed to open file:" << m_fileName.GetFullPath() << "." << e.GetMessage();
+        clWARNING() << "Failed to open file:" << fileName.GetFullPath() << "." << e.GetMessage();
     }
 }
 
@@ -91,7 +275,8 @@ void TagsStorageSQLite::CreateSchema()
     // (this needs to be done before the creation of the
     // tables and indices)
     try {
-        sql = wxT("PRAGMA journal_mode= OFF;");
+        // WAL: the readers (the UI thread) are not blocked while the parser thread writes
+        sql = wxT("PRAGMA journal_mode= WAL;");
         m_db->ExecuteUpdate(sql);
 
         sql = wxT("PRAGMA synchronous = OFF;");
@@ -188,6 +373,15 @@ void TagsStorageSQLite::CreateSchema()
         sql = wxString(wxT("replace into tags_version values ('")) << GetVersion() << wxT("');");
         m_db->ExecuteUpdate(sql);
 
+        // The tags generation. It starts from the current time, so a new database does not repeat the generations
+        // of the one it replaces
+        sql = wxT("create table if not exists tags_generation (id integer primary key, generation integer);");
+        m_db->ExecuteUpdate(sql);
+
+        sql = wxString(wxT("insert or ignore into tags_generation values (1, "))
+              << wxGetUTCTimeMillis().ToString() << wxT(");");
+        m_db->ExecuteUpdate(sql);
+
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
     }
@@ -195,54 +389,48 @@ void TagsStorageSQLite::CreateSchema()
 
 void TagsStorageSQLite::RecreateDatabase()
 {
+    if(!m_fileName.IsOk()) return;
+
     try {
         // commit any open transactions
         Commit();
 
-        // Close the database
-        m_db->Close();
-        wxString filename = m_fileName.GetFullPath();
-        if(clRemoveFile(m_fileName.GetFullPath()) == false) {
-
-            // re-open the database
-            m_fileName.Clear();
-            OpenDatabase(filename);
-
-            // and drop tables
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS TAGS"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS COMMENTS"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS TAGS_VERSION"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS VARIABLES"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS FILES"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS MACROS"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS SIMPLE_MACROS"));
-            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS GLOBAL_TAGS"));
-
-            // drop indexes
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS FILES_NAME"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_UNIQ"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS KIND_IDX"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS FILE_IDX"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_NAME"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_SCOPE"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_PATH"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_PARENT"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS tags_version_uniq"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS MACROS_UNIQ"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS MACROS_NAME"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS SIMPLE_MACROS_FILE"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS GLOBAL_TAGS_IDX_1"));
-            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS GLOBAL_TAGS_IDX_2"));
-
-            // Recreate the schema
-            CreateSchema();
-        } else {
-            // We managed to delete the file
-            // re-open it
+        // Never delete the file of a WAL database: the connections of the other threads (e.g. the parser thread)
+        // would keep writing into the deleted file, and the new database would pick up the left over -wal and -shm
+        // files. Drop the tables instead
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS TAGS"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS COMMENTS"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS TAGS_VERSION"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS VARIABLES"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS FILES"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS MACROS"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS SIMPLE_MACROS"));
+        m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS GLOBAL_TAGS"));
+
+        // drop indexes
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS FILES_NAME"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_UNIQ"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS KIND_IDX"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS FILE_IDX"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_NAME"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_SCOPE"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_PATH"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_PARENT"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS tags_version_uniq"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS MACROS_UNIQ"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS MACROS_NAME"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS SIMPLE_MACROS_FILE"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS GLOBAL_TAGS_IDX_1"));
+        m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS GLOBAL_TAGS_IDX_2"));
+
+        // Recreate the schema
+        CreateSchema();
+        IncrementTagsGeneration();
+
+        // the other threads re-open their connections (and drop their prepared statements) on the next use
+        BumpGeneration(m_fileName.GetFullPath());
+        m_db = DoGetConnection(m_fileName);
 
-            m_fileName.Clear();
-            OpenDatabase(filename);
-        }
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
     }
@@ -291,6 +479,7 @@ void TagsStorageSQLite::Store(TagTreePtr tree, const wxFileName& path, bool auto
 
             DoInsertTagEntry(walker.GetNode()->GetData());
         }
+        IncrementTagsGeneration();
 
         if(autoCommit) m_db->Commit();
 
@@ -310,15 +499,15 @@ void TagsStorageSQLite::SelectTagsByFile(const wxString& file, std::vector<TagEn
     path.IsOk() == false ? databaseFileName = m_fileName : databaseFileName = path;
     OpenDatabase(databaseFileName);
 
-    wxString query;
-    query << wxT("select * from tags where file='") << file << "' ";
+    clSqliteQuery query("select * from tags where file=");
+    query.AddArg(file);
     //#ifdef __WXMSW__
     //    // Under Windows, the file-crawler changes the file path
     //    // to lowercase. However, the database matches the file name
     //    // by case-sensitive
     //    query << "COLLATE NOCASE ";
     //#endif
-    query << wxT("order by line asc");
+    query << " order by line asc";
     DoFetchTags(query, tags);
 }
 
@@ -328,11 +517,12 @@ void TagsStorageSQLite::DeleteByFileName(const wxFileName& path, const wxString&
     try {
         OpenDatabase(path);
 
-        if(autoCommit) { m_db->Begin(); }
+        if(autoCommit) { m_db->Begin(WXSQLITE_TRANSACTION_IMMEDIATE); }
 
-        wxString sql;
-        sql << "delete from tags where File='" << fileName << "'";
-        m_db->ExecuteUpdate(sql);
+        clSqliteQuery query("delete from tags where File=");
+        query.AddArg(fileName);
+        DoExecuteUpdate(query);
+        IncrementTagsGeneration();
 
         if(autoCommit) m_db->Commit();
     } catch(wxSQLite3Exception& e) {
@@ -354,6 +544,55 @@ wxSQLite3ResultSet TagsStorageSQLite::Query(const wxString& sql, const wxFileNam
     return wxSQLite3ResultSet();
 }
 
+void TagsStorageSQLite::DoQuery(const clSqliteQuery& query, const std::function<bool(wxSQLite3ResultSet&)>& onRow)
+{
+    clSqliteQueryStats::Scope stats(query.GetStatsSql());
+    wxSQLite3Statement uncachedStatement;
+    wxSQLite3Statement* statement = nullptr;
+    try {
+        if(query.IsCacheable()) {
+            statement = &m_db->GetPrepareStatement(query.GetSql());
+        } else {
+            uncachedStatement = m_db->PrepareStatement(query.GetSql());
+            statement = &uncachedStatement;
+        }
+        query.Bind(*statement);
+
+        wxSQLite3ResultSet rs = statement->ExecuteQuery();
+        while(rs.NextRow()) {
+            if(!onRow(rs)) { break; }
+        }
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Query error:" << query.GetSql() << "." << e.GetMessage();
+        if(e.GetMessage().Contains("disk I/O error")) {
+            ReOpenDatabase();
+            return;
+        }
+    }
+
+    if(statement) {
+        try {
+            statement->Reset();
+        } catch(wxSQLite3Exception& e) {
+            wxUnusedVar(e);
+        }
+    }
+}
+
+void TagsStorageSQLite::DoExecuteUpdate(const clSqliteQuery& query)
+{
+    clSqliteQueryStats::Scope stats(query.GetStatsSql());
+    if(query.IsCacheable()) {
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(query.GetSql());
+        query.Bind(statement);
+        statement.ExecuteUpdate();
+    } else {
+        wxSQLite3Statement statement = m_db->PrepareStatement(query.GetSql());
+        query.Bind(statement);
+        statement.ExecuteUpdate();
+    }
+}
+
 void TagsStorageSQLite::ExecuteUpdate(const wxString& sql)
 {
     try {
@@ -367,75 +606,64 @@ const bool TagsStorageSQLite::IsOpen() const { return m_db->IsOpen(); }
 
 void TagsStorageSQLite::GetFilesForCC(const wxString& userTyped, wxArrayString& matches)
 {
-    try {
-        wxString query;
-        wxString tmpName(userTyped);
-
-        // Files are kept in native format in the database
-        // so it only makes sense to search them with the correct path
-        // separator
-        tmpName.Replace("\\", "/");
-        tmpName.Replace("/", wxString() << wxFILE_SEP_PATH);
-        tmpName.Replace(wxT("_"), wxT("^_"));
-        query << wxT("select * from files where file like '%%") << tmpName << wxT("%%' ESCAPE '^' ")
-              << wxT("order by file");
-
-        wxString pattern = userTyped;
-        pattern.Replace("\\", "/");
-
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
-        while(res.NextRow()) {
-            // Keep the part from where the user typed and until the end of the file name
-            wxString matchedFile = res.GetString(1);
-            matchedFile.Replace("\\", "/");
-
-            int where = matchedFile.Find(pattern);
-            if(where == wxNOT_FOUND) continue;
-            matchedFile = matchedFile.Mid(where);
-            matches.Add(matchedFile);
-        }
+    wxString tmpName(userTyped);
 
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+    // Files are kept in native format in the database
+    // so it only makes sense to search them with the correct path
+    // separator
+    tmpName.Replace("\\", "/");
+    tmpName.Replace("/", wxString() << wxFILE_SEP_PATH);
+    tmpName.Replace(wxT("_"), wxT("^_"));
+
+    clSqliteQuery query("select * from files where file like ");
+    query.AddArg("%" + tmpName + "%");
+    query << " ESCAPE '^' order by file";
+
+    wxString pattern = userTyped;
+    pattern.Replace("\\", "/");
+
+    DoQuery(query, [&](wxSQLite3ResultSet& res) {
+        // Keep the part from where the user typed and until the end of the file name
+        wxString matchedFile = res.GetString(1);
+        matchedFile.Replace("\\", "/");
+
+        int where = matchedFile.Find(pattern);
+        if(where != wxNOT_FOUND) { matches.Add(matchedFile.Mid(where)); }
+        return true;
+    });
 }
 
 void TagsStorageSQLite::GetFiles(const wxString& partialName, std::vector<FileEntryPtr>& files)
 {
-    try {
-        bool match_path = (!partialName.IsEmpty() && partialName.Last() == wxFileName::GetPathSeparator());
+    bool match_path = (!partialName.IsEmpty() && partialName.Last() == wxFileName::GetPathSeparator());
 
-        wxString query;
-        wxString tmpName(partialName);
-        tmpName.Replace(wxT("_"), wxT("^_"));
-        query << wxT("select * from files where file like '%%") << tmpName << wxT("%%' ESCAPE '^' ")
-              << wxT("order by file");
-
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
-        while(res.NextRow()) {
+    wxString tmpName(partialName);
+    tmpName.Replace(wxT("_"), wxT("^_"));
+    clSqliteQuery query("select * from files where file like ");
+    query.AddArg("%" + tmpName + "%");
+    query << " ESCAPE '^' order by file";
 
-            FileEntryPtr fe(new FileEntry());
-            fe->SetId(res.GetInt(0));
-            fe->SetFile(res.GetString(1));
-            fe->SetLastRetaggedTimestamp(res.GetInt(2));
+    DoQuery(query, [&](wxSQLite3ResultSet& res) {
+        FileEntryPtr fe(new FileEntry());
+        fe->SetId(res.GetInt(0));
+        fe->SetFile(res.GetString(1));
+        fe->SetLastRetaggedTimestamp(res.GetInt(2));
 
-            wxFileName fileName(fe->GetFile());
-            wxString match = match_path ? fileName.GetFullPath() : fileName.GetFullName();
+        wxFileName fileName(fe->GetFile());
+        wxString match = match_path ? fileName.GetFullPath() : fileName.GetFullName();
 
 // Under Windows, all files are stored as lower case in the
 // database (see fc_fileopener.cpp normalize_path method
 #ifdef __WXMSW__
-            wxString lowerCasePartialName(partialName);
-            lowerCasePartialName.MakeLower();
-            match.MakeLower();
+        wxString lowerCasePartialName(partialName);
+        lowerCasePartialName.MakeLower();
+        match.MakeLower();
 #else
-            wxString lowerCasePartialName(partialName);
+        wxString lowerCasePartialName(partialName);
 #endif
-            if(match.StartsWith(lowerCasePartialName)) { files.push_back(fe); }
-        }
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+        if(match.StartsWith(lowerCasePartialName)) { files.push_back(fe); }
+        return true;
+    });
 }
 
 long TagsStorageSQLite::LastRowId() const
@@ -450,12 +678,14 @@ void TagsStorageSQLite::DeleteByFilePrefix(const wxFileName& dbpath, const wxStr
 
     try {
         OpenDatabase(dbpath);
-        wxString sql;
         wxString name(filePrefix);
         name.Replace(wxT("_"), wxT("^_"));
 
-        sql << wxT("delete from tags where file like '") << name << wxT("%%' ESCAPE '^' ");
-        m_db->ExecuteUpdate(sql);
+        clSqliteQuery query("delete from tags where file like ");
+        query.AddArg(name + "%");
+        query << " ESCAPE '^' ";
+        DoExecuteUpdate(query);
+        IncrementTagsGeneration();
 
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
@@ -464,46 +694,32 @@ void TagsStorageSQLite::DeleteByFilePrefix(const wxFileName& dbpath, const wxStr
 
 void TagsStorageSQLite::GetFiles(std::vector<FileEntryPtr>& files)
 {
-    try {
-        wxString query(wxT("select * from files order by file"));
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
-
-        // Pre allocate a reasonable amount of entries
-        files.reserve(5000);
-
-        while(res.NextRow()) {
-            FileEntryPtr fe(new FileEntry());
-            fe->SetId(res.GetInt(0));
-            fe->SetFile(res.GetString(1));
-            fe->SetLastRetaggedTimestamp(res.GetInt(2));
+    // Pre allocate a reasonable amount of entries
+    files.reserve(5000);
 
-            files.push_back(fe);
-        }
-        // release unneeded memory
-        files.shrink_to_fit();
+    DoQuery(clSqliteQuery("select * from files order by file"), [&](wxSQLite3ResultSet& res) {
+        FileEntryPtr fe(new FileEntry());
+        fe->SetId(res.GetInt(0));
+        fe->SetFile(res.GetString(1));
+        fe->SetLastRetaggedTimestamp(res.GetInt(2));
 
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+        files.push_back(fe);
+        return true;
+    });
+    // release unneeded memory
+    files.shrink_to_fit();
 }
 
 void TagsStorageSQLite::DeleteFromFiles(const wxArrayString& files)
 {
     if(files.IsEmpty()) { return; }
 
-    wxString query;
-    query << wxT("delete from FILES where file in (");
-
-    for(size_t i = 0; i < files.GetCount(); i++) {
-        query << wxT("'") << files.Item(i) << wxT("',");
-    }
-
-    // remove last ','
-    query.RemoveLast();
-    query << wxT(")");
+    clSqliteQuery query("delete from FILES where file in (");
+    query.AddArgList(files);
+    query << ")";
 
     try {
-        m_db->ExecuteQuery(query);
+        DoExecuteUpdate(query);
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
     }
@@ -515,12 +731,13 @@ void TagsStorageSQLite::DeleteFromFilesByPrefix(const wxFileName& dbpath, const
 
     try {
         OpenDatabase(dbpath);
-        wxString sql;
         wxString name(filePrefix);
         name.Replace(wxT("_"), wxT("^_"));
 
-        sql << wxT("delete from FILES where file like '") << name << wxT("%%' ESCAPE '^' ");
-        m_db->ExecuteUpdate(sql);
+        clSqliteQuery query("delete from FILES where file like ");
+        query.AddArg(name + "%");
+        query << " ESCAPE '^' ";
+        DoExecuteUpdate(query);
 
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
@@ -567,78 +784,60 @@ TagEntry* TagsStorageSQLite::FromSQLite3ResultSet(wxSQLite3ResultSet& rs)
     return entry;
 }
 
-void TagsStorageSQLite::DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags)
+void TagsStorageSQLite::DoFetchTags(const clSqliteQuery& query, std::vector<TagEntryPtr>& tags)
 {
+    wxString key;
     if(GetUseCache()) {
-        clDEBUG1() << "Testing cache for" << sql << clEndl;
-        if(m_cache.Get(sql, tags) == true) {
-            clDEBUG1() << "[CACHED ITEMS]" << sql << clEndl;
+        key = query.GetKey();
+        clDEBUG1() << "Testing cache for" << key << clEndl;
+        if(m_cache.Get(key, tags) == true) {
+            clDEBUG1() << "[CACHED ITEMS]" << key << clEndl;
             return;
         }
     }
 
-    clDEBUG1() << "Entry not found in cache" << sql << clEndl;
+    clDEBUG1() << "Entry not found in cache" << query.GetSql() << clEndl;
     clDEBUG1() << "Fetching from disk..." << clEndl;
     tags.reserve(500);
-    try {
-        wxSQLite3ResultSet ex_rs;
-        ex_rs = Query(sql);
-
-        // add results from external database to the workspace database
-        while(ex_rs.NextRow()) {
-            // Construct a TagEntry from the rescord set
-            TagEntryPtr tag(FromSQLite3ResultSet(ex_rs));
-            // conver the path to be real path
-            tags.push_back(tag);
-        }
-        ex_rs.Finalize();
-    } catch(wxSQLite3Exception& e) {
-        clWARNING() << "TagsStorageSQLite::DoFetchTags() error:" << e.GetMessage() << clEndl;
-    }
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        // Construct a TagEntry from the rescord set
+        tags.push_back(TagEntryPtr(FromSQLite3ResultSet(rs)));
+        return true;
+    });
     clDEBUG1() << "Fetching from disk...done" << clEndl;
     if(GetUseCache()) {
         clDEBUG1() << "Updating cache" << clEndl;
-        m_cache.Store(sql, tags);
+        m_cache.Store(key, tags);
         clDEBUG1() << "Updating cache...done (" << tags.size() << "entries)" << clEndl;
     }
 }
 
-void TagsStorageSQLite::DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags, const wxArrayString& kinds)
+void TagsStorageSQLite::DoFetchTags(const clSqliteQuery& query, std::vector<TagEntryPtr>& tags,
+                                    const wxArrayString& kinds)
 {
+    wxString key;
     if(GetUseCache()) {
-        CL_DEBUG1(wxT("Testing cache for: %s"), sql);
-        if(m_cache.Get(sql, kinds, tags) == true) {
-            CL_DEBUG1(wxT("[CACHED ITEMS] %s"), sql);
+        key = query.GetKey();
+        CL_DEBUG1(wxT("Testing cache for: %s"), key);
+        if(m_cache.Get(key, kinds, tags) == true) {
+            CL_DEBUG1(wxT("[CACHED ITEMS] %s"), key);
             return;
         }
     }
 
     CL_DEBUG1("Fetching from disk");
-    try {
-        wxSQLite3ResultSet ex_rs;
-        ex_rs = Query(sql);
-
-        // add results from external database to the workspace database
-        while(ex_rs.NextRow()) {
-            // check if this kind is accepted
-            if(kinds.Index(ex_rs.GetString(4)) != wxNOT_FOUND) {
-
-                // Construct a TagEntry from the rescord set
-                TagEntryPtr tag(FromSQLite3ResultSet(ex_rs));
-
-                // conver the path to be real path
-                tags.push_back(tag);
-            }
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        // check if this kind is accepted
+        if(kinds.Index(rs.GetString(4)) != wxNOT_FOUND) {
+            // Construct a TagEntry from the rescord set
+            tags.push_back(TagEntryPtr(FromSQLite3ResultSet(rs)));
         }
-        ex_rs.Finalize();
-
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+        return true;
+    });
     CL_DEBUG1("Fetching from disk...done");
     if(GetUseCache()) {
         CL_DEBUG1("updating cache");
-        m_cache.Store(sql, kinds, tags);
+        m_cache.Store(key, kinds, tags);
         CL_DEBUG1("updating cache...done");
     }
 }
@@ -648,55 +847,56 @@ void TagsStorageSQLite::GetTagsByScopeAndName(const wxString& scope, const wxStr
 {
     if(name.IsEmpty()) return;
 
-    wxString sql;
-    sql << wxT("select * from tags where ");
+    clSqliteQuery query("select * from tags where ");
 
     // did we get scope?
     if(scope.IsEmpty() || scope == wxT("<global>")) {
-        sql << wxT("ID IN (select tag_id from global_tags where ");
-        DoAddNamePartToQuery(sql, name, partialNameAllowed, false);
-        sql << wxT(" ) ");
+        query << "ID IN (select tag_id from global_tags where ";
+        DoAddNamePartToQuery(query, name, partialNameAllowed, false);
+        query << " ) ";
 
     } else {
-        sql << " scope = '" << scope << "' ";
-        DoAddNamePartToQuery(sql, name, partialNameAllowed, true);
+        query << " scope = ";
+        query.AddArg(scope);
+        query << " ";
+        DoAddNamePartToQuery(query, name, partialNameAllowed, true);
     }
 
-    sql << wxT(" LIMIT ") << this->GetSingleSearchLimit();
+    query << " LIMIT ";
+    query.AddArg(GetSingleSearchLimit());
 
     // get get the tags
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByScope(const wxString& scope, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-
     // Build the SQL statement
-    sql << wxT("select * from tags where scope='") << scope << wxT("' ORDER BY NAME limit ") << GetSingleSearchLimit();
+    clSqliteQuery query("select * from tags where scope=");
+    query.AddArg(scope);
+    query << " ORDER BY NAME limit ";
+    query.AddArg(GetSingleSearchLimit());
 
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByKind(const wxArrayString& kinds, const wxString& orderingColumn, int order,
                                       std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where kind in (");
-    for(size_t i = 0; i < kinds.GetCount(); i++) {
-        sql << wxT("'") << kinds.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(") ");
+    if(kinds.empty()) { return; }
+
+    clSqliteQuery query("select * from tags where kind in (");
+    query.AddArgList(kinds);
+    query << ") ";
 
     if(orderingColumn.IsEmpty() == false) {
-        sql << wxT("order by ") << orderingColumn;
+        query << "order by " << orderingColumn;
         switch(order) {
         case ITagsStorage::OrderAsc:
-            sql << wxT(" ASC");
+            query << " ASC";
             break;
         case ITagsStorage::OrderDesc:
-            sql << wxT(" DESC");
+            query << " DESC";
             break;
         case ITagsStorage::OrderNone:
         default:
@@ -704,32 +904,29 @@ void TagsStorageSQLite::GetTagsByKind(const wxArrayString& kinds, const wxString
         }
     }
 
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByPath(const wxArrayString& path, std::vector<TagEntryPtr>& tags)
 {
     if(path.empty()) return;
 
-    wxString sql;
-
-    sql << wxT("select * from tags where path IN(");
-    for(size_t i = 0; i < path.GetCount(); i++) {
-        sql << wxT("'") << path.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where path IN(");
+    query.AddArgList(path);
+    query << ")";
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByNameAndParent(const wxString& name, const wxString& parent,
                                                std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where name='") << name << wxT("' LIMIT ") << GetSingleSearchLimit();
+    clSqliteQuery query("select * from tags where name=");
+    query.AddArg(name);
+    query << " LIMIT ";
+    query.AddArg(GetSingleSearchLimit());
 
     std::vector<TagEntryPtr> tmpResults;
-    DoFetchTags(sql, tmpResults);
+    DoFetchTags(query, tmpResults);
 
     // Filter by parent
     for(size_t i = 0; i < tmpResults.size(); i++) {
@@ -742,25 +939,32 @@ void TagsStorageSQLite::GetTagsByKindAndPath(const wxArrayString& kinds, const w
 {
     if(kinds.empty()) { return; }
 
-    wxString sql;
-    sql << wxT("select * from tags where path='") << path << wxT("' LIMIT ") << GetSingleSearchLimit();
+    clSqliteQuery query("select * from tags where path=");
+    query.AddArg(path);
+    query << " LIMIT ";
+    query.AddArg(GetSingleSearchLimit());
 
-    DoFetchTags(sql, tags, kinds);
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByFileAndLine(const wxString& file, int line, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where file='") << file << wxT("' and line=") << line << wxT(" ");
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where file=");
+    query.AddArg(file);
+    query << " and line=";
+    query.AddArg(line);
+    DoFetchTags(query, tags);
 }
 
 TagEntryPtr TagsStorageSQLite::GetTagAboveFileAndLine(const wxString& file, int line)
 {
-    wxString sql;
-    sql << wxT("select * from tags where file='") << file << wxT("' and line<=") << line << wxT(" LIMIT 1");
+    clSqliteQuery query("select * from tags where file=");
+    query.AddArg(file);
+    query << " and line<=";
+    query.AddArg(line);
+    query << " LIMIT 1";
     TagEntryPtrVector_t tags;
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
     if(!tags.empty()) { return tags.at(0); }
     return NULL;
 }
@@ -770,10 +974,13 @@ void TagsStorageSQLite::GetTagsByScopeAndKind(const wxString& scope, const wxArr
 {
     if(kinds.empty()) { return; }
 
-    wxString sql;
-    sql << wxT("select * from tags where scope='") << scope << wxT("' ");
-    if(applyLimit) { sql << wxT(" LIMIT ") << GetSingleSearchLimit(); }
-    DoFetchTags(sql, tags, kinds);
+    clSqliteQuery query("select * from tags where scope=");
+    query.AddArg(scope);
+    if(applyLimit) {
+        query << " LIMIT ";
+        query.AddArg(GetSingleSearchLimit());
+    }
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByKindAndFile(const wxArrayString& kind, const wxString& fileName,
@@ -781,36 +988,33 @@ void TagsStorageSQLite::GetTagsByKindAndFile(const wxArrayString& kind, const wx
 {
     if(kind.empty()) { return; }
 
-    wxString sql;
-    sql << wxT("select * from tags where file='") << fileName << wxT("' and kind in (");
-
-    for(size_t i = 0; i < kind.GetCount(); i++) {
-        sql << wxT("'") << kind.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
+    clSqliteQuery query("select * from tags where file=");
+    query.AddArg(fileName);
+    query << " and kind in (";
+    query.AddArgList(kind);
+    query << ")";
 
     if(orderingColumn.IsEmpty() == false) {
-        sql << wxT("order by ") << orderingColumn;
+        query << "order by " << orderingColumn;
         switch(order) {
         case ITagsStorage::OrderAsc:
-            sql << wxT(" ASC");
+            query << " ASC";
             break;
         case ITagsStorage::OrderDesc:
-            sql << wxT(" DESC");
+            query << " DESC";
             break;
         case ITagsStorage::OrderNone:
         default:
             break;
         }
     }
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 int TagsStorageSQLite::DeleteFileEntry(const wxString& filename)
 {
     try {
-        wxSQLite3Statement statement = m_db->GetPrepareStatement(wxT("DELETE FROM FILES WHERE FILE=?"));
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(wxT("DELETE FROM FILES WHERE FILE=?"));
         statement.Bind(1, filename);
         statement.ExecuteUpdate();
 
@@ -824,7 +1028,7 @@ int TagsStorageSQLite::DeleteFileEntry(const wxString& filename)
 int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp)
 {
     try {
-        wxSQLite3Statement statement =
+        wxSQLite3Statement& statement =
             m_db->GetPrepareStatement(wxT("INSERT OR REPLACE INTO FILES VALUES(NULL, ?, ?)"));
         statement.Bind(1, filename);
         statement.Bind(2, timestamp);
@@ -839,7 +1043,7 @@ int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp)
 int TagsStorageSQLite::UpdateFileEntry(const wxString& filename, int timestamp)
 {
     try {
-        wxSQLite3Statement statement =
+        wxSQLite3Statement& statement =
             m_db->GetPrepareStatement(wxT("UPDATE OR REPLACE FILES SET last_retagged=? WHERE file=?"));
         statement.Bind(1, timestamp);
         statement.Bind(2, filename);
@@ -860,7 +1064,7 @@ int TagsStorageSQLite::DoInsertTagEntry(const TagEntry& tag)
     if(GetUseCache()) { ClearCache(); }
 
     try {
-        wxSQLite3Statement statement = m_db->GetPrepareStatement(
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(
             wxT("INSERT OR REPLACE INTO TAGS VALUES (NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
         statement.Bind(1, tag.GetName());
         statement.Bind(2, tag.GetFile());
@@ -884,8 +1088,6 @@ int TagsStorageSQLite::DoInsertTagEntry(const TagEntry& tag)
 
 bool TagsStorageSQLite::IsTypeAndScopeContainer(wxString& typeName, wxString& scope)
 {
-    wxString sql;
-
     // Break the typename to 'name' and scope
     wxString typeNameNoScope(typeName.AfterLast(wxT(':')));
     wxString scopeOne(typeName.BeforeLast(wxT(':')));
@@ -901,44 +1103,44 @@ bool TagsStorageSQLite::IsTypeAndScopeContainer(wxString& typeName, wxString& sc
         combinedScope << scopeOne;
     }
 
-    sql << wxT("select scope,kind from tags where name='") << typeNameNoScope << wxT("'");
+    clSqliteQuery query("select scope,kind from tags where name=");
+    query.AddArg(typeNameNoScope);
 
     bool found_global(false);
-
-    try {
-        wxSQLite3ResultSet rs = Query(sql);
-        while(rs.NextRow()) {
-            wxString scopeFounded(rs.GetString(0));
-            wxString kindFounded(rs.GetString(1));
-
-            bool containerKind = kindFounded == wxT("struct") || kindFounded == wxT("class") || kindFounded == "cenum";
-            if(scopeFounded == combinedScope && containerKind) {
-                scope = combinedScope;
-                typeName = typeNameNoScope;
-                // we got an exact match
-                return true;
-
-            } else if(scopeFounded == scopeOne && containerKind) {
-                // this is equal to cases like this:
-                // class A {
-                // typedef std::list<int> List;
-                // List l;
-                // };
-                // the combinedScope will be: 'A::std'
-                // however, the actual scope is 'std'
-                scope = scopeOne;
-                typeName = typeNameNoScope;
-                // we got an exact match
-                return true;
-
-            } else if(containerKind && scopeFounded == wxT("<global>")) {
-                found_global = true;
-            }
+    bool found(false);
+
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        wxString scopeFounded(rs.GetString(0));
+        wxString kindFounded(rs.GetString(1));
+
+        bool containerKind = kindFounded == wxT("struct") || kindFounded == wxT("class") || kindFounded == "cenum";
+        if(scopeFounded == combinedScope && containerKind) {
+            scope = combinedScope;
+            typeName = typeNameNoScope;
+            // we got an exact match
+            found = true;
+            return false;
+
+        } else if(scopeFounded == scopeOne && containerKind) {
+            // this is equal to cases like this:
+            // class A {
+            // typedef std::list<int> List;
+            // List l;
+            // };
+            // the combinedScope will be: 'A::std'
+            // however, the actual scope is 'std'
+            scope = scopeOne;
+            typeName = typeNameNoScope;
+            // we got an exact match
+            found = true;
+            return false;
+
+        } else if(containerKind && scopeFounded == wxT("<global>")) {
+            found_global = true;
         }
-
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+        return true;
+    });
+    if(found) { return true; }
 
     // if we reached here, it means we did not find any exact match
     if(found_global) {
@@ -952,7 +1154,6 @@ bool TagsStorageSQLite::IsTypeAndScopeContainer(wxString& typeName, wxString& sc
 
 bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
 {
-    wxString sql;
     wxString strippedName;
     wxString secondScope;
     wxString bestScope;
@@ -966,9 +1167,11 @@ bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
 
     if(strippedName.IsEmpty()) return false;
 
-    sql << wxT("select scope,parent from tags where name='") << strippedName
-        << wxT("' and kind in ('class', 'struct', 'typedef') LIMIT 50");
+    clSqliteQuery query("select scope,parent from tags where name=");
+    query.AddArg(strippedName);
+    query << " and kind in ('class', 'struct', 'typedef') LIMIT 50";
     int foundOther(0);
+    bool found(false);
     wxString scopeFounded;
     wxString parentFounded;
 
@@ -976,30 +1179,26 @@ bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
 
     parent = tmpScope.AfterLast(wxT(':'));
 
-    try {
-        wxSQLite3ResultSet rs = Query(sql);
-        while(rs.NextRow()) {
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        scopeFounded = rs.GetString(0);
+        parentFounded = rs.GetString(1);
 
-            scopeFounded = rs.GetString(0);
-            parentFounded = rs.GetString(1);
+        if(scopeFounded == tmpScope) {
+            // exact match
+            scope = scopeFounded;
+            typeName = strippedName;
+            found = true;
+            return false;
 
-            if(scopeFounded == tmpScope) {
-                // exact match
-                scope = scopeFounded;
-                typeName = strippedName;
-                return true;
+        } else if(parentFounded == parent) {
+            bestScope = scopeFounded;
 
-            } else if(parentFounded == parent) {
-                bestScope = scopeFounded;
-
-            } else {
-                foundOther++;
-            }
+        } else {
+            foundOther++;
         }
-
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+        return true;
+    });
+    if(found) { return true; }
 
     // if we reached here, it means we did not find any exact match
     if(bestScope.IsEmpty() == false) {
@@ -1017,85 +1216,59 @@ bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
 
 void TagsStorageSQLite::GetScopesFromFileAsc(const wxFileName& fileName, std::vector<wxString>& scopes)
 {
-    wxString sql;
-    sql << wxT("select distinct scope from tags where file = '") << fileName.GetFullPath() << wxT("' ")
-        << wxT(" and kind in('prototype', 'function', 'enum')") << wxT(" order by scope ASC");
+    clSqliteQuery query("select distinct scope from tags where file = ");
+    query.AddArg(fileName.GetFullPath());
+    query << " and kind in('prototype', 'function', 'enum') order by scope ASC";
 
-    // we take the first entry
-    try {
-        wxSQLite3ResultSet rs = Query(sql);
-        while(rs.NextRow()) {
-            scopes.push_back(rs.GetString(0));
-        }
-        rs.Finalize();
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        scopes.push_back(rs.GetString(0));
+        return true;
+    });
 }
 
 void TagsStorageSQLite::GetTagsByFileScopeAndKind(const wxFileName& fileName, const wxString& scopeName,
                                                   const wxArrayString& kind, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where file = '") << fileName.GetFullPath() << wxT("' ") << wxT(" and scope='")
-        << scopeName << wxT("' ");
+    clSqliteQuery query("select * from tags where file = ");
+    query.AddArg(fileName.GetFullPath());
+    query << " and scope=";
+    query.AddArg(scopeName);
 
     if(kind.IsEmpty() == false) {
-        sql << wxT(" and kind in(");
-        for(size_t i = 0; i < kind.GetCount(); i++) {
-            sql << wxT("'") << kind.Item(i) << wxT("',");
-        }
-        sql.RemoveLast();
-        sql << wxT(")");
+        query << " and kind in(";
+        query.AddArgList(kind);
+        query << ")";
     }
 
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetAllTagsNames(wxArrayString& names)
 {
-    try {
-
-        wxString query(wxT("SELECT distinct name FROM tags order by name ASC LIMIT "));
-        query << GetMaxWorkspaceTagToColour();
+    clSqliteQuery query("SELECT distinct name FROM tags order by name ASC LIMIT ");
+    query.AddArg(GetMaxWorkspaceTagToColour());
 
-        wxSQLite3ResultSet res = Query(query);
-        while(res.NextRow()) {
-            // add unique strings only
-            names.Add(res.GetString(0));
-        }
-
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+    DoQuery(query, [&](wxSQLite3ResultSet& res) {
+        // add unique strings only
+        names.Add(res.GetString(0));
+        return true;
+    });
 }
 
 void TagsStorageSQLite::GetTagsNames(const wxArrayString& kind, wxArrayString& names)
 {
     if(kind.IsEmpty()) return;
-    try {
-
-        wxString whereClause;
-        whereClause << wxT(" kind IN (");
-        for(size_t i = 0; i < kind.GetCount(); i++) {
-            whereClause << wxT("'") << kind.Item(i) << wxT("',");
-        }
 
-        whereClause = whereClause.BeforeLast(wxT(','));
-        whereClause << wxT(") ");
-
-        wxString query(wxT("SELECT distinct name FROM tags WHERE "));
-        query << whereClause << wxT(" order by name ASC LIMIT ") << GetMaxWorkspaceTagToColour();
-
-        wxSQLite3ResultSet res = Query(query);
-        while(res.NextRow()) {
-            // add unique strings only
-            names.Add(res.GetString(0));
-        }
+    clSqliteQuery query("SELECT distinct name FROM tags WHERE kind IN (");
+    query.AddArgList(kind);
+    query << ") order by name ASC LIMIT ";
+    query.AddArg(GetMaxWorkspaceTagToColour());
 
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
+    DoQuery(query, [&](wxSQLite3ResultSet& res) {
+        // add unique strings only
+        names.Add(res.GetString(0));
+        return true;
+    });
 }
 
 void TagsStorageSQLite::GetTagsByScopesAndKind(const wxArrayString& scopes, const wxArrayString& kinds,
@@ -1103,15 +1276,11 @@ void TagsStorageSQLite::GetTagsByScopesAndKind(const wxArrayString& scopes, cons
 {
     if(kinds.empty() || scopes.empty()) { return; }
 
-    wxString sql;
-    sql << wxT("select * from tags where scope in (");
-    for(size_t i = 0; i < scopes.GetCount(); i++) {
-        sql << wxT("'") << scopes.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(") ORDER BY NAME ");
-    DoAddLimitPartToQuery(sql, tags);
-    DoFetchTags(sql, tags, kinds);
+    clSqliteQuery query("select * from tags where scope in (");
+    query.AddArgList(scopes);
+    query << ") ORDER BY NAME ";
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByScopesAndKindNoLimit(const wxArrayString& scopes, const wxArrayString& kinds,
@@ -1119,15 +1288,11 @@ void TagsStorageSQLite::GetTagsByScopesAndKindNoLimit(const wxArrayString& scope
 {
     if(kinds.empty() || scopes.empty()) { return; }
 
-    wxString sql;
-    sql << wxT("select * from tags where scope in (");
-    for(size_t i = 0; i < scopes.GetCount(); i++) {
-        sql << wxT("'") << scopes.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(") ORDER BY NAME");
+    clSqliteQuery query("select * from tags where scope in (");
+    query.AddArgList(scopes);
+    query << ") ORDER BY NAME";
 
-    DoFetchTags(sql, tags, kinds);
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByTyperefAndKind(const wxArrayString& typerefs, const wxArrayString& kinds,
@@ -1135,24 +1300,22 @@ void TagsStorageSQLite::GetTagsByTyperefAndKind(const wxArrayString& typerefs, c
 {
     if(kinds.empty() || typerefs.empty()) { return; }
 
-    wxString sql;
-    sql << wxT("select * from tags where typeref in (");
-    for(size_t i = 0; i < typerefs.GetCount(); i++) {
-        sql << wxT("'") << typerefs.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(") ORDER BY NAME ");
-    DoAddLimitPartToQuery(sql, tags);
-    DoFetchTags(sql, tags, kinds);
+    clSqliteQuery query("select * from tags where typeref in (");
+    query.AddArgList(typerefs);
+    query << ") ORDER BY NAME ";
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByPath(const wxString& path, std::vector<TagEntryPtr>& tags, int limit)
 {
     if(path.empty()) return;
 
-    wxString sql;
-    sql << wxT("select * from tags where path ='") << path << wxT("' LIMIT ") << limit;
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where path =");
+    query.AddArg(path);
+    query << " LIMIT ";
+    query.AddArg(limit);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByScopeAndName(const wxArrayString& scope, const wxString& name, bool partialNameAllowed,
@@ -1173,42 +1336,32 @@ void TagsStorageSQLite::GetTagsByScopeAndName(const wxArrayString& scope, const
     }
 
     if(scopes.IsEmpty() == false) {
-        wxString sql;
-        sql << wxT("select * from tags where scope in(");
-
-        for(size_t i = 0; i < scopes.GetCount(); i++) {
-            sql << wxT("'") << scopes.Item(i) << wxT("',");
-        }
-        sql.RemoveLast();
-        sql << wxT(") ");
+        clSqliteQuery query("select * from tags where scope in(");
+        query.AddArgList(scopes);
+        query << ") ";
 
-        DoAddNamePartToQuery(sql, name, partialNameAllowed, true);
-        DoAddLimitPartToQuery(sql, tags);
+        DoAddNamePartToQuery(query, name, partialNameAllowed, true);
+        DoAddLimitPartToQuery(query, tags);
         // get get the tags
-        DoFetchTags(sql, tags);
+        DoFetchTags(query, tags);
     }
 }
 
 void TagsStorageSQLite::GetGlobalFunctions(std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where scope = '<global>' AND kind IN ('function', 'prototype')");
-    DoAddLimitPartToQuery(sql, tags);
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where scope = '<global>' AND kind IN ('function', 'prototype')");
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByFiles(const wxArrayString& files, std::vector<TagEntryPtr>& tags)
 {
     if(files.IsEmpty()) return;
 
-    wxString sql;
-    sql << wxT("select * from tags where file in (");
-    for(size_t i = 0; i < files.GetCount(); i++) {
-        sql << wxT("'") << files.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where file in (");
+    query.AddArgList(files);
+    query << ")";
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByFilesAndScope(const wxArrayString& files, const wxString& scope,
@@ -1216,16 +1369,11 @@ void TagsStorageSQLite::GetTagsByFilesAndScope(const wxArrayString& files, const
 {
     if(files.IsEmpty()) return;
 
-    wxString sql;
-    sql << wxT("select * from tags where file in (");
-    for(size_t i = 0; i < files.GetCount(); i++) {
-        sql << wxT("'") << files.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-
-    sql << wxT(" AND scope='") << scope << wxT("'");
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where file in (");
+    query.AddArgList(files);
+    query << ") AND scope=";
+    query.AddArg(scope);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByFilesKindAndScope(const wxArrayString& files, const wxArrayString& kinds,
@@ -1233,16 +1381,11 @@ void TagsStorageSQLite::GetTagsByFilesKindAndScope(const wxArrayString& files, c
 {
     if(files.IsEmpty()) return;
 
-    wxString sql;
-    sql << wxT("select * from tags where file in (");
-    for(size_t i = 0; i < files.GetCount(); i++) {
-        sql << wxT("'") << files.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-
-    sql << wxT(" AND scope='") << scope << wxT("'");
-    DoFetchTags(sql, tags, kinds);
+    clSqliteQuery query("select * from tags where file in (");
+    query.AddArgList(files);
+    query << ") AND scope=";
+    query.AddArg(scope);
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByFilesScopeTyperefAndKind(const wxArrayString& files, const wxArrayString& kinds,
@@ -1251,38 +1394,35 @@ void TagsStorageSQLite::GetTagsByFilesScopeTyperefAndKind(const wxArrayString& f
 {
     if(files.IsEmpty()) return;
 
-    wxString sql;
-    sql << wxT("select * from tags where file in (");
-    for(size_t i = 0; i < files.GetCount(); i++) {
-        sql << wxT("'") << files.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-
-    sql << wxT(" AND scope='") << scope << wxT("'");
-    sql << wxT(" AND typeref='") << typeref << wxT("'");
-    DoFetchTags(sql, tags, kinds);
+    clSqliteQuery query("select * from tags where file in (");
+    query.AddArgList(files);
+    query << ") AND scope=";
+    query.AddArg(scope);
+    query << " AND typeref=";
+    query.AddArg(typeref);
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByKindLimit(const wxArrayString& kinds, const wxString& orderingColumn, int order,
                                            int limit, const wxString& partName, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where kind in (");
-    for(size_t i = 0; i < kinds.GetCount(); i++) {
-        sql << wxT("'") << kinds.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(") ");
+    if(kinds.empty()) { return; }
+
+    clSqliteQuery query("select * from tags where kind in (");
+    query.AddArgList(kinds);
+    query << ") ";
+
+    // the name condition is part of the WHERE clause: it must come before the ORDER BY
+    DoAddNamePartToQuery(query, partName, true, true);
 
     if(orderingColumn.IsEmpty() == false) {
-        sql << wxT("order by ") << orderingColumn;
+        query << " order by " << orderingColumn;
         switch(order) {
         case ITagsStorage::OrderAsc:
-            sql << wxT(" ASC");
+            query << " ASC";
             break;
         case ITagsStorage::OrderDesc:
-            sql << wxT(" DESC");
+            query << " DESC";
             break;
         case ITagsStorage::OrderNone:
         default:
@@ -1290,45 +1430,48 @@ void TagsStorageSQLite::GetTagsByKindLimit(const wxArrayString& kinds, const wxS
         }
     }
 
-    DoAddNamePartToQuery(sql, partName, true, true);
-    if(limit > 0) { sql << wxT(" LIMIT ") << limit; }
+    if(limit > 0) {
+        query << " LIMIT ";
+        query.AddArg(limit);
+    }
 
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 bool TagsStorageSQLite::IsTypeAndScopeExistLimitOne(const wxString& typeName, const wxString& scope)
 {
-    wxString sql;
     wxString path;
 
     // Build the path
     if(scope.IsEmpty() == false && scope != wxT("<global>")) path << scope << wxT("::");
 
     path << typeName;
-    sql << wxT("select ID from tags where path='") << path
-        << wxT("' and kind in ('class', 'struct', 'typedef') LIMIT 1");
+    clSqliteQuery query("select ID from tags where path=");
+    query.AddArg(path);
+    query << " and kind in ('class', 'struct', 'typedef') LIMIT 1";
 
-    try {
-        wxSQLite3ResultSet rs = Query(sql);
-        if(rs.NextRow()) { return true; }
-
-    } catch(wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
-    return false;
+    bool found(false);
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        wxUnusedVar(rs);
+        found = true;
+        return false;
+    });
+    return found;
 }
 
 void TagsStorageSQLite::GetDereferenceOperator(const wxString& scope, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where scope ='") << scope << wxT("' and name like 'operator%->%' LIMIT 1");
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where scope =");
+    query.AddArg(scope);
+    query << " and name like 'operator%->%' LIMIT 1";
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetSubscriptOperator(const wxString& scope, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where scope ='") << scope << wxT("' and name like 'operator%[%]%' LIMIT 1");
-    DoFetchTags(sql, tags);
+    clSqliteQuery query("select * from tags where scope =");
+    query.AddArg(scope);
+    query << " and name like 'operator%[%]%' LIMIT 1";
+    DoFetchTags(query, tags);
 }
 
 //---------------------------------------------------------------------
@@ -1358,6 +1501,9 @@ void TagsStorageSQLiteCache::Clear()
 {
     // CL_DEBUG1(wxT("[CACHE CLEARED]"));
     m_cache.clear();
+    m_store.Clear();
+    m_garbageBytes = 0;
+    m_materializedCount = 0;
 }
 
 void TagsStorageSQLiteCache::Store(const wxString& sql, const wxArrayString& kind, const std::vector<TagEntryPtr>& tags)
@@ -1372,19 +1518,78 @@ void TagsStorageSQLiteCache::Store(const wxString& sql, const wxArrayString& kin
 
 bool TagsStorageSQLiteCache::DoGet(const wxString& key, std::vector<TagEntryPtr>& tags)
 {
-    std::unordered_map<wxString, std::vector<TagEntryPtr>>::iterator iter = m_cache.find(key);
-    if(iter != m_cache.end()) {
-        // Append the results to the output tags
-        tags.insert(tags.end(), iter->second.begin(), iter->second.end());
+    std::unordered_map<wxString, Entry>::iterator iter = m_cache.find(key);
+    if(iter == m_cache.end()) { return false; }
+
+    Entry& entry = iter->second;
+    if(entry.tags.size() > MAX_MATERIALIZED_TAGS) {
+        // keeping these would use the memory the compact form saves
+        tags.reserve(tags.size() + entry.tags.size());
+        for(const clCompactTag& tag : entry.tags) {
+            tags.push_back(m_store.ToTagEntry(tag));
+        }
         return true;
     }
-    return false;
+
+    if(entry.materialized.size() != entry.tags.size()) {
+        // first hit: build the TagEntry objects once
+        if(m_materializedCount + entry.tags.size() > MAX_MATERIALIZED_TAGS) { DoReleaseMaterialized(); }
+        entry.materialized.reserve(entry.tags.size());
+        for(const clCompactTag& tag : entry.tags) {
+            entry.materialized.push_back(m_store.ToTagEntry(tag));
+        }
+        m_materializedCount += entry.materialized.size();
+    }
+
+    // Append the results to the output tags
+    tags.insert(tags.end(), entry.materialized.begin(), entry.materialized.end());
+    return true;
 }
 
 void TagsStorageSQLiteCache::DoStore(const wxString& key, const std::vector<TagEntryPtr>& tags)
 {
-    m_cache[key].reserve(tags.size());
-    m_cache[key] = tags;
+    Entry& entry = m_cache[key];
+    m_garbageBytes += entry.bytes;
+    m_materializedCount -= entry.materialized.size();
+    entry = Entry();
+
+    size_t before = m_store.GetStringsSize();
+    entry.tags.reserve(tags.size());
+    for(const TagEntryPtr& tag : tags) {
+        entry.tags.push_back(m_store.Add(*tag));
+    }
+    entry.bytes = m_store.GetStringsSize() - before;
+
+    if(m_garbageBytes >= MIN_GARBAGE_TO_COMPACT && m_garbageBytes * 2 >= m_store.GetStringsSize()) { DoCompact(); }
+    clDEBUG1() << "Tags cache:" << tags.size() << "tags stored," << m_store.GetMemoryUsage()
+               << "bytes used by the cache strings," << m_materializedCount << "TagEntry objects kept" << clEndl;
+}
+
+void TagsStorageSQLiteCache::DoReleaseMaterialized()
+{
+    for(auto& vt : m_cache) {
+        vt.second.materialized.clear();
+        vt.second.materialized.shrink_to_fit();
+    }
+    m_materializedCount = 0;
+}
+
+void TagsStorageSQLiteCache::DoCompact()
+{
+    // copy the records of the live entries into a new store, this drops the strings of the replaced entries
+    clCompactTagStore store;
+    for(auto& vt : m_cache) {
+        Entry& entry = vt.second;
+        size_t before = store.GetStringsSize();
+        for(clCompactTag& tag : entry.tags) {
+            tag = store.Copy(tag, m_store);
+        }
+        entry.bytes = store.GetStringsSize() - before;
+    }
+    clDEBUG1() << "Tags cache: compacted the strings from" << m_store.GetStringsSize() << "to"
+               << store.GetStringsSize() << "bytes" << clEndl;
+    m_store.Swap(store);
+    m_garbageBytes = 0;
 }
 
 void TagsStorageSQLite::ClearCache() { m_cache.Clear(); }
@@ -1394,27 +1599,21 @@ void TagsStorageSQLite::SetUseCache(bool useCache) { ITagsStorage::SetUseCache(u
 PPToken TagsStorageSQLite::GetMacro(const wxString& name)
 {
     PPToken token;
-    try {
-        wxString sql;
-        sql << wxT("select * from MACROS where name = '") << name << wxT("'");
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(sql);
-        if(res.NextRow()) {
-            PPTokenFromSQlite3ResultSet(res, token);
-            return token;
-        }
-    } catch(wxSQLite3Exception& exc) {
-        wxUnusedVar(exc);
-    }
-
+    clSqliteQuery query("select * from MACROS where name = ");
+    query.AddArg(name);
+    DoQuery(query, [&](wxSQLite3ResultSet& res) {
+        PPTokenFromSQlite3ResultSet(res, token);
+        return false;
+    });
     return token;
 }
 
 void TagsStorageSQLite::StoreMacros(const std::map<wxString, PPToken>& table)
 {
     try {
-        wxSQLite3Statement stmntCC =
+        wxSQLite3Statement& stmntCC =
             m_db->GetPrepareStatement(wxT("insert or replace into MACROS values(NULL, ?, ?, ?, ?, ?, ?)"));
-        wxSQLite3Statement stmntSimple =
+        wxSQLite3Statement& stmntSimple =
             m_db->GetPrepareStatement(wxT("insert or replace into SIMPLE_MACROS values(NULL, ?, ?)"));
 
         std::map<wxString, PPToken>::const_iterator iter = table.begin();
@@ -1455,72 +1654,62 @@ void TagsStorageSQLite::GetMacrosDefined(const std::set<std::string>& files, con
 {
     if(files.empty() || usedMacros.empty()) { return; }
 
-    // Create the file list SQL string, used for IN operator
-    wxString sFileList;
+    // The file list, used for IN operator
+    wxArrayString fileList;
     for(std::set<std::string>::const_iterator itFile = files.begin(); itFile != files.end(); ++itFile) {
-        sFileList << wxT("'") << wxString::From8BitData(itFile->c_str()) << wxT("',");
+        fileList.Add(wxString::From8BitData(itFile->c_str()));
     }
-    sFileList.RemoveLast();
 
-    // Create the used macros list SQL string, used for IN operator
-    wxString sMacroList;
+    // The used macros list, used for IN operator
+    wxArrayString macroList;
     for(std::set<wxString>::const_iterator itUsedMacro = usedMacros.begin(); itUsedMacro != usedMacros.end();
         ++itUsedMacro) {
-        sMacroList << wxT("'") << *itUsedMacro << wxT("',");
-    }
-    sMacroList.RemoveLast();
-
-    try {
-        // Step 1 : Retrieve defined macros in MACROS table
-        wxString req;
-        req << wxT("select name from MACROS where file in (") << sFileList << wxT(")") << wxT(" and name in (")
-            << sMacroList << wxT(")");
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(req);
-        while(res.NextRow()) {
+        macroList.Add(*itUsedMacro);
+    }
+
+    // Step 1 : Retrieve defined macros in MACROS table
+    // Step 2 : Retrieve defined macros in SIMPLE_MACROS table
+    const wxString tables[] = { "MACROS", "SIMPLE_MACROS" };
+    for(const wxString& table : tables) {
+        clSqliteQuery query;
+        query << "select name from " << table << " where file in (";
+        query.AddArgList(fileList);
+        query << ") and name in (";
+        query.AddArgList(macroList);
+        query << ")";
+        DoQuery(query, [&](wxSQLite3ResultSet& res) {
             defMacros.push_back(res.GetString(0));
-        }
-
-        // Step 2 : Retrieve defined macros in SIMPLE_MACROS table
-        req.Clear();
-        req << wxT("select name from SIMPLE_MACROS where file in (") << sFileList << wxT(")") << wxT(" and name in (")
-            << sMacroList << wxT(")");
-        res = m_db->ExecuteQuery(req);
-        while(res.NextRow()) {
-            defMacros.push_back(res.GetString(0));
-        }
-    } catch(wxSQLite3Exception& exc) {
-        CL_DEBUG(wxT("%s"), exc.GetMessage().c_str());
+            return true;
+        });
     }
 }
 
 void TagsStorageSQLite::GetTagsByName(const wxString& prefix, std::vector<TagEntryPtr>& tags, bool exactMatch)
 {
-    try {
-        if(prefix.IsEmpty()) return;
-
-        wxString sql;
-        sql << wxT("select * from tags where ");
-        DoAddNamePartToQuery(sql, prefix, !exactMatch, false);
-        DoAddLimitPartToQuery(sql, tags);
-        DoFetchTags(sql, tags);
+    if(prefix.IsEmpty()) return;
 
-    } catch(wxSQLite3Exception& e) {
-        CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
-    }
+    clSqliteQuery query("select * from tags where ");
+    DoAddNamePartToQuery(query, prefix, !exactMatch, false);
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
-void TagsStorageSQLite::DoAddNamePartToQuery(wxString& sql, const wxString& name, bool partial, bool prependAnd)
+void TagsStorageSQLite::DoAddNamePartToQuery(clSqliteQuery& sql, const wxString& name, bool partial, bool prependAnd)
 {
     if(name.empty()) return;
-    if(prependAnd) { sql << wxT(" AND "); }
+    if(prependAnd) { sql << " AND "; }
 
     if(m_enableCaseInsensitive) {
         wxString tmpName(name);
         tmpName.Replace(wxT("_"), wxT("^_"));
         if(partial) {
-            sql << wxT(" name LIKE '") << tmpName << wxT("%%' ESCAPE '^' ");
+            sql << " name LIKE ";
+            sql.AddArg(tmpName + "%");
+            sql << " ESCAPE '^' ";
         } else {
-            sql << wxT(" name ='") << name << wxT("' ");
+            sql << " name =";
+            sql.AddArg(name);
+            sql << " ";
         }
     } else {
         // Don't use LIKE
@@ -1532,127 +1721,120 @@ void TagsStorageSQLite::DoAddNamePartToQuery(wxString& sql, const wxString& name
 
         // add the name condition
         if(partial) {
-            sql << wxT(" name >= '") << from << wxT("' AND  name < '") << until << wxT("'");
+            sql << " name >= ";
+            sql.AddArg(from);
+            sql << " AND  name < ";
+            sql.AddArg(until);
         } else {
-            sql << wxT(" name ='") << name << wxT("' ");
+            sql << " name =";
+            sql.AddArg(name);
+            sql << " ";
         }
     }
 }
 
-void TagsStorageSQLite::DoAddLimitPartToQuery(wxString& sql, const std::vector<TagEntryPtr>& tags)
+void TagsStorageSQLite::DoAddLimitPartToQuery(clSqliteQuery& sql, const std::vector<TagEntryPtr>& tags)
 {
+    sql << " LIMIT ";
     if(tags.size() >= (size_t)GetSingleSearchLimit()) {
-        sql << wxT(" LIMIT 1 ");
+        sql.AddArg(1);
     } else {
-        sql << wxT(" LIMIT ") << (size_t)GetSingleSearchLimit() - tags.size();
+        sql.AddArg(GetSingleSearchLimit() - (int)tags.size());
     }
 }
 
 TagEntryPtr TagsStorageSQLite::GetTagsByNameLimitOne(const wxString& name)
 {
-    try {
-        if(name.IsEmpty()) return NULL;
-
-        std::vector<TagEntryPtr> tags;
-        wxString sql;
-        sql << wxT("select * from tags where ");
-        DoAddNamePartToQuery(sql, name, false, false);
-        sql << wxT(" LIMIT 1 ");
+    if(name.IsEmpty()) return NULL;
 
-        DoFetchTags(sql, tags);
-        if(tags.size() == 1)
-            return tags.at(0);
-        else
-            return NULL;
+    std::vector<TagEntryPtr> tags;
+    clSqliteQuery query("select * from tags where ");
+    DoAddNamePartToQuery(query, name, false, false);
+    query << " LIMIT 1 ";
 
-    } catch(wxSQLite3Exception& e) {
-        CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
-    }
-    return NULL;
+    DoFetchTags(query, tags);
+    if(tags.size() == 1)
+        return tags.at(0);
+    else
+        return NULL;
 }
 
 void TagsStorageSQLite::GetTagsByPartName(const wxString& partname, std::vector<TagEntryPtr>& tags)
 {
-    try {
-        if(partname.IsEmpty()) return;
+    if(partname.IsEmpty()) return;
 
-        wxString tmpName(partname);
-        tmpName.Replace(wxT("_"), wxT("^_"));
-
-        wxString sql;
-        sql << wxT("select * from tags where name like '%%") << tmpName << wxT("%%' ESCAPE '^' ");
-        DoAddLimitPartToQuery(sql, tags);
-        DoFetchTags(sql, tags);
+    wxString tmpName(partname);
+    tmpName.Replace(wxT("_"), wxT("^_"));
 
-    } catch(wxSQLite3Exception& e) {
-        CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
-    }
+    clSqliteQuery query("select * from tags where name like ");
+    query.AddArg("%" + tmpName + "%");
+    query << " ESCAPE '^' ";
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::RemoveNonWorkspaceSymbols(const std::vector<wxString>& symbols,
                                                   std::vector<wxString>& workspaceSymbols,
                                                   std::vector<wxString>& nonWorkspaceSymbols)
 {
-    wxString sql;
-    try {
-        workspaceSymbols.clear();
-        nonWorkspaceSymbols.clear();
-        if(symbols.empty()) { return; }
-
-        // an example query
-        // SELECT distinct name FROM 'main'.'tags' where name in ('LoadList')
-        wxString kindSQL;
-        kindSQL << " AND KIND IN ('class', 'enum', 'cenum', 'prototype', 'macro', 'namespace', 'function', "
-                   "'struct','typedef')";
-
-        // Split the input vector into arrays of up to 500 elements each
-        std::vector<std::vector<wxString>> v;
-        int chunks = (symbols.size() / 250) + 1;
-        int offset = 0;
-        int left = symbols.size();
-        for(int i = 0; i < chunks; ++i) {
-            int amountToCopy = left > 250 ? 250 : left;
-            left -= amountToCopy;
-            if(amountToCopy > 0) {
-                std::vector<wxString> vChunk(symbols.begin() + offset, symbols.begin() + (offset + amountToCopy));
-                offset += amountToCopy;
-                v.push_back(vChunk);
-            }
+    workspaceSymbols.clear();
+    nonWorkspaceSymbols.clear();
+    if(symbols.empty()) { return; }
+
+    // an example query
+    // SELECT distinct name FROM 'main'.'tags' where name in ('LoadList')
+    wxString kindSQL;
+    kindSQL << " AND KIND IN " << WORKSPACE_SYMBOL_KINDS;
+
+    // Split the input vector into arrays of up to 250 elements each (the IN list of a prepared statement is kept
+    // short)
+    std::vector<wxArrayString> v;
+    for(size_t offset = 0; offset < symbols.size(); offset += 250) {
+        size_t amountToCopy = std::min(symbols.size() - offset, (size_t)250);
+        wxArrayString vChunk;
+        vChunk.reserve(amountToCopy);
+        for(size_t n = offset; n < (offset + amountToCopy); ++n) {
+            vChunk.Add(symbols[n]);
         }
+        v.push_back(vChunk);
+    }
 
-        std::vector<wxString> allSymbols;
-        for(size_t i = 0; i < v.size(); ++i) {
-            sql.Clear();
-            sql << "SELECT distinct name,kind FROM tags where name in (";
-            for(size_t n = 0; n < v[i].size(); ++n) {
-                sql << "'" << v[i][n] << "',";
-            }
+    std::vector<wxString> allSymbols;
+    for(size_t i = 0; i < v.size(); ++i) {
+        clSqliteQuery query("SELECT distinct name,kind FROM tags where name in (");
+        query.AddArgList(v[i]);
+        query << ")" << kindSQL;
 
-            // remove the last comma
-            sql.RemoveLast();
-            sql << ")";
-            sql << kindSQL;
-
-            // Run the query
-            wxSQLite3ResultSet res = m_db->ExecuteQuery(sql);
-            while(res.NextRow()) {
-                wxString name = res.GetString(0);
-                wxString kind = res.GetString(1);
-                allSymbols.push_back(name);
-                if((kind != "function") && (kind != "prototype") && (kind != "macro")) {
-                    workspaceSymbols.push_back(name);
-                }
-            }
-        }
+        // Run the query
+        DoQuery(query, [&](wxSQLite3ResultSet& res) {
+            wxString name = res.GetString(0);
+            wxString kind = res.GetString(1);
+            allSymbols.push_back(name);
+            if((kind != "function") && (kind != "prototype") && (kind != "macro")) { workspaceSymbols.push_back(name); }
+            return true;
+        });
+    }
 
-        std::sort(workspaceSymbols.begin(), workspaceSymbols.end());
-        std::sort(allSymbols.begin(), allSymbols.end());
-        std::set_difference(symbols.begin(), symbols.end(), allSymbols.begin(), allSymbols.end(),
-                            std::back_inserter(nonWorkspaceSymbols));
+    std::sort(workspaceSymbols.begin(), workspaceSymbols.end());
+    std::sort(allSymbols.begin(), allSymbols.end());
+    std::set_difference(symbols.begin(), symbols.end(), allSymbols.begin(), allSymbols.end(),
+                        std::back_inserter(nonWorkspaceSymbols));
+}
 
-    } catch(wxSQLite3Exception& e) {
-        clDEBUG() << "SplitSymbols error:" << sql << ":" << e.GetMessage() << clEndl;
-    }
+void TagsStorageSQLite::IncrementTagsGeneration()
+{
+    // runs in the transaction of the caller, errors are handled by it
+    m_db->ExecuteUpdate(wxT("update tags_generation set generation = generation + 1 where id = 1"));
+}
+
+wxUint64 TagsStorageSQLite::GetTagsGeneration()
+{
+    wxUint64 generation = 0;
+    DoQuery(clSqliteQuery("select generation from tags_generation where id = 1"), [&](wxSQLite3ResultSet& res) {
+        generation = res.GetInt64(0).GetValue();
+        return false;
+    });
+    return generation;
 }
 
 const wxString& TagsStorageSQLite::GetVersion() const
@@ -1663,24 +1845,20 @@ const wxString& TagsStorageSQLite::GetVersion() const
 
 void TagsStorageSQLite::GetTagsByPartName(const wxArrayString& parts, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    try {
-        if(parts.IsEmpty()) { return; }
-
-        wxString filterQuery = "where ";
-        for(size_t i = 0; i < parts.size(); ++i) {
-            wxString tmpName = parts.Item(i);
-            tmpName.Replace(wxT("_"), wxT("^_"));
-            filterQuery << "path like '%%" << tmpName << "%%' " << ((i == (parts.size() - 1)) ? "" : "AND ");
-        }
+    if(parts.IsEmpty()) { return; }
 
-        sql << "select * from tags " << filterQuery << " ESCAPE '^' ";
-        DoAddLimitPartToQuery(sql, tags);
-        DoFetchTags(sql, tags);
-
-    } catch(wxSQLite3Exception& e) {
-        clWARNING() << sql << ":" << e.GetMessage() << clEndl;
+    clSqliteQuery query("select * from tags where ");
+    for(size_t i = 0; i < parts.size(); ++i) {
+        wxString tmpName = parts.Item(i);
+        tmpName.Replace(wxT("_"), wxT("^_"));
+        if(i) { query << "AND "; }
+        query << "path like ";
+        query.AddArg("%" + tmpName + "%");
+        query << " ESCAPE '^' ";
     }
+
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::ReOpenDatabase()
@@ -1692,20 +1870,14 @@ void TagsStorageSQLite::ReOpenDatabase()
     // Close database first
     clDEBUG() << "Closing database first";
     try {
-        if(m_db) {
-            m_db->Close();
-            delete m_db;
-            m_db = nullptr;
-        }
+        m_db->Close();
     } catch(...) {
     }
 
     clDEBUG() << "Open is called for file:" << m_fileName;
     try {
-        // First time we open the db
-        m_db->Open(m_fileName.GetFullPath());
-        m_db->SetBusyTimeout(10);
-        CreateSchema();
+        BumpGeneration(m_fileName.GetFullPath());
+        m_db = DoGetConnection(m_fileName);
     } catch(wxSQLite3Exception& e) {
         clWARNING() << "Failed to reopen file:" << m_fileName.GetFullPath() << "." << e.GetMessage();
     }
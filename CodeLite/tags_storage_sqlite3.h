@@ -25,12 +25,15 @@
 #ifndef CODELITE_TAGS_DATABASE_H
 #define CODELITE_TAGS_DATABASE_H
 
+#include "clCompactTag.h"
 #include "codelite_exports.h"
 #include "entry.h"
 #include "fileentry.h"
 #include "istorage.h"
 #include "tag_tree.h"
 #include "wxStringHash.h"
+#include <functional>
+#include <memory>
 #include <unordered_map>
 #include <wx/filename.h>
 #include <wx/wxsqlite3.h>
@@ -92,11 +95,25 @@
 
 class TagsStorageSQLiteCache
 {
-    std::unordered_map<wxString, std::vector<TagEntryPtr>> m_cache;
+    // The cached tags are kept in their compact form: a query such as "all the classes of the workspace" can return
+    // hundreds of thousands of tags. The TagEntry objects of the smaller entries are built on their first hit and
+    // shared by the following hits, up to a total number of tags
+    struct Entry {
+        std::vector<clCompactTag> tags;
+        std::vector<TagEntryPtr> materialized;
+        size_t bytes = 0; // the size of the strings added to m_store by this entry
+    };
+    std::unordered_map<wxString, Entry> m_cache;
+    // The strings of the replaced entries stay in the store until it is compacted
+    clCompactTagStore m_store;
+    size_t m_garbageBytes = 0;
+    size_t m_materializedCount = 0;
 
 protected:
     bool DoGet(const wxString& key, std::vector<TagEntryPtr>& tags);
     void DoStore(const wxString& key, const std::vector<TagEntryPtr>& tags);
+    void DoReleaseMaterialized();
+    void DoCompact();
 
 public:
     TagsStorageSQLiteCache();
@@ -109,6 +126,83 @@ public:
     void Clear();
 };
 
+/**
+ * @class clSqliteQuery
+ * @brief an SQL statement with '?' placeholders and the values to bind to them. The SQL text does not contain the
+ * values, so a single prepared statement serves all the executions of a query (see clSqliteDB::GetPrepareStatement)
+ */
+class WXDLLIMPEXP_CL clSqliteQuery
+{
+    struct Arg {
+        wxString str;
+        int num = 0;
+        bool isNull = false;
+        bool isNumber = false;
+    };
+
+    wxString m_sql;
+    wxString m_statsSql; // m_sql without the literal lists, set once the query is no longer cacheable
+    std::vector<Arg> m_args;
+    bool m_cacheable = true;
+
+public:
+    clSqliteQuery() {}
+    clSqliteQuery(const wxString& sql)
+        : m_sql(sql)
+    {
+    }
+
+    /**
+     * @brief append SQL text. Never append values this way, use AddArg() instead
+     */
+    clSqliteQuery& operator<<(const wxString& sql)
+    {
+        m_sql << sql;
+        if(!m_cacheable) { m_statsSql << sql; }
+        return *this;
+    }
+
+    /**
+     * @brief append a '?' placeholder bound to 'value'
+     */
+    clSqliteQuery& AddArg(const wxString& value);
+    clSqliteQuery& AddArg(int value);
+
+    /**
+     * @brief append a list of placeholders ("?,?,?") bound to 'values', to be used with the IN operator. The list is
+     * padded with NULLs to the next power of 2, so queries with lists of similar sizes share the same statement. Very
+     * long lists are added as literals
+     */
+    clSqliteQuery& AddArgList(const wxArrayString& values);
+
+    const wxString& GetSql() const { return m_sql; }
+
+    /**
+     * @brief the SQL text used to collect the query statistics: the literal lists are replaced by a single marker,
+     * so all the executions of a query share the same text
+     */
+    const wxString& GetStatsSql() const { return m_cacheable ? m_sql : m_statsSql; }
+
+    /**
+     * @brief can the prepared statement of this query be kept for later use?
+     */
+    bool IsCacheable() const { return m_cacheable; }
+
+    /**
+     * @brief the SQL text and the values: identifies the results of the query
+     */
+    wxString GetKey() const;
+
+    /**
+     * @brief bind the values to 'statement'
+     */
+    void Bind(wxSQLite3Statement& statement) const;
+};
+
+/**
+ * @class clSqliteDB
+ * @brief an SQLite connection that keeps its prepared statements
+ */
 class WXDLLIMPEXP_CL clSqliteDB : public wxSQLite3Database
 {
     std::unordered_map<wxString, wxSQLite3Statement> m_statements;
@@ -119,20 +213,27 @@ public:
     {
     }
 
+    virtual ~clSqliteDB() { Close(); }
+
     void Close()
     {
-        if(IsOpen()) wxSQLite3Database::Close();
-
+        // the statements must be finalized before the connection is closed
         m_statements.clear();
+        if(IsOpen()) wxSQLite3Database::Close();
     }
 
-    wxSQLite3Statement GetPrepareStatement(const wxString& sql) { return wxSQLite3Database::PrepareStatement(sql); }
+    /**
+     * @brief return the prepared statement of 'sql', preparing it on the first call. The statement is owned by the
+     * connection and is reset (and its bindings cleared) every time it is returned
+     */
+    wxSQLite3Statement& GetPrepareStatement(const wxString& sql);
 };
 
 class WXDLLIMPEXP_CL TagsStorageSQLite : public ITagsStorage
 {
-    clSqliteDB* m_db;
+    std::shared_ptr<clSqliteDB> m_db;
     TagsStorageSQLiteCache m_cache;
+    bool m_transactionStarted = false; // the connection is shared, only roll back our own transaction
 
 private:
     /**
@@ -140,17 +241,37 @@ private:
      * @param sql
      * @param tags
      */
-    void DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags);
+    void DoFetchTags(const clSqliteQuery& query, std::vector<TagEntryPtr>& tags);
 
     /**
-     * @brief
-     * @param sql
-     * @param tags
+     * @brief fetch tags from the database, keeping only the tags of the given kinds
+     */
+    void DoFetchTags(const clSqliteQuery& query, std::vector<TagEntryPtr>& tags, const wxArrayString& kinds);
+
+    /**
+     * @brief run 'query' and call 'onRow' for every row of the result, until it returns false. The statement is reset
+     * before returning, so it does not keep the read transaction open
+     */
+    void DoQuery(const clSqliteQuery& query, const std::function<bool(wxSQLite3ResultSet&)>& onRow);
+
+    /**
+     * @brief execute an update query. Throws wxSQLite3Exception on error
      */
-    void DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags, const wxArrayString& kinds);
+    void DoExecuteUpdate(const clSqliteQuery& query);
 
-    void DoAddNamePartToQuery(wxString& sql, const wxString& name, bool partial, bool prependAnd);
-    void DoAddLimitPartToQuery(wxString& sql, const std::vector<TagEntryPtr>& tags);
+    /**
+     * @brief increment the tags generation. Called by the methods that add or remove tags. Throws
+     * wxSQLite3Exception on error
+     */
+    void IncrementTagsGeneration();
+
+    /**
+     * @brief return the connection of the calling thread to 'fileName', opening it if needed
+     */
+    std::shared_ptr<clSqliteDB> DoGetConnection(const wxFileName& fileName);
+
+    void DoAddNamePartToQuery(clSqliteQuery& sql, const wxString& name, bool partial, bool prependAnd);
+    void DoAddLimitPartToQuery(clSqliteQuery& sql, const std::vector<TagEntryPtr>& tags);
     int DoInsertTagEntry(const TagEntry& tag);
 
 public:
@@ -186,7 +307,8 @@ public:
     const wxFileName& GetDatabaseFileName() const { return m_fileName; }
 
     /**
-     * Open sqlite database.
+     * Open sqlite database. The connection (and its prepared statements) is shared by all the TagsStorageSQLite
+     * objects of the calling thread, so the object must be used by the thread that opened it
      * @param fileName Database file name
      */
     void OpenDatabase(const wxFileName& fileName);
@@ -262,12 +384,14 @@ public:
     virtual void GetSubscriptOperator(const wxString& scope, std::vector<TagEntryPtr>& tags);
 
     /**
-     * Begin transaction.
+     * Begin transaction. The write lock is taken immediately: there is a single writer at a time, while the readers
+     * (other threads) keep reading the last committed data
      */
     void Begin()
     {
         try {
-            m_db->Begin();
+            m_db->Begin(WXSQLITE_TRANSACTION_IMMEDIATE);
+            m_transactionStarted = true;
         } catch(wxSQLite3Exception& e) {
             wxUnusedVar(e);
         }
@@ -278,6 +402,7 @@ public:
      */
     void Commit()
     {
+        m_transactionStarted = false;
         try {
             m_db->Commit();
         } catch(wxSQLite3Exception& e) {
@@ -288,7 +413,11 @@ public:
     /**
      * Rollback transaction.
      */
-    void Rollback() { return m_db->Rollback(); }
+    void Rollback()
+    {
+        m_transactionStarted = false;
+        m_db->Rollback();
+    }
 
     /**
      * Test whether the database is opened
@@ -631,6 +760,11 @@ public:
      */
     void RemoveNonWorkspaceSymbols(const std::vector<wxString>& symbols, std::vector<wxString>& workspaceSymbols,
                                    std::vector<wxString>& nonWorkspaceSymbols);
+
+    /**
+     * @brief return the tags generation, see ITagsStorage::GetTagsGeneration
+     */
+    wxUint64 GetTagsGeneration();
 };
 
 #endif // CODELITE_TAGS_DATABASE_H
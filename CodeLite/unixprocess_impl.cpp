@@ -31,6 +31,7 @@
 #include "SocketAPI/clSocketBase.h"
 #include <thread>
 #include "StringUtils.h"
+#include "clProcessReactor.h"
 
 #if defined(__WXMAC__) || defined(__WXGTK__)
 
@@ -273,6 +274,10 @@ UnixProcessImpl::~UnixProcessImpl() { Cleanup(); }
 
 void UnixProcessImpl::Cleanup()
 {
+    // Stop monitoring the descriptors before we close them
+    if(m_usingReactor && clProcessReactor::Get()) { clProcessReactor::Get()->Remove(this); }
+    m_usingReactor = false;
+
     close(GetReadHandle());
     close(GetWriteHandle());
     if(GetStderrHandle() != wxNOT_FOUND) { close(GetStderrHandle()); }
@@ -509,6 +514,12 @@ IProcess* UnixProcessImpl::Execute(wxEvtHandler* parent, const wxString& cmd, si
 
 void UnixProcessImpl::StartReaderThread()
 {
+    // Redirected processes share a single reactor thread where available
+    if(IsRedirect() && clProcessReactor::IsSupported() && clProcessReactor::Get()) {
+        m_usingReactor = clProcessReactor::Get()->Add(this, m_parent, GetReadHandle(), GetStderrHandle(), m_flags);
+        if(m_usingReactor) { return; }
+    }
+
     // Launch the 'Reader' thread
     m_thr = new ProcessReaderThread();
     m_thr->SetProcess(this);
@@ -536,6 +547,8 @@ bool UnixProcessImpl::WriteToConsole(const wxString& buff)
 
 void UnixProcessImpl::Detach()
 {
+    if(m_usingReactor && clProcessReactor::Get()) { clProcessReactor::Get()->Remove(this); }
+    m_usingReactor = false;
     if(m_thr) {
         // Stop the reader thread
         m_thr->Stop();
@@ -38,6 +38,7 @@ class WXDLLIMPEXP_CL UnixProcessImpl : public IProcess
     int m_stderrHandle = wxNOT_FOUND;
     int m_writeHandle;
     ProcessReaderThread* m_thr = nullptr;
+    bool m_usingReactor = false;
     wxString m_tty;
     friend class wxTerminal;
 private:
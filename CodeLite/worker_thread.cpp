@@ -32,15 +32,17 @@ WorkerThread::WorkerThread()
 
 WorkerThread::~WorkerThread() { Stop(); }
 
-static ThreadRequest* QueueGet(std::mutex& m, std::queue<ThreadRequest*>& q, std::condition_variable& cv)
+static ThreadRequest* QueueGet(std::mutex& m, std::queue<ThreadRequest*>& priorityQ, std::queue<ThreadRequest*>& q,
+                               std::condition_variable& cv)
 {
     std::unique_lock<std::mutex> lock{ m }; // acquiring the mutex
-    while(q.empty()) {
+    while(priorityQ.empty() && q.empty()) {
         cv.wait(lock); // waiting to be notified of new data
     }
 
-    ThreadRequest* req = q.front(); // moving the front element
-    q.pop();                        // which is immediately deleted
+    std::queue<ThreadRequest*>& from = priorityQ.empty() ? q : priorityQ;
+    ThreadRequest* req = from.front(); // moving the front element
+    from.pop();                        // which is immediately deleted
 
     return req;
 }
@@ -60,7 +62,7 @@ void* WorkerThread::Entry()
         if(TestDestroy()) break;
 
         // Get the next entry from the queue
-        ThreadRequest* request = QueueGet(m_mutex, m_Q, m_cv);
+        ThreadRequest* request = QueueGet(m_mutex, m_priorityQ, m_Q, m_cv);
         if(request == nullptr) {
             // this dummy message was sent to tell us to exit
             break;
@@ -78,6 +80,12 @@ void WorkerThread::Add(ThreadRequest* request)
     QueuePut(m_mutex, m_Q, m_cv, request);
 }
 
+void WorkerThread::AddPriority(ThreadRequest* request)
+{
+    if(!request) { return; }
+    QueuePut(m_mutex, m_priorityQ, m_cv, request);
+}
+
 void WorkerThread::Stop()
 {
     // Notify the thread to exit and
@@ -105,4 +113,7 @@ void WorkerThread::ClearQueue()
     while(!m_Q.empty()) {
         m_Q.pop();
     }
+    while(!m_priorityQ.empty()) {
+        m_priorityQ.pop();
+    }
 }
@@ -55,6 +55,8 @@ protected:
     std::mutex m_mutex;
     std::condition_variable m_cv;
     std::queue<ThreadRequest*> m_Q;
+    // processed before the requests of m_Q
+    std::queue<ThreadRequest*> m_priorityQ;
 
 public:
     /**
@@ -84,6 +86,13 @@ public:
      */
     void Add(ThreadRequest* request);
 
+    /**
+     * Add a request that is processed before all the requests that were added with Add() (the priority requests are
+     * processed in the order they were added). The request that is currently being processed is not interrupted
+     * \param request request to execute.
+     */
+    void AddPriority(ThreadRequest* request);
+
     /**
      * @brief clear the request queue
      */
@@ -69,6 +69,7 @@ CL_PLUGIN_API PluginInfo* GetPluginInfo()
     info.SetDescription(
         _("Copyright Plugin - a small plugin that allows you to place copyright block on top of your source files"));
     info.SetVersion(wxT("v1.0"));
+    info.EnableFlag(PluginInfo::kLazyActivation, true);
     return &info;
 }
 
@@ -1,5 +1,6 @@
 #include "CxxTokenizer.h"
 #include "CxxVariableScanner.h"
+#include "clJSONDocument.h"
 #include "ctags_manager.h"
 #include "fileutils.h"
 #include "tester.h"
@@ -188,6 +189,46 @@ TEST_FUNC(test_local_in_std_for_each)
     return true;
 }
 
+TEST_FUNC(test_json_numbers)
+{
+    clJSONDocument doc;
+    CHECK_BOOL(doc.Parse(std::string("[1.5e3, -0.25, 12, 0, 1E-2]")));
+    clJSONValue arr = doc.toElement();
+    CHECK_SIZE(arr.arraySize(), 5);
+    CHECK_BOOL(arr[0].toDouble() == 1500.0);
+    CHECK_BOOL(arr[1].toDouble() == -0.25);
+    CHECK_SIZE(arr[2].toInt(), 12);
+    CHECK_SIZE(arr[3].toInt(), 0);
+    CHECK_BOOL(arr[4].toDouble() == 0.01);
+
+    // digits are required after '-', '.' and the exponent
+    CHECK_BOOL(!doc.Parse(std::string("1.")));
+    CHECK_BOOL(!doc.Parse(std::string("-")));
+    CHECK_BOOL(!doc.Parse(std::string("[1e]")));
+    return true;
+}
+
+TEST_FUNC(test_json_surrogates)
+{
+    clJSONDocument doc;
+    CHECK_BOOL(doc.Parse(std::string("\"\\uD83D\\uDE00\"")));
+    CHECK_BOOL(doc.toElement().toStdString() == "\xF0\x9F\x98\x80");
+
+    CHECK_BOOL(!doc.Parse(std::string("\"\\uD800\"")));
+    CHECK_BOOL(!doc.Parse(std::string("\"\\uDC00\"")));
+    CHECK_BOOL(!doc.Parse(std::string("\"\\uD800\\u0041\"")));
+    return true;
+}
+
+TEST_FUNC(test_json_trailing_data)
+{
+    clJSONDocument doc;
+    CHECK_BOOL(doc.Parse(std::string(" {\"a\": 1} \n")));
+    CHECK_BOOL(!doc.Parse(std::string("{} x")));
+    CHECK_BOOL(!doc.Parse(std::string("[1] [2]")));
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     wxInitializer initializer(argc, argv);
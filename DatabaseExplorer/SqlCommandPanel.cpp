@@ -25,9 +25,9 @@
 
 #include "DbViewerPanel.h"
 #include "SqlCommandPanel.h"
+#include "SqlQueryThread.h"
 #include "bitmap_loader.h"
 #include "clKeyboardManager.h"
-#include "clStatusBarMessage.h"
 #include "cl_aui_tool_stickness.h"
 #include "cl_defs.h"
 #include "db_explorer_settings.h"
@@ -55,6 +55,21 @@
 
 const wxEventType wxEVT_EXECUTE_SQL = XRCID("wxEVT_EXECUTE_SQL");
 
+// Fetching an earlier page of the results executes the statement again. This is only safe for a single read-only
+// SELECT: a script, or any statement that modifies the database, must run exactly once
+static bool IsReadOnlySelect(const wxArrayString& sqls)
+{
+    if(sqls.GetCount() != 1) { return false; }
+    wxString sql = sqls.Item(0).Lower();
+    sql.Replace("\t", " ");
+    sql.Replace("\r", " ");
+    sql.Replace("\n", " ");
+    sql.Trim().Trim(false);
+    if(!sql.StartsWith("select ") && !sql.StartsWith("select*")) { return false; }
+    // "SELECT ... INTO" creates or fills a table
+    return sql.Find(" into ") == wxNOT_FOUND;
+}
+
 BEGIN_EVENT_TABLE(SQLCommandPanel, _SqlCommandPanel)
 EVT_COMMAND(wxID_ANY, wxEVT_EXECUTE_SQL, SQLCommandPanel::OnExecuteSQL)
 END_EVENT_TABLE()
@@ -62,6 +77,11 @@ END_EVENT_TABLE()
 SQLCommandPanel::SQLCommandPanel(wxWindow* parent, IDbAdapter* dbAdapter, const wxString& dbName,
                                  const wxString& dbTable)
     : _SqlCommandPanel(parent)
+    , m_queryThread(nullptr)
+    , m_queryId(0)
+    , m_columnsSet(false)
+    , m_canExecuteAgain(false)
+    , m_spoolLastPage(wxNOT_FOUND)
 {
     LexerConf::Ptr_t lexerSQL = EditorConfigST::Get()->GetLexer("SQL");
     if(lexerSQL) {
@@ -99,15 +119,22 @@ SQLCommandPanel::SQLCommandPanel(wxWindow* parent, IDbAdapter* dbAdapter, const
     m_toolbar = new clToolBar(this);
     m_toolbar->AddTool(wxID_OPEN, _("Load SQL Script"), bmpLoader->LoadBitmap("file_open"));
     m_toolbar->AddTool(wxID_EXECUTE, _("Execute SQL"), bmpLoader->LoadBitmap("execute"));
+    m_toolbar->AddTool(wxID_STOP, _("Cancel query"), bmpLoader->LoadBitmap("stop"));
     m_toolbar->Realize();
     GetSizer()->Insert(0, m_toolbar, 0, wxEXPAND);
 
     // Bind events
     m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnExecuteClick, this, wxID_EXECUTE);
     m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnLoadClick, this, wxID_OPEN);
+    m_toolbar->Bind(wxEVT_TOOL, &SQLCommandPanel::OnCancelClick, this, wxID_STOP);
+    m_toolbar->Bind(wxEVT_UPDATE_UI, &SQLCommandPanel::OnCancelUI, this, wxID_STOP);
 }
 
-SQLCommandPanel::~SQLCommandPanel() { wxDELETE(m_pDbAdapter); }
+SQLCommandPanel::~SQLCommandPanel()
+{
+    DoStopQuery();
+    wxDELETE(m_pDbAdapter);
+}
 
 void SQLCommandPanel::OnExecuteClick(wxCommandEvent& event) { ExecuteSql(); }
 
@@ -121,156 +148,127 @@ void SQLCommandPanel::OnScintilaKeyDown(wxKeyEvent& event)
 
 void SQLCommandPanel::ExecuteSql()
 {
-    clStatusBarMessage message(_("Executing SQL..."));
-
-    clWindowUpdateLocker locker(this);
-    std::set<int> textCols;
-    std::set<int> blobCols;
-    DatabaseLayerPtr m_pDbLayer = m_pDbAdapter->GetDatabaseLayer(m_dbName);
-    if(m_pDbLayer->IsOpen()) {
-        // build string of SQL statements with comments removed
-        wxArrayString sqls = ParseSql();
-        wxString sqlStmt = "";
-        for(size_t i = 0; i < sqls.GetCount(); i++) {
-            sqlStmt += sqls[i];
-        }
+    // build string of SQL statements with comments removed
+    wxArrayString sqls = ParseSql();
+    wxString sqlStmt = "";
+    for(size_t i = 0; i < sqls.GetCount(); i++) {
+        sqlStmt += sqls[i];
+    }
 
-        // save the history
-        SaveSqlHistory(sqls);
-
-        if(!sqls.IsEmpty()) {
-            try {
-                m_colsMetaData.clear();
-                if(!m_pDbAdapter->GetUseDb(m_dbName).IsEmpty()) m_pDbLayer->RunQuery(m_pDbAdapter->GetUseDb(m_dbName));
-                // run query
-                DatabaseResultSet* pResultSet = m_pDbLayer->RunQueryWithResults(sqlStmt);
-
-                m_table->ClearAll();
-                if(!pResultSet) {
-                    wxMessageBox(_("Unknown SQL error."), _("DB Error"), wxOK | wxICON_ERROR);
-                    return;
-                }
-
-                int cols = pResultSet->GetMetaData()->GetColumnCount();
-                m_colsMetaData.resize(cols);
-
-                // create table header
-                wxArrayString columns;
-                for(int i = 1; i <= pResultSet->GetMetaData()->GetColumnCount(); i++) {
-                    columns.Add(pResultSet->GetMetaData()->GetColumnName(i));
-                    m_colsMetaData.at(i - 1) = ColumnInfo(pResultSet->GetMetaData()->GetColumnType(i),
-                                                          pResultSet->GetMetaData()->GetColumnName(i));
-                }
-                m_table->SetColumns(columns);
-
-                // fill table data
-                std::vector<wxArrayString> data;
-                while(pResultSet->Next()) {
-                    data.push_back(wxArrayString());
-                    wxArrayString& row = data.back();
-                    wxString value;
-                    for(int i = 1; i <= pResultSet->GetMetaData()->GetColumnCount(); i++) {
-
-                        switch(pResultSet->GetMetaData()->GetColumnType(i)) {
-                        case ResultSetMetaData::COLUMN_INTEGER:
-                            if(m_pDbAdapter->GetAdapterType() == IDbAdapter::atSQLITE) {
-                                value = pResultSet->GetResultString(i);
-
-                            } else {
-                                value = wxString::Format(wxT("%i"), pResultSet->GetResultInt(i));
-                            }
-                            break;
-
-                        case ResultSetMetaData::COLUMN_STRING:
-                            value = pResultSet->GetResultString(i);
-                            break;
-
-                        case ResultSetMetaData::COLUMN_UNKNOWN:
-                            value = pResultSet->GetResultString(i);
-                            break;
-
-                        case ResultSetMetaData::COLUMN_BLOB: {
-                            if(textCols.find(i) != textCols.end()) {
-                                // this column should be displayed as TEXT rather than BLOB
-                                value = pResultSet->GetResultString(i);
-
-                            } else if(blobCols.find(i) != blobCols.end()) {
-                                // this column should be displayed as BLOB
-                                wxMemoryBuffer buffer;
-                                pResultSet->GetResultBlob(i, buffer);
-                                value = wxString::Format(wxT("BLOB (Size:%u)"), buffer.GetDataLen());
-
-                            } else {
-                                // first time
-                                wxString strCol = pResultSet->GetResultString(i);
-                                if(IsBlobColumn(strCol)) {
-                                    blobCols.insert(i);
-                                    wxMemoryBuffer buffer;
-                                    pResultSet->GetResultBlob(i, buffer);
-                                    value = wxString::Format(wxT("BLOB (Size:%u)"), buffer.GetDataLen());
-
-                                } else {
-                                    textCols.insert(i);
-                                    value = strCol;
-                                }
-                            }
-                            break;
-                        }
-                        case ResultSetMetaData::COLUMN_BOOL:
-                            value = wxString::Format(wxT("%b"), pResultSet->GetResultBool(i));
-                            break;
-
-                        case ResultSetMetaData::COLUMN_DATE: {
-                            wxDateTime dt = pResultSet->GetResultDate(i);
-                            if(dt.IsValid()) {
-                                value = dt.Format();
-                            } else {
-                                value.Clear();
-                            }
-                        } break;
-
-                        case ResultSetMetaData::COLUMN_DOUBLE:
-                            value = wxString::Format(wxT("%f"), pResultSet->GetResultDouble(i));
-                            break;
-
-                        case ResultSetMetaData::COLUMN_NULL:
-                            value = wxT("NULL");
-                            break;
-
-                        default:
-                            value = pResultSet->GetResultString(i);
-                            break;
-                        }
-                        row.Add(value);
-                    }
-                }
-                m_pDbLayer->CloseResultSet(pResultSet);
-
-                // Popuplate the data
-                m_table->SetData(data);
-                GetSizer()->Layout();
-                Layout();
-
-            } catch(DatabaseLayerException& e) {
-                // for some reason an exception is thrown even if the error code is 0...
-                if(e.GetErrorCode() != 0) {
-                    wxString errorMessage =
-                        wxString::Format(_("Error (%d): %s"), e.GetErrorCode(), e.GetErrorMessage().c_str());
-                    wxMessageDialog dlg(this, errorMessage, _("DB Error"), wxOK | wxCENTER | wxICON_ERROR);
-                    dlg.ShowModal();
-                }
-
-            } catch(...) {
-                wxMessageDialog dlg(this, _("Unknown error."), _("DB Error"), wxOK | wxCENTER | wxICON_ERROR);
-                dlg.ShowModal();
-            }
-        }
+    // save the history
+    SaveSqlHistory(sqls);
+    if(sqls.IsEmpty()) { return; }
+
+    // Cancel the previous query. Replies that are still pending are ignored (they carry the old query id)
+    DoStopQuery();
+    ++m_queryId;
+    m_sql = sqlStmt;
+    m_canExecuteAgain = IsReadOnlySelect(sqls);
+    m_spool.clear();
+    m_spoolLastPage = wxNOT_FOUND;
+    m_columnsSet = false;
+    m_colsMetaData.clear();
+    m_table->SetPageSource(nullptr);
+    m_table->ClearAll();
+    if(!DoStartQuery()) { return; }
+
+    // The rows are fetched by the query thread one page at a time, as the user browses the table
+    m_table->SetPageSource(this);
+}
 
-    } else {
+bool SQLCommandPanel::DoStartQuery()
+{
+    DatabaseLayerPtr pDbLayer = m_pDbAdapter->GetDatabaseLayer(m_dbName);
+    if(!pDbLayer || !pDbLayer->IsOpen()) {
         wxMessageBox(_("Cant connect!"));
+        return false;
+    }
+
+    // From here on, the connection is used by the query thread only
+    m_queryThread = new SqlQueryThread(this, m_queryId, pDbLayer, m_sql, m_pDbAdapter->GetUseDb(m_dbName),
+                                       m_pDbAdapter->GetAdapterType() == IDbAdapter::atSQLITE, m_canExecuteAgain,
+                                       m_table->GetLinesPerPage());
+    m_queryThread->Start();
+    clGetManager()->SetStatusMessage(_("Executing SQL..."));
+    return true;
+}
+
+void SQLCommandPanel::DoStopQuery()
+{
+    if(m_queryThread) {
+        // Stop() returns once the thread finished reading the current row
+        m_queryThread->Stop();
+        wxDELETE(m_queryThread);
     }
 }
 
+void SQLCommandPanel::OnCancelClick(wxCommandEvent& event)
+{
+    wxUnusedVar(event);
+    DoStopQuery();
+    // The pages that were not delivered are requested again (by a new query thread) if the user browses to them.
+    // A statement that can not be executed again only shows the rows that were already received
+    m_table->ResetPendingPages();
+    clGetManager()->SetStatusMessage(_("Query cancelled"), 3);
+}
+
+void SQLCommandPanel::OnCancelUI(wxUpdateUIEvent& event) { event.Enable(m_queryThread != nullptr); }
+
+void SQLCommandPanel::RequestPage(int nPage)
+{
+    if(m_sql.IsEmpty()) { return; }
+    if(!m_canExecuteAgain) {
+        // the statement is never executed twice: the pages we already have are served from the spool
+        std::map<int, std::vector<wxArrayString> >::const_iterator iter = m_spool.find(nPage);
+        if(iter != m_spool.end()) {
+            std::vector<wxArrayString> rows = iter->second;
+            m_table->SetPage(nPage, rows, nPage == m_spoolLastPage);
+            return;
+        }
+        if(!m_queryThread) {
+            // the statement was cancelled or failed, there are no more rows
+            std::vector<wxArrayString> rows;
+            m_table->SetPage(nPage, rows, true);
+            return;
+        }
+    }
+    if(!m_queryThread && !DoStartQuery()) { return; }
+    m_queryThread->Add(new SqlQueryPageRequest(nPage));
+}
+
+void SQLCommandPanel::OnQueryReply(std::shared_ptr<SqlQueryReply> reply)
+{
+    if(reply->queryId != m_queryId) {
+        // a reply for a query that was replaced or cancelled
+        return;
+    }
+
+    if(!reply->errorMessage.IsEmpty()) {
+        DoStopQuery();
+        m_table->ResetPendingPages();
+        clGetManager()->SetStatusMessage(wxEmptyString);
+        wxMessageDialog dlg(this, reply->errorMessage, _("DB Error"), wxOK | wxCENTER | wxICON_ERROR);
+        dlg.ShowModal();
+        return;
+    }
+
+    // A new query thread (e.g. after the query was cancelled) sends the columns again, keep the ones we have
+    if(!m_columnsSet) {
+        m_columnsSet = true;
+        m_colsMetaData.swap(reply->colsMetaData);
+        m_table->SetColumns(reply->columns);
+        GetSizer()->Layout();
+        Layout();
+    }
+
+    if(!m_canExecuteAgain) {
+        m_spool[reply->page] = reply->rows;
+        if(reply->lastPage) { m_spoolLastPage = reply->page; }
+    }
+    m_table->SetPage(reply->page, reply->rows, reply->lastPage);
+    if(reply->page == 0) { clGetManager()->SetStatusMessage(_("Done"), 3); }
+}
+
 void SQLCommandPanel::OnLoadClick(wxCommandEvent& event)
 {
     wxFileDialog dlg(this, _("Choose a file"), wxT(""), wxT(""), wxT("Sql files(*.sql)|*.sql"),
@@ -365,16 +363,6 @@ void SQLCommandPanel::OnCopyCellValue(wxCommandEvent& e)
     }
 }
 
-bool SQLCommandPanel::IsBlobColumn(const wxString& str)
-{
-    for(size_t i = 0; i < str.Len(); i++) {
-        if(!wxIsprint(str.GetChar(i))) {
-            return true;
-        }
-    }
-    return false;
-}
-
 void SQLCommandPanel::SetDefaultSelect()
 {
     m_scintillaSQL->ClearAll();
@@ -40,9 +40,12 @@
 #include <wx/dblayer/include/DatabaseErrorCodes.h>
 
 #include <map>
+#include <memory>
 
 // ----------------------------------------------------------------
 class clToolBar;
+class SqlQueryThread;
+class SqlQueryReply;
 class ColumnInfo
 {
     int m_type;
@@ -72,7 +75,7 @@ public:
 };
 
 // ----------------------------------------------------------------
-class SQLCommandPanel : public _SqlCommandPanel
+class SQLCommandPanel : public _SqlCommandPanel, public clTablePageSource
 {
 
     int m_OperatorStyle;
@@ -88,11 +91,25 @@ protected:
     ColumnInfo::Vector_t m_colsMetaData;
     clEditEventsHandler::Ptr_t m_editHelper;
     clToolBar* m_toolbar;
+    SqlQueryThread* m_queryThread;
+    size_t m_queryId;
+    wxString m_sql;
+    bool m_columnsSet;
+    bool m_canExecuteAgain;
+    // the pages received for a statement that can not be executed again
+    std::map<int, std::vector<wxArrayString> > m_spool;
+    int m_spoolLastPage;
 
 protected:
-    bool IsBlobColumn(const wxString& str);
     wxArrayString ParseSql() const;
     void SaveSqlHistory(wxArrayString sqls);
+    bool DoStartQuery();
+    void DoStopQuery();
+    void OnCancelClick(wxCommandEvent& event);
+    void OnCancelUI(wxUpdateUIEvent& event);
+
+    // clTablePageSource
+    virtual void RequestPage(int nPage);
 
 public:
     SQLCommandPanel(wxWindow* parent, IDbAdapter* dbAdapter, const wxString& dbName, const wxString& dbTable);
@@ -109,6 +126,8 @@ public:
     void ExecuteSql();
     void SetDefaultSelect();
     void OnCopyCellValue(wxCommandEvent& e);
+    // the reply is shared: it is freed even when the panel is destroyed before the call is delivered
+    void OnQueryReply(std::shared_ptr<SqlQueryReply> reply);
     DECLARE_EVENT_TABLE()
     void OnExecuteSQL(wxCommandEvent& e);
 };
@@ -0,0 +1,239 @@
+#include "SqlQueryThread.h"
+#include <wx/dblayer/include/DatabaseLayerException.h>
+
+SqlQueryThread::SqlQueryThread(SQLCommandPanel* owner, size_t queryId, DatabaseLayerPtr db, const wxString& sql,
+                               const wxString& useDb, bool isSqlite, bool canExecuteAgain, int linesPerPage)
+    : m_owner(owner)
+    , m_queryId(queryId)
+    , m_db(db)
+    , m_sql(sql.c_str()) // the strings are used by the worker thread, make our own copy
+    , m_useDb(useDb.c_str())
+    , m_isSqlite(isSqlite)
+    , m_canExecuteAgain(canExecuteAgain)
+    , m_linesPerPage(linesPerPage)
+    , m_resultSet(nullptr)
+    , m_metaData(nullptr)
+    , m_rowIndex(0)
+    , m_eof(false)
+{
+}
+
+SqlQueryThread::~SqlQueryThread() {}
+
+void SqlQueryThread::OnExit()
+{
+    // release the result set and the connection from the thread that used them
+    DoCloseResultSet();
+    m_db.Reset(nullptr);
+}
+
+void SqlQueryThread::ProcessRequest(ThreadRequest* request)
+{
+    SqlQueryPageRequest* req = dynamic_cast<SqlQueryPageRequest*>(request);
+    if(!req) { return; }
+
+    std::shared_ptr<SqlQueryReply> reply(new SqlQueryReply());
+    reply->queryId = m_queryId;
+    reply->page = req->m_page;
+
+    int firstRow = req->m_page * m_linesPerPage;
+    try {
+        if(!m_resultSet || firstRow < m_rowIndex) {
+            // the result set is forward only: an earlier page is read by executing the query again. This is only done
+            // for a read-only SELECT, the panel keeps the rows of the other statements
+            if(m_resultSet && !m_canExecuteAgain) { return; }
+            if(!DoExecute(reply.get())) { m_eof = true; }
+        }
+
+        while(!m_eof && m_rowIndex < firstRow) {
+            if(m_canExecuteAgain) {
+                // skip the rows of the pages that are not needed
+                if(TestDestroy()) { return; }
+                if(!m_resultSet->Next()) {
+                    m_eof = true;
+                    break;
+                }
+                ++m_rowIndex;
+
+            } else {
+                // the statement can not be executed again: send the skipped pages as well
+                std::shared_ptr<SqlQueryReply> skipped(new SqlQueryReply());
+                skipped->queryId = m_queryId;
+                skipped->page = m_rowIndex / m_linesPerPage;
+                if(!DoReadPage(skipped.get())) { return; }
+                skipped->lastPage = m_eof;
+                DoSendReply(skipped);
+            }
+        }
+
+        if(!DoReadPage(reply.get())) { return; }
+        reply->lastPage = m_eof;
+
+    } catch(DatabaseLayerException& e) {
+        // for some reason an exception is thrown even if the error code is 0...
+        if(e.GetErrorCode() != 0) {
+            reply->errorMessage = wxString::Format(_("Error (%d): %s"), e.GetErrorCode(), e.GetErrorMessage().c_str());
+        }
+        m_eof = true;
+        reply->lastPage = true;
+
+    } catch(...) {
+        reply->errorMessage = _("Unknown error.");
+        m_eof = true;
+        reply->lastPage = true;
+    }
+    DoSendReply(reply);
+}
+
+bool SqlQueryThread::DoExecute(SqlQueryReply* reply)
+{
+    DoCloseResultSet();
+    m_rowIndex = 0;
+    m_eof = true;
+    m_columns.Clear();
+    m_colsMetaData.clear();
+
+    if(!m_useDb.IsEmpty()) { m_db->RunQuery(m_useDb); }
+    m_resultSet = m_db->RunQueryWithResults(m_sql);
+    if(!m_resultSet) {
+        reply->errorMessage = _("Unknown SQL error.");
+        return false;
+    }
+    m_eof = false;
+
+    // GetMetaData() allocates a new object on every call, fetch it once per result set
+    m_metaData = m_resultSet->GetMetaData();
+    int cols = m_metaData->GetColumnCount();
+    m_colTypes.resize(cols);
+    for(int i = 1; i <= cols; i++) {
+        m_colTypes[i - 1] = m_metaData->GetColumnType(i);
+        m_columns.Add(m_metaData->GetColumnName(i));
+        m_colsMetaData.push_back(ColumnInfo(m_colTypes[i - 1], m_metaData->GetColumnName(i)));
+    }
+    return true;
+}
+
+bool SqlQueryThread::DoReadPage(SqlQueryReply* reply)
+{
+    while(!m_eof && ((int)reply->rows.size() < m_linesPerPage)) {
+        if(TestDestroy()) { return false; }
+        if(!m_resultSet->Next()) {
+            m_eof = true;
+            break;
+        }
+        reply->rows.push_back(wxArrayString());
+        DoReadRow(reply->rows.back());
+        ++m_rowIndex;
+    }
+    return true;
+}
+
+void SqlQueryThread::DoSendReply(std::shared_ptr<SqlQueryReply> reply)
+{
+    // the first reply after the query was executed carries the columns
+    if(!m_columns.IsEmpty()) {
+        reply->columns.swap(m_columns);
+        reply->colsMetaData.swap(m_colsMetaData);
+        m_columns.Clear();
+        m_colsMetaData.clear();
+    }
+    m_owner->CallAfter(&SQLCommandPanel::OnQueryReply, reply);
+}
+
+void SqlQueryThread::DoCloseResultSet()
+{
+    if(m_resultSet) {
+        // closing the result set also frees its meta data
+        m_db->CloseResultSet(m_resultSet);
+        m_resultSet = nullptr;
+        m_metaData = nullptr;
+    }
+}
+
+void SqlQueryThread::DoReadRow(wxArrayString& row)
+{
+    row.reserve(m_colTypes.size());
+    wxString value;
+    for(int i = 1; i <= (int)m_colTypes.size(); i++) {
+        switch(m_colTypes[i - 1]) {
+        case ResultSetMetaData::COLUMN_INTEGER:
+            if(m_isSqlite) {
+                value = m_resultSet->GetResultString(i);
+
+            } else {
+                value.Clear();
+                value << m_resultSet->GetResultInt(i);
+            }
+            break;
+
+        case ResultSetMetaData::COLUMN_STRING:
+            value = m_resultSet->GetResultString(i);
+            break;
+
+        case ResultSetMetaData::COLUMN_UNKNOWN:
+            value = m_resultSet->GetResultString(i);
+            break;
+
+        case ResultSetMetaData::COLUMN_BLOB: {
+            if(m_textCols.find(i) != m_textCols.end()) {
+                // this column should be displayed as TEXT rather than BLOB
+                value = m_resultSet->GetResultString(i);
+
+            } else if(m_blobCols.find(i) != m_blobCols.end()) {
+                // this column should be displayed as BLOB
+                wxMemoryBuffer buffer;
+                m_resultSet->GetResultBlob(i, buffer);
+                value = wxString::Format(wxT("BLOB (Size:%u)"), (unsigned)buffer.GetDataLen());
+
+            } else {
+                // first time
+                wxString strCol = m_resultSet->GetResultString(i);
+                if(IsBlobColumn(strCol)) {
+                    m_blobCols.insert(i);
+                    wxMemoryBuffer buffer;
+                    m_resultSet->GetResultBlob(i, buffer);
+                    value = wxString::Format(wxT("BLOB (Size:%u)"), (unsigned)buffer.GetDataLen());
+
+                } else {
+                    m_textCols.insert(i);
+                    value = strCol;
+                }
+            }
+            break;
+        }
+        case ResultSetMetaData::COLUMN_BOOL:
+            value = wxString::Format(wxT("%b"), m_resultSet->GetResultBool(i));
+            break;
+
+        case ResultSetMetaData::COLUMN_DATE: {
+            wxDateTime dt = m_resultSet->GetResultDate(i);
+            if(dt.IsValid()) {
+                value = dt.Format();
+            } else {
+                value.Clear();
+            }
+        } break;
+
+        case ResultSetMetaData::COLUMN_DOUBLE:
+            value = wxString::Format(wxT("%f"), m_resultSet->GetResultDouble(i));
+            break;
+
+        case ResultSetMetaData::COLUMN_NULL:
+            value = wxT("NULL");
+            break;
+
+        default:
+            value = m_resultSet->GetResultString(i);
+            break;
+        }
+        row.Add(value);
+    }
+}
+
+bool SqlQueryThread::IsBlobColumn(const wxString& str) const
+{
+    for(size_t i = 0; i < str.Len(); i++) {
+        if(!wxIsprint(str.GetChar(i))) { return true; }
+    }
+    return false;
+}
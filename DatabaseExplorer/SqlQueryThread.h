@@ -0,0 +1,94 @@
+#ifndef SQLQUERYTHREAD_H
+#define SQLQUERYTHREAD_H
+
+#include "IDbAdapter.h"
+#include "SqlCommandPanel.h"
+#include "worker_thread.h"
+#include <memory>
+#include <set>
+#include <vector>
+#include <wx/arrstr.h>
+
+/**
+ * @class SqlQueryReply
+ * @brief a page of results (or an error) sent from the SqlQueryThread to the SQLCommandPanel
+ */
+class SqlQueryReply
+{
+public:
+    size_t queryId = 0;
+    int page = 0;
+    bool lastPage = false;
+    std::vector<wxArrayString> rows;
+    // set only by the first reply after the query was executed
+    wxArrayString columns;
+    ColumnInfo::Vector_t colsMetaData;
+    wxString errorMessage;
+};
+
+/**
+ * @class SqlQueryPageRequest
+ * @brief ask the SqlQueryThread for a page of results
+ */
+class SqlQueryPageRequest : public ThreadRequest
+{
+public:
+    int m_page;
+
+    SqlQueryPageRequest(int page)
+        : m_page(page)
+    {
+    }
+    virtual ~SqlQueryPageRequest() {}
+};
+
+/**
+ * @class SqlQueryThread
+ * @brief runs a query of the SQL command panel and reads its result set page by page. The thread owns the database
+ * connection and keeps the result set open between requests: reading the next page continues from where the
+ * previous one stopped. Only a single read-only SELECT is executed again to fetch an earlier page, the rows of any
+ * other statement are all sent to the panel (which keeps them) and the statement is never executed twice. Stopping
+ * the thread cancels the query between two rows
+ */
+class SqlQueryThread : public WorkerThread
+{
+    SQLCommandPanel* m_owner;
+    size_t m_queryId;
+    DatabaseLayerPtr m_db;
+    wxString m_sql;
+    wxString m_useDb;
+    bool m_isSqlite;
+    bool m_canExecuteAgain;
+    int m_linesPerPage;
+    DatabaseResultSet* m_resultSet;
+    ResultSetMetaData* m_metaData;
+    std::vector<int> m_colTypes;
+    // the columns of the result set, sent with the first reply
+    wxArrayString m_columns;
+    ColumnInfo::Vector_t m_colsMetaData;
+    int m_rowIndex; // the number of rows read from m_resultSet
+    bool m_eof;
+    std::set<int> m_textCols;
+    std::set<int> m_blobCols;
+
+protected:
+    bool DoExecute(SqlQueryReply* reply);
+    void DoCloseResultSet();
+    /**
+     * @brief read the next page of rows into 'reply'. Return false if the thread is being stopped
+     */
+    bool DoReadPage(SqlQueryReply* reply);
+    void DoSendReply(std::shared_ptr<SqlQueryReply> reply);
+    void DoReadRow(wxArrayString& row);
+    bool IsBlobColumn(const wxString& str) const;
+
+public:
+    SqlQueryThread(SQLCommandPanel* owner, size_t queryId, DatabaseLayerPtr db, const wxString& sql,
+                   const wxString& useDb, bool isSqlite, bool canExecuteAgain, int linesPerPage);
+    virtual ~SqlQueryThread();
+
+    virtual void ProcessRequest(ThreadRequest* request);
+    virtual void OnExit();
+};
+
+#endif // SQLQUERYTHREAD_H
@@ -540,6 +540,12 @@ public:
      * @return number of bookmarks found
      */
     virtual size_t GetFindMarkers(std::vector<std::pair<int, wxString> >& bookmarksVector) = 0;
+
+    /**
+     * @brief is the editor in large-file mode? Plugins should avoid operations that scan the entire
+     * document (e.g. caching the editor text) for such editors
+     */
+    virtual bool IsLargeFile() const = 0;
 };
 
 #endif // IEDITOR_H
@@ -82,12 +82,12 @@ wxString LLDBBacktrace::ToString() const
     return str;
 }
 
-void LLDBBacktrace::FromJSON(const JSONItem& json)
+void LLDBBacktrace::FromJSON(const clJSONValue& json)
 {
     m_callstack.clear();
     m_threadId = json.namedObject("m_threadId").toInt(0);
     m_selectedFrameId = json.namedObject("m_selectedFrameId").toInt(0);
-    JSONItem arr = json.namedObject("m_callstack");
+    clJSONValue arr = json.namedObject("m_callstack");
     for(int i = 0; i < arr.arraySize(); ++i) {
         LLDBBacktrace::Entry entry;
         entry.FromJSON(arr.arrayItem(i));
@@ -95,26 +95,25 @@ void LLDBBacktrace::FromJSON(const JSONItem& json)
     }
 }
 
-JSONItem LLDBBacktrace::ToJSON() const
+void LLDBBacktrace::ToJSON(clJSONWriter& writer) const
 {
-    JSONItem json = JSONItem::createObject();
-    json.addProperty("m_threadId", m_threadId);
-    json.addProperty("m_selectedFrameId", m_selectedFrameId);
-
-    JSONItem arr = JSONItem::createArray("m_callstack");
-    json.append(arr);
+    writer.StartObject();
+    writer.Property("m_threadId", m_threadId);
+    writer.Property("m_selectedFrameId", m_selectedFrameId);
 
+    writer.Key("m_callstack").StartArray();
     for(size_t i = 0; i < m_callstack.size(); ++i) {
-        arr.append(m_callstack.at(i).ToJSON());
+        m_callstack.at(i).ToJSON(writer);
     }
-    return json;
+    writer.EndArray();
+    writer.EndObject();
 }
 
 // -------------------------------------------------------------------------
 // -------------------------------------------------------------------------
 // -------------------------------------------------------------------------
 
-void LLDBBacktrace::Entry::FromJSON(const JSONItem& json)
+void LLDBBacktrace::Entry::FromJSON(const clJSONValue& json)
 {
     id = json.namedObject("id").toInt(0);
     line = json.namedObject("line").toInt(0);
@@ -123,13 +122,13 @@ void LLDBBacktrace::Entry::FromJSON(const JSONItem& json)
     address = json.namedObject("address").toString();
 }
 
-JSONItem LLDBBacktrace::Entry::ToJSON() const
+void LLDBBacktrace::Entry::ToJSON(clJSONWriter& writer) const
 {
-    JSONItem json = JSONItem::createObject();
-    json.addProperty("id", id);
-    json.addProperty("line", line);
-    json.addProperty("filename", filename);
-    json.addProperty("functionName", functionName);
-    json.addProperty("address", address);
-    return json;
+    writer.StartObject();
+    writer.Property("id", id);
+    writer.Property("line", line);
+    writer.Property("filename", filename);
+    writer.Property("functionName", functionName);
+    writer.Property("address", address);
+    writer.EndObject();
 }
@@ -47,6 +47,7 @@
 #endif
 
 #include "JSON.h"
+#include "clJSONDocument.h"
 
 /**
  * @class LLDBBacktrace
@@ -62,8 +63,8 @@ public:
         wxString functionName;
         wxString address;
 
-        JSONItem ToJSON() const;
-        void FromJSON(const JSONItem& json);
+        void ToJSON(clJSONWriter& writer) const;
+        void FromJSON(const clJSONValue& json);
 
         Entry()
             : id(0)
@@ -108,8 +109,8 @@ public:
     wxString ToString() const;
 
     // Serialization API
-    JSONItem ToJSON() const;
-    void FromJSON(const JSONItem& json);
+    void ToJSON(clJSONWriter& writer) const;
+    void FromJSON(const clJSONValue& json);
 };
 
 #endif // LLDBBACKTRACE_H
@@ -140,7 +140,7 @@ void LLDBBreakpoint::Invalidate()
     m_children.clear();
 }
 
-void LLDBBreakpoint::FromJSON(const JSONItem& json)
+void LLDBBreakpoint::FromJSON(const clJSONValue& json)
 {
     m_children.clear();
     m_id = json.namedObject("m_id").toInt(wxNOT_FOUND);
@@ -148,7 +148,7 @@ void LLDBBreakpoint::FromJSON(const JSONItem& json)
     m_name = json.namedObject("m_name").toString();
     SetFilename(json.namedObject("m_filename").toString(), false);
     m_lineNumber = json.namedObject("m_lineNumber").toInt();
-    JSONItem arr = json.namedObject("m_children");
+    clJSONValue arr = json.namedObject("m_children");
     for(int i=0; i<arr.arraySize(); ++i) {
         LLDBBreakpoint::Ptr_t bp(new LLDBBreakpoint() );
         bp->FromJSON( arr.arrayItem(i) );
@@ -172,3 +172,20 @@ JSONItem LLDBBreakpoint::ToJSON() const
     }
     return json;
 }
+
+void LLDBBreakpoint::ToJSON(clJSONWriter& writer) const
+{
+    writer.StartObject();
+    writer.Property("m_id", m_id);
+    writer.Property("m_type", m_type);
+    writer.Property("m_name", m_name);
+    writer.Property("m_filename", m_filename);
+    writer.Property("m_lineNumber", m_lineNumber);
+
+    writer.Key("m_children").StartArray();
+    for(size_t i = 0; i < m_children.size(); ++i) {
+        m_children.at(i)->ToJSON(writer);
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
@@ -32,6 +32,7 @@
 #include <wx/sharedptr.h>
 #include "debugger.h"
 #include "JSON.h"
+#include "clJSONDocument.h"
 
 class LLDBBreakpoint
 {
@@ -145,8 +146,9 @@ public:
     int GetId() const { return m_id; }
 
     // Serialization API
-    void FromJSON(const JSONItem& json);
+    void FromJSON(const clJSONValue& json);
     JSONItem ToJSON() const;
+    void ToJSON(clJSONWriter& writer) const;
 };
 
 #endif // LLDBBREAKPOINT_H
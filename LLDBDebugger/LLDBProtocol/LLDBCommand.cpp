@@ -27,13 +27,14 @@
 
 LLDBCommand::~LLDBCommand() {}
 
-LLDBCommand::LLDBCommand(const wxString& jsonString)
+LLDBCommand::LLDBCommand(const std::string& jsonString)
 {
-    JSON root(jsonString);
+    clJSONDocument root;
+    root.Parse(jsonString.c_str(), jsonString.length());
     FromJSON(root.toElement());
 }
 
-void LLDBCommand::FromJSON(const JSONItem& json)
+void LLDBCommand::FromJSON(const clJSONValue& json)
 {
     m_commandType = json.namedObject("m_commandType").toInt(kCommandInvalid);
     m_commandArguments = json.namedObject("m_commandArguments").toString();
@@ -48,12 +49,12 @@ void LLDBCommand::FromJSON(const JSONItem& json)
     m_startupCommands = json.namedObject("m_startupCommands").toString();
     m_displayFormat = json.namedObject("m_displayFormat").toInt((int)eLLDBFormat::kFormatDefault);
 
-    JSONItem threadIdArr = json.namedObject("m_threadIds");
+    clJSONValue threadIdArr = json.namedObject("m_threadIds");
     for(int i = 0; i < threadIdArr.arraySize(); ++i) {
         m_threadIds.push_back(threadIdArr.arrayItem(i).toInt());
     }
 
-    JSONItem bparr = json.namedObject("m_breakpoints");
+    clJSONValue bparr = json.namedObject("m_breakpoints");
     for(int i = 0; i < bparr.arraySize(); ++i) {
         LLDBBreakpoint::Ptr_t bp(new LLDBBreakpoint());
         bp->FromJSON(bparr.arrayItem(i));
@@ -31,6 +31,7 @@
 #include "LLDBPivot.h"
 #include "LLDBSettings.h"
 #include "JSON.h"
+#include "clJSONDocument.h"
 #include <wx/string.h>
 
 class LLDBCommand
@@ -57,7 +58,7 @@ protected:
 public:
     // Serialization API
     JSONItem ToJSON() const;
-    void FromJSON(const JSONItem& json);
+    void FromJSON(const clJSONValue& json);
 
     LLDBCommand()
         : m_commandType(kCommandInvalid)
@@ -68,7 +69,7 @@ public:
         , m_displayFormat((int)eLLDBFormat::kFormatDefault)
     {
     }
-    LLDBCommand(const wxString& jsonString);
+    LLDBCommand(const std::string& jsonString);
     virtual ~LLDBCommand();
 
     void UpdatePaths(const LLDBPivot& pivot);
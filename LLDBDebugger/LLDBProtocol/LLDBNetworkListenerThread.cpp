@@ -41,7 +41,7 @@ LLDBNetworkListenerThread::~LLDBNetworkListenerThread() { Stop(); }
 void* LLDBNetworkListenerThread::Entry()
 {
     while(!TestDestroy()) {
-        wxString msg;
+        std::string msg;
         try {
             if(m_socket->ReadMessage(msg, 1) == clSocketBase::kSuccess) {
                 LLDBReply reply(msg);
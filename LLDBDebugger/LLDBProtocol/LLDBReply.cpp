@@ -28,13 +28,14 @@
 
 LLDBReply::~LLDBReply() {}
 
-LLDBReply::LLDBReply(const wxString& str)
+LLDBReply::LLDBReply(const std::string& str)
 {
-    JSON root(str);
+    clJSONDocument root;
+    root.Parse(str.c_str(), str.length());
     FromJSON(root.toElement());
 }
 
-void LLDBReply::FromJSON(const JSONItem& json)
+void LLDBReply::FromJSON(const clJSONValue& json)
 {
     m_replyType = json.namedObject("m_replyType").toInt(kReplyTypeInvalid);
     m_interruptResaon = json.namedObject("m_stopResaon").toInt(kInterruptReasonNone);
@@ -46,7 +47,7 @@ void LLDBReply::FromJSON(const JSONItem& json)
     m_text = json.namedObject("m_text").toString();
     
     m_breakpoints.clear();
-    JSONItem arr = json.namedObject("m_breakpoints");
+    clJSONValue arr = json.namedObject("m_breakpoints");
     for(int i = 0; i < arr.arraySize(); ++i) {
         LLDBBreakpoint::Ptr_t bp(new LLDBBreakpoint());
         bp->FromJSON(arr.arrayItem(i));
@@ -54,7 +55,7 @@ void LLDBReply::FromJSON(const JSONItem& json)
     }
 
     m_variables.clear();
-    JSONItem localsArr = json.namedObject("m_locals");
+    clJSONValue localsArr = json.namedObject("m_locals");
     m_variables.reserve(localsArr.arraySize());
     for(int i = 0; i < localsArr.arraySize(); ++i) {
         LLDBVariable::Ptr_t variable(new LLDBVariable());
@@ -63,38 +64,40 @@ void LLDBReply::FromJSON(const JSONItem& json)
     }
 
     m_backtrace.Clear();
-    JSONItem backtrace = json.namedObject("m_backtrace");
+    clJSONValue backtrace = json.namedObject("m_backtrace");
     m_backtrace.FromJSON(backtrace);
 
     m_threads = LLDBThread::FromJSON(json, "m_threads");
 }
 
-JSONItem LLDBReply::ToJSON() const
+void LLDBReply::ToJSON(clJSONWriter& writer) const
 {
-    JSONItem json = JSONItem::createObject();
-    json.addProperty("m_replyType", m_replyType);
-    json.addProperty("m_stopResaon", m_interruptResaon);
-    json.addProperty("m_line", m_line);
-    json.addProperty("m_filename", m_filename);
-    json.addProperty("m_lldbId", m_lldbId);
-    json.addProperty("m_expression", m_expression);
-    json.addProperty("m_debugSessionType", m_debugSessionType);
-    json.addProperty("m_text", m_text);
-    JSONItem bparr = JSONItem::createArray("m_breakpoints");
-    json.append(bparr);
+    writer.StartObject();
+    writer.Property("m_replyType", m_replyType);
+    writer.Property("m_stopResaon", m_interruptResaon);
+    writer.Property("m_line", m_line);
+    writer.Property("m_filename", m_filename);
+    writer.Property("m_lldbId", m_lldbId);
+    writer.Property("m_expression", m_expression);
+    writer.Property("m_debugSessionType", m_debugSessionType);
+    writer.Property("m_text", m_text);
+
+    writer.Key("m_breakpoints").StartArray();
     for(size_t i = 0; i < m_breakpoints.size(); ++i) {
-        bparr.arrayAppend(m_breakpoints.at(i)->ToJSON());
+        m_breakpoints.at(i)->ToJSON(writer);
     }
+    writer.EndArray();
 
-    JSONItem localsArr = JSONItem::createArray("m_locals");
-    json.append(localsArr);
+    writer.Key("m_locals").StartArray();
     for(size_t i = 0; i < m_variables.size(); ++i) {
-        localsArr.arrayAppend(m_variables.at(i)->ToJSON());
+        m_variables.at(i)->ToJSON(writer);
     }
+    writer.EndArray();
 
-    json.addProperty("m_backtrace", m_backtrace.ToJSON());
-    json.append(LLDBThread::ToJSON(m_threads, "m_threads"));
-    return json;
+    writer.Key("m_backtrace");
+    m_backtrace.ToJSON(writer);
+    LLDBThread::ToJSON(writer, m_threads, "m_threads");
+    writer.EndObject();
 }
 
 void LLDBReply::UpdatePaths(const LLDBPivot& pivot)
@@ -27,6 +27,7 @@
 #define LLDBREPLY_H
 
 #include "JSON.h"
+#include "clJSONDocument.h"
 #include "LLDBEnums.h"
 #include "LLDBBreakpoint.h"
 #include "LLDBBacktrace.h"
@@ -60,7 +61,7 @@ public:
     {
     }
 
-    LLDBReply(const wxString& str);
+    LLDBReply(const std::string& str);
     virtual ~LLDBReply();
 
     void SetText(const wxString& text) { this->m_text = text; }
@@ -89,8 +90,8 @@ public:
     int GetLine() const { return m_line; }
     int GetInterruptResaon() const { return m_interruptResaon; }
     // Serialization API
-    JSONItem ToJSON() const;
-    void FromJSON(const JSONItem& json);
+    void ToJSON(clJSONWriter& writer) const;
+    void FromJSON(const clJSONValue& json);
 };
 
 #endif // LLDBREPLY_H
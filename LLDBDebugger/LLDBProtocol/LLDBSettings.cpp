@@ -106,7 +106,7 @@ void LLDBSettings::SavePerspective(const wxString& perspective)
     }
 }
 
-void LLDBSettings::FromJSON(const JSONItem& json)
+void LLDBSettings::FromJSON(const clJSONValue& json)
 {
     m_arrItems = json.namedObject("m_maxArrayElements").toSize_t(m_arrItems);
     m_stackFrames = json.namedObject("m_maxCallstackFrames").toSize_t(m_stackFrames);
@@ -139,16 +139,8 @@ LLDBSettings& LLDBSettings::Load()
     wxFileName fn(clStandardPaths::Get().GetUserDataDir(), "lldb.conf");
     fn.AppendDir("config");
     if(fn.Exists()) { // check for existance, or we will get an error in the Trace tab
-        // Open the file
-        wxFFile fp(fn.GetFullPath(), "rb");
-        if(fp.IsOpened()) {
-            wxString content;
-            fp.ReadAll(&content, wxConvUTF8);
-
-            JSON root(content);
-            FromJSON(root.toElement());
-            fp.Close();
-        }
+        clJSONDocument root;
+        if(root.Load(fn)) { FromJSON(root.toElement()); }
     }
     return *this;
 }
@@ -29,6 +29,7 @@
 #include "LLDBEnums.h"
 #include <wx/string.h>
 #include "JSON.h"
+#include "clJSONDocument.h"
 
 class LLDBSettings
 {
@@ -89,7 +90,7 @@ public:
 
     // Serialization API
     JSONItem ToJSON() const;
-    void FromJSON(const JSONItem& json);
+    void FromJSON(const clJSONValue& json);
     LLDBSettings& SetArrItems(size_t arrItems)
     {
         this->m_arrItems = arrItems;
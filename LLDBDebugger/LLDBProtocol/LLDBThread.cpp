@@ -39,7 +39,7 @@ LLDBThread::~LLDBThread()
 {
 }
 
-void LLDBThread::FromJSON(const JSONItem& json)
+void LLDBThread::FromJSON(const clJSONValue& json)
 {
     m_id   = json.namedObject("m_id").toInt();
     m_func = json.namedObject("m_func").toString();
@@ -52,34 +52,34 @@ void LLDBThread::FromJSON(const JSONItem& json)
     m_name = json.namedObject("m_name").toString();
 }
 
-JSONItem LLDBThread::ToJSON() const
+void LLDBThread::ToJSON(clJSONWriter& writer) const
 {
-    JSONItem json = JSONItem::createObject();
-    json.addProperty("m_id", m_id);
-    json.addProperty("m_func", m_func);
-    json.addProperty("m_file", m_file);
-    json.addProperty("m_line", m_line);
-    json.addProperty("m_active", m_active);
-    json.addProperty("m_suspended", m_suspended);
-    json.addProperty("m_stopReason", m_stopReason);
-    json.addProperty("m_stopReasonString", m_stopReasonString);
-    json.addProperty("m_name", m_name);
-    return json;
+    writer.StartObject();
+    writer.Property("m_id", m_id);
+    writer.Property("m_func", m_func);
+    writer.Property("m_file", m_file);
+    writer.Property("m_line", m_line);
+    writer.Property("m_active", m_active);
+    writer.Property("m_suspended", m_suspended);
+    writer.Property("m_stopReason", m_stopReason);
+    writer.Property("m_stopReasonString", m_stopReasonString);
+    writer.Property("m_name", m_name);
+    writer.EndObject();
 }
 
-JSONItem LLDBThread::ToJSON(const LLDBThread::Vect_t& threads, const wxString &name)
+void LLDBThread::ToJSON(clJSONWriter& writer, const LLDBThread::Vect_t& threads, const char* name)
 {
-    JSONItem arr = JSONItem::createArray(name);
+    writer.Key(name).StartArray();
     for(size_t i=0; i<threads.size(); ++i) {
-        arr.arrayAppend( threads.at(i).ToJSON() );
+        threads.at(i).ToJSON(writer);
     }
-    return arr;
+    writer.EndArray();
 }
 
-LLDBThread::Vect_t LLDBThread::FromJSON(const JSONItem& json, const wxString& name)
+LLDBThread::Vect_t LLDBThread::FromJSON(const clJSONValue& json, const char* name)
 {
     LLDBThread::Vect_t v;
-    JSONItem arr = json.namedObject(name);
+    clJSONValue arr = json.namedObject(name);
     for(int i=0; i<arr.arraySize(); ++i) {
         LLDBThread thr;
         thr.FromJSON( arr.arrayItem(i) );
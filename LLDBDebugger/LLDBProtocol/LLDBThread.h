@@ -28,6 +28,7 @@
 
 #include <wx/string.h>
 #include "JSON.h"
+#include "clJSONDocument.h"
 #include <vector>
 
 class LLDBThread
@@ -113,11 +114,11 @@ public:
     }
 
     // Serialization API
-    JSONItem ToJSON() const;
-    void FromJSON(const JSONItem& json);
+    void ToJSON(clJSONWriter& writer) const;
+    void FromJSON(const clJSONValue& json);
 
-    static JSONItem ToJSON(const LLDBThread::Vect_t& threads, const wxString &name);
-    static LLDBThread::Vect_t FromJSON(const JSONItem& json, const wxString &name);
+    static void ToJSON(clJSONWriter& writer, const LLDBThread::Vect_t& threads, const char* name);
+    static LLDBThread::Vect_t FromJSON(const clJSONValue& json, const char* name);
 };
 
 #endif // LLDBTHREAD_H
@@ -59,7 +59,7 @@ void LLDBVariable::DoInitFromLLDBValue(lldb::SBValue value)
 
 LLDBVariable::~LLDBVariable() {}
 
-void LLDBVariable::FromJSON(const JSONItem& json)
+void LLDBVariable::FromJSON(const clJSONValue& json)
 {
     m_name = json.namedObject("m_name").toString();
     m_value = json.namedObject("m_value").toString();
@@ -72,19 +72,19 @@ void LLDBVariable::FromJSON(const JSONItem& json)
     m_isWatch = json.namedObject("m_isWatch").toBool(m_isWatch);
 }
 
-JSONItem LLDBVariable::ToJSON() const
+void LLDBVariable::ToJSON(clJSONWriter& writer) const
 {
-    JSONItem json = JSONItem::createObject();
-    json.addProperty("m_name", m_name);
-    json.addProperty("m_value", m_value);
-    json.addProperty("m_summary", m_summary);
-    json.addProperty("m_type", m_type);
-    json.addProperty("m_expression", m_expression);
-    json.addProperty("m_valueChanged", m_valueChanged);
-    json.addProperty("m_lldbId", m_lldbId);
-    json.addProperty("m_hasChildren", m_hasChildren);
-    json.addProperty("m_isWatch", m_isWatch);
-    return json;
+    writer.StartObject();
+    writer.Property("m_name", m_name);
+    writer.Property("m_value", m_value);
+    writer.Property("m_summary", m_summary);
+    writer.Property("m_type", m_type);
+    writer.Property("m_expression", m_expression);
+    writer.Property("m_valueChanged", m_valueChanged);
+    writer.Property("m_lldbId", m_lldbId);
+    writer.Property("m_hasChildren", m_hasChildren);
+    writer.Property("m_isWatch", m_isWatch);
+    writer.EndObject();
 }
 
 wxString LLDBVariable::ToString(const wxString& alternateName) const
@@ -31,6 +31,7 @@
 #include <wx/clntdata.h>
 #include <wx/sharedptr.h>
 #include "JSON.h"
+#include "clJSONDocument.h"
 #include <wx/treebase.h>
 #include "LLDBEnums.h"
 #if BUILD_CODELITE_LLDB
@@ -78,8 +79,8 @@ public:
     int GetLldbId() const { return m_lldbId; }
 
     // Seriliazation API
-    void FromJSON(const JSONItem& json);
-    JSONItem ToJSON() const;
+    void FromJSON(const clJSONValue& json);
+    void ToJSON(clJSONWriter& writer) const;
 
     void SetValueChanged(bool valueChanged) { this->m_valueChanged = valueChanged; }
     bool IsValueChanged() const { return m_valueChanged; }
@@ -536,7 +536,9 @@ void CodeLiteLLDBApp::NotifyStoppedOnFirstEntry()
 void CodeLiteLLDBApp::SendReply(const LLDBReply& reply)
 {
     try {
-        m_replySocket->WriteMessage(reply.ToJSON().format());
+        clJSONWriter writer;
+        reply.ToJSON(writer);
+        m_replySocket->WriteMessage(writer.GetBuffer());
 
     } catch(clSocketException& e) {
         wxPrintf("codelite-lldb: failed to send reply. %s. %s.\n", e.what().c_str(), strerror(errno));
@@ -56,7 +56,7 @@ void* LLDBNetworkServerThread::Entry()
 
         // we got connection, enter the main loop
         while(!TestDestroy()) {
-            wxString str;
+            std::string str;
             if(m_socket->ReadMessage(str, 1) == clSocketBase::kSuccess) {
                 // wxPrintf("codelite-lldb: received command\n%s\n", str);
 
@@ -1,7 +1,9 @@
 #include "EditorOptionsGeneralEdit.h"
+#include "cl_config.h"
 #include "editor_config.h"
 #include "globals.h"
 #include "optionsconfig.h"
+#include <algorithm>
 
 EditorOptionsGeneralEdit::EditorOptionsGeneralEdit(wxWindow* parent)
     : EditorOptionsGeneralEditBase(parent)
@@ -19,6 +21,7 @@ EditorOptionsGeneralEdit::EditorOptionsGeneralEdit(wxWindow* parent)
     m_pgPropWrapQuotes->SetValue(options->IsWrapSelectionWithQuotes());
     m_pgPropZoomUsingCtrlScroll->SetValue(options->IsMouseZoomEnabled());
     m_pgPropCommentsIndented->SetValue(options->GetIndentedComments());
+    m_pgPropLargeFileSize->SetValue(clConfig::Get().Read("editor/large_file_size_mb", 32));
 }
 
 EditorOptionsGeneralEdit::~EditorOptionsGeneralEdit() {}
@@ -39,4 +42,5 @@ void EditorOptionsGeneralEdit::Save(OptionsConfigPtr options)
     options->SetWrapSelectionWithQuotes(m_pgPropWrapQuotes->GetValue().GetBool());
     options->SetMouseZoomEnabled(m_pgPropZoomUsingCtrlScroll->GetValue().GetBool());
     options->SetIndentedComments(m_pgPropCommentsIndented->GetValue().GetBool());
+    clConfig::Get().Write("editor/large_file_size_mb", std::max(0, (int)m_pgPropLargeFileSize->GetValue().GetLong()));
 }
@@ -31,6 +31,8 @@
 #include "autoversion.h"
 #include "clInitializeDialog.h"
 #include "clKeyboardManager.h"
+#include "clProcessReactor.h"
+#include "clStartupProfiler.h"
 #include "clSystemSettings.h"
 #include "cl_config.h"
 #include "cl_registry.h"
@@ -259,6 +261,7 @@ static wxLogNull NO_LOG;
 
 bool CodeLiteApp::OnInit()
 {
+    long long startupStart = clStartupProfiler::Get().Now();
 #if defined(__WXMSW__) && CL_DEBUG_BUILD
     SetAppName(wxT("codelite-dbg"));
 #elif defined(__WXOSX__)
@@ -649,18 +652,27 @@ bool CodeLiteApp::OnInit()
     // If running under Cygwin terminal, adjust the environment variables
     AdjustPathForMSYSIfNeeded();
 
+    clStartupProfiler::Get().Add("Settings and environment", "Application", startupStart,
+                                 clStartupProfiler::Get().Now() - startupStart);
+
     // Make sure that the colours and fonts manager is instantiated
     ColoursAndFontsManager::Get().Load();
 
     // Merge the user settings with any new settings
-    ColoursAndFontsManager::Get().ImportLexersFile(wxFileName(clStandardPaths::Get().GetLexersDir(), "lexers.json"),
-                                                   false);
+    {
+        clStartupProfiler::Scope profile("Import lexers", "Colours and Fonts");
+        ColoursAndFontsManager::Get().ImportLexersFile(
+            wxFileName(clStandardPaths::Get().GetLexersDir(), "lexers.json"), false);
+    }
 
     // Create the main application window
-    clMainFrame::Initialize((parser.GetParamCount() == 0) && !IsStartedInDebuggerMode());
-    m_pMainFrame = clMainFrame::Get();
-    m_pMainFrame->Show(TRUE);
-    SetTopWindow(m_pMainFrame);
+    {
+        clStartupProfiler::Scope profile("Create main frame", "Main frame");
+        clMainFrame::Initialize((parser.GetParamCount() == 0) && !IsStartedInDebuggerMode());
+        m_pMainFrame = clMainFrame::Get();
+        m_pMainFrame->Show(TRUE);
+        SetTopWindow(m_pMainFrame);
+    }
 
     long lineNumber(0);
     parser.Found(wxT("l"), &lineNumber);
@@ -689,14 +701,25 @@ bool CodeLiteApp::OnInit()
     // Especially with the OutputView open, CodeLite was consuming 50% of a cpu, mostly in updateui
     // The next line limits the frequency of UpdateUI events to every 100ms
     wxUpdateUIEvent::SetUpdateInterval(200);
+    CallAfter(&CodeLiteApp::OnStartupCompleted);
     return TRUE;
 }
 
+void CodeLiteApp::OnStartupCompleted()
+{
+    // The main frame is up, construct the plugins that did not need to be initialized during startup
+    PluginManager::Get()->LoadLazyPlugins();
+
+    wxFileName fnTimeline(clStandardPaths::Get().GetUserDataDir(), "startup-timeline.json");
+    clStartupProfiler::Get().SetCompleted(fnTimeline);
+}
+
 int CodeLiteApp::OnExit()
 {
     clDEBUG() << "Bye";
     EditorConfigST::Free();
     ConfFileLocator::Release();
+    clProcessReactor::Release();
 
     // flush any saved changes to the configuration file
     clConfig::Get().Save();
@@ -108,6 +108,7 @@ protected:
     void OpenFolder(const wxString& path);
     void OpenFile(const wxString& path, long lineNumber);
     void OpenItem(const wxString& path, long lineNumber);
+    void OnStartupCompleted();
 };
 
 #endif // LITEEDITOR_APP_H
@@ -0,0 +1,214 @@
+#include "clEditorFileLoader.h"
+#include "clFileIdentity.h"
+#include "cl_editor.h"
+#include "file_logger.h"
+#include <algorithm>
+#include <vector>
+#include <wx/file.h>
+#include <wx/strconv.h>
+
+clEditorFileLoader::clEditorFileLoader(clEditor* editor, const wxFileName& filename, wxFontEncoding encoding,
+                                       size_t skipBytes, size_t generation)
+    : wxThread(wxTHREAD_JOINABLE)
+    , m_editor(editor)
+    , m_filename(filename)
+    , m_encoding(encoding)
+    , m_skipBytes(skipBytes)
+    , m_generation(generation)
+    , m_conversion(kConvertEncoding)
+{
+    // the UTF8 builtin conversion is faster
+    if(m_encoding == wxFONTENCODING_UTF8 || m_encoding == wxFONTENCODING_DEFAULT) { m_conversion = kConvertUTF8; }
+}
+
+clEditorFileLoader::~clEditorFileLoader() {}
+
+bool clEditorFileLoader::Decode(const char* buffer, size_t len, wxString& text) const
+{
+    text.Clear();
+    if(len == 0) { return true; }
+
+    switch(m_conversion) {
+    case kConvertEncoding: {
+        wxCSConv conv(m_encoding);
+        if(conv.IsOk()) { text = wxString(buffer, conv, len); }
+        break;
+    }
+    case kConvertUTF8:
+        text = wxString(buffer, wxConvUTF8, len);
+        break;
+    case kConvert8Bit:
+        text = wxString::From8BitData(buffer, len);
+        break;
+    }
+    return !text.IsEmpty();
+}
+
+size_t clEditorFileLoader::GetCodeUnitSize() const
+{
+    if(m_conversion != kConvertEncoding) { return 1; }
+    switch(m_encoding) {
+    case wxFONTENCODING_UTF16BE:
+    case wxFONTENCODING_UTF16LE:
+        return 2;
+    case wxFONTENCODING_UTF32BE:
+    case wxFONTENCODING_UTF32LE:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+bool clEditorFileLoader::IsBigEndian() const
+{
+    return m_encoding == wxFONTENCODING_UTF16BE || m_encoding == wxFONTENCODING_UTF32BE;
+}
+
+size_t clEditorFileLoader::FindSplit(const std::string& buffer) const
+{
+    size_t unit = GetCodeUnitSize();
+    if(unit > 1) {
+        // UTF-16 / UTF-32: a '\n' byte can be a part of another character, look for a whole newline code unit on a
+        // code unit boundary
+        size_t newLineByte = IsBigEndian() ? (unit - 1) : 0;
+        size_t len = buffer.length() - (buffer.length() % unit);
+        for(size_t pos = len; pos >= unit; pos -= unit) {
+            size_t i = 0;
+            while(i < unit && buffer[pos - unit + i] == (i == newLineByte ? '\n' : '\0')) {
+                ++i;
+            }
+            if(i == unit) { return pos; }
+        }
+        if(buffer.length() < (4 * kChunkSize)) { return 0; }
+
+        // A single line that is larger than a few chunks: never split a UTF-16 surrogate pair
+        if(unit == 2 && len >= 2) {
+            unsigned char high = IsBigEndian() ? buffer[len - 2] : buffer[len - 1];
+            if(high >= 0xD8 && high <= 0xDB) { len -= 2; }
+        }
+        return len ? len : buffer.length();
+    }
+
+    // Decode up to the last complete line, keep the rest for the next round
+    size_t where = buffer.rfind('\n');
+    if(where != std::string::npos) { return where + 1; }
+    if(buffer.length() < (4 * kChunkSize)) { return 0; }
+
+    // A single line that is larger than a few chunks: split it on a character boundary
+    size_t len = buffer.length();
+    switch(m_conversion) {
+    case kConvertUTF8:
+        // keep the last sequence (its lead byte and continuation bytes) for the next round
+        --len;
+        while(len > 0 && (buffer[len] & 0xC0) == 0x80) {
+            --len;
+        }
+        break;
+    case kConvertEncoding:
+        // In the multibyte encodings we support (Shift-JIS, GBK, Big5, EUC) a byte below 0x40 is never the second
+        // byte of a character, so a character always starts after it
+        while(len > 0 && (unsigned char)buffer[len - 1] >= 0x40) {
+            --len;
+        }
+        break;
+    case kConvert8Bit:
+        break;
+    }
+    // no boundary was found: this is not a text in the current conversion, Decode() fails and we try the next one
+    return len ? len : buffer.length();
+}
+
+void clEditorFileLoader::Post(const wxString& text, bool done, bool reset, wxUint64 hash, bool error)
+{
+    clEditorFileChunk chunk;
+    chunk.generation = m_generation;
+    chunk.text = text;
+    chunk.done = done;
+    chunk.reset = reset;
+    chunk.hash = hash;
+    chunk.error = error;
+    m_editor->CallAfter(&clEditor::OnLargeFileChunk, chunk);
+}
+
+bool clEditorFileLoader::DoLoad(wxFile& file)
+{
+    // The raw bytes (including the BOM) are hashed as we go, so the editor can record the file identity without
+    // reading the file again
+    clFileHasher hasher;
+    size_t skipBytes = m_skipBytes;
+    bool reset = true;
+    std::string buffer;
+    std::vector<char> chunk(kChunkSize);
+    wxString text;
+    bool readError = false;
+    while(!TestDestroy()) {
+        ssize_t bytesRead = file.Read(chunk.data(), chunk.size());
+        if(bytesRead == wxInvalidOffset) {
+            // don't let a read error look like the end of the file
+            clWARNING() << "Failed to read file:" << m_filename << clEndl;
+            readError = true;
+            break;
+        }
+        if(bytesRead == 0) { break; }
+        hasher.Update(chunk.data(), bytesRead);
+        buffer.append(chunk.data(), bytesRead);
+        if(skipBytes) {
+            size_t count = std::min(skipBytes, buffer.length());
+            buffer.erase(0, count);
+            skipBytes -= count;
+        }
+
+        size_t len = FindSplit(buffer);
+        if(len == 0) { continue; }
+        if(!Decode(buffer.c_str(), len, text)) { return false; }
+        buffer.erase(0, len);
+        Post(text, false, reset);
+        reset = false;
+    }
+
+    if(TestDestroy()) { return true; }
+    if(!Decode(buffer.c_str(), buffer.length(), text) && !readError) { return false; }
+    Post(text, true, reset, readError ? 0 : hasher.Digest(), readError);
+    return true;
+}
+
+void* clEditorFileLoader::Entry()
+{
+    wxFile file(m_filename.GetFullPath(), wxFile::read);
+    if(!file.IsOpened()) {
+        clWARNING() << "Failed to open file:" << m_filename << clEndl;
+        Post(wxString(), true, true, 0, true);
+        return NULL;
+    }
+
+    // the 8 bit conversion never fails
+    while(!DoLoad(file)) {
+        m_conversion = (m_conversion == kConvertEncoding) ? kConvertUTF8 : kConvert8Bit;
+        clDEBUG() << "Failed to decode" << m_filename << ", loading it again with conversion" << (int)m_conversion
+                  << clEndl;
+        if(file.Seek(0) == wxInvalidOffset) {
+            Post(wxString(), true, true, 0, true);
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+void clEditorFileLoader::Start(int priority)
+{
+    Create();
+    SetPriority(priority);
+    Run();
+}
+
+void clEditorFileLoader::Stop()
+{
+    // Notify the thread to exit and
+    // wait for it
+    if(IsAlive()) {
+        Delete(NULL, wxTHREAD_WAIT_BLOCK);
+
+    } else {
+        Wait(wxTHREAD_WAIT_BLOCK);
+    }
+}
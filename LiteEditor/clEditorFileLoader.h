@@ -0,0 +1,93 @@
+#ifndef CLEDITORFILELOADER_H
+#define CLEDITORFILELOADER_H
+
+#include <string>
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/fontenc.h>
+#include <wx/string.h>
+#include <wx/thread.h>
+
+class clEditor;
+
+/// A decoded part of the file, passed from the loader thread to the editor
+struct clEditorFileChunk {
+    size_t generation = 0;
+    wxString text;
+    bool done = false;
+    wxUint64 hash = 0; // the hash of the raw file content (set on the last chunk)
+    bool reset = false; // the first chunk of the content: replace the editor text
+    bool error = false; // the file could not be read to its end (set on the last chunk)
+};
+
+/**
+ * @class clEditorFileLoader
+ * @brief read and decode a large file in a background thread.
+ * The file is read in chunks. Every chunk is split after the last newline code unit (a '\n' byte is never part of a
+ * multibyte sequence in the 8 bit based encodings we support, in UTF-16/32 the newline is a whole aligned code unit),
+ * decoded and passed to the editor with clEditor::OnLargeFileChunk().
+ * The conversion is chosen for the entire file: if a chunk can not be decoded, the file is loaded again from the start
+ * with the next conversion (the requested encoding, UTF-8 and finally the raw 8 bit data), like ReadFileWithConversion()
+ */
+class clEditorFileLoader : public wxThread
+{
+    enum eConversion {
+        kConvertEncoding,
+        kConvertUTF8,
+        kConvert8Bit,
+    };
+
+    clEditor* m_editor;
+    wxFileName m_filename;
+    wxFontEncoding m_encoding;
+    size_t m_skipBytes;
+    size_t m_generation;
+    eConversion m_conversion;
+
+protected:
+    bool Decode(const char* buffer, size_t len, wxString& text) const;
+    /**
+     * @brief the size of a code unit of the current conversion: 2 for UTF-16, 4 for UTF-32, 1 otherwise
+     */
+    size_t GetCodeUnitSize() const;
+    bool IsBigEndian() const;
+    /**
+     * @brief return the length of the part of 'buffer' that can be decoded now, 0 to wait for more data
+     */
+    size_t FindSplit(const std::string& buffer) const;
+    /**
+     * @brief read the file from the current position and post its content to the editor
+     * @return false if the content can not be decoded with the current conversion
+     */
+    bool DoLoad(wxFile& file);
+    void Post(const wxString& text, bool done, bool reset, wxUint64 hash = 0, bool error = false);
+
+public:
+    enum { kChunkSize = 4 * 1024 * 1024 };
+
+    /**
+     * @param skipBytes number of bytes to skip at the start of the file (e.g. a UTF-8 BOM)
+     * @param generation identifies this load operation. The editor ignores chunks from an older load that were
+     * already queued when it was restarted
+     */
+    clEditorFileLoader(clEditor* editor, const wxFileName& filename, wxFontEncoding encoding, size_t skipBytes,
+                       size_t generation);
+    virtual ~clEditorFileLoader();
+
+    virtual void* Entry();
+
+    /**
+     * Start the thread as joinable thread.
+     * \note This call must be called from the context of other thread (e.g. main thread)
+     */
+    void Start(int priority = WXTHREAD_DEFAULT_PRIORITY);
+
+    /**
+     * Stops the thread
+     * This function returns only when the thread is terminated.
+     * \note This call must be called from the context of other thread (e.g. main thread)
+     */
+    void Stop();
+};
+
+#endif // CLEDITORFILELOADER_H
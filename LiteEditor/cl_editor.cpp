@@ -31,6 +31,7 @@
 #include "breakpointdlg.h"
 #include "buildtabsettingsdata.h"
 #include "cc_box_tip_window.h"
+#include "clEditorFileLoader.h"
 #include "clEditorStateLocker.h"
 #include "clFileSystemWorkspace.hpp"
 #include "clPrintout.h"
@@ -78,6 +79,7 @@
 #include "wxCodeCompletionBoxManager.h"
 #include <wx/dataobj.h>
 #include <wx/dcmemory.h>
+#include <wx/file.h>
 #include <wx/log.h>
 #include <wx/printdlg.h>
 #include <wx/regex.h>
@@ -431,6 +433,9 @@ clEditor::clEditor(wxWindow* parent)
 
 clEditor::~clEditor()
 {
+    DoStopLargeFileLoader();
+    wxDELETE(m_largeFileState);
+
     // Report file-close event
     if(GetFileName().IsOk() && GetFileName().FileExists()) {
         clCommandEvent eventClose(wxEVT_FILE_CLOSED);
@@ -961,6 +966,9 @@ void clEditor::SetProperties()
     CmdKeyAssign(wxSTC_KEY_LEFT, wxSTC_KEYMOD_META, wxSTC_CMD_WORDPARTLEFT);
     CmdKeyAssign(wxSTC_KEY_RIGHT, wxSTC_KEYMOD_META, wxSTC_CMD_WORDPARTRIGHT);
 #endif
+
+    // the user settings must not turn the expensive features back on
+    if(m_largeFile) { DoApplyLargeFileSettings(); }
 }
 
 void clEditor::OnSavePoint(wxStyledTextEvent& event)
@@ -1636,11 +1644,16 @@ bool clEditor::SaveToFile(const wxFileName& fileName)
         return false;
     }
 
+    // hash what we write, so the file identity can be recorded without reading the file back
+    clFileHasher hasher;
     if(!m_fileBom.IsEmpty()) {
         // restore the BOM
         file.Write(m_fileBom.GetData(), m_fileBom.Len());
+        hasher.Update(m_fileBom.GetData(), m_fileBom.Len());
     }
-    file.Write(buf.data(), strlen(buf.data()));
+    size_t bufLen = strlen(buf.data());
+    file.Write(buf.data(), bufLen);
+    hasher.Update(buf.data(), bufLen);
     file.Close();
 
     wxFileName symlinkedFile = fileName;
@@ -1692,6 +1705,7 @@ bool clEditor::SaveToFile(const wxFileName& fileName)
 
     // update the modification time of the file
     m_modifyTime = GetFileModificationTime(symlinkedFile.GetFullPath());
+    m_fileIdentity = clFileIdentity::FromFile(symlinkedFile.GetFullPath(), hasher.Digest());
     SetSavePoint();
 
     // update the tab title (remove the star from the file name)
@@ -3161,6 +3175,9 @@ void clEditor::OpenFile()
         return;
     }
 
+    // Large files are loaded in the background
+    if(DoOpenLargeFile()) { return; }
+
     // State locker (on dtor it restores: bookmarks, current line, breakpoints and folds)
     clEditorStateLocker stateLocker(GetCtrl());
 
@@ -3172,11 +3189,16 @@ void clEditor::OpenFile()
     // Read the file we currently support:
     // BOM, Auto-Detect encoding & User defined encoding
     m_fileBom.Clear();
-    ReadFileWithConversion(m_fileName.GetFullPath(), text, DetectEncoding(m_fileName.GetFullPath()), &m_fileBom);
+    wxUint64 hash = 0;
+    bool readOk = ReadFileWithConversion(m_fileName.GetFullPath(), text, DetectEncoding(m_fileName.GetFullPath()),
+                                         &m_fileBom, &hash);
 
     SetText(text);
 
     m_modifyTime = GetFileLastModifiedTime();
+    // the hash is only valid if the file was read, otherwise let the identity hash the file (if it can)
+    m_fileIdentity = readOk ? clFileIdentity::FromFile(m_fileName.GetFullPath(), hash)
+                            : clFileIdentity::FromFile(m_fileName.GetFullPath());
 
     SetSavePoint();
     EmptyUndoBuffer();
@@ -3209,6 +3231,148 @@ void clEditor::OpenFile()
     m_mgr->GetStatusBar()->SetMessage(_("Ready"));
 }
 
+bool clEditor::DoOpenLargeFile()
+{
+    DoStopLargeFileLoader();
+
+    // threshold in MB, 0 disables large-file mode
+    bool wasLargeFile = m_largeFile;
+    long threshold = clConfig::Get().Read("editor/large_file_size_mb", 32);
+    wxULongLong fileSize = m_fileName.GetSize();
+    m_largeFile = (threshold > 0) && (fileSize != wxInvalidSize) &&
+                  (fileSize.GetValue() >= ((wxULongLong_t)threshold * 1024 * 1024));
+    if(!m_largeFile) {
+        if(wasLargeFile) { DoRevertLargeFileSettings(); }
+        return false;
+    }
+
+    // Detecting the encoding (uchardet) requires reading the entire file, so we use the configured encoding. Files
+    // with UTF-8 BOM are supported, other BOM files (UTF-16/32) are loaded normally
+    wxFontEncoding encoding = GetOptions()->GetFileFontEncoding();
+    size_t skipBytes = 0;
+    m_fileBom.Clear();
+    wxFile file(m_fileName.GetFullPath(), wxFile::read);
+    if(file.IsOpened()) {
+        char header[4] = { 0, 0, 0, 0 };
+        if(file.Read(header, sizeof(header)) == sizeof(header)) {
+            wxFontEncoding bomEncoding = BOM::Encoding(header);
+            if(bomEncoding == wxFONTENCODING_UTF8) {
+                encoding = wxFONTENCODING_UTF8;
+                skipBytes = 3;
+                m_fileBom.SetData(header, skipBytes);
+            } else if(bomEncoding != wxFONTENCODING_SYSTEM) {
+                m_largeFile = false;
+                if(wasLargeFile) { DoRevertLargeFileSettings(); }
+                return false;
+            }
+        }
+    }
+
+    clDEBUG() << "Opening" << m_fileName << "in large-file mode (" << fileSize.ToString() << "bytes)" << clEndl;
+    DoApplyLargeFileSettings();
+
+    // Keep the state of the content that is currently displayed (if we are restarting a load that is still running,
+    // the state captured when it started is kept), it is restored once the entire file is loaded
+    if(!m_largeFileState) { m_largeFileState = new clEditorStateLocker(GetCtrl()); }
+
+    // The content is appended chunk by chunk while the editor is read-only, don't record it in the undo buffer
+    SetUndoCollection(false);
+    SetReadOnly(false);
+    ClearAll();
+    SetReadOnly(true);
+    m_mgr->GetStatusBar()->SetMessage(_("Loading large file..."));
+
+    m_largeFileLoader = new clEditorFileLoader(this, m_fileName, encoding, skipBytes, ++m_largeFileGeneration);
+    m_largeFileLoader->Start();
+    return true;
+}
+
+void clEditor::DoStopLargeFileLoader()
+{
+    if(m_largeFileLoader) {
+        m_largeFileLoader->Stop();
+        wxDELETE(m_largeFileLoader);
+    }
+}
+
+void clEditor::DoApplyLargeFileSettings()
+{
+    // Folding and word wrapping require processing the entire document
+    SetProperty(wxT("fold"), wxT("0"));
+    SetMarginWidth(FOLD_MARGIN_ID, 0);
+    SetWrapMode(wxSTC_WRAP_NONE);
+    SetLayoutCache(wxSTC_CACHE_PAGE);
+#if wxCHECK_VERSION(3, 1, 1)
+    // Colour only the visible range, don't style the rest of the document in the background
+    SetIdleStyling(wxSTC_IDLESTYLING_NONE);
+#endif
+}
+
+void clEditor::DoRevertLargeFileSettings()
+{
+    // The file is no longer large (e.g. it was reloaded after it was modified outside the editor)
+    clDEBUG() << m_fileName << "is no longer in large-file mode" << clEndl;
+    // a load that was cancelled: put the state back, so the caller's state locker captures it
+    wxDELETE(m_largeFileState);
+    SetProperties();
+#if wxCHECK_VERSION(3, 1, 1)
+    SetIdleStyling(wxSTC_IDLESTYLING_TOVISIBLE);
+#endif
+    // the semantic colouring requires the new content
+    CallAfter(&clEditor::UpdateColours);
+}
+
+void clEditor::OnLargeFileChunk(const clEditorFileChunk& chunk)
+{
+    // a chunk of a load operation that was already cancelled
+    if(chunk.generation != m_largeFileGeneration) { return; }
+
+    if(chunk.reset || !chunk.text.IsEmpty()) {
+        SetReadOnly(false);
+        // the loader started over (with another conversion)
+        if(chunk.reset) { ClearAll(); }
+        AppendText(chunk.text);
+        SetReadOnly(true);
+    }
+
+    if(!chunk.done) { return; }
+
+    DoStopLargeFileLoader();
+    SetUndoCollection(true);
+    // a file that could not be read to its end is kept read-only, so the partial content can't overwrite the file
+    SetReadOnly(chunk.error);
+
+    m_modifyTime = GetFileLastModifiedTime();
+    m_fileIdentity = chunk.error ? clFileIdentity::FromFile(m_fileName.GetFullPath())
+                                 : clFileIdentity::FromFile(m_fileName.GetFullPath(), chunk.hash);
+    // loading is not a modification
+    SetSavePoint();
+    EmptyUndoBuffer();
+    GetCommandsProcessor().Reset();
+    UpdateLineNumberMarginWidth();
+    SetEOL();
+
+    // restore the bookmarks, breakpoints and the caret position
+    wxDELETE(m_largeFileState);
+
+    // mark read only files
+    clMainFrame::Get()->GetMainBook()->MarkEditorReadOnly(this);
+    SetReloadingFile(false);
+
+    // Notify that a file has been loaded into the editor
+    clCommandEvent fileLoadedEvent(wxEVT_FILE_LOADED);
+    fileLoadedEvent.SetFileName(GetFileName().GetFullPath());
+    EventNotifier::Get()->AddPendingEvent(fileLoadedEvent);
+    m_mgr->GetStatusBar()->SetMessage(_("Ready"));
+
+    if(chunk.error) {
+        wxMessageBox(wxString::Format(_("Failed to read file\n'%s'\nThe content is incomplete, the editor is "
+                                        "read-only"),
+                                      m_fileName.GetFullPath()),
+                     "CodeLite", wxOK | wxICON_ERROR | wxCENTER, wxTheApp->GetTopWindow());
+    }
+}
+
 void clEditor::SetEditorText(const wxString& text)
 {
     wxWindowUpdateLocker locker(this);
@@ -3998,6 +4162,10 @@ void clEditor::UpdateColours()
     SetKeywordClasses("");
     SetKeywordLocals("");
 
+    // Semantic colouring and colouring the entire document are too expensive for large files. The visible range is
+    // coloured on demand by the control
+    if(m_largeFile) { return; }
+
     if(TagsManagerST::Get()->GetCtagsOptions().GetFlags() & CC_COLOUR_VARS ||
        TagsManagerST::Get()->GetCtagsOptions().GetFlags() & CC_COLOUR_MACRO_BLOCKS) {
         m_context->OnFileSaved();
@@ -4581,6 +4749,9 @@ void clEditor::OnChange(wxStyledTextEvent& event)
     // Notify about this editor being changed
     clCommandEvent eventMod(wxEVT_EDITOR_MODIFIED);
     eventMod.SetFileName(GetFileName().GetFullPath());
+    // the first modified line and the number of lines added (negative when removed)
+    eventMod.SetLineNumber((isInsert || isDelete) ? LineFromPosition(event.GetPosition()) : wxNOT_FOUND);
+    eventMod.SetInt(event.GetLinesAdded());
     EventNotifier::Get()->QueueEvent(eventMod.Clone());
 
     if((m_autoAddNormalBraces && !m_disableSmartIndent) || GetOptions()->GetAutoCompleteDoubleQuotes()) {
@@ -5307,7 +5478,7 @@ void clEditor::OnTimer(wxTimerEvent& event)
         HighlightWord(false);
 
     } else {
-        if(EditorConfigST::Get()->GetInteger("highlight_word") == 1) {
+        if(EditorConfigST::Get()->GetInteger("highlight_word") == 1 && !m_largeFile) {
             int pos = GetCurrentPos();
             int wordStartPos = WordStartPos(pos, true);
             int wordEndPos = WordEndPos(pos, true);
@@ -5793,6 +5964,8 @@ void clEditor::ReloadFromDisk(bool keepUndoHistory)
         return;
     }
 
+    if(DoOpenLargeFile()) { return; }
+
     clEditorStateLocker stateLocker(GetCtrl());
 
     wxString text;
@@ -5800,12 +5973,16 @@ void clEditor::ReloadFromDisk(bool keepUndoHistory)
     // Read the file we currently support:
     // BOM, Auto-Detect encoding & User defined encoding
     m_fileBom.Clear();
-    ReadFileWithConversion(m_fileName.GetFullPath(), text, GetOptions()->GetFileFontEncoding(), &m_fileBom);
+    wxUint64 hash = 0;
+    bool readOk =
+        ReadFileWithConversion(m_fileName.GetFullPath(), text, GetOptions()->GetFileFontEncoding(), &m_fileBom, &hash);
 
     SetText(text);
     Colourise(0, wxNOT_FOUND);
 
     m_modifyTime = GetFileLastModifiedTime();
+    m_fileIdentity = readOk ? clFileIdentity::FromFile(m_fileName.GetFullPath(), hash)
+                            : clFileIdentity::FromFile(m_fileName.GetFullPath());
     SetSavePoint();
 
     if(!keepUndoHistory) {
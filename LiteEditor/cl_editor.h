@@ -29,6 +29,7 @@
 #include "bookmark_manager.h"
 #include "browse_record.h"
 #include "clEditorStateLocker.h"
+#include "clFileIdentity.h"
 #include "cl_calltip.h"
 #include "cl_defs.h"
 #include "cl_unredo.h"
@@ -77,6 +78,8 @@ class CCBox;
 class clEditorTipWindow;
 class DisplayVariableDlg;
 class EditorDeltasHolder;
+class clEditorFileLoader;
+struct clEditorFileChunk;
 
 enum sci_annotation_styles { eAnnotationStyleError = 128, eAnnotationStyleWarning };
 
@@ -269,6 +272,12 @@ protected:
     int m_lastLineCount;
     wxColour m_selTextColour;
     wxColour m_selTextBgColour;
+    bool m_largeFile = false;
+    clEditorFileLoader* m_largeFileLoader = nullptr;
+    // the editor state (bookmarks, breakpoints, caret...) before the large file was loaded, restored when it is done
+    clEditorStateLocker* m_largeFileState = nullptr;
+    size_t m_largeFileGeneration = 0;
+    clFileIdentity m_fileIdentity;
 
 public:
     static bool m_ccShowPrivateMembers;
@@ -304,6 +313,17 @@ public:
     void SetReloadingFile(const bool& reloadingFile) { this->m_reloadingFile = reloadingFile; }
     const bool& GetReloadingFile() const { return m_reloadingFile; }
 
+    /**
+     * @brief is this editor in large-file mode? In this mode the file is loaded in the background and folding, word
+     * highlighting, semantic colouring and full document colouring are disabled
+     */
+    virtual bool IsLargeFile() const { return m_largeFile; }
+
+    /**
+     * @brief called by clEditorFileLoader for every decoded chunk of a large file
+     */
+    void OnLargeFileChunk(const clEditorFileChunk& chunk);
+
     clEditorTipWindow* GetFunctionTip() { return m_functionTip; }
 
     bool IsFocused() const;
@@ -759,6 +779,11 @@ public:
      */
     time_t GetEditorLastModifiedTime() const { return m_modifyTime; }
     void SetEditorLastModifiedTime(time_t modificationTime) { m_modifyTime = modificationTime; }
+    /**
+     * @brief the identity (metadata + content hash) of the file as it was last loaded or saved
+     */
+    const clFileIdentity& GetFileIdentity() const { return m_fileIdentity; }
+    void SetFileIdentity(const clFileIdentity& fileIdentity) { this->m_fileIdentity = fileIdentity; }
 
     /**
      * @brief Get the editor's modification count
@@ -992,6 +1017,10 @@ private:
     void BraceMatch(const bool& bSelRegion);
     void BraceMatch(long pos);
     void DoHighlightWord();
+    bool DoOpenLargeFile();
+    void DoApplyLargeFileSettings();
+    void DoRevertLargeFileSettings();
+    void DoStopLargeFileLoader();
     bool IsOpenBrace(int position);
     bool IsCloseBrace(int position);
     size_t GetCodeNavModifier();
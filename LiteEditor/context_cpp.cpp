@@ -32,6 +32,7 @@
 #include "buildtabsettingsdata.h"
 #include "clEditorStateLocker.h"
 #include "clSelectSymbolDialog.h"
+#include "clSemanticHighlightCache.h"
 #include "cl_command_event.h"
 #include "cl_editor.h"
 #include "cl_editor_tip_window.h"
@@ -1920,12 +1921,28 @@ void ContextCpp::OnFileSaved()
         // if there is nothing to color, go ahead and return
         if(!(TagsManagerST::Get()->GetCtagsOptions().GetFlags() & CC_COLOUR_VARS)) { return; }
 
-        // Start a colour request
-        ParseRequest* parsingRequest = new ParseRequest(ManagerST::Get());
-        parsingRequest->setDbFile(TagsManagerST::Get()->GetDatabase()->GetDatabaseFileName().GetFullPath());
-        parsingRequest->setType(ParseRequest::PR_SUGGEST_HIGHLIGHT_WORDS);
-        parsingRequest->setFile(GetCtrl().GetFileName().GetFullPath());
-        ParseThreadST::Get()->Add(parsingRequest);
+        // Apply the tokens cached for this content right away. The editor hashed the content when it loaded or saved
+        // the file, so there is nothing to read here but the cache entry. The parser computes the tokens again only
+        // if tags were written since
+        wxString filename = GetCtrl().GetFileName().GetFullPath();
+        ITagsStoragePtr db = TagsManagerST::Get()->GetDatabase();
+        const clFileIdentity& identity = GetCtrl().GetFileIdentity();
+        bool upToDate = false;
+        clSemanticHighlightCache::Entry entry;
+        if(identity.HasHash() && clSemanticHighlightCache::Load(filename, entry) &&
+           (entry.contentHash == identity.GetHash())) {
+            ColourContextTokens(entry.classes, entry.locals);
+            upToDate = (entry.tagsGeneration == db->GetTagsGeneration());
+        }
+
+        if(!upToDate) {
+            // Start a colour request
+            ParseRequest* parsingRequest = new ParseRequest(ManagerST::Get());
+            parsingRequest->setDbFile(db->GetDatabaseFileName().GetFullPath());
+            parsingRequest->setType(ParseRequest::PR_SUGGEST_HIGHLIGHT_WORDS);
+            parsingRequest->setFile(filename);
+            ParseThreadST::Get()->Add(parsingRequest);
+        }
 
         // Update preprocessor visualization
         ManagerST::Get()->UpdatePreprocessorFile(&GetCtrl());
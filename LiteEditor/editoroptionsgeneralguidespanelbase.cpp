@@ -203,6 +203,14 @@ EditorOptionsGeneralEditBase::EditorOptionsGeneralEditBase(wxWindow* parent, wxW
     m_pgPropCommentsIndented->SetHelpString(_(
         "Indent line comments (C++-style comments) according to the indentation of the selected fragmant of the text"));
 
+    m_pgPropLargeFiles = m_pgMgrEdit->Append(new wxPropertyCategory(_("Large files")));
+    m_pgPropLargeFiles->SetHelpString(wxT(""));
+
+    m_pgPropLargeFileSize =
+        m_pgMgrEdit->AppendIn(m_pgPropLargeFiles, new wxIntProperty(_("Large file size (MB)"), wxPG_LABEL, 32));
+    m_pgPropLargeFileSize->SetHelpString(_("Files of this size or larger are loaded in the background, without "
+                                           "folding, word wrapping or background colouring. 0 disables it"));
+
     SetName(wxT("EditorOptionsGeneralEditBase"));
     SetSize(wxDLG_UNIT(this, wxSize(500, 300)));
     if(GetSizer()) { GetSizer()->Fit(this); }
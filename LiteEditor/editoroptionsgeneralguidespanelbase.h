@@ -84,6 +84,8 @@ protected:
     wxPGProperty* m_pgPropZoomUsingCtrlScroll;
     wxPGProperty* m_pgProp565;
     wxPGProperty* m_pgPropCommentsIndented;
+    wxPGProperty* m_pgPropLargeFiles;
+    wxPGProperty* m_pgPropLargeFileSize;
 
 protected:
     virtual void OnValueChanged(wxPropertyGridEvent& event) { event.Skip(); }
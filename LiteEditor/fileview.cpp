@@ -576,7 +576,9 @@ bool FileViewTree::AddFilesToVirtualFolder(const wxString& vdFullPath, wxArraySt
     // locate the item
     wxTreeItemId item = ItemByFullPath(vdFullPath);
     if(item.IsOk()) {
-        for(size_t i = 0; i < actualAdded.Count(); i++) {
+        // If the folder content was never created, it is created now from the project (which has the new files)
+        bool built = DoBuildSubTreeIfNeeded(item);
+        for(size_t i = 0; !built && i < actualAdded.Count(); i++) {
 
             // Add the tree node
             wxFileName fnFileName(actualAdded.Item(i));
@@ -1388,12 +1390,9 @@ wxTreeItemId FileViewTree::FindItemByPath(wxTreeItemId& projectHTI, const wxStri
     ProjectPtr proj = clCxxWorkspaceST::Get()->GetProject(projectName);
     if(!proj) return wxTreeItemId();
 
+    // The project knows the virtual folder of the file: only the folders on the way to it are created
     wxString vdFullPath = proj->GetVDByFileName(fileName);
 
-#if defined(__WXGTK__)
-    wxString realpathItem = CLRealPath(fileName);
-#endif
-
     wxTreeItemId curItem = projectHTI;
     wxArrayString dirs = ::wxStringTokenize(vdFullPath, ":", wxTOKEN_STRTOK);
     for(size_t i = 0; i < dirs.size(); ++i) {
@@ -1423,8 +1422,21 @@ wxTreeItemId FileViewTree::FindItemByPath(wxTreeItemId& projectHTI, const wxStri
         DoBuildSubTreeIfNeeded(curItem);
 
         // We found the virtual folder that should contain the filename
+        // The items keep the path as stored in the project, so an exact match does not need the file system
         wxTreeItemIdValue cookie;
         wxTreeItemId child = GetFirstChild(curItem, cookie);
+        while(child.IsOk()) {
+            FilewViewTreeItemData* childData = static_cast<FilewViewTreeItemData*>(GetItemData(child));
+            if(childData && childData->GetData().IsFile() && childData->GetData().GetFile() == fileName) {
+                return child;
+            }
+            child = GetNextChild(curItem, cookie);
+        }
+
+#if defined(__WXGTK__)
+        wxString realpathItem = CLRealPath(fileName);
+#endif
+        child = GetFirstChild(curItem, cookie);
         while(child.IsOk()) {
             FilewViewTreeItemData* childData = static_cast<FilewViewTreeItemData*>(GetItemData(child));
             wxFileName fn(childData->GetData().GetFile());
@@ -1455,6 +1467,8 @@ wxTreeItemId FileViewTree::ItemByFullPath(const wxString& fullPath)
     wxTreeItemId parent = GetItemParent(m_projectsMap[projname]);
     wxArrayString texts = wxStringTokenize(fullPath, wxT(":"), wxTOKEN_STRTOK);
     for(size_t i = 0; i < texts.GetCount(); i++) {
+        // the folders on the way may not be expanded yet
+        DoBuildSubTreeIfNeeded(parent);
         parent = DoGetItemByText(parent, texts.Item(i));
         if(parent.IsOk() == false) { return wxTreeItemId(); }
     }
@@ -1879,6 +1893,13 @@ bool FileViewTree::DoAddNewItem(wxTreeItemId& item, const wxString& filename, co
 
     ManagerST::Get()->AddNewFileToProject(filename, vdFullpath);
 
+    // If the folder content was never created, it is created now from the project (which has the new file)
+    if(DoBuildSubTreeIfNeeded(item)) {
+        Expand(item);
+        SendCmdEvent(wxEVT_FILE_VIEW_REFRESHED);
+        return true;
+    }
+
     // Add the tree node
     wxFileName fnFileName(filename);
     wxString path(vdFullpath);
@@ -2836,46 +2857,58 @@ void FileViewTree::DoAddChildren(const wxTreeItemId& parentItem)
         proj->GetFolders("", folders);
     }
 
+    // The project knows the folder content: create all the children in a single batch
+    clTreeCtrlItem::Vec_t items;
+    items.reserve(folders.size() + files.size());
+
     // First, we add the virtual folders
     for(size_t i = 0; i < folders.size(); ++i) {
         const wxString& childVdFullPath = folders.Item(i);
         wxString displayName = childVdFullPath.AfterLast(':');
         ProjectItem folderItem(proj->GetName() + ":" + childVdFullPath, displayName, "",
                                ProjectItem::TypeVirtualDirectory);
-        wxTreeItemId hti = AppendItem(parentItem,            // parent
-                                      displayName,           // display name
-                                      FOLDER_IMG_IDX,        // item image index
-                                      FOLDER_EXPAND_IMG_IDX, // selected item image
-                                      new FilewViewTreeItemData(folderItem));
-        DoSetItemBackgroundColour(hti, coloursList, folderItem);
-        if(!proj->IsVirtualDirectoryEmpty(childVdFullPath)) {
-            // Add a dummy item So the user can "Expand" it
-            AppendItem(hti, "<dummy>", -1, -1,
-                       new FilewViewTreeItemData(ProjectItem("", "", "", ProjectItem::TypeInvalid)));
-        }
+        items.push_back(clTreeCtrlItem(displayName,           // display name
+                                       FOLDER_IMG_IDX,        // item image index
+                                       FOLDER_EXPAND_IMG_IDX, // selected item image
+                                       new FilewViewTreeItemData(folderItem)));
     }
 
-    BuildConfigPtr buildConf = proj->GetBuildConfiguration();
-    wxString buildConfName = buildConf ? buildConf->GetName() : "";
-
     for(size_t i = 0; i < files.size(); ++i) {
         const wxString& filepath = files.Item(i);
-        wxFileName fn(filepath);
-        ProjectItem fileItem(vdFullPath + ":" + fn.GetFullName(), fn.GetFullName(), filepath, ProjectItem::TypeFile);
+        size_t sep = filepath.find_last_of(wxFileName::GetPathSeparators());
+        wxString fullname = (sep == wxString::npos) ? filepath : filepath.Mid(sep + 1);
+        ProjectItem fileItem(vdFullPath + ":" + fullname, fullname, filepath, ProjectItem::TypeFile);
 
         int iconIndex = GetIconIndex(fileItem);
-        wxTreeItemId hti = AppendItem(parentItem,                // parent
-                                      fileItem.GetDisplayName(), // display name
-                                      iconIndex,                 // item image index
-                                      iconIndex,                 // selected item image
-                                      new FilewViewTreeItemData(fileItem));
-        DoSetItemBackgroundColour(hti, coloursList, fileItem);
+        items.push_back(clTreeCtrlItem(fileItem.GetDisplayName(), // display name
+                                       iconIndex,                 // item image index
+                                       iconIndex,                 // selected item image
+                                       new FilewViewTreeItemData(fileItem)));
+    }
+
+    std::vector<wxTreeItemId> ids = AppendItems(parentItem, items);
+
+    BuildConfigPtr buildConf = proj->GetBuildConfiguration();
+    wxString buildConfName = buildConf ? buildConf->GetName() : "";
 
-        // If the file is disabled for the current build configuration, mark it as such
-        clProjectFile::Ptr_t fileInfo = proj->GetFile(fn.GetFullPath());
-        if(fileInfo && !buildConfName.IsEmpty() && fileInfo->IsExcludeFromConfiguration(buildConfName)) {
-            // Set the item text with disabled colour
-            ExcludeFileFromBuildUI(hti, true);
+    for(size_t i = 0; i < ids.size(); ++i) {
+        const wxTreeItemId& hti = ids[i];
+        const ProjectItem& childItem = static_cast<FilewViewTreeItemData*>(items[i].data)->GetData();
+        DoSetItemBackgroundColour(hti, coloursList, childItem);
+
+        if(i < folders.size()) {
+            if(!proj->IsVirtualDirectoryEmpty(folders.Item(i))) {
+                // Add a dummy item So the user can "Expand" it
+                AppendItem(hti, "<dummy>", -1, -1,
+                           new FilewViewTreeItemData(ProjectItem("", "", "", ProjectItem::TypeInvalid)));
+            }
+        } else {
+            // If the file is disabled for the current build configuration, mark it as such
+            clProjectFile::Ptr_t fileInfo = proj->GetFile(childItem.GetFile());
+            if(fileInfo && !buildConfName.IsEmpty() && fileInfo->IsExcludeFromConfiguration(buildConfName)) {
+                // Set the item text with disabled colour
+                ExcludeFileFromBuildUI(hti, true);
+            }
         }
     }
 }
@@ -2901,7 +2934,7 @@ FilewViewTreeItemData* FileViewTree::ItemData(const wxTreeItemId& item) const
     return static_cast<FilewViewTreeItemData*>(cd);
 }
 
-void FileViewTree::DoBuildSubTreeIfNeeded(const wxTreeItemId& parent)
+bool FileViewTree::DoBuildSubTreeIfNeeded(const wxTreeItemId& parent)
 {
     if(parent.IsOk() && ItemHasChildren(parent)) {
         wxTreeItemIdValue cookie;
@@ -2914,8 +2947,10 @@ void FileViewTree::DoBuildSubTreeIfNeeded(const wxTreeItemId& parent)
 
             // Append the real items
             DoAddChildren(parent);
+            return true;
         }
     }
+    return false;
 }
 
 void FileViewTree::ExcludeFileFromBuildUI(const wxTreeItemId& item, bool exclude)
@@ -230,7 +230,11 @@ private:
     void BuildProjectNode(const wxString& projectName);
     void DoClear();
     void DoAddChildren(const wxTreeItemId& parentItem);
-    void DoBuildSubTreeIfNeeded(const wxTreeItemId& parent);
+    /**
+     * @brief create the children of 'parent' if they were not created yet (its only child is a "<dummy>" item)
+     * @return true if the children were created by this call
+     */
+    bool DoBuildSubTreeIfNeeded(const wxTreeItemId& parent);
 
     /**
      * @brief add a workspace folder
@@ -37,6 +37,7 @@
 
 FindUsageTab::FindUsageTab(wxWindow* parent, const wxString& name)
     : OutputTabWindow(parent, wxID_ANY, name)
+    , m_lineNumber(0)
 {
     m_styler->SetStyles(m_sci);
     m_sci->HideSelection(true);
@@ -65,6 +66,9 @@ void FindUsageTab::OnStyleNeeded(wxStyledTextEvent& e)
 void FindUsageTab::Clear()
 {
     m_matches.clear();
+    m_lineNumber = 0;
+    m_curfile.Clear();
+    m_curfileLines.Clear();
     m_styler->Reset();
     OutputTabWindow::Clear();
 }
@@ -93,49 +97,50 @@ void FindUsageTab::OnClearAllUI(wxUpdateUIEvent& e) { e.Enable(m_sci && m_sci->G
 
 void FindUsageTab::ShowUsage(const CppToken::Vec_t& matches, const wxString& searchWhat)
 {
-    Clear();
-    int lineNumber(0);
-    wxString text;
-    wxString curfile;
-    wxString curfileContent;
-    wxArrayString lines;
+    BeginUsage(searchWhat);
+    AppendUsage(matches);
+    EndUsage();
+}
 
-    text = wxString::Format(_("===== Finding references of '%s' =====\n"), searchWhat.c_str());
-    lineNumber++;
+void FindUsageTab::BeginUsage(const wxString& searchWhat)
+{
+    Clear();
+    AppendText(wxString::Format(_("===== Finding references of '%s' =====\n"), searchWhat.c_str()));
+    m_lineNumber++;
+}
 
+void FindUsageTab::AppendUsage(const CppToken::Vec_t& matches)
+{
+    wxString text;
     CppToken::Vec_t::const_iterator iter = matches.begin();
     for(; iter != matches.end(); ++iter) {
 
         // Print the line number
         wxString file_name(iter->getFilename());
-        if(curfile != file_name) {
-            curfile = file_name;
+        if(m_curfile != file_name) {
+            m_curfile = file_name;
+            m_curfileLines.Clear();
             wxFileName fn(file_name);
             fn.MakeRelativeTo();
 
             text << fn.GetFullPath() << wxT("\n");
-            lineNumber++;
+            m_lineNumber++;
 
             // Load the file content
             wxLogNull nolog;
             wxFFile thefile(file_name, wxT("rb"));
             if(thefile.IsOpened()) {
-
-                wxFileOffset size = thefile.Length();
-                wxString fileData;
-                fileData.Alloc(size);
-                curfileContent.Clear();
-
+                wxString curfileContent;
                 wxCSConv fontEncConv(wxFONTENCODING_ISO8859_1);
                 thefile.ReadAll(&curfileContent, fontEncConv);
 
                 // break the current file into lines, a line can be an empty string
-                lines = wxStringTokenize(curfileContent, wxT("\n"), wxTOKEN_RET_EMPTY_ALL);
+                m_curfileLines = wxStringTokenize(curfileContent, wxT("\n"), wxTOKEN_RET_EMPTY_ALL);
             }
         }
 
         // Keep the match
-        m_matches[lineNumber] = *iter;
+        m_matches[m_lineNumber] = *iter;
 
         // Format the message
         wxString linenum = wxString::Format(wxT(" %5u: "), (unsigned int)iter->getLineNumber() + 1);
@@ -146,15 +151,30 @@ void FindUsageTab::ShowUsage(const CppToken::Vec_t& matches, const wxString& sea
         }
 
         text << linenum << wxT("[ ") << scopeName << wxT(" ] ");
-        if(lines.GetCount() > iter->getLineNumber()) {
-            text << lines.Item(iter->getLineNumber()).Trim().Trim(false);
+        if(m_curfileLines.GetCount() > iter->getLineNumber()) {
+            text << m_curfileLines.Item(iter->getLineNumber()).Trim().Trim(false);
         }
 
         text << wxT("\n");
-        lineNumber++;
+        m_lineNumber++;
+    }
+    if(!text.IsEmpty()) {
+        AppendText(text);
+    }
+}
+
+void FindUsageTab::EndUsage(const CppToken::Vec_t& possibleMatches)
+{
+    size_t count = m_matches.size();
+    if(!possibleMatches.empty()) {
+        AppendText(_("===== Possible matches (files that don't seem to include the declaration) =====\n"));
+        m_lineNumber++;
+        m_curfile.Clear();
+        AppendUsage(possibleMatches);
     }
-    text << wxString::Format(_("===== Found total of %u matches =====\n"), (unsigned int)m_matches.size());
-    AppendText(text);
+    AppendText(wxString::Format(_("===== Found total of %u matches =====\n"), (unsigned int)count));
+    m_curfile.Clear();
+    m_curfileLines.Clear();
 }
 
 void FindUsageTab::DoOpenResult(const CppToken& token)
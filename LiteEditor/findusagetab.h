@@ -35,6 +35,9 @@ typedef std::unordered_map<int, CppToken> UsageResultsMap;
 class FindUsageTab : public OutputTabWindow
 {
     UsageResultsMap m_matches;
+    int m_lineNumber;
+    wxString m_curfile;
+    wxArrayString m_curfileLines;
 
 protected:
     void DoOpenResult(const CppToken& token);
@@ -55,6 +58,14 @@ public:
 
 public:
     void ShowUsage(const CppToken::Vec_t& matches, const wxString& searchWhat);
+
+    /**
+     * @brief display the results as they arrive: BeginUsage() clears the view, AppendUsage() adds matches and
+     * EndUsage() prints the possible matches (if any) and the summary
+     */
+    void BeginUsage(const wxString& searchWhat);
+    void AppendUsage(const CppToken::Vec_t& matches);
+    void EndUsage(const CppToken::Vec_t& possibleMatches = CppToken::Vec_t());
 };
 
 #endif // FINDUSAGETAB_H
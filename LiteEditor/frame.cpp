@@ -41,7 +41,10 @@
 #include "clGotoAnythingManager.h"
 #include "clInfoBar.h"
 #include "clMainFrameHelper.h"
+#include "clParseResultCache.h"
 #include "clSingleChoiceDialog.h"
+#include "clSqliteQueryStats.h"
+#include "clStartupProfiler.h"
 #include "clThemeUpdater.h"
 #include "clToolBarButtonBase.h"
 #include "clWorkspaceManager.h"
@@ -451,6 +454,8 @@ EVT_MENU(XRCID("add_project"), clMainFrame::OnProjectAddProject)
 EVT_MENU(XRCID("reconcile_project"), clMainFrame::OnReconcileProject)
 EVT_MENU(XRCID("retag_workspace"), clMainFrame::OnRetagWorkspace)
 EVT_MENU(XRCID("full_retag_workspace"), clMainFrame::OnRetagWorkspace)
+EVT_MENU(XRCID("export_parse_cache"), clMainFrame::OnExportParseCache)
+EVT_MENU(XRCID("clear_parse_cache"), clMainFrame::OnClearParseCache)
 EVT_MENU(XRCID("project_properties"), clMainFrame::OnShowActiveProjectSettings)
 
 EVT_UPDATE_UI(XRCID("local_workspace_prefs"), clMainFrame::OnWorkspaceOpen)
@@ -599,6 +604,8 @@ EVT_MENU(wxID_ABOUT, clMainFrame::OnAbout)
 EVT_MENU(XRCID("wxID_REPORT_BUG"), clMainFrame::OnReportIssue)
 EVT_MENU(XRCID("check_for_update"), clMainFrame::OnCheckForUpdate)
 EVT_MENU(XRCID("run_setup_wizard"), clMainFrame::OnRunSetupWizard)
+EVT_MENU(XRCID("show_startup_timeline"), clMainFrame::OnShowStartupTimeline)
+EVT_MENU(XRCID("show_tags_db_stats"), clMainFrame::OnShowTagsDatabaseStats)
 
 //-------------------------------------------------------
 // Perspective menu
@@ -828,6 +835,8 @@ clMainFrame::clMainFrame(wxWindow* pParent, wxWindowID id, const wxString& title
     EventNotifier::Get()->Bind(wxEVT_DEBUG_STARTED, &clMainFrame::OnDebugStarted, this);
     EventNotifier::Get()->Bind(wxEVT_DEBUG_ENDED, &clMainFrame::OnDebugEnded, this);
     m_infoBar->Bind(wxEVT_BUTTON, &clMainFrame::OnInfobarButton, this);
+    EventNotifier::Get()->Bind(wxEVT_REFACTOR_ENGINE_REFERENCES_STARTED, &clMainFrame::OnFindReferencesStarted, this);
+    EventNotifier::Get()->Bind(wxEVT_REFACTOR_ENGINE_REFERENCES_PARTIAL, &clMainFrame::OnFindReferencesPartial, this);
     EventNotifier::Get()->Bind(wxEVT_REFACTOR_ENGINE_REFERENCES, &clMainFrame::OnFindReferences, this);
     EventNotifier::Get()->Bind(wxEVT_REFACTOR_ENGINE_RENAME_SYMBOL, &clMainFrame::OnRenameSymbol, this);
 
@@ -898,6 +907,10 @@ clMainFrame::~clMainFrame(void)
                          NULL, this);
     wxTheApp->Disconnect(wxID_CUT, wxEVT_UPDATE_UI, wxUpdateUIEventHandler(clMainFrame::DispatchUpdateUIEvent), NULL,
                          this);
+    EventNotifier::Get()->Unbind(wxEVT_REFACTOR_ENGINE_REFERENCES_STARTED, &clMainFrame::OnFindReferencesStarted,
+                                 this);
+    EventNotifier::Get()->Unbind(wxEVT_REFACTOR_ENGINE_REFERENCES_PARTIAL, &clMainFrame::OnFindReferencesPartial,
+                                 this);
     EventNotifier::Get()->Unbind(wxEVT_REFACTOR_ENGINE_REFERENCES, &clMainFrame::OnFindReferences, this);
     EventNotifier::Get()->Unbind(wxEVT_REFACTOR_ENGINE_RENAME_SYMBOL, &clMainFrame::OnRenameSymbol, this);
     EventNotifier::Get()->Unbind(wxEVT_ENVIRONMENT_VARIABLES_MODIFIED, &clMainFrame::OnEnvironmentVariablesModified,
@@ -3307,16 +3320,22 @@ void clMainFrame::CompleteInitialization()
     clKeyboardManager::Get()->AddGlobalAccelerator("open_include_file", "", "Open Include File");
 
     // Load the plugins
-    PluginManager::Get()->Load();
+    {
+        clStartupProfiler::Scope profile("Load plugins", "Plugins");
+        PluginManager::Get()->Load();
+    }
 
-// Load debuggers (*must* be after the plugins)
+    // Load debuggers (*must* be after the plugins)
+    {
+        clStartupProfiler::Scope profile("Load debuggers", "Debuggers");
 #ifdef USE_POSIX_LAYOUT
-    wxString plugdir(clStandardPaths::Get().GetPluginsDirectory());
-    DebuggerMgr::Get().Initialize(this, EnvironmentConfig::Instance(), plugdir);
+        wxString plugdir(clStandardPaths::Get().GetPluginsDirectory());
+        DebuggerMgr::Get().Initialize(this, EnvironmentConfig::Instance(), plugdir);
 #else
-    DebuggerMgr::Get().Initialize(this, EnvironmentConfig::Instance(), ManagerST::Get()->GetInstallDir());
+        DebuggerMgr::Get().Initialize(this, EnvironmentConfig::Instance(), ManagerST::Get()->GetInstallDir());
 #endif
-    DebuggerMgr::Get().LoadDebuggers(ManagerST::Get());
+        DebuggerMgr::Get().LoadDebuggers(ManagerST::Get());
+    }
 
     // Connect some system events
     m_mgr.Connect(wxEVT_AUI_PANE_CLOSE, wxAuiManagerEventHandler(clMainFrame::OnDockablePaneClosed), NULL, this);
@@ -3360,7 +3379,10 @@ void clMainFrame::CompleteInitialization()
 
     TabGroupsManager::Get(); // Ensure that the events are binded
 
-    ManagerST::Get()->GetPerspectiveManager().LoadPerspective(NORMAL_LAYOUT);
+    {
+        clStartupProfiler::Scope profile("Load perspective", "Main frame");
+        ManagerST::Get()->GetPerspectiveManager().LoadPerspective(NORMAL_LAYOUT);
+    }
     m_initCompleted = true;
 
     if(GetTheApp()->IsStartedInDebuggerMode()) {
@@ -4433,6 +4455,34 @@ void clMainFrame::OnRetagWorkspace(wxCommandEvent& event)
     ManagerST::Get()->RetagWorkspace(type);
 }
 
+void clMainFrame::OnExportParseCache(wxCommandEvent& event)
+{
+    wxUnusedVar(event);
+    wxString filename = ::wxFileSelector(_("Export Parse Cache"), wxEmptyString, wxT("parse-cache.clpack"),
+                                         wxT("clpack"), wxT("Parse cache packs (*.clpack)|*.clpack"),
+                                         wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if(filename.IsEmpty()) return;
+
+    size_t count = 0;
+    if(!clParseResultCache::Get().ExportPack(filename, count)) {
+        ::wxMessageBox(_("Failed to export the parse cache to:\n") + filename, "CodeLite", wxICON_ERROR | wxOK);
+        return;
+    }
+    wxString message;
+    message << wxString::Format(_("Exported %lu parsed files.\n"), (unsigned long)count)
+            << _("To use the pack on another machine, copy it into the folder:\n")
+            << clParseResultCache::Get().GetPacksDir().GetPath();
+    ::wxMessageBox(message, "CodeLite", wxICON_INFORMATION | wxOK);
+}
+
+void clMainFrame::OnClearParseCache(wxCommandEvent& event)
+{
+    wxUnusedVar(event);
+    size_t count = clParseResultCache::Get().Clear();
+    ::wxMessageBox(wxString::Format(_("Removed %lu parsed files from the parse cache"), (unsigned long)count),
+                   "CodeLite", wxICON_INFORMATION | wxOK);
+}
+
 void clMainFrame::OnShowFullScreen(wxCommandEvent& e)
 {
     wxUnusedVar(e);
@@ -5495,6 +5545,30 @@ void clMainFrame::OnRunSetupWizard(wxCommandEvent& e)
     }
 }
 
+void clMainFrame::OnShowStartupTimeline(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    clEditor* editor = GetMainBook()->NewEditor();
+    if(!editor) { return; }
+
+    wxFileName fnTimeline(clStandardPaths::Get().GetUserDataDir(), "startup-timeline.json");
+    wxString content = clStartupProfiler::Get().ToString();
+    content << "\n" << _("The timeline is saved in the Chrome trace format (chrome://tracing) in: ")
+            << fnTimeline.GetFullPath() << "\n";
+    editor->SetText(content);
+    editor->SetSavePoint();
+}
+
+void clMainFrame::OnShowTagsDatabaseStats(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    clEditor* editor = GetMainBook()->NewEditor();
+    if(!editor) { return; }
+
+    editor->SetText(clSqliteQueryStats::Get().ToString());
+    editor->SetSavePoint();
+}
+
 void clMainFrame::OnCloseTabsToTheRight(wxCommandEvent& e)
 {
     wxUnusedVar(e);
@@ -6033,11 +6107,24 @@ void clMainFrame::OnShowMenuBarUI(wxUpdateUIEvent& event)
 
 void clMainFrame::Raise() { wxFrame::Raise(); }
 
+void clMainFrame::OnFindReferencesStarted(clRefactoringEvent& e)
+{
+    e.Skip();
+    GetOutputPane()->GetShowUsageTab()->BeginUsage(e.GetString());
+}
+
+void clMainFrame::OnFindReferencesPartial(clRefactoringEvent& e)
+{
+    e.Skip();
+    // Show the results as they are confirmed
+    GetOutputPane()->GetShowUsageTab()->AppendUsage(e.GetMatches());
+}
+
 void clMainFrame::OnFindReferences(clRefactoringEvent& e)
 {
     e.Skip();
-    // Show the results
-    GetOutputPane()->GetShowUsageTab()->ShowUsage(e.GetMatches(), e.GetString());
+    // the matches were already displayed by OnFindReferencesPartial
+    GetOutputPane()->GetShowUsageTab()->EndUsage(e.GetPossibleMatches());
 }
 
 void clMainFrame::OnRenameSymbol(clRefactoringEvent& e)
@@ -433,6 +433,8 @@ protected:
     void OnReportIssue(wxCommandEvent& event);
     void OnCheckForUpdate(wxCommandEvent& e);
     void OnRunSetupWizard(wxCommandEvent& e);
+    void OnShowStartupTimeline(wxCommandEvent& e);
+    void OnShowTagsDatabaseStats(wxCommandEvent& e);
     void OnFileNew(wxCommandEvent& event);
     void OnFileOpen(wxCommandEvent& event);
     void OnFileOpenFolder(wxCommandEvent& event);
@@ -489,6 +491,8 @@ protected:
     void OnBuildAndRunProject(wxCommandEvent& event);
     void OnRebuildProject(wxCommandEvent& event);
     void OnRetagWorkspace(wxCommandEvent& event);
+    void OnExportParseCache(wxCommandEvent& event);
+    void OnClearParseCache(wxCommandEvent& event);
     void OnBuildProjectUI(wxUpdateUIEvent& event);
     void OnStopBuild(wxCommandEvent& event);
     void OnStopBuildUI(wxUpdateUIEvent& event);
@@ -530,6 +534,8 @@ protected:
     void OnWebSearchSelectionUI(wxUpdateUIEvent& e);
     void OnThemeChanged(wxCommandEvent& e);
     void OnEnvironmentVariablesModified(clCommandEvent& e);
+    void OnFindReferencesStarted(clRefactoringEvent& e);
+    void OnFindReferencesPartial(clRefactoringEvent& e);
     void OnFindReferences(clRefactoringEvent& e);
     void OnRenameSymbol(clRefactoringEvent& e);
 
@@ -26,6 +26,7 @@
 #include "NotebookNavigationDlg.h"
 #include "WelcomePage.h"
 #include "clAuiMainNotebookTabArt.h"
+#include "clFileIdentity.h"
 #include "clFileOrFolderDropTarget.h"
 #include "clImageViewer.h"
 #include "clThemeUpdater.h"
@@ -822,25 +823,36 @@ void MainBook::ReloadExternallyModified(bool prompt)
     clEditor::Vec_t editors;
     GetAllEditors(editors, MainBook::kGetAll_IncludeDetached);
 
+    // Editors that are still loading their file (large-file mode) record its identity once done
+    editors.erase(std::remove_if(editors.begin(), editors.end(),
+                                 [](clEditor* editor) { return editor->GetReloadingFile(); }),
+                  editors.end());
+
     time_t workspaceModifiedTimeBefore = clCxxWorkspaceST::Get()->GetFileLastModifiedTime();
 
+    // Check the files of all the editors in one batch. Only the metadata is compared, unless it changed: in that case
+    // the raw content is hashed (never decoded) and compared with the hash recorded when the file was loaded/saved.
+    // This avoids unnecessary reload offers after e.g. git stash
+    std::vector<clFileIdentity::BatchEntry> entries(editors.size());
+    for(size_t i = 0; i < editors.size(); i++) {
+        entries[i].path = editors[i]->GetFileName().GetFullPath();
+        entries[i].identity = editors[i]->GetFileIdentity();
+    }
+    clFileIdentity::CheckBatch(entries);
+
     // filter list of editors for any whose files have been modified
     std::vector<std::pair<wxFileName, bool>> files;
     size_t n = 0;
     for(size_t i = 0; i < editors.size(); i++) {
-        time_t diskTime = editors[i]->GetFileLastModifiedTime();
-        time_t editTime = editors[i]->GetEditorLastModifiedTime();
-        if(diskTime != editTime) {
-            // update editor last mod time so that we don't keep bugging the user over the same file,
-            // unless it gets changed again
-            editors[i]->SetEditorLastModifiedTime(diskTime);
-
-            // A last check: see if the content of the file has actually changed. This avoids unnecessary reload offers
-            // after e.g. git stash
-            if(!CompareFileWithString(editors[i]->GetFileName().GetFullPath(), editors[i]->GetText())) {
-                files.push_back(std::make_pair(editors[i]->GetFileName(), !editors[i]->GetModify()));
-                editors[n++] = editors[i];
-            }
+        if(entries[i].state == clFileIdentity::kUnchanged) { continue; }
+
+        // update the editor file identity so that we don't keep bugging the user over the same file,
+        // unless it gets changed again
+        editors[i]->SetFileIdentity(entries[i].current);
+        editors[i]->SetEditorLastModifiedTime(editors[i]->GetFileLastModifiedTime());
+        if(entries[i].state == clFileIdentity::kModified || entries[i].state == clFileIdentity::kDeleted) {
+            files.push_back(std::make_pair(editors[i]->GetFileName(), !editors[i]->GetModify()));
+            editors[n++] = editors[i];
         }
     }
     editors.resize(n);
@@ -29,6 +29,7 @@
 #include "clEditorBar.h"
 #include "clInfoBar.h"
 #include "clKeyboardManager.h"
+#include "clStartupProfiler.h"
 #include "clToolBarButtonBase.h"
 #include "cl_config.h"
 #include "cl_standard_paths.h"
@@ -97,6 +98,7 @@ void PluginManager::UnLoad()
 
     m_dl.clear();
     m_plugins.clear();
+    m_lazyPlugins.clear();
 }
 
 PluginManager::~PluginManager() {}
@@ -112,6 +114,29 @@ PluginManager::PluginManager()
     m_menusToBeHooked.insert(MenuTypeEditor);
 }
 
+void PluginManager::LoadLazyPlugins()
+{
+    if(m_lazyPlugins.empty()) { return; }
+
+    wxMenu* pluginsMenu = NULL;
+    wxMenuItem* menuitem = clMainFrame::Get()->GetMenuBar()->FindItem(XRCID("manage_plugins"), &pluginsMenu);
+    for(const auto& vt : m_lazyPlugins) {
+        clStartupProfiler::Scope profile(vt.first, "Plugins (lazy)");
+        IPlugin* plugin = vt.second((IManager*)this);
+        CL_DEBUG(wxT("Loaded plugin: ") + plugin->GetLongName());
+        m_plugins[plugin->GetShortName()] = plugin;
+        plugin->CreateToolBar(GetToolBar());
+        if(pluginsMenu && menuitem) {
+            plugin->SetPluginsMenu(pluginsMenu);
+            plugin->CreatePluginMenu(pluginsMenu);
+        }
+    }
+    m_lazyPlugins.clear();
+
+    clMainFrame::Get()->GetDockingManager().Update();
+    GetToolBar()->Realize();
+}
+
 void PluginManager::Load()
 {
     wxString ext;
@@ -159,6 +184,7 @@ void PluginManager::Load()
         for(size_t i = 0; i < files.GetCount(); i++) {
 
             wxString fileName(files.Item(i));
+            clStartupProfiler::Scope profile(wxFileName(fileName).GetName(), "Plugins");
 #if defined(__WXMSW__) && CL_DEBUG_BUILD
 
             // Under MSW loading a release plugin while in debug mode will cause a crash
@@ -263,6 +289,13 @@ void PluginManager::Load()
                 continue;
             }
 
+            if(pluginInfo->HasFlag(PluginInfo::kLazyActivation)) {
+                CL_DEBUG(wxT("Plugin activation is deferred: ") + pluginInfo->GetName());
+                m_lazyPlugins.push_back({ pluginInfo->GetName(), pfn });
+                m_dl.push_back(dl);
+                continue;
+            }
+
             // Construct the plugin
             IPlugin* plugin = pfn((IManager*)this);
             CL_DEBUG(wxT("Loaded plugin: ") + plugin->GetLongName());
@@ -58,6 +58,8 @@ class PluginManager : public IManager
     std::map<wxString, wxString> m_backticks;
     wxAuiManager* m_dockingManager;
     PluginInfo::PluginMap_t m_installedPlugins;
+    /// plugins with the PluginInfo::kLazyActivation flag, waiting for LoadLazyPlugins()
+    std::vector<std::pair<wxString, GET_PLUGIN_CREATE_FUNC>> m_lazyPlugins;
 
 private:
     PluginManager();
@@ -68,6 +70,10 @@ public:
 
     virtual void Load();
     virtual void UnLoad();
+    /**
+     * @brief construct the plugins whose activation was deferred by Load()
+     */
+    void LoadLazyPlugins();
     virtual void EnableToolbars();
 
     void SetInstalledPlugins(const PluginInfo::PluginMap_t& installedPlugins)
@@ -31,8 +31,10 @@
 #include <wx/stc/stc.h>
 #include <wx/thread.h>
 
+#include "codelite_events.h"
 #include "event_notifier.h"
 #include "file_logger.h"
+#include "fileextmanager.h"
 #include "imanager.h"
 #include "outline_symbol_tree.h"
 #include <algorithm>
@@ -45,6 +47,9 @@
 
 #define INCLUDE_FILES_NODE_TEXT _("Include Files")
 
+// the modified lines are parsed once the user stops typing for this long
+static const int PARSE_DELAY_MS = 500;
+
 IMPLEMENT_DYNAMIC_CLASS(svSymbolTree, SymbolTree)
 
 const wxEventType wxEVT_CMD_CPP_SYMBOL_ITEM_SELECTED = wxNewEventType();
@@ -66,10 +71,26 @@ svSymbolTree::svSymbolTree(wxWindow* parent, IManager* manager, const wxWindowID
     Bind(wxEVT_PARSE_INCLUDE_STATEMENTS_DONE, &svSymbolTree::OnIncludeStatements, this);
     EventNotifier::Get()->Bind(wxEVT_CXX_SYMBOLS_CACHE_UPDATED, &svSymbolTree::OnCacheUpdated, this);
     EventNotifier::Get()->Bind(wxEVT_CXX_SYMBOLS_CACHE_INVALIDATED, &svSymbolTree::OnCacheInvalidated, this);
+    EventNotifier::Get()->Bind(wxEVT_EDITOR_MODIFIED, &svSymbolTree::OnEditorModified, this);
+    EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &svSymbolTree::OnFileSavedOrClosed, this);
+    EventNotifier::Get()->Bind(wxEVT_FILE_CLOSED, &svSymbolTree::OnFileSavedOrClosed, this);
+    m_parseTimer.SetOwner(this);
+    Bind(wxEVT_TIMER, &svSymbolTree::OnParseTimer, this, m_parseTimer.GetId());
 
     SetFont(wxSystemSettings::GetFont(wxSYS_DEFAULT_GUI_FONT));
 }
 
+svSymbolTree::~svSymbolTree()
+{
+    m_parseTimer.Stop();
+    Unbind(wxEVT_TIMER, &svSymbolTree::OnParseTimer, this, m_parseTimer.GetId());
+    EventNotifier::Get()->Unbind(wxEVT_CXX_SYMBOLS_CACHE_UPDATED, &svSymbolTree::OnCacheUpdated, this);
+    EventNotifier::Get()->Unbind(wxEVT_CXX_SYMBOLS_CACHE_INVALIDATED, &svSymbolTree::OnCacheInvalidated, this);
+    EventNotifier::Get()->Unbind(wxEVT_EDITOR_MODIFIED, &svSymbolTree::OnEditorModified, this);
+    EventNotifier::Get()->Unbind(wxEVT_FILE_SAVED, &svSymbolTree::OnFileSavedOrClosed, this);
+    EventNotifier::Get()->Unbind(wxEVT_FILE_CLOSED, &svSymbolTree::OnFileSavedOrClosed, this);
+}
+
 void svSymbolTree::OnMouseRightUp(wxTreeEvent& event)
 {
     event.Skip();
@@ -203,6 +224,9 @@ void svSymbolTree::BuildTree(const wxFileName& fn, bool force)
         clDEBUG() << "Outline: symbols found in cache, building tree...";
         DoBuildTree(tags, fn);
     }
+
+    // The editor was modified while another file was displayed
+    if(m_modifiedLines.count(fn.GetFullPath())) { m_parseTimer.Start(PARSE_DELAY_MS, wxTIMER_ONE_SHOT); }
 }
 
 wxTreeItemId svSymbolTree::DoAddIncludeFiles(const wxFileName& fn, const fcFileOpener::Set_t& includes)
@@ -320,12 +344,28 @@ void svSymbolTree::DoBuildTree(TagEntryPtrVector_t& tags, const wxFileName& file
         });
     }
     clDEBUG() << "Outline: DoBuildTree is called";
-    if(TagsManagerST::Get()->AreTheSame(m_currentTags, tags)) {
+    wxWindowUpdateLocker locker(this);
+    bool sameFile = (m_currentFile == filename.GetFullPath());
+    eApplyTagsResult applied = sameFile ? ApplyTags(tags) : kApplyTagsFailed;
+    if(applied == kApplyTagsDone) {
+        clDEBUG() << "Outline: symbols tree updated";
+        return;
+    }
+
+    if(applied != kApplyTagsUnsorted && TagsManagerST::Get()->AreTheSame(m_currentTags, tags)) {
         clDEBUG() << "Outline: symbols are the same, DoBuildTree will do nothing";
         return;
     }
-    wxWindowUpdateLocker locker(this);
-    SymbolTree::BuildTree(filename, tags, false);
+
+    // Keep the expanded items of the current file
+    wxStringSet_t expandedItems;
+    if(sameFile) {
+        for(const std::pair<wxString, void*>& p : m_items) {
+            wxTreeItemId item(p.second);
+            if(ItemHasChildren(item) && IsExpanded(item)) { expandedItems.insert(p.first); }
+        }
+    }
+    SymbolTree::BuildTree(filename, tags, applied == kApplyTagsUnsorted);
 
     wxTreeItemId root = GetRootItem();
     if(root.IsOk() && ItemHasChildren(root)) {
@@ -336,5 +376,73 @@ void svSymbolTree::DoBuildTree(TagEntryPtrVector_t& tags, const wxFileName& file
             child = GetNextChild(root, cookie);
         }
     }
+    for(const wxString& key : expandedItems) {
+        std::map<wxString, void*>::iterator iter = m_items.find(key);
+        if(iter != m_items.end()) { Expand(wxTreeItemId(iter->second)); }
+    }
     m_currentFile = filename.GetFullPath();
 }
+
+void svSymbolTree::OnEditorModified(clCommandEvent& e)
+{
+    e.Skip();
+    int line = e.GetLineNumber();
+    int linesAdded = e.GetInt();
+    if(line < 0 || !FileExtManager::IsCxxFile(e.GetFileName())) { return; }
+
+    int lastLine = line + std::max(0, linesAdded);
+    std::unordered_map<wxString, ModifiedLines>::iterator iter = m_modifiedLines.find(e.GetFileName());
+    if(iter == m_modifiedLines.end()) {
+        ModifiedLines& range = m_modifiedLines[e.GetFileName()];
+        range.firstLine = line;
+        range.lastLine = lastLine;
+        range.linesAdded = linesAdded;
+
+    } else {
+        // Lines added or removed above the modified range move it
+        ModifiedLines& range = iter->second;
+        if(linesAdded != 0) {
+            if(range.firstLine > line) { range.firstLine = std::max(line, range.firstLine + linesAdded); }
+            if(range.lastLine > line) { range.lastLine = std::max(line, range.lastLine + linesAdded); }
+        }
+        range.firstLine = std::min(range.firstLine, line);
+        range.lastLine = std::max(range.lastLine, lastLine);
+        range.linesAdded += linesAdded;
+    }
+
+    // Wait for the user to stop typing
+    if(e.GetFileName() == m_currentFile) { m_parseTimer.Start(PARSE_DELAY_MS, wxTIMER_ONE_SHOT); }
+}
+
+void svSymbolTree::OnFileSavedOrClosed(clCommandEvent& e)
+{
+    e.Skip();
+    // The saved file is parsed entirely
+    m_modifiedLines.erase(e.GetFileName());
+}
+
+void svSymbolTree::OnParseTimer(wxTimerEvent& e)
+{
+    wxUnusedVar(e);
+    IEditor* editor = m_manager->GetActiveEditor();
+    CHECK_PTR_RET(editor);
+
+    wxString filename = editor->GetFileName().GetFullPath();
+    std::unordered_map<wxString, ModifiedLines>::iterator iter = m_modifiedLines.find(filename);
+    if(iter == m_modifiedLines.end()) { return; }
+
+    // Huge files are updated when saved
+    if(editor->IsLargeFile()) {
+        m_modifiedLines.erase(iter);
+        return;
+    }
+
+    const ModifiedLines& range = iter->second;
+    if(!TagsManagerST::Get()->GetFileCache()->RequestSymbols(editor->GetFileName(), editor->GetCtrl()->GetText(),
+                                                              range.firstLine, range.lastLine, range.linesAdded)) {
+        // The previous modifications are still being parsed
+        m_parseTimer.Start(PARSE_DELAY_MS, wxTIMER_ONE_SHOT);
+        return;
+    }
+    m_modifiedLines.erase(iter);
+}
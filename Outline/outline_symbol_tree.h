@@ -30,14 +30,27 @@
 #include "imanager.h"
 #include "stack"
 #include "symbol_tree.h"
+#include <unordered_map>
+#include <wx/timer.h>
 
 extern const wxEventType wxEVT_CMD_CPP_SYMBOL_ITEM_SELECTED;
 
 /// This class represents the GUI tree for the C++ symbols
 class svSymbolTree : public SymbolTree
 {
+    /**
+     * @brief the lines of an editor modified since its symbols were last requested
+     */
+    struct ModifiedLines {
+        int firstLine = wxNOT_FOUND;
+        int lastLine = wxNOT_FOUND;
+        int linesAdded = 0;
+    };
+
     IManager* m_manager;
     wxString m_currentFile;
+    std::unordered_map<wxString, ModifiedLines> m_modifiedLines;
+    wxTimer m_parseTimer;
 
 public:
     svSymbolTree();
@@ -47,7 +60,7 @@ public:
                  const wxSize& size = wxDefaultSize, long style = wxTR_HIDE_ROOT);
 
     /// destructor
-    virtual ~svSymbolTree(){};
+    virtual ~svSymbolTree();
 
     virtual void BuildTree(const wxFileName& fn, bool force);
 
@@ -74,6 +87,9 @@ protected:
     void OnIncludeStatements(wxCommandEvent& e);
     void OnCacheUpdated(clCommandEvent& e);
     void OnCacheInvalidated(clCommandEvent& e);
+    void OnEditorModified(clCommandEvent& e);
+    void OnFileSavedOrClosed(clCommandEvent& e);
+    void OnParseTimer(wxTimerEvent& e);
     virtual void OnMouseDblClick(wxMouseEvent& event);
     virtual void OnMouseRightUp(wxTreeEvent& event);
     virtual void OnItemActivated(wxTreeEvent& event);
@@ -1,5 +1,7 @@
 #include "ColoursAndFontsManager.h"
 #include "EclipseThemeImporterManager.h"
+#include "clParallel.h"
+#include "clStartupProfiler.h"
 #include "cl_command_event.h"
 #include "cl_standard_paths.h"
 #include "editor_config.h"
@@ -139,21 +141,24 @@ struct ColoursAndFontsManagerLoaderHelper {
 
         CL_DEBUG("Loading users lexers");
         wxDir::GetAllFiles(userLexersPath.GetPath(), &files, "lexer_*.xml");
-        // Each XMl represents a single lexer
-        for(size_t i = 0; i < files.GetCount(); ++i) {
+        // Each XMl represents a single lexer. The files are parsed in parallel
+        std::vector<wxXmlDocument*> docs(files.GetCount(), nullptr);
+        clParallelFor(files.GetCount(), [&](size_t i) {
             wxString content;
             wxFFile xmlFile(files.Item(i), "rb");
-            if(!xmlFile.IsOpened()) continue;
+            if(!xmlFile.IsOpened()) return;
             if(xmlFile.ReadAll(&content, wxConvUTF8)) {
                 wxXmlDocument* doc = new wxXmlDocument();
                 wxStringInputStream sis(content);
                 if(doc->Load(sis)) {
-                    userLexers.push_back(doc);
+                    docs[i] = doc;
                 } else {
                     wxDELETE(doc);
                 }
             }
-            xmlFile.Close();
+        });
+        for(size_t i = 0; i < files.GetCount(); ++i) {
+            if(docs[i]) { userLexers.push_back(docs[i]); }
             clRemoveFile(files.Item(i));
         }
         CL_DEBUG("Loading users lexers...done");
@@ -164,6 +169,7 @@ struct ColoursAndFontsManagerLoaderHelper {
 void ColoursAndFontsManager::Load()
 {
     if(m_initialized) return;
+    clStartupProfiler::Scope profile("Load lexers", "Colours and Fonts");
     m_lexersMap.clear();
     m_initialized = true;
     m_globalTheme = "Default";
@@ -750,9 +756,21 @@ void ColoursAndFontsManager::LoadJSON(const wxFileName& path)
     JSONItem arr = root.toElement();
     int arrSize = arr.arraySize();
     CL_DEBUG("Loading JSON file: %s (contains %d lexers)", path.GetFullPath(), arrSize);
-    for(int i = 0; i < arrSize; ++i) {
-        JSONItem json = arr.arrayItem(i);
-        DoAddLexer(json);
+
+    // Converting the JSON into lexers is string work only, do it in parallel. The lexers are then added in order on
+    // this thread, since adding a lexer touches the system colours
+    std::vector<JSONItem> items;
+    items.reserve(arrSize);
+    for(JSONItem json = arr.firstChild(); json.isOk(); json = arr.nextChild()) {
+        items.push_back(json);
+    }
+    std::vector<LexerConf::Ptr_t> lexers(items.size());
+    clParallelFor(items.size(), [&](size_t i) {
+        lexers[i].Reset(new LexerConf());
+        lexers[i]->FromJSON(items[i]);
+    });
+    for(LexerConf::Ptr_t lexer : lexers) {
+        DoAddLexer(lexer);
     }
     CL_DEBUG("Loading JSON file...done");
 }
@@ -761,7 +779,11 @@ LexerConf::Ptr_t ColoursAndFontsManager::DoAddLexer(JSONItem json)
 {
     LexerConf::Ptr_t lexer(new LexerConf());
     lexer->FromJSON(json);
+    return DoAddLexer(lexer);
+}
 
+LexerConf::Ptr_t ColoursAndFontsManager::DoAddLexer(LexerConf::Ptr_t lexer)
+{
     wxString lexerName = lexer->GetName().Lower();
     if(lexerName.IsEmpty()) return NULL;
 
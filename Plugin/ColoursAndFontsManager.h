@@ -66,6 +66,7 @@ private:
     void LoadOldXmls(const std::vector<wxXmlDocument*>& xmlFiles, bool userLexers = false);
     LexerConf::Ptr_t DoAddLexer(wxXmlNode* node);
     LexerConf::Ptr_t DoAddLexer(JSONItem json);
+    LexerConf::Ptr_t DoAddLexer(LexerConf::Ptr_t lexer);
     void Clear();
     wxFileName GetConfigFile() const;
     void LoadJSON(const wxFileName& path);
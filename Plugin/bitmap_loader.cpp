@@ -25,6 +25,9 @@
 
 #include "bitmap_loader.h"
 #include "clBitmap.h"
+#include "clFileIdentity.h"
+#include "clParallel.h"
+#include "clStartupProfiler.h"
 #include "clZipReader.h"
 #include "cl_standard_paths.h"
 #include "editor_config.h"
@@ -44,6 +47,7 @@
 
 std::unordered_map<wxString, wxBitmap> BitmapLoader::m_toolbarsBitmaps;
 std::unordered_map<wxString, wxString> BitmapLoader::m_manifest;
+clBitmapAtlas BitmapLoader::m_atlas;
 
 BitmapLoader::~BitmapLoader() {}
 
@@ -64,6 +68,14 @@ const wxBitmap& BitmapLoader::LoadBitmap(const wxString& name, int requestedSize
         const wxBitmap& b = iter->second;
         return b;
     }
+
+    // First time this bitmap is requested
+    wxImage image;
+    double scale = 1.0;
+    if(m_atlas.GetImage(newName, image, scale)) {
+        clBitmap bmp(image, scale);
+        if(bmp.IsOk()) { return m_toolbarsBitmaps.insert({ newName, bmp }).first->second; }
+    }
     return wxNullBitmap;
 }
 
@@ -83,6 +95,7 @@ wxIcon BitmapLoader::GetIcon(const wxBitmap& bmp) const
 
 void BitmapLoader::initialize()
 {
+    clStartupProfiler::Scope profile("Load bitmaps", "Bitmaps");
     wxString zipname;
     wxFileName fn;
 
@@ -124,50 +137,94 @@ void BitmapLoader::initialize()
     }
 #else
     if(fnNewZip.FileExists()) {
-        clZipReader zip(fnNewZip);
-        // Extract all images into this memory
-        std::unordered_map<wxString, clZipReader::Entry> buffers;
-        zip.ExtractAll(buffers);
-
-        std::function<bool(const wxString&, void**, size_t&)> fnGetHiResVersion = [&](const wxString& name,
-                                                                                      void** ppData, size_t& nLen) {
-            wxString key;
-            key << name << ".png";
-            if(buffers.count(key)) {
-                *ppData = buffers[key].buffer;
-                nLen = buffers[key].len;
-                return true;
-            }
-            return false;
-        };
-
-        for(const auto& entry : buffers) {
-            if(!entry.first.EndsWith(".png")) { continue; }
-
-            wxString name = wxFileName(entry.first).GetName();
-            clZipReader::Entry d = entry.second;
-            if(d.len && d.buffer) {
-                wxMemoryInputStream is(d.buffer, d.len);
-                clBitmap bmp;
-                if(bmp.LoadPNGFromMemory(name, is, fnGetHiResVersion)) {
-                    clDEBUG1() << "Adding new image:" << name;
-                    m_toolbarsBitmaps.erase(name);
-                    m_toolbarsBitmaps.insert({ name, bmp });
+        // Decoding the PNGs is done once per zip file: the decoded images are kept in an atlas file under the user
+        // data folder and are mapped into memory on the next startups
+        bool loadHiRes = clBitmap::ShouldLoadHiResImages();
+        wxFileName atlasFile(clStandardPaths::Get().GetUserDataDir(),
+                             fnNewZip.GetName() + (loadHiRes ? "@2x" : "") + ".atlas");
+        atlasFile.AppendDir("cache");
+
+        wxUint64 key = 0;
+        clFileIdentity::HashFile(fnNewZip.GetFullPath(), key);
+        // the bitmaps of the previous set are no longer valid
+        m_toolbarsBitmaps.clear();
+        if(!m_atlas.Open(atlasFile, key)) {
+            clBitmapAtlas::Vec_t images;
+            DecodeImages(fnNewZip, loadHiRes, images);
+            if(clBitmapAtlas::Save(atlasFile, key, images) && m_atlas.Open(atlasFile, key)) {
+                clDEBUG() << "Created bitmap atlas:" << atlasFile.GetFullPath() << clEndl;
+            } else {
+                // no atlas, keep all the bitmaps in memory
+                for(const clBitmapAtlas::Image& img : images) {
+                    if(!img.image.IsOk()) { continue; }
+                    clBitmap bmp(img.image, img.scale);
+                    if(bmp.IsOk()) {
+                        m_toolbarsBitmaps.erase(img.name);
+                        m_toolbarsBitmaps.insert({ img.name, bmp });
+                    }
                 }
             }
         }
-
-        // Free the memory
-        for(const auto& entry : buffers) {
-            if(entry.second.buffer && entry.second.len) { free(entry.second.buffer); }
-        }
-        buffers.clear();
     }
 #endif
     // Create the mime-list
     CreateMimeList();
 }
 
+void BitmapLoader::DecodeImages(const wxFileName& zipfile, bool loadHiRes, clBitmapAtlas::Vec_t& images)
+{
+    clZipReader zip(zipfile);
+    // Extract all images into this memory
+    std::unordered_map<wxString, clZipReader::Entry> buffers;
+    zip.ExtractAll(buffers);
+
+    // Decoding the PNGs is the expensive part: decode them in parallel into wxImages
+    struct PendingImage {
+        clZipReader::Entry data;
+        clZipReader::Entry hiResData;
+    };
+
+    std::vector<PendingImage> pending;
+    pending.reserve(buffers.size());
+    images.reserve(buffers.size());
+    for(const auto& entry : buffers) {
+        if(!entry.first.EndsWith(".png")) { continue; }
+
+        // the @2x images are loaded with their normal resolution version
+        wxString name = wxFileName(entry.first).GetName();
+        if(name.Contains("@2x")) { continue; }
+        if(!entry.second.len || !entry.second.buffer) { continue; }
+
+        PendingImage img;
+        img.data = entry.second;
+        if(loadHiRes) {
+            auto iter = buffers.find(name + "@2x.png");
+            if(iter != buffers.end()) { img.hiResData = iter->second; }
+        }
+        pending.push_back(img);
+        images.push_back(clBitmapAtlas::Image());
+        images.back().name = name;
+    }
+
+    clParallelFor(images.size(), [&](size_t i) {
+        const PendingImage& img = pending[i];
+        if(img.hiResData.len && img.hiResData.buffer) {
+            wxMemoryInputStream is(img.hiResData.buffer, img.hiResData.len);
+            if(images[i].image.LoadFile(is, wxBITMAP_TYPE_PNG)) {
+                images[i].scale = 2.0;
+                return;
+            }
+        }
+        wxMemoryInputStream is(img.data.buffer, img.data.len);
+        images[i].image.LoadFile(is, wxBITMAP_TYPE_PNG);
+    });
+
+    // Free the memory
+    for(const auto& entry : buffers) {
+        if(entry.second.buffer && entry.second.len) { free(entry.second.buffer); }
+    }
+}
+
 void BitmapLoader::CreateMimeList()
 {
     const int bitmap_size = 16;
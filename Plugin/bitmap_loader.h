@@ -26,6 +26,7 @@
 #ifndef BITMAP_LOADER_H
 #define BITMAP_LOADER_H
 
+#include "clBitmapAtlas.h"
 #include "codelite_exports.h"
 #include "fileextmanager.h"
 #include "wxStringHash.h"
@@ -107,6 +108,8 @@ protected:
     wxFileName m_zipPath;
     static std::unordered_map<wxString, wxBitmap> m_toolbarsBitmaps;
     static std::unordered_map<wxString, wxString> m_manifest;
+    // the decoded images of the zip. Bitmaps are created from it on demand and kept in m_toolbarsBitmaps
+    static clBitmapAtlas m_atlas;
     std::unordered_map<FileExtManager::FileType, int> m_fileIndexMap;
     bool m_bMapPopulated;
     size_t m_toolbarIconSize;
@@ -155,6 +158,10 @@ public:
 
 protected:
     void CreateMimeList();
+    /**
+     * @brief decode all the PNG images of the zip file
+     */
+    void DecodeImages(const wxFileName& zipfile, bool loadHiRes, clBitmapAtlas::Vec_t& images);
 
 private:
     void initialize();
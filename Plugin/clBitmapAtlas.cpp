@@ -0,0 +1,186 @@
+#include "clBitmapAtlas.h"
+#include "file_logger.h"
+#include <string.h>
+#include <wx/ffile.h>
+
+namespace
+{
+const char ATLAS_MAGIC[8] = { 'C', 'L', 'A', 'T', 'L', 'A', 'S', '\0' };
+// bump this whenever the layout changes
+const wxUint32 ATLAS_VERSION = 1;
+
+// File layout: AtlasHeader, AtlasEntry[count], the names (UTF-8) and then the pixels of each image, 8 bytes aligned.
+// The file is only read on the machine that wrote it, so the native byte order is used
+struct AtlasHeader {
+    char magic[8];
+    wxUint32 version;
+    wxUint32 count;
+    wxUint64 key;
+};
+
+struct AtlasEntry {
+    wxUint64 pixelsOffset;
+    wxUint32 nameOffset;
+    wxUint32 nameLen;
+    wxUint32 width;
+    wxUint32 height;
+    wxUint32 scale; // the image scale * 100
+    wxUint32 hasAlpha;
+};
+
+size_t Align(size_t offset) { return (offset + 7) & ~(size_t)7; }
+size_t PixelsSize(const AtlasEntry& entry)
+{
+    size_t pixels = (size_t)entry.width * (size_t)entry.height;
+    return pixels * 3 + (entry.hasAlpha ? pixels : 0);
+}
+} // namespace
+
+bool clBitmapAtlas::Open(const wxFileName& path, wxUint64 key)
+{
+    Close();
+    if(!path.FileExists() || !m_file.Open(path.GetFullPath())) { return false; }
+
+    const char* data = m_file.GetData();
+    size_t size = m_file.GetSize();
+    if(size < sizeof(AtlasHeader)) {
+        Close();
+        return false;
+    }
+
+    const AtlasHeader* header = (const AtlasHeader*)data;
+    if(memcmp(header->magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0 || header->version != ATLAS_VERSION ||
+       header->key != key || ((size - sizeof(AtlasHeader)) / sizeof(AtlasEntry)) < header->count) {
+        clDEBUG() << "Bitmap atlas" << path.GetFullPath() << "is out of date" << clEndl;
+        Close();
+        return false;
+    }
+
+    // Validate the entries once, so GetImage() can trust them
+    const AtlasEntry* entries = (const AtlasEntry*)(data + sizeof(AtlasHeader));
+    m_index.reserve(header->count);
+    for(size_t i = 0; i < header->count; ++i) {
+        const AtlasEntry& entry = entries[i];
+        if(((size_t)entry.nameOffset + entry.nameLen) > size || entry.pixelsOffset > size ||
+           PixelsSize(entry) > (size - entry.pixelsOffset) || entry.width == 0 || entry.height == 0) {
+            clWARNING() << "Bitmap atlas" << path.GetFullPath() << "is corrupted" << clEndl;
+            Close();
+            return false;
+        }
+        wxString name = wxString::FromUTF8(data + entry.nameOffset, entry.nameLen);
+        m_index.insert({ name, i });
+    }
+    return true;
+}
+
+void clBitmapAtlas::Close()
+{
+    m_index.clear();
+    m_file.Close();
+}
+
+bool clBitmapAtlas::GetImage(const wxString& name, wxImage& image, double& scale) const
+{
+    std::unordered_map<wxString, size_t>::const_iterator iter = m_index.find(name);
+    if(iter == m_index.end()) { return false; }
+
+    const AtlasEntry& entry = ((const AtlasEntry*)(m_file.GetData() + sizeof(AtlasHeader)))[iter->second];
+    const unsigned char* pixels = (const unsigned char*)(m_file.GetData() + entry.pixelsOffset);
+    size_t count = (size_t)entry.width * (size_t)entry.height;
+
+    // wxImage takes ownership of malloc()ed buffers
+    unsigned char* rgb = (unsigned char*)malloc(count * 3);
+    memcpy(rgb, pixels, count * 3);
+    image.Create(entry.width, entry.height, rgb);
+    if(entry.hasAlpha) {
+        unsigned char* alpha = (unsigned char*)malloc(count);
+        memcpy(alpha, pixels + count * 3, count);
+        image.SetAlpha(alpha);
+    }
+    scale = entry.scale / 100.0;
+    return image.IsOk();
+}
+
+bool clBitmapAtlas::Save(const wxFileName& path, wxUint64 key, const clBitmapAtlas::Vec_t& images)
+{
+    AtlasHeader header;
+    memcpy(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+    header.version = ATLAS_VERSION;
+    header.count = 0;
+    header.key = key;
+
+    // Layout the file
+    std::vector<AtlasEntry> entries;
+    std::vector<wxCharBuffer> names;
+    entries.reserve(images.size());
+    names.reserve(images.size());
+    for(const Image& img : images) {
+        if(!img.image.IsOk()) { continue; }
+        AtlasEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.width = img.image.GetWidth();
+        entry.height = img.image.GetHeight();
+        entry.scale = (wxUint32)(img.scale * 100.0 + 0.5);
+        entry.hasAlpha = img.image.HasAlpha() ? 1 : 0;
+        entries.push_back(entry);
+        names.push_back(img.name.mb_str(wxConvUTF8));
+    }
+    header.count = entries.size();
+
+    size_t offset = sizeof(AtlasHeader) + entries.size() * sizeof(AtlasEntry);
+    for(size_t i = 0; i < entries.size(); ++i) {
+        entries[i].nameOffset = offset;
+        entries[i].nameLen = names[i].length();
+        offset += names[i].length();
+    }
+    for(size_t i = 0; i < entries.size(); ++i) {
+        offset = Align(offset);
+        entries[i].pixelsOffset = offset;
+        offset += PixelsSize(entries[i]);
+    }
+
+    wxFileName::Mkdir(path.GetPath(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+    wxString tmpfile = path.GetFullPath() + ".tmp";
+    {
+        wxFFile fp(tmpfile, "wb");
+        if(!fp.IsOpened()) { return false; }
+
+        bool ok = fp.Write(&header, sizeof(header)) == sizeof(header);
+        if(!entries.empty()) {
+            ok = ok && fp.Write(entries.data(), entries.size() * sizeof(AtlasEntry)) ==
+                           (entries.size() * sizeof(AtlasEntry));
+        }
+        for(const wxCharBuffer& name : names) {
+            ok = ok && fp.Write(name.data(), name.length()) == name.length();
+        }
+
+        const char padding[8] = { 0 };
+        size_t current = sizeof(AtlasHeader) + entries.size() * sizeof(AtlasEntry);
+        for(const wxCharBuffer& name : names) {
+            current += name.length();
+        }
+        size_t e = 0;
+        for(const Image& img : images) {
+            if(!ok) { break; }
+            if(!img.image.IsOk()) { continue; }
+            const AtlasEntry& entry = entries[e++];
+            ok = fp.Write(padding, entry.pixelsOffset - current) == (entry.pixelsOffset - current);
+            size_t count = (size_t)entry.width * (size_t)entry.height;
+            ok = ok && fp.Write(img.image.GetData(), count * 3) == (count * 3);
+            if(entry.hasAlpha) { ok = ok && fp.Write(img.image.GetAlpha(), count) == count; }
+            current = entry.pixelsOffset + PixelsSize(entry);
+        }
+        ok = ok && fp.Close();
+        if(!ok) {
+            clWARNING() << "Failed to write bitmap atlas" << tmpfile << clEndl;
+            wxRemoveFile(tmpfile);
+            return false;
+        }
+    }
+
+    if(!wxRenameFile(tmpfile, path.GetFullPath(), true)) {
+        wxRemoveFile(tmpfile);
+        return false;
+    }
+    return true;
+}
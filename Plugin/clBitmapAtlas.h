@@ -0,0 +1,59 @@
+#ifndef CLBITMAPATLAS_H
+#define CLBITMAPATLAS_H
+
+#include "clMemoryMappedFile.h"
+#include "codelite_exports.h"
+#include "wxStringHash.h"
+#include <unordered_map>
+#include <vector>
+#include <wx/filename.h>
+#include <wx/image.h>
+
+/**
+ * @class clBitmapAtlas
+ * @brief an on-disk cache of decoded images. The pixels are stored the way wxImage keeps them (RGB followed by the
+ * alpha channel) so an image is created from the mapped file with a plain copy, without decoding any PNG. The file
+ * is memory mapped: only the pages of the images that are actually used are read from the disk
+ */
+class WXDLLIMPEXP_SDK clBitmapAtlas
+{
+public:
+    struct Image {
+        wxString name;
+        wxImage image;
+        double scale = 1.0;
+    };
+    typedef std::vector<Image> Vec_t;
+
+protected:
+    clMemoryMappedFile m_file;
+    // image name : entry index
+    std::unordered_map<wxString, size_t> m_index;
+
+public:
+    clBitmapAtlas() {}
+    ~clBitmapAtlas() {}
+
+    /**
+     * @brief map an atlas file
+     * @param key identifies the content the atlas was built from (e.g. the hash of the images zip). An atlas built
+     * with a different key is not opened
+     */
+    bool Open(const wxFileName& path, wxUint64 key);
+    void Close();
+    bool IsOpened() const { return m_file.IsOpened(); }
+    size_t GetCount() const { return m_index.size(); }
+
+    /**
+     * @brief create the image 'name' from the mapped pixels
+     */
+    bool GetImage(const wxString& name, wxImage& image, double& scale) const;
+
+    /**
+     * @brief write 'images' into a new atlas file. The file is written under a temporary name and then renamed, so
+     * a reader never sees a partially written atlas
+     */
+    static bool Save(const wxFileName& path, wxUint64 key, const clBitmapAtlas::Vec_t& images);
+};
+
+#endif // CLBITMAPATLAS_H
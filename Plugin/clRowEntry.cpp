@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <drawingutils.h>
 #include <functional>
+#include <iterator>
 #include <wx/dataview.h>
 #include <wx/dc.h>
 #include <wx/renderer.h>
@@ -185,10 +186,69 @@ void clRowEntry::InsertChild(clRowEntry* child, clRowEntry* prev)
         nodeBefore = prevSibling;
     }
     child->ConnectNodes(nodeBefore, nodeBefore->m_next);
+
+    m_offsetsDirty = true;
+    if(IsExpanded()) {
+        PropagateRowsDelta(child->m_rowsCount);
+    }
 }
 
 void clRowEntry::AddChild(clRowEntry* child) { InsertChild(child, m_children.empty() ? nullptr : m_children.back()); }
 
+void clRowEntry::AddChildren(const clRowEntry::Vec_t& children,
+                             const std::function<bool(clRowEntry*, clRowEntry*)>& sortFunc)
+{
+    if(children.empty()) {
+        return;
+    }
+
+    // The node that follows this subtree in the linked list
+    clRowEntry* last = this;
+    while(last->HasChildren()) {
+        last = last->GetLastChild();
+    }
+    clRowEntry* after = last->m_next;
+
+    clRowEntry::Vec_t newChildren = children;
+    if(sortFunc) {
+        // Place each new item after the current children that are not greater than it, like InsertChild() does
+        std::stable_sort(newChildren.begin(), newChildren.end(), sortFunc);
+        clRowEntry::Vec_t merged;
+        merged.reserve(m_children.size() + newChildren.size());
+        std::merge(m_children.begin(), m_children.end(), newChildren.begin(), newChildren.end(),
+                   std::back_inserter(merged), sortFunc);
+        m_children.swap(merged);
+    } else {
+        m_children.insert(m_children.end(), newChildren.begin(), newChildren.end());
+    }
+
+    int rows = 0;
+    for(clRowEntry* child : newChildren) {
+        child->m_parent = this;
+        child->SetIndentsCount(GetIndentsCount() + 1);
+        rows += child->m_rowsCount;
+    }
+    m_offsetsDirty = true;
+    if(IsExpanded()) {
+        PropagateRowsDelta(rows);
+    }
+
+    // Re-connect the linked list: the subtrees of the existing children are kept as they are
+    clRowEntry* prev = this;
+    for(clRowEntry* child : m_children) {
+        prev->m_next = child;
+        child->m_prev = prev;
+        prev = child;
+        while(prev->HasChildren()) {
+            prev = prev->GetLastChild();
+        }
+    }
+    prev->m_next = after;
+    if(after) {
+        after->m_prev = prev;
+    }
+}
+
 void clRowEntry::SetParent(clRowEntry* parent)
 {
     if(m_parent == parent) {
@@ -223,10 +283,142 @@ void clRowEntry::DeleteChild(clRowEntry* child)
         std::find_if(m_children.begin(), m_children.end(), [&](clRowEntry* c) { return c == child; });
     if(iter != m_children.end()) {
         m_children.erase(iter);
+        m_offsetsDirty = true;
+        if(IsExpanded()) {
+            PropagateRowsDelta(-child->m_rowsCount);
+        }
     }
     wxDELETE(child);
 }
 
+void clRowEntry::PropagateRowsDelta(int delta)
+{
+    if(delta == 0) {
+        return;
+    }
+    clRowEntry* node = this;
+    while(node) {
+        node->m_rowsCount += delta;
+        clRowEntry* parent = node->m_parent;
+        if(!parent) {
+            break;
+        }
+        parent->m_offsetsDirty = true;
+        if(!parent->IsExpanded()) {
+            // the rows of a collapsed item do not include its children
+            break;
+        }
+        node = parent;
+    }
+}
+
+void clRowEntry::UpdateRowsCount()
+{
+    int rows = IsHidden() ? 0 : 1;
+    if(IsExpanded()) {
+        for(clRowEntry* child : m_children) {
+            rows += child->m_rowsCount;
+        }
+    }
+    PropagateRowsDelta(rows - m_rowsCount);
+}
+
+void clRowEntry::UpdateChildrenOffsets() const
+{
+    if(!m_offsetsDirty) {
+        return;
+    }
+    m_childrenOffsets.resize(m_children.size() + 1);
+    m_childrenOffsets[0] = 0;
+    for(size_t i = 0; i < m_children.size(); ++i) {
+        m_children[i]->m_indexInParent = i;
+        m_childrenOffsets[i + 1] = m_childrenOffsets[i] + m_children[i]->m_rowsCount;
+    }
+    m_offsetsDirty = false;
+}
+
+int clRowEntry::GetRowIndex() const
+{
+    int index = 0;
+    const clRowEntry* child = this;
+    for(const clRowEntry* parent = m_parent; parent; parent = parent->m_parent) {
+        parent->UpdateChildrenOffsets();
+        index += (parent->IsHidden() ? 0 : 1) + parent->m_childrenOffsets[child->m_indexInParent];
+        child = parent;
+    }
+    return index;
+}
+
+clRowEntry* clRowEntry::GetRowAt(int index)
+{
+    clRowEntry* node = this;
+    while(index >= 0 && index < node->m_rowsCount) {
+        if(!node->IsHidden()) {
+            if(index == 0) {
+                return node;
+            }
+            --index;
+        }
+        // find the child that contains the row
+        node->UpdateChildrenOffsets();
+        const std::vector<int>& offsets = node->m_childrenOffsets;
+        size_t where = std::upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin() - 1;
+        if(where >= node->m_children.size()) {
+            return nullptr;
+        }
+        index -= offsets[where];
+        node = node->m_children[where];
+    }
+    return nullptr;
+}
+
+clRowEntry* clRowEntry::GetNextVisible() const
+{
+    if(!IsHidden() && !IsVisible()) {
+        // this item is inside a collapsed subtree
+        clRowEntry* next = m_next;
+        while(next && !next->IsVisible()) {
+            next = next->m_next;
+        }
+        return next;
+    }
+
+    // the items of a collapsed subtree are placed right after it, skip them
+    const clRowEntry* last = this;
+    if(!IsExpanded()) {
+        while(last->HasChildren()) {
+            last = last->GetLastChild();
+        }
+    }
+    return last->m_next;
+}
+
+clRowEntry* clRowEntry::GetPrevVisible() const
+{
+    if(!IsHidden() && !IsVisible()) {
+        clRowEntry* prev = m_prev;
+        while(prev && !prev->IsVisible()) {
+            prev = prev->m_prev;
+        }
+        return prev;
+    }
+
+    clRowEntry* prev = m_prev;
+    if(!prev || prev == m_parent) {
+        return (prev && !prev->IsHidden()) ? prev : nullptr;
+    }
+
+    // 'prev' is the last item in the subtree of our previous sibling. The visible row is its top most collapsed
+    // ancestor (below our parent), or 'prev' itself when all of them are expanded
+    clRowEntry* candidate = prev;
+    for(clRowEntry* node = prev->m_parent; node && node != m_parent; node = node->m_parent) {
+        if(!node->IsExpanded()) {
+            candidate = node;
+        }
+    }
+    return candidate;
+}
+
 int clRowEntry::GetExpandedLines() const
 {
     clRowEntry* node = const_cast<clRowEntry*>(this);
@@ -249,15 +441,10 @@ void clRowEntry::GetNextItems(int count, clRowEntry::Vec_t& items, bool selfIncl
     if(!this->IsHidden() && selfIncluded) {
         items.push_back(this);
     }
-    clRowEntry* next = GetNext();
-    while(next) {
-        if(next->IsVisible() && !next->IsHidden()) {
-            items.push_back(next);
-        }
-        if((int)items.size() == count) {
-            return;
-        }
-        next = next->GetNext();
+    clRowEntry* next = GetNextVisible();
+    while(next && ((int)items.size() < count)) {
+        items.push_back(next);
+        next = next->GetNextVisible();
     }
 }
 
@@ -270,15 +457,10 @@ void clRowEntry::GetPrevItems(int count, clRowEntry::Vec_t& items, bool selfIncl
     if(!this->IsHidden() && selfIncluded) {
         items.insert(items.begin(), this);
     }
-    clRowEntry* prev = GetPrev();
-    while(prev) {
-        if(prev->IsVisible() && !prev->IsHidden()) {
-            items.insert(items.begin(), prev);
-        }
-        if((int)items.size() == count) {
-            return;
-        }
-        prev = prev->GetPrev();
+    clRowEntry* prev = GetPrevVisible();
+    while(prev && ((int)items.size() < count)) {
+        items.insert(items.begin(), prev);
+        prev = prev->GetPrevVisible();
     }
 }
 
@@ -331,6 +513,7 @@ bool clRowEntry::SetExpanded(bool b)
     }
 
     SetFlag(kNF_Expanded, b);
+    UpdateRowsCount();
     m_model->NodeExpanded(this, b);
     return true;
 }
@@ -670,6 +853,7 @@ void clRowEntry::SetHidden(bool b)
         return;
     }
     SetFlag(kNF_Hidden, b);
+    UpdateRowsCount();
     if(b) {
         m_indentsCount = -1;
     } else {
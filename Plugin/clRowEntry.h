@@ -5,6 +5,7 @@
 #include "clColours.h"
 #include "codelite_exports.h"
 #include <array>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 #include <wx/colour.h>
@@ -66,6 +67,13 @@ protected:
     clRowEntry* m_next = nullptr;
     clRowEntry* m_prev = nullptr;
     int m_indentsCount = 0;
+    // the number of visible rows in this subtree (this item + the rows of its children if it is expanded)
+    int m_rowsCount = 1;
+    // this item's position in its parent's children list. Valid while the parent's offsets are up to date
+    size_t m_indexInParent = 0;
+    // m_childrenOffsets[i]: the number of visible rows in the subtrees of the first 'i' children
+    mutable std::vector<int> m_childrenOffsets;
+    mutable bool m_offsetsDirty = true;
     wxRect m_rowRect;
     wxRect m_buttonRect;
     clMatchResult m_higlightInfo;
@@ -82,6 +90,20 @@ protected:
 
     bool HasFlag(clTreeCtrlNodeFlags flag) const { return m_flags & flag; }
 
+    /**
+     * @brief add 'delta' to the rows count of this item and of its ancestors, as long as the rows are visible
+     * in the parent (i.e. the parent is expanded)
+     */
+    void PropagateRowsDelta(int delta);
+    /**
+     * @brief re-calculate the rows count after this item's expanded/hidden state was changed
+     */
+    void UpdateRowsCount();
+    /**
+     * @brief rebuild the children offsets (prefix sum of the children rows count) if needed
+     */
+    void UpdateChildrenOffsets() const;
+
     /**
      * @brief return the nth visible item
      */
@@ -161,6 +183,14 @@ public:
 
     void AddChild(clRowEntry* child);
 
+    /**
+     * @brief add a batch of new items as children of this node. When 'sortFunc' is set, the items are sorted once and
+     * merged with the current children (which are expected to be sorted already), otherwise they are appended in
+     * their order. O(N log N) for the batch, instead of O(N) per item with InsertChild()
+     */
+    void AddChildren(const clRowEntry::Vec_t& children,
+                     const std::function<bool(clRowEntry*, clRowEntry*)>& sortFunc = nullptr);
+
     /**
      * @brief insert item at 'where'. The new item is placed after 'prev'
      */
@@ -200,7 +230,12 @@ public:
     const wxString& GetLabel(size_t col = 0) const;
 
     const std::vector<clRowEntry*>& GetChildren() const { return m_children; }
-    std::vector<clRowEntry*>& GetChildren() { return m_children; }
+    std::vector<clRowEntry*>& GetChildren()
+    {
+        // the caller might re-order the children
+        m_offsetsDirty = true;
+        return m_children;
+    }
     wxTreeItemData* GetClientObject() const { return m_clientObject; }
     void SetParent(clRowEntry* parent);
     clRowEntry* GetParent() const { return m_parent; }
@@ -212,6 +247,25 @@ public:
     }
     size_t GetChildrenCount(bool recurse) const;
     int GetExpandedLines() const;
+    /**
+     * @brief return the number of visible rows in this subtree, including this item (unless it is hidden)
+     */
+    int GetRowsCount() const { return m_rowsCount; }
+    /**
+     * @brief return the number of visible rows before this item. O(depth), this item must be visible
+     */
+    int GetRowIndex() const;
+    /**
+     * @brief return the visible row at 'index' of this subtree (0 is this item, unless it is hidden) or nullptr.
+     * O(depth * log(children))
+     */
+    clRowEntry* GetRowAt(int index);
+    /**
+     * @brief return the next / previous visible row. The items of collapsed subtrees are skipped without visiting
+     * them
+     */
+    clRowEntry* GetNextVisible() const;
+    clRowEntry* GetPrevVisible() const;
     void GetNextItems(int count, clRowEntry::Vec_t& items, bool selfIncluded = true);
     void GetPrevItems(int count, clRowEntry::Vec_t& items, bool selfIncluded = true);
     void SetIndentsCount(int count) { this->m_indentsCount = count; }
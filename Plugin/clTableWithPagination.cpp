@@ -3,6 +3,8 @@
 #include "clThemedListCtrl.h"
 #include "globals.h"
 #include "macros.h"
+#include <algorithm>
+#include <stdlib.h>
 #include <wx/dataview.h>
 #include <wx/sizer.h>
 
@@ -63,47 +65,169 @@ void clTableWithPagination::SetColumns(const wxArrayString& columns)
 
 void clTableWithPagination::SetData(std::vector<wxArrayString>& data)
 {
+    m_pageSource = nullptr;
+    ClearPages();
     m_data.clear();
     m_data.swap(data);
     ShowPage(0);
 }
 
+void clTableWithPagination::SetPageSource(clTablePageSource* source, size_t maxCachedPages)
+{
+    m_data.clear();
+    ClearPages();
+    m_ctrl->DeleteAllItems();
+    m_currentPage = 0;
+    m_pageSource = source;
+    // we need room for at least the current page and the next one
+    m_maxCachedPages = std::max<size_t>(maxCachedPages, 2);
+    if(m_pageSource) { ShowPage(0); }
+}
+
+void clTableWithPagination::SetPage(int nPage, std::vector<wxArrayString>& rows, bool lastPage)
+{
+    m_requestedPages.erase(nPage);
+    // a page that we already have is never replaced: the list control items point to its rows
+    if(!m_pageSource || m_pages.count(nPage)) { return; }
+
+    m_pages[nPage].swap(rows);
+    if(lastPage) { m_lastPage = nPage; }
+    DoEvictPages();
+
+    if(nPage == m_currentPage) {
+        ShowPage(nPage);
+    } else {
+        // the page count might be known now
+        DoUpdatePageLabel();
+    }
+}
+
 void clTableWithPagination::ClearAll()
 {
     m_data.clear();
+    ClearPages();
+    m_currentPage = 0;
     m_ctrl->DeleteAllItems();
     m_ctrl->ClearColumns();
 }
 
+void clTableWithPagination::ClearPages()
+{
+    m_pages.clear();
+    m_requestedPages.clear();
+    m_lastPage = wxNOT_FOUND;
+}
+
 void clTableWithPagination::ShowPage(int nPage)
 {
     m_ctrl->DeleteAllItems();
+    if(m_pageSource) {
+        m_currentPage = nPage;
+        std::map<int, std::vector<wxArrayString> >::const_iterator iter = m_pages.find(nPage);
+        if(iter == m_pages.end()) {
+            m_staticText->SetLabel(_("Loading..."));
+            DoRequestPage(nPage);
+            return;
+        }
+
+        const std::vector<wxArrayString>& rows = iter->second;
+        if(!rows.empty()) { DoShowRows(rows, 0, rows.size() - 1); }
+        DoUpdatePageLabel();
+
+        // fetch the next page while the user is looking at this one
+        if(m_lastPage == wxNOT_FOUND || nPage < m_lastPage) { DoRequestPage(nPage + 1); }
+        return;
+    }
+
     if(m_data.empty()) return;
     int startIndex = (nPage * m_linesPerPage);
     int lastIndex = startIndex + m_linesPerPage - 1; // last index, including
     if(lastIndex >= (int)m_data.size()) { lastIndex = (m_data.size() - 1); }
     m_currentPage = nPage;
+    DoShowRows(m_data, startIndex, lastIndex);
+
+    m_staticText->SetLabel(wxString() << _("Showing entries from: ") << startIndex << _(":") << lastIndex
+                                      << " Total of: " << m_data.size() << _(" entries"));
+}
+
+void clTableWithPagination::DoShowRows(const std::vector<wxArrayString>& rows, int startIndex, int lastIndex)
+{
     for(int i = startIndex; i <= lastIndex; ++i) {
         wxVector<wxVariant> cols;
-        const wxArrayString& items = m_data[i];
+        const wxArrayString& items = rows[i];
         for(size_t j = 0; j < items.size(); ++j) {
             const wxString& cellContent = items.Item(j);
             cols.push_back(wxVariant(MakeDisplayString(cellContent)));
         }
         m_ctrl->AppendItem(cols, (wxUIntPtr)&items);
     }
+}
 
-    m_staticText->SetLabel(wxString() << _("Showing entries from: ") << startIndex << _(":") << lastIndex
-                                      << " Total of: " << m_data.size() << _(" entries"));
+void clTableWithPagination::DoUpdatePageLabel()
+{
+    std::map<int, std::vector<wxArrayString> >::const_iterator iter = m_pages.find(m_currentPage);
+    if(iter == m_pages.end()) { return; }
+
+    int startIndex = (m_currentPage * m_linesPerPage);
+    int lastIndex = startIndex + (int)iter->second.size() - 1;
+    wxString label;
+    if(iter->second.empty()) {
+        label << _("No entries");
+    } else {
+        label << _("Showing entries from: ") << startIndex << _(":") << lastIndex;
+    }
+
+    if(m_lastPage == wxNOT_FOUND) {
+        label << _(" (more entries available)");
+    } else if(m_pages.count(m_lastPage)) {
+        label << " Total of: " << (m_lastPage * m_linesPerPage + m_pages.find(m_lastPage)->second.size())
+              << _(" entries");
+    }
+    m_staticText->SetLabel(label);
+}
+
+void clTableWithPagination::DoRequestPage(int nPage)
+{
+    if(!m_pageSource || m_pages.count(nPage) || m_requestedPages.count(nPage)) { return; }
+    m_requestedPages.insert(nPage);
+    m_pageSource->RequestPage(nPage);
+}
+
+void clTableWithPagination::DoEvictPages()
+{
+    // drop the pages that are the farthest from the one being viewed
+    while(m_pages.size() > m_maxCachedPages) {
+        std::map<int, std::vector<wxArrayString> >::iterator farthest = m_pages.end();
+        for(std::map<int, std::vector<wxArrayString> >::iterator iter = m_pages.begin(); iter != m_pages.end();
+            ++iter) {
+            if(iter->first == m_currentPage) { continue; }
+            if(farthest == m_pages.end() ||
+               std::abs(iter->first - m_currentPage) > std::abs(farthest->first - m_currentPage)) {
+                farthest = iter;
+            }
+        }
+        if(farthest == m_pages.end()) { break; }
+        m_pages.erase(farthest);
+    }
 }
 
 bool clTableWithPagination::CanNext() const
 {
+    if(m_pageSource) {
+        if(!m_pages.count(m_currentPage)) { return false; }
+        if(m_lastPage != wxNOT_FOUND && m_currentPage >= m_lastPage) { return false; }
+        std::map<int, std::vector<wxArrayString> >::const_iterator iter = m_pages.find(m_currentPage + 1);
+        return (iter == m_pages.end()) || !iter->second.empty();
+    }
     int startIndex = ((m_currentPage + 1) * m_linesPerPage);
     return startIndex < (int)m_data.size();
 }
 
-bool clTableWithPagination::CanPrev() const { return (((m_currentPage - 1) >= 0) && !m_data.empty()); }
+bool clTableWithPagination::CanPrev() const
+{
+    if(m_pageSource) { return m_currentPage > 0; }
+    return (((m_currentPage - 1) >= 0) && !m_data.empty());
+}
 
 void clTableWithPagination::ClearAllItems()
 {
@@ -2,6 +2,8 @@
 #define CLTABLEWITHPAGINATION_H
 
 #include "codelite_exports.h"
+#include <map>
+#include <set>
 #include <vector>
 #include <wx/arrstr.h>
 #include <wx/button.h>
@@ -10,11 +12,34 @@
 #include <wx/stattext.h>
 
 class clThemedListCtrl;
+
+/**
+ * @class clTablePageSource
+ * @brief provides the rows of a clTableWithPagination one page at a time. The source replies (possibly
+ * asynchronously) by calling clTableWithPagination::SetPage()
+ */
+class WXDLLIMPEXP_SDK clTablePageSource
+{
+public:
+    clTablePageSource() {}
+    virtual ~clTablePageSource() {}
+
+    /**
+     * @brief the table needs page 'nPage'
+     */
+    virtual void RequestPage(int nPage) = 0;
+};
+
 class WXDLLIMPEXP_SDK clTableWithPagination : public wxPanel
 {
     int m_linesPerPage;
     int m_currentPage;
     std::vector<wxArrayString> m_data;
+    clTablePageSource* m_pageSource = nullptr;
+    std::map<int, std::vector<wxArrayString> > m_pages; // the pages cache, used with a page source
+    std::set<int> m_requestedPages;
+    int m_lastPage = wxNOT_FOUND;
+    size_t m_maxCachedPages = 10;
     wxArrayString m_columns;
     clThemedListCtrl* m_ctrl = nullptr;
     wxButton* m_btnNextPage = nullptr;
@@ -26,6 +51,11 @@ protected:
     bool CanPrev() const;
 
     void ClearAllItems();
+    void ClearPages();
+    void DoShowRows(const std::vector<wxArrayString>& rows, int startIndex, int lastIndex);
+    void DoRequestPage(int nPage);
+    void DoEvictPages();
+    void DoUpdatePageLabel();
     wxString MakeDisplayString(const wxString& str) const;
     void OnLineActivated(wxDataViewEvent& event);
 
@@ -36,6 +66,7 @@ public:
     virtual ~clTableWithPagination();
 
     void SetLinesPerPage(int numLines);
+    int GetLinesPerPage() const { return m_linesPerPage; }
 
     /**
      * @brief define the columns for this table
@@ -49,6 +80,23 @@ public:
      */
     void SetData(std::vector<wxArrayString>& data);
 
+    /**
+     * @brief fetch the rows from 'source' page by page instead of keeping all of them in memory. Only the last
+     * 'maxCachedPages' pages are kept. Pass nullptr to stop using the source
+     */
+    void SetPageSource(clTablePageSource* source, size_t maxCachedPages = 10);
+
+    /**
+     * @brief a reply from the page source. 'lastPage' should be set once the source has no more rows
+     */
+    void SetPage(int nPage, std::vector<wxArrayString>& rows, bool lastPage);
+
+    /**
+     * @brief forget the pages that were requested but were not delivered (e.g. the page source cancelled its work).
+     * They will be requested again when needed
+     */
+    void ResetPendingPages() { m_requestedPages.clear(); }
+
     /**
      * @brief clear all data and columns from the table
      */
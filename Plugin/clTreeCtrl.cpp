@@ -257,6 +257,19 @@ wxTreeItemId clTreeCtrl::AppendItem(const wxTreeItemId& parent, const wxString&
     return item;
 }
 
+std::vector<wxTreeItemId> clTreeCtrl::AppendItems(const wxTreeItemId& parent, const clTreeCtrlItem::Vec_t& items)
+{
+    std::vector<wxTreeItemId> ids;
+    m_model.AppendItems(parent, items, ids);
+    for(const wxTreeItemId& item : ids) {
+        DoUpdateHeader(item);
+    }
+    if(!ids.empty() && IsExpanded(parent)) {
+        UpdateScrollBar();
+    }
+    return ids;
+}
+
 wxTreeItemId clTreeCtrl::AddRoot(const wxString& text, int image, int selImage, wxTreeItemData* data)
 {
     wxTreeItemId root = m_model.AddRoot(text, image, selImage, data);
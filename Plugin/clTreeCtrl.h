@@ -174,6 +174,11 @@ public:
      */
     wxTreeItemId AppendItem(const wxTreeItemId& parent, const wxString& text, int image = -1, int selImage = -1,
                             wxTreeItemData* data = NULL);
+    /**
+     * @brief append a batch of items to 'parent'. Prefer this over calling AppendItem() in a loop: the items are
+     * sorted once and the view is updated once for the whole batch. Return the new items, in the order of 'items'
+     */
+    std::vector<wxTreeItemId> AppendItems(const wxTreeItemId& parent, const clTreeCtrlItem::Vec_t& items);
     /**
      * @brief Adds the root node to the tree, returning the new item.
      */
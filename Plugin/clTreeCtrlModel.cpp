@@ -167,6 +167,32 @@ wxTreeItemId clTreeCtrlModel::AppendItem(const wxTreeItemId& parent, const wxStr
     return wxTreeItemId(child);
 }
 
+void clTreeCtrlModel::AppendItems(const wxTreeItemId& parent, const clTreeCtrlItem::Vec_t& items,
+                                  std::vector<wxTreeItemId>& ids)
+{
+    ids.clear();
+    if(!parent.IsOk()) { return; }
+    clRowEntry* parentNode = ToPtr(parent);
+
+    clRowEntry::Vec_t children;
+    children.reserve(items.size());
+    ids.reserve(items.size());
+    for(const clTreeCtrlItem& item : items) {
+        clRowEntry* child = new clRowEntry(m_tree, item.text, item.image, item.selImage);
+        child->SetClientData(item.data);
+        children.push_back(child);
+        ids.push_back(wxTreeItemId(child));
+    }
+
+    // Same placement rules as AppendItem()
+    bool sortTopLevelOnly = !parentNode->IsRoot() && (m_tree->GetTreeStyle() & wxTR_SORT_TOP_LEVEL);
+    if(!sortTopLevelOnly && m_shouldInsertBeforeFunc != nullptr) {
+        parentNode->AddChildren(children, m_shouldInsertBeforeFunc);
+    } else {
+        parentNode->AddChildren(children);
+    }
+}
+
 wxTreeItemId clTreeCtrlModel::InsertItem(const wxTreeItemId& parent, const wxTreeItemId& previous, const wxString& text,
                                          int image, int selImage, wxTreeItemData* data)
 {
@@ -299,6 +325,9 @@ int clTreeCtrlModel::GetItemIndex(clRowEntry* item) const
 {
     if(item == NULL) { return wxNOT_FOUND; }
     if(!m_root) { return wxNOT_FOUND; }
+    if(item->IsVisible()) { return item->GetRowIndex(); }
+
+    // An item inside a collapsed subtree: count the visible items before it
     int counter = 0;
     clRowEntry* current = m_root;
     while(current) {
@@ -346,21 +375,14 @@ bool clTreeCtrlModel::GetRange(clRowEntry* from, clRowEntry* to, clRowEntry::Vec
 size_t clTreeCtrlModel::GetExpandedLines() const
 {
     if(!GetRoot()) { return 0; }
-    return m_root->GetExpandedLines();
+    return m_root->GetRowsCount();
 }
 
 clRowEntry* clTreeCtrlModel::GetItemFromIndex(int index) const
 {
     if(index < 0) { return nullptr; }
     if(!m_root) { return nullptr; }
-    int curIndex = -1;
-    clRowEntry* current = m_root;
-    while(current) {
-        if(current->IsVisible()) { ++curIndex; }
-        if(curIndex == index) { return current; }
-        current = current->GetNext();
-    }
-    return nullptr;
+    return m_root->GetRowAt(index);
 }
 
 void clTreeCtrlModel::SelectChildren(const wxTreeItemId& item)
@@ -481,30 +503,12 @@ bool clTreeCtrlModel::IsVisible(const wxTreeItemId& item) const
 
 clRowEntry* clTreeCtrlModel::GetRowBefore(clRowEntry* item, bool visibleItem) const
 {
-    clRowEntry* curp = item;
-    if(!curp) { return nullptr; }
-    curp = curp->GetPrev();
-    while(curp) {
-        if(visibleItem && !curp->IsVisible()) {
-            curp = curp->GetPrev();
-            continue;
-        }
-        break;
-    }
-    return curp;
+    if(!item) { return nullptr; }
+    return visibleItem ? item->GetPrevVisible() : item->GetPrev();
 }
 
 clRowEntry* clTreeCtrlModel::GetRowAfter(clRowEntry* item, bool visibleItem) const
 {
-    clRowEntry* curp = item;
-    if(!curp) { return nullptr; }
-    curp = curp->GetNext();
-    while(curp) {
-        if(visibleItem && !curp->IsVisible()) {
-            curp = curp->GetNext();
-            continue;
-        }
-        break;
-    }
-    return curp;
+    if(!item) { return nullptr; }
+    return visibleItem ? item->GetNextVisible() : item->GetNext();
 }
@@ -12,6 +12,26 @@
 
 class clTreeCtrl;
 typedef std::function<bool(clRowEntry*, clRowEntry*)> clSortFunc_t;
+
+/**
+ * @brief an item to add with clTreeCtrl::AppendItems()
+ */
+struct WXDLLIMPEXP_SDK clTreeCtrlItem {
+    wxString text;
+    int image = wxNOT_FOUND;
+    int selImage = wxNOT_FOUND;
+    wxTreeItemData* data = nullptr;
+
+    clTreeCtrlItem() {}
+    clTreeCtrlItem(const wxString& t, int img, int selImg, wxTreeItemData* d)
+        : text(t)
+        , image(img)
+        , selImage(selImg)
+        , data(d)
+    {
+    }
+    typedef std::vector<clTreeCtrlItem> Vec_t;
+};
 class WXDLLIMPEXP_SDK clTreeCtrlModel
 {
     clTreeCtrl* m_tree = nullptr;
@@ -52,6 +72,10 @@ public:
                             wxTreeItemData* data);
     wxTreeItemId InsertItem(const wxTreeItemId& parent, const wxTreeItemId& previous, const wxString& text, int image,
                             int selImage, wxTreeItemData* data);
+    /**
+     * @brief append a batch of items to 'parent'. 'ids' is filled with the new items, in the order of 'items'
+     */
+    void AppendItems(const wxTreeItemId& parent, const clTreeCtrlItem::Vec_t& items, std::vector<wxTreeItemId>& ids);
     wxTreeItemId GetRootItem() const;
 
     void SetIndentSize(int indentSize) { this->m_indentSize = indentSize; }
@@ -122,6 +146,10 @@ public:
      * @param item
      */
     void DeleteItem(const wxTreeItemId& item);
+    /**
+     * @brief return the row index of a visible item / the visible item at a given row. Both use the visible rows
+     * count kept by each item, so they don't depend on the number of items in the tree
+     */
     int GetItemIndex(clRowEntry* item) const;
     clRowEntry* GetItemFromIndex(int index) const;
 
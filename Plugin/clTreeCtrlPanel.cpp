@@ -228,31 +228,53 @@ void clTreeCtrlPanel::DoExpandItem(const wxTreeItemId& parent, bool expand)
     if(!dir.IsOpened())
         return;
     wxBusyCursor bc;
+
+    clTreeCtrlData* parentData = GetItemData(parent);
+    CHECK_PTR_RET(parentData);
+    wxArrayString topFolders;
+    wxArrayTreeItemIds topFoldersItems;
+    GetTopLevelFolders(topFolders, topFoldersItems);
+
+    // Collect the folder content and add it to the tree in a single batch: a folder may contain thousands of files
+    clTreeCtrlItem::Vec_t items;
     wxString filename;
     bool cont = dir.GetFirst(&filename, wxEmptyString);
     while(cont) {
         wxFileName fullpath(folderPath, filename);
-        // Make sure we don't add the same folder twice
-        if(wxFileName::DirExists(fullpath.GetFullPath())) {
-            // a folder
-            if(!(m_options & kShowHiddenFolders) && FileUtils::IsHidden(fullpath)) {
-                cont = dir.GetNext(&filename);
+        cont = dir.GetNext(&filename);
+
+        bool isFolder = wxFileName::DirExists(fullpath.GetFullPath());
+        if(isFolder) {
+            if((!(m_options & kShowHiddenFolders) && FileUtils::IsHidden(fullpath)) ||
+               (topFolders.Index(fullpath.GetFullPath()) != wxNOT_FOUND)) {
                 continue;
             }
-            DoAddFolder(parent, fullpath.GetFullPath());
+        } else if(!(m_options & kShowHiddenFiles) && FileUtils::IsHidden(fullpath)) {
+            continue;
+        } else if(!m_excludeFilePatterns.empty() && FileUtils::WildMatch(m_excludeFilePatterns, fullpath)) {
+            // exclude this file?
+            continue;
+        }
+
+        // make sure we don't add the same file or folder twice
+        clTreeCtrlItem item = DoCreateItem(fullpath.GetFullPath(), isFolder);
+        if(parentData->GetIndex() && parentData->GetIndex()->Find(item.text).IsOk()) {
+            wxDELETE(item.data);
         } else {
-            // make sure we don't add the same file twice
-            if(!(m_options & kShowHiddenFiles) && FileUtils::IsHidden(fullpath)) {
-                cont = dir.GetNext(&filename);
-                continue;
-            } else if(!m_excludeFilePatterns.empty() && FileUtils::WildMatch(m_excludeFilePatterns, fullpath)) {
-                // exclude this file?
-                cont = dir.GetNext(&filename);
-                continue;
-            }
-            DoAddFile(parent, fullpath.GetFullPath());
+            items.push_back(item);
+        }
+    }
+
+    std::vector<wxTreeItemId> ids = GetTreeCtrl()->AppendItems(parent, items);
+    for(size_t i = 0; i < ids.size(); ++i) {
+        // Add this entry to the index
+        if(parentData->GetIndex()) {
+            parentData->GetIndex()->Add(items[i].text, ids[i]);
+        }
+        // Append the dummy item to the folders, it is replaced by the folder content when expanded
+        if(static_cast<clTreeCtrlData*>(items[i].data)->IsFolder()) {
+            GetTreeCtrl()->AppendItem(ids[i], "Dummy", -1, -1, new clTreeCtrlData(clTreeCtrlData::kDummy));
         }
-        cont = dir.GetNext(&filename);
     }
 
     // Sort the parent
@@ -278,32 +300,47 @@ void clTreeCtrlPanel::AddFolder(const wxString& path)
     ToggleView();
 }
 
-wxTreeItemId clTreeCtrlPanel::DoAddFile(const wxTreeItemId& parent, const wxString& path)
+clTreeCtrlItem clTreeCtrlPanel::DoCreateItem(const wxString& path, bool isFolder) const
 {
+    if(isFolder) {
+        clTreeCtrlData* cd = new clTreeCtrlData(clTreeCtrlData::kFolder);
+        cd->SetPath(path);
+        wxString displayName = (m_options & kShowRootFullPath) ? cd->GetPath() : cd->GetName();
+        return clTreeCtrlItem(displayName, m_bmpLoader->GetMimeImageId(FileExtManager::TypeFolder),
+                              m_bmpLoader->GetMimeImageId(FileExtManager::TypeFolderExpanded), cd);
+    }
+
     wxFileName filename(path);
+    clTreeCtrlData* cd = new clTreeCtrlData(clTreeCtrlData::kFile);
+    cd->SetPath(filename.GetFullPath());
+    int imgIdx = m_bmpLoader->GetMimeImageId(filename.GetFullName());
+    if(imgIdx == wxNOT_FOUND) {
+        imgIdx = m_bmpLoader->GetMimeImageId(FileExtManager::TypeText);
+    }
+    return clTreeCtrlItem(filename.GetFullName(), imgIdx, imgIdx, cd);
+}
+
+wxTreeItemId clTreeCtrlPanel::DoAddFile(const wxTreeItemId& parent, const wxString& path)
+{
     clTreeCtrlData* parentData = GetItemData(parent);
     if(!parentData) {
         return wxTreeItemId();
     }
+
+    clTreeCtrlItem item = DoCreateItem(path, false);
     if(parentData->GetIndex()) {
-        wxTreeItemId cachedItem = parentData->GetIndex()->Find(filename.GetFullName());
+        wxTreeItemId cachedItem = parentData->GetIndex()->Find(item.text);
         if(cachedItem.IsOk()) {
             // the item already exists, return it
+            wxDELETE(item.data);
             return cachedItem;
         }
     }
 
-    clTreeCtrlData* cd = new clTreeCtrlData(clTreeCtrlData::kFile);
-    cd->SetPath(filename.GetFullPath());
-
-    int imgIdx = m_bmpLoader->GetMimeImageId(filename.GetFullName());
-    if(imgIdx == wxNOT_FOUND) {
-        imgIdx = m_bmpLoader->GetMimeImageId(FileExtManager::TypeText);
-    }
-    wxTreeItemId fileItem = GetTreeCtrl()->AppendItem(parent, filename.GetFullName(), imgIdx, imgIdx, cd);
+    wxTreeItemId fileItem = GetTreeCtrl()->AppendItem(parent, item.text, item.image, item.selImage, item.data);
     // Add this entry to the index
     if(parentData->GetIndex()) {
-        parentData->GetIndex()->Add(filename.GetFullName(), fileItem);
+        parentData->GetIndex()->Add(item.text, fileItem);
     }
     return fileItem;
 }
@@ -319,34 +356,27 @@ wxTreeItemId clTreeCtrlPanel::DoAddFolder(const wxTreeItemId& parent, const wxSt
         return topFoldersItems.Item(where);
     }
 
-    wxFileName filename(path, "");
-    clTreeCtrlData* cd = new clTreeCtrlData(clTreeCtrlData::kFolder);
-    cd->SetPath(path);
-    wxString displayName = (m_options & kShowRootFullPath) ? cd->GetPath() : cd->GetName();
-
     clTreeCtrlData* parentData = GetItemData(parent);
     if(!parentData) {
-        wxDELETE(cd);
         return wxTreeItemId();
     }
 
     // Check the index before adding new folder
+    clTreeCtrlItem item = DoCreateItem(path, true);
     if(parentData->GetIndex()) {
-        wxTreeItemId cachedItem = parentData->GetIndex()->Find(displayName);
+        wxTreeItemId cachedItem = parentData->GetIndex()->Find(item.text);
         if(cachedItem.IsOk()) {
             // the item already exists, return it
-            wxDELETE(cd);
+            wxDELETE(item.data);
             return cachedItem;
         }
     }
 
-    int imgIdx = m_bmpLoader->GetMimeImageId(FileExtManager::TypeFolder);
-    int imgOpenedIDx = m_bmpLoader->GetMimeImageId(FileExtManager::TypeFolderExpanded);
-    wxTreeItemId itemFolder = GetTreeCtrl()->AppendItem(parent, displayName, imgIdx, imgOpenedIDx, cd);
+    wxTreeItemId itemFolder = GetTreeCtrl()->AppendItem(parent, item.text, item.image, item.selImage, item.data);
 
     // Add this entry to the index
     if(parentData->GetIndex()) {
-        parentData->GetIndex()->Add(displayName, itemFolder);
+        parentData->GetIndex()->Add(item.text, itemFolder);
     }
 
     // Append the dummy item
@@ -189,6 +189,10 @@ protected:
     bool IsTopLevelFolder(const wxTreeItemId& item);
 
     clTreeCtrlData* GetItemData(const wxTreeItemId& item) const;
+    /**
+     * @brief build the tree item (label, images and data) of a file or a folder. The caller owns the item data
+     */
+    clTreeCtrlItem DoCreateItem(const wxString& path, bool isFolder) const;
     wxTreeItemId DoAddFolder(const wxTreeItemId& parent, const wxString& path);
     wxTreeItemId DoAddFile(const wxTreeItemId& parent, const wxString& path);
     void DoCloseFolder(const wxTreeItemId& item);
@@ -27,6 +27,7 @@
 #include "asyncprocess.h"
 #include "clConsoleBase.h"
 #include "clDataViewListCtrl.h"
+#include "clFileIdentity.h"
 #include "clFileSystemWorkspace.hpp"
 #include "clGetTextFromUserDialog.h"
 #include "cl_standard_paths.h"
@@ -59,6 +60,7 @@
 #include "wxmd5.h"
 #include <algorithm>
 #include <set>
+#include <vector>
 #include <wx/app.h>
 #include <wx/clipbrd.h>
 #include <wx/dataobj.h>
@@ -251,92 +253,6 @@ struct ProjListCompartor {
     bool operator()(const ProjectPtr p1, const ProjectPtr p2) const { return p1->GetName() > p2->GetName(); }
 };
 
-static bool IsBOMFile(const char* file_name)
-{
-    bool res(false);
-    FILE* fp = fopen(file_name, "rb");
-    if(fp) {
-        struct stat buff;
-        if(stat(file_name, &buff) == 0) {
-
-            // Read the first 4 bytes (or less)
-            size_t size = buff.st_size;
-            if(size > 4)
-                size = 4;
-
-            char* buffer = new char[size];
-            if(fread(buffer, sizeof(char), size, fp) == size) {
-                BOM bom(buffer, size);
-                res = (bom.Encoding() != wxFONTENCODING_SYSTEM);
-            }
-            delete[] buffer;
-        }
-        fclose(fp);
-    }
-    return res;
-}
-
-static bool ReadBOMFile(const char* file_name, wxString& content, BOM& bom)
-{
-    content.Empty();
-
-    FILE* fp = fopen(file_name, "rb");
-    if(fp) {
-        struct stat buff;
-        if(stat(file_name, &buff) == 0) {
-            size_t size = buff.st_size;
-            char* buffer = new char[size + 1];
-            if(fread(buffer, sizeof(char), size, fp) == size) {
-                buffer[size] = 0;
-
-                wxFontEncoding encoding(wxFONTENCODING_SYSTEM);
-                size_t bomSize(size);
-
-                if(bomSize > 4)
-                    bomSize = 4;
-                bom.SetData(buffer, bomSize);
-                encoding = bom.Encoding();
-
-                if(encoding != wxFONTENCODING_SYSTEM) {
-                    wxCSConv conv(encoding);
-                    // Skip the BOM
-                    char* ptr = buffer;
-                    ptr += bom.Len();
-                    content = wxString(ptr, conv);
-
-                    if(content.IsEmpty()) {
-                        content = wxString::From8BitData(ptr);
-                    }
-                }
-            }
-            delete[] buffer;
-        }
-        fclose(fp);
-    } // From8BitData
-    return content.IsEmpty() == false;
-}
-
-static bool ReadFile8BitData(const char* file_name, wxString& content)
-{
-    content.Empty();
-
-    FILE* fp = fopen(file_name, "rb");
-    if(fp) {
-        struct stat buff;
-        if(stat(file_name, &buff) == 0) {
-            size_t size = buff.st_size;
-            char* buffer = new char[size + 1];
-            if(fread(buffer, sizeof(char), size, fp) == size) {
-                buffer[size] = 0;
-                content = wxString::From8BitData(buffer);
-            }
-            delete[] buffer;
-        }
-        fclose(fp);
-    }
-    return content.IsEmpty() == false;
-}
-
 bool SendCmdEvent(int eventId, void* clientData) { return EventNotifier::Get()->SendCommandEvent(eventId, clientData); }
 
 bool SendCmdEvent(int eventId, void* clientData, const wxString& str)
@@ -367,39 +283,52 @@ wxString GetColumnText(wxListCtrl* list, long index, long column)
     return list_item.GetText();
 }
 
-bool ReadFileWithConversion(const wxString& fileName, wxString& content, wxFontEncoding encoding, BOM* bom)
+bool ReadFileWithConversion(const wxString& fileName, wxString& content, wxFontEncoding encoding, BOM* bom,
+                            wxUint64* hash)
 {
     wxLogNull noLog;
     content.Clear();
-    wxFile file(fileName, wxFile::read);
 
-    const wxCharBuffer name = _C(fileName);
-    if(file.IsOpened()) {
+    // Read the raw bytes once, all the conversions below (and the hash) work on the memory buffer
+    wxFFile file(fileName, "rb");
+    if(!file.IsOpened()) { return false; }
+    wxFileOffset len = file.Length();
+    if(len < 0) { return false; }
+    size_t size = (size_t)len;
+    std::vector<char> buffer(size + 1, 0);
+    if(size && file.Read(buffer.data(), size) != size) { return false; }
+    file.Close();
 
-        // If we got a BOM pointer, test to see whether the file is BOM file
-        if(bom && IsBOMFile(name.data())) {
-            return ReadBOMFile(name.data(), content, *bom);
-        }
+    if(hash) { *hash = clFileHasher::Hash(buffer.data(), size); }
+    const char* data = buffer.data();
 
-        if(encoding == wxFONTENCODING_DEFAULT) {
-            encoding = EditorConfigST::Get()->GetOptions()->GetFileFontEncoding();
-        }
+    // If we got a BOM pointer, test to see whether the file is BOM file
+    if(bom && size && BOM(data, std::min<size_t>(size, 4)).Encoding() != wxFONTENCODING_SYSTEM) {
+        bom->SetData(data, std::min<size_t>(size, 4));
+        wxCSConv conv(bom->Encoding());
+        // Skip the BOM
+        const char* ptr = data + bom->Len();
+        content = wxString(ptr, conv);
+        if(content.IsEmpty()) { content = wxString::From8BitData(ptr); }
+        return !content.IsEmpty();
+    }
 
-        // first try the user defined encoding (except for UTF8: the UTF8 builtin appears to be faster)
-        if(encoding != wxFONTENCODING_UTF8) {
-            wxCSConv fontEncConv(encoding);
-            if(fontEncConv.IsOk()) {
-                file.ReadAll(&content, fontEncConv);
-            }
-        }
+    if(encoding == wxFONTENCODING_DEFAULT) {
+        encoding = EditorConfigST::Get()->GetOptions()->GetFileFontEncoding();
+    }
+
+    // first try the user defined encoding (except for UTF8: the UTF8 builtin appears to be faster)
+    if(encoding != wxFONTENCODING_UTF8) {
+        wxCSConv fontEncConv(encoding);
+        if(fontEncConv.IsOk()) { content = wxString(data, fontEncConv, size); }
+    }
 
+    if(content.IsEmpty()) {
+        // now try the Utf8
+        content = wxString(data, wxConvUTF8, size);
         if(content.IsEmpty()) {
-            // now try the Utf8
-            file.ReadAll(&content, wxConvUTF8);
-            if(content.IsEmpty()) {
-                // try local 8 bit data
-                ReadFile8BitData(name.data(), content);
-            }
+            // try local 8 bit data
+            content = wxString::From8BitData(data, size);
         }
     }
     return !content.IsEmpty();
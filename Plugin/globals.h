@@ -133,10 +133,12 @@ WXDLLIMPEXP_SDK long AppendListCtrlRow(wxListCtrl* list);
  * \param fileName file name
  * \param content output string
  * \param encoding
+ * \param hash [output] if not NULL, the clFileHasher hash of the raw bytes (set when the file could be read)
  * \return true on success, false otherwise
  */
 WXDLLIMPEXP_SDK bool ReadFileWithConversion(const wxString& fileName, wxString& content,
-                                            wxFontEncoding encoding = wxFONTENCODING_DEFAULT, BOM* bom = NULL);
+                                            wxFontEncoding encoding = wxFONTENCODING_DEFAULT, BOM* bom = NULL,
+                                            wxUint64* hash = NULL);
 
 /**
  * \brief write file using UTF8 converter
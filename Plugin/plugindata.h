@@ -38,6 +38,9 @@ public:
     enum eFlags {
         kNone = 0,
         kDisabledByDefault = (1 << 0),
+        // The plugin does not need to be initialized during startup (e.g. it only adds menu entries). It is
+        // constructed once the main frame is up and the startup completed
+        kLazyActivation = (1 << 1),
     };
 
 protected:
@@ -34,6 +34,10 @@
 #include <imanager.h>
 #include <wx/wupdlock.h>
 
+#define GLOBALS_NODE_TEXT wxT("Global Functions and Variables")
+#define PROTOTYPES_NODE_TEXT wxT("Functions Prototypes")
+#define MACROS_NODE_TEXT wxT("Macros")
+
 SymbolTree::SymbolTree()
     : m_sortByLineNumber(true)
 {
@@ -203,13 +207,9 @@ void SymbolTree::BuildTree(const wxFileName& fileName, const TagEntryPtrVector_t
 
     // add three items here:
     // the globals node, the mcros and the prototype node
-    int nodeImgIdx = clGetManager()->GetStdIcons()->GetImageIndex(BitmapLoader::kAngleBrackets);
-    m_globalsNode = AppendItem(root, wxT("Global Functions and Variables"), nodeImgIdx, nodeImgIdx,
-                               new MyTreeItemData(wxT("Global Functions and Variables"), wxEmptyString));
-    m_prototypesNode = AppendItem(root, wxT("Functions Prototypes"), nodeImgIdx, nodeImgIdx,
-                                  new MyTreeItemData(wxT("Functions Prototypes"), wxEmptyString));
-    m_macrosNode =
-        AppendItem(root, wxT("Macros"), nodeImgIdx, nodeImgIdx, new MyTreeItemData(wxT("Macros"), wxEmptyString));
+    DoGetGroupNode(m_globalsNode, GLOBALS_NODE_TEXT);
+    DoGetGroupNode(m_prototypesNode, PROTOTYPES_NODE_TEXT);
+    DoGetGroupNode(m_macrosNode, MACROS_NODE_TEXT);
 
     for(; !walker.End(); walker++) {
         // Add the item to the tree
@@ -221,10 +221,93 @@ void SymbolTree::BuildTree(const wxFileName& fileName, const TagEntryPtrVector_t
         // Add the node
         AddItem(node);
     }
+    DoDeleteEmptyGroups();
+}
+
+SymbolTree::eApplyTagsResult SymbolTree::ApplyTags(const TagEntryPtrVector_t& tags)
+{
+    if(!m_tree || !GetRootItem().IsOk()) { return kApplyTagsFailed; }
+
+    TagEntryPtrVector_t newTags(tags);
+    TagTreePtr newTree = TagsManagerST::Get()->Load(m_fileName, &newTags);
+    if(!newTree) { return kApplyTagsFailed; }
+
+    std::vector<std::pair<wxString, TagEntry> > deletedItems, modifiedItems, newItems;
+    m_tree->Compare(newTree.Get(), deletedItems, modifiedItems, newItems);
+
+    // When most of the symbols were replaced, building the tree again is cheaper
+    if(((deletedItems.size() + newItems.size()) * 2) > std::max<size_t>(m_items.size(), 100)) { return kApplyTagsFailed; }
+
+    // A symbol that changed its kind might belong to another group
+    for(const std::pair<wxString, TagEntry>& item : modifiedItems) {
+        TagNode* node = m_tree->Find(item.first);
+        if(!node || node->GetData().GetKind() != item.second.GetKind()) { return kApplyTagsFailed; }
+    }
 
-    if(ItemHasChildren(m_globalsNode) == false) { Delete(m_globalsNode); }
-    if(ItemHasChildren(m_prototypesNode) == false) { Delete(m_prototypesNode); }
-    if(ItemHasChildren(m_macrosNode) == false) { Delete(m_macrosNode); }
+    Freeze();
+    DeleteSymbols(deletedItems);
+    for(const std::pair<wxString, TagEntry>& item : deletedItems) {
+        // the children of a removed node are removed with it
+        TagNode* node = m_tree->Remove(item.first);
+        if(node) { delete node; }
+    }
+    UpdateSymbols(modifiedItems);
+    AddSymbols(newItems);
+    DoDeleteEmptyGroups();
+    Thaw();
+
+    // m_currentTags is not updated when the tree must be built again, so the caller does not take the new tags for
+    // the ones already displayed
+    if(m_sortByLineNumber && !IsSortedByLine(modifiedItems)) { return kApplyTagsUnsorted; }
+
+    m_currentTags.clear();
+    m_currentTags.insert(m_currentTags.end(), tags.begin(), tags.end());
+    return kApplyTagsDone;
+}
+
+bool SymbolTree::IsSortedByLine(const std::vector<std::pair<wxString, TagEntry> >& items)
+{
+    for(const std::pair<wxString, TagEntry>& item : items) {
+        std::map<wxString, void*>::iterator iter = m_items.find(item.first);
+        if(iter == m_items.end()) { continue; }
+
+        wxTreeItemId hti = iter->second;
+        int line = item.second.GetLine();
+        wxTreeItemId prev = GetPrevSibling(hti);
+        wxTreeItemId next = GetNextSibling(hti);
+        MyTreeItemData* prevData = prev.IsOk() ? dynamic_cast<MyTreeItemData*>(GetItemData(prev)) : NULL;
+        MyTreeItemData* nextData = next.IsOk() ? dynamic_cast<MyTreeItemData*>(GetItemData(next)) : NULL;
+        if((prevData && prevData->GetLine() > line) || (nextData && nextData->GetLine() < line)) { return false; }
+    }
+    return true;
+}
+
+wxTreeItemId SymbolTree::DoGetGroupNode(wxTreeItemId& node, const wxString& label)
+{
+    if(!node.IsOk()) {
+        int nodeImgIdx = clGetManager()->GetStdIcons()->GetImageIndex(BitmapLoader::kAngleBrackets);
+        node = AppendItem(GetRootItem(), label, nodeImgIdx, nodeImgIdx, new MyTreeItemData(label, wxEmptyString));
+    }
+    return node;
+}
+
+void SymbolTree::DoDeleteEmptyGroups()
+{
+    wxTreeItemId* groups[] = { &m_globalsNode, &m_prototypesNode, &m_macrosNode };
+    for(wxTreeItemId* group : groups) {
+        if(group->IsOk() && !ItemHasChildren(*group)) {
+            Delete(*group);
+            *group = wxTreeItemId();
+        }
+    }
+}
+
+wxFont SymbolTree::GetItemFont(const TagEntry& tag) const
+{
+    wxFont font = clScrolledPanel::GetDefaultFont();
+    if(tag.GetKind() == wxT("prototype")) { font.SetStyle(wxFONTSTYLE_ITALIC); }
+    if(tag.GetAccess() == wxT("public")) { font.SetWeight(wxFONTWEIGHT_BOLD); }
+    return font;
 }
 
 void SymbolTree::AddItem(TagNode* node)
@@ -238,28 +321,33 @@ void SymbolTree::AddItem(TagNode* node)
     wxTreeItemId parentHti;
     if(nodeData.GetName().IsEmpty()) return;
 
-    wxFont font = clScrolledPanel::GetDefaultFont();
-    if(nodeData.GetKind() == wxT("prototype")) { font.SetStyle(wxFONTSTYLE_ITALIC); }
-    if(nodeData.GetAccess() == wxT("public")) { font.SetWeight(wxFONTWEIGHT_BOLD); }
-
-    //-------------------------------------------------------------------------------
-    // We gather globals together under special node
-    //-------------------------------------------------------------------------------
-    if((nodeData.GetParent() == wxT("<global>")) && // parent is global scope
-       m_globalsKind.find(nodeData.GetKind()) !=
-           m_globalsKind.end()) { // the node kind is one of function, prototype or variable
-        if(nodeData.GetKind() == wxT("prototype"))
-            parentHti = m_prototypesNode;
-        else
-            parentHti = m_globalsNode;
+    wxFont font = GetItemFont(nodeData);
+
+    // the group nodes are added on demand when the tree is updated (see ApplyTags())
+    bool newGroup = false;
+    if(nodeData.GetKind() == wxT("macro")) {
+        //---------------------------------------------------------------------------------
+        // Macros are gathered under the 'Macros' node
+        //---------------------------------------------------------------------------------
+        newGroup = !m_macrosNode.IsOk();
+        parentHti = DoGetGroupNode(m_macrosNode, MACROS_NODE_TEXT);
+
+    } else if((nodeData.GetParent() == wxT("<global>")) && // parent is global scope
+              m_globalsKind.find(nodeData.GetKind()) !=
+                  m_globalsKind.end()) { // the node kind is one of function, prototype or variable
+        //-------------------------------------------------------------------------------
+        // We gather globals together under special node
+        //-------------------------------------------------------------------------------
+        if(nodeData.GetKind() == wxT("prototype")) {
+            newGroup = !m_prototypesNode.IsOk();
+            parentHti = DoGetGroupNode(m_prototypesNode, PROTOTYPES_NODE_TEXT);
+        } else {
+            newGroup = !m_globalsNode.IsOk();
+            parentHti = DoGetGroupNode(m_globalsNode, GLOBALS_NODE_TEXT);
+        }
     } else
         parentHti = node->GetParent()->GetData().GetTreeItemId();
 
-    //---------------------------------------------------------------------------------
-    // Macros are gathered under the 'Macros' node
-    //---------------------------------------------------------------------------------
-    if(nodeData.GetKind() == wxT("macro")) { parentHti = m_macrosNode; }
-
     // only if parent is valid, we add item to the tree
     wxTreeItemId hti;
 
@@ -275,6 +363,7 @@ void SymbolTree::AddItem(TagNode* node)
         SetItemFont(hti, font);
         node->GetData().SetTreeItemId(hti);
         m_items[nodeData.Key()] = hti.m_pItem;
+        if(newGroup) { Expand(parentHti); }
     }
 }
 
@@ -338,10 +427,10 @@ void SymbolTree::UpdateGuiItem(TagEntry& data, const wxString& key)
                 SetItemImage(node->GetData().GetTreeItemId(), iconIndex, wxTreeItemIcon_Selected);
 
             } // if(curIconIndex != iconIndex )
+            SetItemFont(itemId, GetItemFont(data));
             // update the linenumber and file
-            MyTreeItemData* item_data = new MyTreeItemData(data.GetFile(), data.GetPattern());
-            wxTreeItemData* old_data = GetItemData(itemId);
-            if(old_data) delete old_data;
+            MyTreeItemData* item_data = new MyTreeItemData(data.GetFile(), data.GetPattern(), data.GetLine());
+            // the tree deletes the old data
             SetItemData(itemId, item_data);
         }
     }
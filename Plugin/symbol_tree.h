@@ -132,6 +132,18 @@ public:
      */
     virtual void BuildTree(const wxFileName& fileName, const TagEntryPtrVector_t& tags, bool forceBuild = false);
 
+    enum eApplyTagsResult {
+        kApplyTagsDone,     // the tree is up to date
+        kApplyTagsFailed,   // the tree was not changed, it should be built again
+        kApplyTagsUnsorted, // the tree was updated, but the items are no longer sorted by line: it must be built again
+    };
+
+    /**
+     * @brief update the tree of the current file with 'tags': only the symbols that were added, removed or modified
+     * since the tree was built are updated, the other items (and their expanded state) are kept
+     */
+    eApplyTagsResult ApplyTags(const TagEntryPtrVector_t& tags);
+
     /**
      * User provided icons for the symbols tree.
      * The assignment is index based, in the following order:
@@ -208,6 +220,26 @@ protected:
      */
     void UpdateGuiItem(TagEntry& data, const wxString& key);
 
+    /**
+     * @brief return the font of the item of 'tag'
+     */
+    wxFont GetItemFont(const TagEntry& tag) const;
+
+    /**
+     * @brief return the node that gathers the globals / prototypes / macros. Add it if needed
+     */
+    wxTreeItemId DoGetGroupNode(wxTreeItemId& node, const wxString& label);
+
+    /**
+     * @brief remove the globals / prototypes / macros node if they have no children
+     */
+    void DoDeleteEmptyGroups();
+
+    /**
+     * @brief return true if the items that were moved (see UpdateSymbols()) are still sorted by their line number
+     */
+    bool IsSortedByLine(const std::vector<std::pair<wxString, TagEntry> >& items);
+
     void SelectFirstItem();
 };
 #endif // CODELITE_SYMBOL_TREE_H
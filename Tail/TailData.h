@@ -1,6 +1,7 @@
 #ifndef TAIL_DATA_H
 #define TAIL_DATA_H
 
+#include <wx/arrstr.h>
 #include <wx/filename.h>
 #include <wx/string.h>
 
@@ -9,7 +10,9 @@ class TailData
 public:
     wxFileName filename;
     size_t lastPos;
-    wxString displayedText;
+    wxArrayString lines; // the last lines read from the file, before the filter is applied
+    wxString includeFilter;
+    wxString excludeFilter;
 
 public:
     TailData()
@@ -1,5 +1,6 @@
 #include "ColoursAndFontsManager.h"
 #include "TailPanel.h"
+#include "TailReaderThread.h"
 #include "bitmap_loader.h"
 #include "cl_config.h"
 #include "codelite_events.h"
@@ -8,22 +9,42 @@
 #include "globals.h"
 #include "lexer_configuration.h"
 #include "tail.h"
+#include <algorithm>
 #include <imanager.h>
-#include <wx/ffile.h>
 #include <wx/filedlg.h>
+#include <wx/sizer.h>
+#include <wx/spinctrl.h>
+#include <wx/stattext.h>
+#include <wx/textctrl.h>
+#include <wx/wupdlock.h>
 #include "clThemeUpdater.h"
 
+// the view is refreshed at most every REFRESH_INTERVAL_MS, no matter how fast the file grows
+static const int REFRESH_INTERVAL_MS = 100;
+
 TailPanel::TailPanel(wxWindow* parent, Tail* plugin)
     : TailPanelBase(parent)
     , m_lastPos(0)
     , m_plugin(plugin)
     , m_isDetached(false)
     , m_frame(NULL)
+    , m_thread(NULL)
+    , m_generation(0)
+    , m_throttle(REFRESH_INTERVAL_MS, [this]() { DoRefresh(); })
+    , m_textCtrlInclude(NULL)
+    , m_textCtrlExclude(NULL)
+    , m_spinCtrlMaxLines(NULL)
 {
     clThemeUpdater::Get().RegisterWindow(this);
     clThemeUpdater::Get().RegisterWindow(m_staticTextFileName);
     
+    m_maxLines = std::max(clConfig::Get().Read("TailMaxLines", 10000), 1);
     DoBuildToolbar();
+    DoBuildFilterBar();
+
+    m_thread = new TailReaderThread(&m_throttle, m_maxLines);
+    m_thread->Start();
+
     m_fileWatcher.reset(new clFileSystemWatcher());
     m_fileWatcher->SetOwner(this);
     Bind(wxEVT_FILE_MODIFIED, &TailPanel::OnFileModified, this);
@@ -38,6 +59,10 @@ TailPanel::~TailPanel()
     clThemeUpdater::Get().UnRegisterWindow(this);
     clThemeUpdater::Get().UnRegisterWindow(m_staticTextFileName);
     Unbind(wxEVT_FILE_MODIFIED, &TailPanel::OnFileModified, this);
+    m_fileWatcher->Stop();
+    m_throttle.Stop();
+    m_thread->Stop();
+    wxDELETE(m_thread);
     EventNotifier::Get()->Unbind(wxEVT_CL_THEME_CHANGED, &TailPanel::OnThemeChanged, this);
 }
 
@@ -60,6 +85,11 @@ void TailPanel::DoClear()
     m_stc->SetReadOnly(true);
     m_lastPos = 0;
 
+    // drop the lines of the previous file
+    TailRequest* req = new TailRequest(TailRequest::kOpen);
+    req->m_generation = ++m_generation;
+    m_thread->Add(req);
+
     m_staticTextFileName->SetLabel(_("<No opened file>"));
     SetFrameTitle();
     Layout();
@@ -67,25 +97,46 @@ void TailPanel::DoClear()
 
 void TailPanel::OnFileModified(clFileSystemEvent& event)
 {
-    wxFileName fn(event.GetPath());
-    // Get the current file size
-    size_t cursize = FileUtils::GetFileSize(m_file);
-    wxFFile fp(m_file.GetFullPath(), "rb");
-    if(fp.IsOpened() && fp.Seek(m_lastPos)) {
-        if(cursize > m_lastPos) {
-            size_t bufferSize = cursize - m_lastPos;
-            char* buffer = new char[bufferSize + 1];
-            if(fp.Read(buffer, bufferSize) == bufferSize) {
-                buffer[bufferSize] = '\0';
-                wxString content((const char*)buffer, wxConvUTF8);
-                DoAppendText(content);
-            }
-            wxDELETEA(buffer);
-        } else {
-            DoAppendText(_("\n>>> File truncated <<<\n"));
-        }
-        m_lastPos = cursize;
+    // the reader thread reads the new content from where it stopped
+    m_thread->Add(new TailRequest(TailRequest::kRead));
+}
+
+void TailPanel::DoRefresh()
+{
+    TailOutput output;
+    m_thread->TakeOutput(output);
+    if(output.generation != m_generation) { return; }
+    m_lastPos = output.lastPos;
+    if(!output.replace && output.lines.empty()) { return; }
+
+    size_t len = 0;
+    for(const wxString& line : output.lines) {
+        len += line.length() + 1;
+    }
+    wxString text;
+    text.reserve(len);
+    for(const wxString& line : output.lines) {
+        text << line << "\n";
+    }
+
+    wxWindowUpdateLocker locker(m_stc);
+    if(output.replace) {
+        m_stc->SetReadOnly(false);
+        m_stc->ClearAll();
+        m_stc->SetReadOnly(true);
     }
+    DoAppendText(text);
+    DoTruncate();
+}
+
+void TailPanel::DoTruncate()
+{
+    // allow some slack so we don't delete lines on every refresh
+    int lines = m_stc->GetLineCount();
+    if(lines <= (int)(m_maxLines + m_maxLines / 10)) { return; }
+    m_stc->SetReadOnly(false);
+    m_stc->DeleteRange(0, m_stc->PositionFromLine(lines - m_maxLines));
+    m_stc->SetReadOnly(true);
 }
 
 void TailPanel::DoAppendText(const wxString& text)
@@ -113,6 +164,7 @@ void TailPanel::OnClear(wxCommandEvent& event)
     m_stc->SetReadOnly(false);
     m_stc->ClearAll();
     m_stc->SetReadOnly(true);
+    m_thread->Add(new TailRequest(TailRequest::kClear));
 }
 
 void TailPanel::OnClearUI(wxUpdateUIEvent& event) { event.Enable(!m_stc->IsEmpty()); }
@@ -137,10 +189,20 @@ void TailPanel::OnOpenMenu(wxCommandEvent& event)
     m_toolbar->ShowMenuForButton(XRCID("tail_open"), &menu);
 }
 
-void TailPanel::DoOpen(const wxString& filename)
+void TailPanel::DoOpen(const wxString& filename, size_t lastPos, const wxArrayString& lines)
 {
     m_file = filename;
-    m_lastPos = FileUtils::GetFileSize(m_file);
+    m_lastPos = (lastPos == wxString::npos) ? FileUtils::GetFileSize(m_file) : lastPos;
+
+    // the strings are used by the worker thread, make our own copy
+    TailRequest* req = new TailRequest(TailRequest::kOpen);
+    req->m_file = m_file.GetFullPath().c_str();
+    req->m_pos = m_lastPos;
+    req->m_generation = ++m_generation;
+    for(const wxString& line : lines) {
+        req->m_seedLines.Add(line.c_str());
+    }
+    m_thread->Add(req);
 
     wxArrayString recentItems = clConfig::Get().Read("tail", wxArrayString());
     if(recentItems.Index(m_file.GetFullPath()) == wxNOT_FOUND) {
@@ -193,10 +255,11 @@ void TailPanel::OnDetachWindowUI(wxUpdateUIEvent& event) { event.Enable(!m_isDet
 void TailPanel::Initialize(const TailData& tailData)
 {
     DoClear();
+    m_textCtrlInclude->ChangeValue(tailData.includeFilter);
+    m_textCtrlExclude->ChangeValue(tailData.excludeFilter);
+    DoSendFilter();
     if(tailData.filename.IsOk() && tailData.filename.Exists()) {
-        DoOpen(tailData.filename.GetFullPath());
-        DoAppendText(tailData.displayedText);
-        m_lastPos = tailData.lastPos;
+        DoOpen(tailData.filename.GetFullPath(), tailData.lastPos, tailData.lines);
         SetFrameTitle();
     }
 }
@@ -204,9 +267,19 @@ void TailPanel::Initialize(const TailData& tailData)
 TailData TailPanel::GetTailData() const
 {
     TailData dt;
-    dt.displayedText = m_stc->GetText();
     dt.filename = m_file;
     dt.lastPos = m_lastPos;
+    // The view only shows the lines that pass the filter, take all of them from the reader. They come with the
+    // position they were read up to, the new panel continues from there
+    size_t lastPos = 0;
+    if(m_thread->GetLines(dt.lines, lastPos) == m_generation) {
+        dt.lastPos = lastPos;
+    } else {
+        // the reader did not open the current file yet
+        dt.lines.clear();
+    }
+    dt.includeFilter = m_textCtrlInclude->GetValue();
+    dt.excludeFilter = m_textCtrlExclude->GetValue();
     return dt;
 }
 
@@ -260,3 +333,55 @@ void TailPanel::DoBuildToolbar()
 
     GetSizer()->Insert(0, m_toolbar, 0, wxEXPAND);
 }
+
+void TailPanel::DoBuildFilterBar()
+{
+    wxBoxSizer* sizer = new wxBoxSizer(wxHORIZONTAL);
+    m_textCtrlInclude = new wxTextCtrl(this, wxID_ANY);
+    m_textCtrlInclude->SetHint(_("Show only lines containing..."));
+    m_textCtrlExclude = new wxTextCtrl(this, wxID_ANY);
+    m_textCtrlExclude->SetHint(_("Hide lines containing..."));
+    m_spinCtrlMaxLines = new wxSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+                                        wxSP_ARROW_KEYS, 100, 10000000, m_maxLines);
+    m_spinCtrlMaxLines->SetToolTip(_("The number of lines to keep"));
+
+    sizer->Add(new wxStaticText(this, wxID_ANY, _("Include:")), 0, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+    sizer->Add(m_textCtrlInclude, 1, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+    sizer->Add(new wxStaticText(this, wxID_ANY, _("Exclude:")), 0, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+    sizer->Add(m_textCtrlExclude, 1, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+    sizer->Add(new wxStaticText(this, wxID_ANY, _("Max lines:")), 0, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+    sizer->Add(m_spinCtrlMaxLines, 0, wxALL | wxALIGN_CENTER_VERTICAL, 5);
+
+    m_textCtrlInclude->Bind(wxEVT_TEXT, &TailPanel::OnFilterChanged, this);
+    m_textCtrlExclude->Bind(wxEVT_TEXT, &TailPanel::OnFilterChanged, this);
+    m_spinCtrlMaxLines->Bind(wxEVT_SPINCTRL, &TailPanel::OnMaxLinesChanged, this);
+
+    // below the toolbar
+    GetSizer()->Insert(1, sizer, 0, wxEXPAND);
+}
+
+void TailPanel::OnFilterChanged(wxCommandEvent& event)
+{
+    event.Skip();
+    DoSendFilter();
+}
+
+void TailPanel::DoSendFilter()
+{
+    // the lines are filtered by the reader thread. The strings are used by the worker thread, make our own copy
+    TailRequest* req = new TailRequest(TailRequest::kFilter);
+    req->m_include = m_textCtrlInclude->GetValue().c_str();
+    req->m_exclude = m_textCtrlExclude->GetValue().c_str();
+    m_thread->Add(req);
+}
+
+void TailPanel::OnMaxLinesChanged(wxSpinEvent& event)
+{
+    event.Skip();
+    m_maxLines = std::max(m_spinCtrlMaxLines->GetValue(), 1);
+    clConfig::Get().Write("TailMaxLines", (int)m_maxLines);
+
+    TailRequest* req = new TailRequest(TailRequest::kMaxLines);
+    req->m_maxLines = m_maxLines;
+    m_thread->Add(req);
+}
@@ -6,6 +6,7 @@
 #include "clEditorEditEventsHandler.h"
 #include "clFileSystemEvent.h"
 #include "clFileSystemWatcher.h"
+#include "clOutputThrottle.h"
 #include <map>
 #include <vector>
 #include <wx/filename.h>
@@ -13,6 +14,10 @@
 class TailFrame;
 class clToolBar;
 class Tail;
+class TailReaderThread;
+class wxSpinCtrl;
+class wxSpinEvent;
+class wxTextCtrl;
 class TailPanel : public TailPanelBase
 {
     clFileSystemWatcher::Ptr_t m_fileWatcher;
@@ -24,6 +29,14 @@ class TailPanel : public TailPanelBase
     bool m_isDetached;
     clToolBar* m_toolbar;
     TailFrame* m_frame;
+    TailReaderThread* m_thread;
+    // incremented whenever a file is opened or closed, output read for an older file is ignored
+    size_t m_generation;
+    size_t m_maxLines;
+    clOutputThrottle m_throttle;
+    wxTextCtrl* m_textCtrlInclude;
+    wxTextCtrl* m_textCtrlExclude;
+    wxSpinCtrl* m_spinCtrlMaxLines;
 
 protected:
     virtual void OnDetachWindow(wxCommandEvent& event);
@@ -35,12 +48,19 @@ protected:
     virtual void OnClose(wxCommandEvent& event);
     virtual void OnCloseUI(wxUpdateUIEvent& event);
     void OnOpenRecentItem(wxCommandEvent& event);
+    void OnFilterChanged(wxCommandEvent& event);
+    void OnMaxLinesChanged(wxSpinEvent& event);
 
 private:
     void DoBuildToolbar();
+    void DoBuildFilterBar();
     void DoClear();
-    void DoOpen(const wxString& filename);
+    void DoOpen(const wxString& filename, size_t lastPos = wxString::npos,
+                const wxArrayString& lines = wxArrayString());
     void DoAppendText(const wxString& text);
+    void DoSendFilter();
+    void DoRefresh();
+    void DoTruncate();
     void DoPrepareRecentItemsMenu(wxMenu& menu);
     wxString GetTailTitle() const;
 
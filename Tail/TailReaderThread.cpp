@@ -0,0 +1,223 @@
+#include "TailReaderThread.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+#include <wx/ffile.h>
+
+// the size of a single read
+static const size_t CHUNK_SIZE = 64 * 1024;
+// a larger delta is not read entirely, only its end can make it into the view
+static const size_t MAX_DELTA = 16 * 1024 * 1024;
+// a longer line (e.g. a binary file) is split
+static const size_t MAX_LINE_LEN = 1024 * 1024;
+
+TailReaderThread::TailReaderThread(clOutputThrottle* throttle, size_t maxLines)
+    : m_throttle(throttle)
+    , m_maxLines(std::max<size_t>(maxLines, 1))
+{
+}
+
+TailReaderThread::~TailReaderThread() {}
+
+void TailReaderThread::ProcessRequest(ThreadRequest* request)
+{
+    TailRequest* req = dynamic_cast<TailRequest*>(request);
+    if(!req) { return; }
+
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    switch(req->m_type) {
+    case TailRequest::kOpen:
+        DoOpen(req);
+        break;
+    case TailRequest::kRead:
+        DoRead();
+        break;
+    case TailRequest::kFilter:
+        m_include = req->m_include;
+        m_exclude = req->m_exclude;
+        DoFilter();
+        break;
+    case TailRequest::kClear:
+        m_lines.clear();
+        m_newLines.clear();
+        DoPost(true);
+        break;
+    case TailRequest::kMaxLines:
+        m_maxLines = std::max<size_t>(req->m_maxLines, 1);
+        while(m_lines.size() > m_maxLines) {
+            m_lines.pop_front();
+        }
+        DoFilter();
+        break;
+    }
+}
+
+void TailReaderThread::DoOpen(TailRequest* req)
+{
+    m_file = req->m_file.IsEmpty() ? wxFileName() : wxFileName(req->m_file);
+    m_lastPos = req->m_pos;
+    m_generation = req->m_generation;
+    m_partialLine.clear();
+    m_skipLine = false;
+    m_lines.clear();
+    m_newLines.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        m_output = TailOutput();
+        m_output.generation = m_generation;
+        m_output.lastPos = m_lastPos;
+    }
+
+    // the lines read by the panel before it was detached / docked
+    if(!req->m_seedLines.IsEmpty()) {
+        for(const wxString& line : req->m_seedLines) {
+            DoAddLine(line);
+        }
+        DoPost(true);
+    }
+}
+
+void TailReaderThread::DoRead()
+{
+    if(!m_file.IsOk()) { return; }
+    wxFFile fp(m_file.GetFullPath(), "rb");
+    if(!fp.IsOpened()) { return; }
+
+    size_t size = (size_t)fp.Length();
+    if(size < m_lastPos) {
+        // continue from the new end of the file
+        m_partialLine.clear();
+        DoAddLine(_(">>> File truncated <<<"));
+        m_lastPos = size;
+        DoPost(false);
+        return;
+    }
+
+    if((size - m_lastPos) > MAX_DELTA) {
+        // only the last lines are kept, don't read what would be dropped anyway
+        wxString message;
+        message << ">>> " << (size - m_lastPos - MAX_DELTA) << _(" bytes skipped") << " <<<";
+        DoAddLine(message);
+        m_lastPos = size - MAX_DELTA;
+        m_partialLine.clear();
+        m_skipLine = true;
+    }
+
+    if(!fp.Seek(m_lastPos)) { return; }
+    std::vector<char> buffer(CHUNK_SIZE);
+    while(m_lastPos < size) {
+        if(TestDestroy()) { return; }
+        size_t count = fp.Read(buffer.data(), std::min(CHUNK_SIZE, size - m_lastPos));
+        if(count == 0) { break; }
+        m_lastPos += count;
+        DoProcessChunk(buffer.data(), count);
+        // let the panel display the lines as we go
+        DoPost(false);
+    }
+}
+
+void TailReaderThread::DoProcessChunk(const char* data, size_t len)
+{
+    const char* end = data + len;
+    const char* start = data;
+    while(start < end) {
+        const char* eol = (const char*)::memchr(start, '\n', end - start);
+        if(!eol) {
+            m_partialLine.append(start, end - start);
+            if(m_partialLine.length() > MAX_LINE_LEN) {
+                DoAddLine(wxString::From8BitData(m_partialLine.c_str(), m_partialLine.length()));
+                m_partialLine.clear();
+            }
+            break;
+        }
+
+        m_partialLine.append(start, eol - start);
+        start = eol + 1;
+        if(m_skipLine) {
+            // the first line after a skip is not complete
+            m_skipLine = false;
+            m_partialLine.clear();
+            continue;
+        }
+
+        if(!m_partialLine.empty() && m_partialLine[m_partialLine.length() - 1] == '\r') {
+            m_partialLine.erase(m_partialLine.length() - 1);
+        }
+        wxString line = wxString::FromUTF8(m_partialLine.c_str(), m_partialLine.length());
+        if(line.IsEmpty() && !m_partialLine.empty()) {
+            // not a valid UTF-8 string
+            line = wxString::From8BitData(m_partialLine.c_str(), m_partialLine.length());
+        }
+        DoAddLine(line);
+        m_partialLine.clear();
+    }
+}
+
+void TailReaderThread::DoAddLine(const wxString& line)
+{
+    m_lines.push_back(line);
+    if(m_lines.size() > m_maxLines) { m_lines.pop_front(); }
+    if(IsMatching(line)) { m_newLines.push_back(line); }
+}
+
+void TailReaderThread::DoFilter()
+{
+    m_newLines.clear();
+    for(const wxString& line : m_lines) {
+        if(IsMatching(line)) { m_newLines.push_back(line); }
+    }
+    DoPost(true);
+}
+
+bool TailReaderThread::IsMatching(const wxString& line) const
+{
+    if(!m_include.IsEmpty() && !line.Contains(m_include)) { return false; }
+    if(!m_exclude.IsEmpty() && line.Contains(m_exclude)) { return false; }
+    return true;
+}
+
+void TailReaderThread::DoPost(bool replace)
+{
+    bool notify = (replace || !m_newLines.empty());
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        if(replace) {
+            m_output.lines.clear();
+            m_output.replace = true;
+        }
+        m_output.lines.insert(m_output.lines.end(), m_newLines.begin(), m_newLines.end());
+        while(m_output.lines.size() > m_maxLines) {
+            // the pending lines fill the view on their own
+            m_output.lines.pop_front();
+            m_output.replace = true;
+        }
+        m_output.generation = m_generation;
+        m_output.lastPos = m_lastPos;
+    }
+    m_newLines.clear();
+    if(notify) { m_throttle->Notify(); }
+}
+
+size_t TailReaderThread::GetLines(wxArrayString& lines, size_t& lastPos)
+{
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    lines.clear();
+    lines.reserve(m_lines.size());
+    for(const wxString& line : m_lines) {
+        lines.Add(line.c_str());
+    }
+    // the incomplete last line is read again by the next reader
+    lastPos = m_lastPos - (m_skipLine ? 0 : m_partialLine.length());
+    return m_generation;
+}
+
+void TailReaderThread::TakeOutput(TailOutput& output)
+{
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    output.generation = m_output.generation;
+    output.lastPos = m_output.lastPos;
+    output.replace = m_output.replace;
+    output.lines.swap(m_output.lines);
+    m_output.lines.clear();
+    m_output.replace = false;
+}
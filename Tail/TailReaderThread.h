@@ -0,0 +1,102 @@
+#ifndef TAILREADERTHREAD_H
+#define TAILREADERTHREAD_H
+
+#include "clOutputThrottle.h"
+#include "worker_thread.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class TailOutput
+ * @brief the lines waiting to be displayed by the tail panel
+ */
+class TailOutput
+{
+public:
+    size_t generation = 0;
+    bool replace = false; // clear the view before appending the lines
+    std::deque<wxString> lines;
+    size_t lastPos = 0;
+};
+
+class TailRequest : public ThreadRequest
+{
+public:
+    enum eType { kOpen, kRead, kFilter, kClear, kMaxLines };
+    eType m_type;
+    // kOpen
+    wxString m_file;
+    size_t m_pos = 0;
+    size_t m_generation = 0;
+    wxArrayString m_seedLines;
+    // kFilter
+    wxString m_include;
+    wxString m_exclude;
+    // kMaxLines
+    size_t m_maxLines = 0;
+
+    TailRequest(eType type)
+        : m_type(type)
+    {
+    }
+    virtual ~TailRequest() {}
+};
+
+/**
+ * @class TailReaderThread
+ * @brief reads the new content of the followed file in fixed size chunks, keeps a ring of the last N lines and
+ * applies the include/exclude filter. The lines that should be displayed are accumulated until the panel takes them
+ * (TakeOutput), the throttle decides when
+ */
+class TailReaderThread : public WorkerThread
+{
+    clOutputThrottle* m_throttle;
+    wxFileName m_file;
+    size_t m_lastPos = 0;
+    size_t m_generation = 0;
+    std::string m_partialLine;
+    bool m_skipLine = false;
+    std::deque<wxString> m_lines;
+    size_t m_maxLines;
+    wxString m_include;
+    wxString m_exclude;
+    std::deque<wxString> m_newLines;
+
+    // held while a request is processed, so GetLines() sees the lines and the position of a completed request
+    std::mutex m_stateMutex;
+    std::mutex m_outputMutex;
+    TailOutput m_output;
+
+protected:
+    void DoOpen(TailRequest* req);
+    void DoRead();
+    void DoFilter();
+    void DoProcessChunk(const char* data, size_t len);
+    void DoAddLine(const wxString& line);
+    void DoPost(bool replace);
+    bool IsMatching(const wxString& line) const;
+
+public:
+    TailReaderThread(clOutputThrottle* throttle, size_t maxLines);
+    virtual ~TailReaderThread();
+
+    virtual void ProcessRequest(ThreadRequest* request);
+
+    /**
+     * @brief move the lines waiting to be displayed into 'output'. Called from the UI thread
+     */
+    void TakeOutput(TailOutput& output);
+
+    /**
+     * @brief copy the last lines read from the file (before filtering) and the position of the first byte that is
+     * not part of them. Called from the UI thread
+     * @return the generation of the file the lines belong to
+     */
+    size_t GetLines(wxArrayString& lines, size_t& lastPos);
+};
+
+#endif // TAILREADERTHREAD_H
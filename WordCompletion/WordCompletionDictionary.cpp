@@ -1,20 +1,36 @@
 #include "WordCompletionDictionary.h"
-#include "event_notifier.h"
+#include "WordCompletionSettings.h"
+#include "clWorkspaceManager.h"
 #include "codelite_events.h"
-#include <algorithm>
+#include "event_notifier.h"
+#include "fileextmanager.h"
 #include "globals.h"
 #include "ieditor.h"
 #include "imanager.h"
+#include <algorithm>
 #include <wx/stc/stc.h>
 
+// a larger modification is parsed by the thread, along with the rest of the file
+static const int MAX_LINES_TO_PARSE = 1000;
+
 WordCompletionDictionary::WordCompletionDictionary()
 {
     EventNotifier::Get()->Bind(wxEVT_ACTIVE_EDITOR_CHANGED, &WordCompletionDictionary::OnEditorChanged, this);
     EventNotifier::Get()->Bind(wxEVT_ALL_EDITORS_CLOSED, &WordCompletionDictionary::OnAllEditorsClosed, this);
     EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &WordCompletionDictionary::OnFileSaved, this);
+    EventNotifier::Get()->Bind(wxEVT_EDITOR_MODIFIED, &WordCompletionDictionary::OnEditorModified, this);
+    EventNotifier::Get()->Bind(wxEVT_WORKSPACE_LOADED, &WordCompletionDictionary::OnWorkspaceLoaded, this);
+    EventNotifier::Get()->Bind(wxEVT_WORKSPACE_CLOSED, &WordCompletionDictionary::OnWorkspaceClosed, this);
+
+    WordCompletionSettings settings;
+    settings.Load();
+    m_indexWorkspace = settings.IsIndexWorkspace();
 
     m_thread = new WordCompletionThread(this);
     m_thread->Start();
+
+    // the plugin might be loaded after the workspace
+    DoIndexWorkspace();
 }
 
 WordCompletionDictionary::~WordCompletionDictionary()
@@ -22,6 +38,9 @@ WordCompletionDictionary::~WordCompletionDictionary()
     EventNotifier::Get()->Unbind(wxEVT_ACTIVE_EDITOR_CHANGED, &WordCompletionDictionary::OnEditorChanged, this);
     EventNotifier::Get()->Unbind(wxEVT_ALL_EDITORS_CLOSED, &WordCompletionDictionary::OnAllEditorsClosed, this);
     EventNotifier::Get()->Unbind(wxEVT_FILE_SAVED, &WordCompletionDictionary::OnFileSaved, this);
+    EventNotifier::Get()->Unbind(wxEVT_EDITOR_MODIFIED, &WordCompletionDictionary::OnEditorModified, this);
+    EventNotifier::Get()->Unbind(wxEVT_WORKSPACE_LOADED, &WordCompletionDictionary::OnWorkspaceLoaded, this);
+    EventNotifier::Get()->Unbind(wxEVT_WORKSPACE_CLOSED, &WordCompletionDictionary::OnWorkspaceClosed, this);
 
     m_thread->Stop();   // Stop the thread
     wxDELETE(m_thread); // Delete it
@@ -31,55 +50,45 @@ void WordCompletionDictionary::OnEditorChanged(wxCommandEvent& event)
 {
     event.Skip();
 
-    // 1) Get a list of all open editors and set the compare it to the current cached files
-    //    and delete all "closed" editors
+    // 1) Remove the words of the closed editors
     // 2) Request to cache the newly opened file's words
+    DoRemoveClosedFiles();
+    DoCacheActiveEditor(false);
+}
+
+void WordCompletionDictionary::DoRemoveClosedFiles()
+{
     IEditor::List_t allEditors;
-    wxArrayString openEditors, cachedEditors, closedEditors;
     ::clGetManager()->GetAllEditors(allEditors);
 
-    std::for_each(allEditors.begin(), allEditors.end(), [&](IEditor* editor) {
-        openEditors.Add(editor->GetFileName().GetFullPath());
-    });
-
-    std::for_each(m_files.begin(), m_files.end(), [&](const std::pair<wxString, wxStringSet_t>& p) {
-        cachedEditors.Add(p.first);
-    });
-
-    // std::set_difference requires that both arrays will be sorted
-    openEditors.Sort();
-    cachedEditors.Sort();
+    wxStringSet_t openEditors;
+    std::for_each(allEditors.begin(), allEditors.end(),
+                  [&](IEditor* editor) { openEditors.insert(editor->GetFileName().GetFullPath()); });
 
-    // Create a new array "closedEditors" which contains list of files that exists
-    // in the cachedEditors but not in openEditors list
-    std::set_difference(cachedEditors.begin(),
-                        cachedEditors.end(),
-                        openEditors.begin(),
-                        openEditors.end(),
-                        std::back_inserter(closedEditors));
-
-    for(size_t i = 0; i < closedEditors.size(); ++i) {
-        m_files.erase(closedEditors.Item(i));
+    wxArrayString cachedFiles;
+    m_index.GetFiles(cachedFiles);
+    for(const wxString& filename : cachedFiles) {
+        if(openEditors.count(filename) || m_workspaceFiles.count(filename)) { continue; }
+        m_index.RemoveFile(filename);
+        m_modifiedLines.erase(filename);
     }
-
-    // 2: cache the active editor
-    DoCacheActiveEditor(false);
 }
 
 void WordCompletionDictionary::OnSuggestThread(const WordCompletionThreadReply& reply)
 {
-    // Remove the current file's dictionary
-    std::map<wxString, wxStringSet_t>::iterator iter = m_files.find(reply.filename.GetFullPath());
-    if(iter != m_files.end()) m_files.erase(iter);
-
-    // Keep the words
-    m_files.insert(std::make_pair(reply.filename.GetFullPath(), reply.suggest));
+    wxString filename = reply.filename.GetFullPath();
+    if(reply.workspaceFile) {
+        // the words of an opened editor are more recent than the file on the disk
+        if(!m_workspaceFiles.count(filename) || m_index.HasFile(filename)) { return; }
+    }
+    // Replace the current file's words
+    m_index.SetFileWords(filename, reply.suggest);
 }
 
 void WordCompletionDictionary::OnAllEditorsClosed(wxCommandEvent& event)
 {
     event.Skip();
-    m_files.clear();
+    DoRemoveClosedFiles();
 }
 
 void WordCompletionDictionary::DoCacheActiveEditor(bool overwrite)
@@ -88,23 +97,28 @@ void WordCompletionDictionary::DoCacheActiveEditor(bool overwrite)
     IEditor* activeEditor = ::clGetManager()->GetActiveEditor();
     CHECK_PTR_RET(activeEditor);
 
-    if(!overwrite && m_files.count(activeEditor->GetFileName().GetFullPath()))
+    // Don't copy and scan the text of huge files
+    if(activeEditor->IsLargeFile()) return;
+
+    wxString filename = activeEditor->GetFileName().GetFullPath();
+    if(!overwrite && m_index.HasFile(filename))
         return; // we already have this file in the cache
-        
-    m_files.erase(activeEditor->GetFileName().GetFullPath());
-    
+
     // Insert a dummy entry, so we won't queue this file if not needed
-    m_files.insert(std::make_pair(activeEditor->GetFileName().GetFullPath(), wxStringSet_t()));
-    
+    if(!m_index.HasFile(filename)) { m_index.SetFileWords(filename, wxStringSet_t()); }
+    // the entire file is parsed
+    m_modifiedLines.erase(filename);
+
     // Queue this file
     wxStyledTextCtrl* stc = activeEditor->GetCtrl();
-    
+
     // Invoke the thread to parse and suggets words for this file
     WordCompletionThreadRequest* req = new WordCompletionThreadRequest;
     req->buffer = stc->GetText();
     req->filename = activeEditor->GetFileName();
     req->filter = "filter";
-    m_thread->Add(req);
+    // Don't wait behind the workspace files
+    m_thread->AddPriority(req);
 }
 
 void WordCompletionDictionary::OnFileSaved(clCommandEvent& event)
@@ -113,11 +127,116 @@ void WordCompletionDictionary::OnFileSaved(clCommandEvent& event)
     DoCacheActiveEditor(true);
 }
 
-wxStringSet_t WordCompletionDictionary::GetWords() const
+void WordCompletionDictionary::OnEditorModified(clCommandEvent& event)
 {
+    event.Skip();
+    int line = event.GetLineNumber();
+    int linesAdded = event.GetInt();
+    if(line < 0) { return; }
+
+    int lastLine = line + std::max(0, linesAdded);
+    std::unordered_map<wxString, std::pair<int, int> >::iterator iter = m_modifiedLines.find(event.GetFileName());
+    if(iter == m_modifiedLines.end()) {
+        m_modifiedLines.insert({ event.GetFileName(), { line, lastLine } });
+        return;
+    }
+
+    // Lines added or removed above the modified range move it
+    std::pair<int, int>& range = iter->second;
+    if(linesAdded != 0) {
+        if(range.first > line) { range.first = std::max(line, range.first + linesAdded); }
+        if(range.second > line) { range.second = std::max(line, range.second + linesAdded); }
+    }
+    range.first = std::min(range.first, line);
+    range.second = std::max(range.second, lastLine);
+}
+
+void WordCompletionDictionary::UpdateModifiedLines(IEditor* editor)
+{
+    CHECK_PTR_RET(editor);
+    wxString filename = editor->GetFileName().GetFullPath();
+    std::unordered_map<wxString, std::pair<int, int> >::iterator iter = m_modifiedLines.find(filename);
+    if(iter == m_modifiedLines.end()) { return; }
+    std::pair<int, int> range = iter->second;
+    m_modifiedLines.erase(iter);
+    if(editor->IsLargeFile()) { return; }
+
+    if((range.second - range.first) > MAX_LINES_TO_PARSE) {
+        // Let the thread parse the entire file
+        if(editor == ::clGetManager()->GetActiveEditor()) { DoCacheActiveEditor(true); }
+        return;
+    }
+
+    wxStyledTextCtrl* stc = editor->GetCtrl();
+    int lastLine = std::min(range.second, stc->GetLineCount() - 1);
+    int firstLine = std::min(range.first, lastLine);
+    wxString buffer = stc->GetTextRange(stc->PositionFromLine(firstLine), stc->GetLineEndPosition(lastLine));
+
+    // The words removed from these lines are kept until the next time the file is parsed entirely (e.g. when saved)
     wxStringSet_t words;
-    std::for_each(m_files.begin(), m_files.end(), [&](const std::pair<wxString, wxStringSet_t>& p){
-        words.insert(p.second.begin(), p.second.end());
-    });
-    return words;
+    WordCompletionThread::ParseBuffer(buffer, words);
+    m_index.AddFileWords(filename, words);
+}
+
+void WordCompletionDictionary::FindWords(const wxString& filter, bool prefix, wxStringSet_t& words)
+{
+    m_index.Find(filter, prefix, words);
+}
+
+void WordCompletionDictionary::SetIndexWorkspace(bool indexWorkspace)
+{
+    if(m_indexWorkspace == indexWorkspace) { return; }
+    m_indexWorkspace = indexWorkspace;
+    if(m_indexWorkspace) {
+        DoIndexWorkspace();
+    } else {
+        m_workspaceFiles.clear();
+        DoRemoveClosedFiles();
+    }
+}
+
+void WordCompletionDictionary::OnWorkspaceLoaded(wxCommandEvent& event)
+{
+    event.Skip();
+    DoIndexWorkspace();
+}
+
+void WordCompletionDictionary::OnWorkspaceClosed(wxCommandEvent& event)
+{
+    event.Skip();
+    m_workspaceFiles.clear();
+    DoRemoveClosedFiles();
+}
+
+void WordCompletionDictionary::DoIndexWorkspace()
+{
+    if(!m_indexWorkspace || !clWorkspaceManager::Get().IsWorkspaceOpened()) { return; }
+
+    wxArrayString files;
+    clWorkspaceManager::Get().GetWorkspace()->GetWorkspaceFiles(files);
+    for(const wxString& filename : files) {
+        // Only text files with a known type
+        switch(FileExtManager::GetType(filename)) {
+        case FileExtManager::TypeOther:
+        case FileExtManager::TypeExe:
+        case FileExtManager::TypeArchive:
+        case FileExtManager::TypeDll:
+        case FileExtManager::TypeBmp:
+        case FileExtManager::TypeDatabase:
+            continue;
+        default:
+            break;
+        }
+
+        // Keep the words of this file once its editor is closed
+        m_workspaceFiles.insert(filename);
+        if(m_index.HasFile(filename)) { continue; }
+
+        // The thread reads the file, one request per file: an editor request (added with AddPriority) waits for the
+        // current file only
+        WordCompletionThreadRequest* req = new WordCompletionThreadRequest;
+        req->filename = filename;
+        req->workspaceFile = true;
+        m_thread->Add(req);
+    }
 }
@@ -31,20 +31,33 @@
 #include <wx/event.h>
 #include "WordCompletionThread.h"
 #include "WordCompletionRequestReply.h"
+#include "WordCompletionIndex.h"
 #include "cl_command_event.h"
+#include <unordered_map>
 
+class IEditor;
 class WordCompletionDictionary : public wxEvtHandler
 {
-    std::map<wxString, wxStringSet_t> m_files;
+    WordCompletionIndex m_index;
     WordCompletionThread* m_thread;
+    // the workspace files to index. Their words are kept after their editor is closed
+    wxStringSet_t m_workspaceFiles;
+    // file name : the first and last lines modified since the file words were last updated
+    std::unordered_map<wxString, std::pair<int, int> > m_modifiedLines;
+    bool m_indexWorkspace;
 
 protected:
     void OnEditorChanged(wxCommandEvent& event);
     void OnAllEditorsClosed(wxCommandEvent& event);
     void OnFileSaved(clCommandEvent& event);
+    void OnEditorModified(clCommandEvent& event);
+    void OnWorkspaceLoaded(wxCommandEvent& event);
+    void OnWorkspaceClosed(wxCommandEvent& event);
 
 private:
     void DoCacheActiveEditor(bool overwrite);
+    void DoIndexWorkspace();
+    void DoRemoveClosedFiles();
 
 public:
     WordCompletionDictionary();
@@ -57,9 +70,20 @@ public:
     void OnSuggestThread(const WordCompletionThreadReply& reply);
     
     /**
-     * @brief return a set of words from the current editors
+     * @brief add to the index the words of the lines of 'editor' that were modified since the last call
      */
-    wxStringSet_t GetWords() const;
+    void UpdateModifiedLines(IEditor* editor);
+
+    /**
+     * @brief return the words of the current editors (and the workspace files, if enabled) that start with (or
+     * contain) 'filter'. 'filter' is expected in lower case
+     */
+    void FindWords(const wxString& filter, bool prefix, wxStringSet_t& words);
+
+    /**
+     * @brief enable / disable indexing of all the workspace files
+     */
+    void SetIndexWorkspace(bool indexWorkspace);
 };
 
 #endif // WORDCOMPLETIONDICTIONARY_H
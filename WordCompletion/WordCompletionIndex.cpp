@@ -0,0 +1,176 @@
+#include "WordCompletionIndex.h"
+#include <algorithm>
+#include <iterator>
+
+size_t WordCompletionIndex::Intern(const wxString& word)
+{
+    std::unordered_map<wxString, size_t>::iterator iter = m_wordIds.find(word);
+    if(iter != m_wordIds.end()) {
+        if(m_words[iter->second].refCount == 0) { --m_deadCount; }
+        return iter->second;
+    }
+
+    Word w;
+    w.word = word;
+    w.folded = word.Lower();
+    m_words.push_back(w);
+    size_t id = m_words.size() - 1;
+    m_wordIds.insert({ word, id });
+    m_pending.push_back(id);
+    return id;
+}
+
+void WordCompletionIndex::Release(size_t id)
+{
+    if(--m_words[id].refCount == 0) { ++m_deadCount; }
+}
+
+void WordCompletionIndex::ToIds(const wxStringSet_t& words, std::vector<size_t>& ids)
+{
+    ids.clear();
+    ids.reserve(words.size());
+    for(const wxString& word : words) {
+        ids.push_back(Intern(word));
+    }
+    std::sort(ids.begin(), ids.end());
+}
+
+void WordCompletionIndex::SetFileWords(const wxString& filename, const wxStringSet_t& words)
+{
+    // Add the new words before releasing the old ones, so the words that did not change are not marked as dead
+    std::vector<size_t> ids;
+    ToIds(words, ids);
+    for(size_t id : ids) {
+        ++m_words[id].refCount;
+    }
+
+    std::vector<size_t>& fileIds = m_files[filename];
+    for(size_t id : fileIds) {
+        Release(id);
+    }
+    fileIds.swap(ids);
+    Compact();
+}
+
+void WordCompletionIndex::AddFileWords(const wxString& filename, const wxStringSet_t& words)
+{
+    std::vector<size_t> ids;
+    ToIds(words, ids);
+
+    std::vector<size_t>& fileIds = m_files[filename];
+    std::vector<size_t> newIds;
+    std::set_difference(ids.begin(), ids.end(), fileIds.begin(), fileIds.end(), std::back_inserter(newIds));
+    if(newIds.empty()) { return; }
+
+    for(size_t id : newIds) {
+        ++m_words[id].refCount;
+    }
+    std::vector<size_t> merged;
+    merged.reserve(fileIds.size() + newIds.size());
+    std::merge(fileIds.begin(), fileIds.end(), newIds.begin(), newIds.end(), std::back_inserter(merged));
+    fileIds.swap(merged);
+}
+
+void WordCompletionIndex::RemoveFile(const wxString& filename)
+{
+    std::unordered_map<wxString, std::vector<size_t> >::iterator iter = m_files.find(filename);
+    if(iter == m_files.end()) { return; }
+    for(size_t id : iter->second) {
+        Release(id);
+    }
+    m_files.erase(iter);
+    Compact();
+}
+
+void WordCompletionIndex::GetFiles(wxArrayString& files) const
+{
+    files.reserve(files.size() + m_files.size());
+    for(const auto& p : m_files) {
+        files.Add(p.first);
+    }
+}
+
+void WordCompletionIndex::Clear()
+{
+    m_words.clear();
+    m_wordIds.clear();
+    m_files.clear();
+    m_sorted.clear();
+    m_pending.clear();
+    m_deadCount = 0;
+}
+
+void WordCompletionIndex::Compact()
+{
+    // Words that are no longer used by any file are dropped once they are the majority
+    if(m_deadCount < 1024 || (m_deadCount * 2) < m_words.size()) { return; }
+
+    std::vector<size_t> newIds(m_words.size(), wxString::npos);
+    std::vector<Word> words;
+    words.reserve(m_words.size() - m_deadCount);
+    m_wordIds.clear();
+    for(size_t i = 0; i < m_words.size(); ++i) {
+        if(m_words[i].refCount == 0) { continue; }
+        newIds[i] = words.size();
+        m_wordIds.insert({ m_words[i].word, words.size() });
+        words.push_back(m_words[i]);
+    }
+    m_words.swap(words);
+
+    // the order of the ids is kept, so the files ids remain sorted
+    for(auto& p : m_files) {
+        for(size_t& id : p.second) {
+            id = newIds[id];
+        }
+    }
+
+    std::vector<size_t> sorted;
+    sorted.reserve(m_words.size());
+    for(size_t id : m_sorted) {
+        if(newIds[id] != wxString::npos) { sorted.push_back(newIds[id]); }
+    }
+    m_sorted.swap(sorted);
+
+    std::vector<size_t> pending;
+    for(size_t id : m_pending) {
+        if(newIds[id] != wxString::npos) { pending.push_back(newIds[id]); }
+    }
+    m_pending.swap(pending);
+    m_deadCount = 0;
+}
+
+void WordCompletionIndex::UpdateSorted()
+{
+    if(m_pending.empty()) { return; }
+    auto lessFolded = [&](size_t a, size_t b) { return m_words[a].folded < m_words[b].folded; };
+    std::sort(m_pending.begin(), m_pending.end(), lessFolded);
+
+    std::vector<size_t> merged;
+    merged.reserve(m_sorted.size() + m_pending.size());
+    std::merge(m_sorted.begin(), m_sorted.end(), m_pending.begin(), m_pending.end(), std::back_inserter(merged),
+               lessFolded);
+    m_sorted.swap(merged);
+    m_pending.clear();
+}
+
+void WordCompletionIndex::Find(const wxString& folded, bool prefix, wxStringSet_t& words)
+{
+    UpdateSorted();
+    if(!prefix && !folded.IsEmpty()) {
+        for(size_t id : m_sorted) {
+            const Word& w = m_words[id];
+            if(w.refCount && w.folded.Contains(folded)) { words.insert(w.word); }
+        }
+        return;
+    }
+
+    // All the words that start with 'folded' are grouped together
+    std::vector<size_t>::const_iterator iter =
+        std::lower_bound(m_sorted.begin(), m_sorted.end(), folded,
+                         [&](size_t id, const wxString& key) { return m_words[id].folded < key; });
+    for(; iter != m_sorted.end(); ++iter) {
+        const Word& w = m_words[*iter];
+        if(!w.folded.StartsWith(folded)) { break; }
+        if(w.refCount) { words.insert(w.word); }
+    }
+}
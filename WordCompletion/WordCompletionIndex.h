@@ -0,0 +1,64 @@
+#ifndef WORDCOMPLETIONINDEX_H
+#define WORDCOMPLETIONINDEX_H
+
+#include "macros.h"
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class WordCompletionIndex
+ * @brief the words of a set of files. Each word is stored once, together with its lower case version (the folded
+ * key) and the number of files that contain it. The live words are kept sorted by their folded key, so a prefix
+ * query is a binary search followed by a scan of the matches only
+ */
+class WordCompletionIndex
+{
+    struct Word {
+        wxString word;
+        wxString folded;
+        size_t refCount = 0;
+    };
+
+    std::vector<Word> m_words;
+    std::unordered_map<wxString, size_t> m_wordIds;
+    // file name : the (sorted) ids of its words
+    std::unordered_map<wxString, std::vector<size_t> > m_files;
+    // word ids sorted by their folded key
+    std::vector<size_t> m_sorted;
+    // words that were added since m_sorted was updated
+    std::vector<size_t> m_pending;
+    size_t m_deadCount = 0;
+
+protected:
+    size_t Intern(const wxString& word);
+    void Release(size_t id);
+    void UpdateSorted();
+    void Compact();
+    void ToIds(const wxStringSet_t& words, std::vector<size_t>& ids);
+
+public:
+    WordCompletionIndex() {}
+    ~WordCompletionIndex() {}
+
+    /**
+     * @brief replace the words of 'filename'
+     */
+    void SetFileWords(const wxString& filename, const wxStringSet_t& words);
+    /**
+     * @brief add words to 'filename', keeping its current words
+     */
+    void AddFileWords(const wxString& filename, const wxStringSet_t& words);
+    void RemoveFile(const wxString& filename);
+    bool HasFile(const wxString& filename) const { return m_files.count(filename) != 0; }
+    void GetFiles(wxArrayString& files) const;
+    void Clear();
+
+    /**
+     * @brief add to 'words' all the words whose lower case version starts with 'folded'
+     * (or contains it, when 'prefix' is false)
+     */
+    void Find(const wxString& folded, bool prefix, wxStringSet_t& words);
+};
+
+#endif // WORDCOMPLETIONINDEX_H
@@ -33,6 +33,8 @@ struct WordCompletionThreadRequest : public ThreadRequest {
     wxString filter;
     wxFileName filename;
     bool insertSingleMatch;
+    // a workspace file that is not opened: the thread reads its content from the disk
+    bool workspaceFile = false;
 };
 
 struct WordCompletionThreadReply {
@@ -40,6 +42,7 @@ struct WordCompletionThreadReply {
     wxFileName filename;
     wxString filter;
     bool insertSingleMatch;
+    bool workspaceFile = false;
 };
 
 #endif
@@ -11,6 +11,12 @@ WordCompletionSettingsDlg::WordCompletionSettingsDlg(wxWindow* parent)
     settings.Load();
     m_pgPropComparisonMethod->SetChoiceSelection(settings.GetComparisonMethod());
     m_pgPropEnabled->SetValue(settings.IsEnabled());
+    m_pgPropIndexWorkspace =
+        m_pgMgr->Append(new wxBoolProperty(_("Index Workspace Files"), wxPG_LABEL, settings.IsIndexWorkspace()));
+    m_pgPropIndexWorkspace->SetHelpString(
+        _("Suggest the words of all the workspace files, not only the words of the opened editors.
+The files are "
+          "scanned in the background when the workspace is loaded"));
     SetName("WordCompletionSettingsDlg");
     WindowAttrManager::Load(this);
 }
@@ -30,6 +36,7 @@ void WordCompletionSettingsDlg::OnOk(wxCommandEvent& event)
     settings.Load();
     settings.SetComparisonMethod(m_pgPropComparisonMethod->GetChoiceSelection());
     settings.SetEnabled(m_pgPropEnabled->GetValue().GetBool());
+    settings.SetIndexWorkspace(m_pgPropIndexWorkspace->GetValue().GetBool());
     settings.Save();
     EndModal(wxID_OK);
 }
@@ -30,6 +30,8 @@
 class WordCompletionSettingsDlg : public WordCompletionSettingsBaseDlg
 {
     bool m_modified;
+    wxPGProperty* m_pgPropIndexWorkspace;
+
 public:
     WordCompletionSettingsDlg(wxWindow* parent);
     virtual ~WordCompletionSettingsDlg();
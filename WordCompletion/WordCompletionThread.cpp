@@ -4,6 +4,10 @@
 #include "WordCompletionSettings.h"
 #include "WordCompletionDictionary.h"
 #include "WordTokenizerAPI.h"
+#include "fileutils.h"
+
+// workspace files larger than this are not indexed
+static const wxULongLong MAX_WORKSPACE_FILE_SIZE = 2 * 1024 * 1024;
 
 WordCompletionThread::WordCompletionThread(WordCompletionDictionary* dict)
     : m_dict(dict)
@@ -17,13 +21,22 @@ void WordCompletionThread::ProcessRequest(ThreadRequest* request)
     CHECK_PTR_RET(req);
 
     wxStringSet_t suggestsions;
-    ParseBuffer(req->buffer, suggestsions);
+    if(req->workspaceFile) {
+        // Skip huge files (e.g. generated sources or data files)
+        if(req->filename.GetSize() > MAX_WORKSPACE_FILE_SIZE) { return; }
+        wxString content;
+        if(!FileUtils::ReadFileContent(req->filename, content)) { return; }
+        ParseBuffer(content, suggestsions);
+    } else {
+        ParseBuffer(req->buffer, suggestsions);
+    }
 
     // Parse and send back the reply
     WordCompletionThreadReply reply;
     reply.filename = req->filename;
     reply.filter = req->filter;
     reply.insertSingleMatch = req->insertSingleMatch;
+    reply.workspaceFile = req->workspaceFile;
     reply.suggest.swap(suggestsions);
     m_dict->CallAfter(&WordCompletionDictionary::OnSuggestThread, reply);
 }
@@ -56,6 +56,7 @@ WordCompletionPlugin::WordCompletionPlugin(IManager* manager)
     m_shortName = wxT("Word Completion");
 
     wxTheApp->Bind(wxEVT_MENU, &WordCompletionPlugin::OnSettings, this, XRCID("text_word_complete_settings"));
+    m_settings.Load();
     m_dictionary = new WordCompletionDictionary();
     m_completer = new WordCompleter(this);
 }
@@ -85,11 +86,8 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
     IEditor* activeEditor = dynamic_cast<IEditor*>(event.GetEditor());
     CHECK_PTR_RET(activeEditor);
 
-    WordCompletionSettings settings;
-    settings.Load();
-
     // Enabled?
-    if(!settings.IsEnabled()) { return; }
+    if(!m_settings.IsEnabled()) { return; }
 
     // Build the suggetsion list
     static wxBitmap sBmp = wxNullBitmap;
@@ -103,22 +101,12 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
 
     wxString filter = event.GetWord().Lower(); // stc->GetTextRange(start, curPos);
 
-    wxStringSet_t words = m_dictionary->GetWords();
-    // Parse the current bufer (if modified), to include non saved words
-    if(activeEditor->IsModified()) {
-        // For performance (this parsing is done in the main thread)
-        // only parse the visible area of the document
-        wxStringSet_t unsavedBufferWords;
-        wxStyledTextCtrl* stc = activeEditor->GetCtrl();
-        int startPos = stc->PositionFromLine(stc->GetFirstVisibleLine());
-        int endPos = stc->GetCurrentPos();
-
-        wxString buffer = stc->GetTextRange(startPos, endPos);
-        WordCompletionThread::ParseBuffer(buffer, unsavedBufferWords);
-
-        // Merge the results
-        words.insert(unsavedBufferWords.begin(), unsavedBufferWords.end());
-    }
+    bool startsWith = (m_settings.GetComparisonMethod() == WordCompletionSettings::kComparisonStartsWith);
+
+    // Include the words of the lines modified since the editor was last parsed
+    m_dictionary->UpdateModifiedLines(activeEditor);
+    wxStringSet_t words;
+    m_dictionary->FindWords(filter, startsWith, words);
 
     // Get the editor keywords and add them
     LexerConf::Ptr_t lexer = ColoursAndFontsManager::Get().GetLexerForFile(activeEditor->GetFileName().GetFullName());
@@ -127,8 +115,15 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
         for(size_t i = 0; i < wxSTC_KEYWORDSET_MAX; ++i) {
             keywords << lexer->GetKeyWords(i) << " ";
         }
-        wxArrayString langWords = ::wxStringTokenize(keywords, "\n\t \r", wxTOKEN_STRTOK);
-        words.insert(langWords.begin(), langWords.end());
+        LexerKeywords& lexerKeywords = m_lexerKeywords[lexer->GetName()];
+        if(lexerKeywords.keywords != keywords) {
+            // the keywords were changed (or this is the first time), index them again
+            wxArrayString langWords = ::wxStringTokenize(keywords, "\n\t \r", wxTOKEN_STRTOK);
+            lexerKeywords.keywords = keywords;
+            lexerKeywords.index.Clear();
+            lexerKeywords.index.SetFileWords(lexer->GetName(), wxStringSet_t(langWords.begin(), langWords.end()));
+        }
+        lexerKeywords.index.Find(filter, startsWith, words);
     }
 
     wxStringSet_t filterdSet;
@@ -136,13 +131,7 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
         filterdSet.swap(words);
     } else {
         for(wxStringSet_t::iterator iter = words.begin(); iter != words.end(); ++iter) {
-            wxString word = *iter;
-            wxString lcWord = word.Lower();
-            if(settings.GetComparisonMethod() == WordCompletionSettings::kComparisonStartsWith) {
-                if(lcWord.StartsWith(filter) && filter != word) { filterdSet.insert(word); }
-            } else {
-                if(lcWord.Contains(filter) && filter != word) { filterdSet.insert(word); }
-            }
+            if(filter != *iter) { filterdSet.insert(*iter); }
         }
     }
     wxCodeCompletionBoxEntry::Vec_t entries;
@@ -155,5 +144,8 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
 void WordCompletionPlugin::OnSettings(wxCommandEvent& event)
 {
     WordCompletionSettingsDlg dlg(EventNotifier::Get()->TopFrame());
-    dlg.ShowModal();
+    if(dlg.ShowModal() == wxID_OK) {
+        m_settings.Load();
+        m_dictionary->SetIndexWorkspace(m_settings.IsIndexWorkspace());
+    }
 }
@@ -32,6 +32,9 @@
 #include "cl_command_event.h"
 #include "macros.h"
 #include "ServiceProvider.h"
+#include "WordCompletionIndex.h"
+#include "WordCompletionSettings.h"
+#include <unordered_map>
 
 class WordCompletionDictionary;
 class WordCompletionPlugin;
@@ -51,6 +54,15 @@ class WordCompletionPlugin : public IPlugin
 {
     WordCompletionDictionary* m_dictionary = nullptr;
     WordCompleter* m_completer = nullptr;
+    WordCompletionSettings m_settings;
+
+    // the keywords of a lexer, indexed once
+    struct LexerKeywords {
+        wxString keywords;
+        WordCompletionIndex index;
+    };
+    // lexer name : its keywords
+    std::unordered_map<wxString, LexerKeywords> m_lexerKeywords;
     friend class WordCompleter;
 
 public:
@@ -220,7 +220,6 @@ void ZoomNavigator::SetZoomTextScrollPosToMiddle(wxStyledTextCtrl* stc)
     if(first < 0) first = 0;
 
     m_text->SetFirstVisibleLine(first);
-    m_text->ClearSelections();
 }
 
 void ZoomNavigator::PatchUpHighlights(const int first, const int last)
@@ -328,7 +327,6 @@ void ZoomNavigator::OnInitDone(wxCommandEvent& e)
 {
     e.Skip();
     m_startupCompleted = true;
-    m_text->Startup();
 }
 
 void ZoomNavigator::OnIdle(wxIdleEvent& e)
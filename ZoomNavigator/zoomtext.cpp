@@ -44,10 +44,12 @@
 #include "plugin.h"
 #include "macros.h"
 #include "globals.h"
+#include "drawingutils.h"
 #include <wx/app.h>
 
 ZoomText::ZoomText(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wxSize& size, long style,
                    const wxString& name)
+    : m_document(NULL)
 {
     Hide();
     if(!wxStyledTextCtrl::Create(parent, id, pos, size, style | wxNO_BORDER, name)) {
@@ -66,7 +68,16 @@ ZoomText::ZoomText(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wx
     SetEditable(false);
     SetUseHorizontalScrollBar(false);
     SetUseVerticalScrollBar(data.IsUseScrollbar());
-    HideSelection(true);
+    SetCaretWidth(0);
+
+    // The document is shared with the editor, so SetReadOnly() can't be used to protect it
+    CmdKeyClearAll();
+    UsePopUp(false);
+    SetDropTarget(NULL);
+    Bind(wxEVT_CHAR, &ZoomText::OnBlockInput, this);
+    Bind(wxEVT_KEY_DOWN, &ZoomText::OnBlockInput, this);
+    Bind(wxEVT_MIDDLE_DOWN, &ZoomText::OnBlockInput, this);
+    Bind(wxEVT_MIDDLE_UP, &ZoomText::OnBlockInput, this);
 
     SetMarginWidth(1, 0);
     SetMarginWidth(2, 0);
@@ -76,20 +87,17 @@ ZoomText::ZoomText(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wx
     m_colour = data.GetHighlightColour();
     MarkerSetBackground(1, m_colour);
     SetZoom(m_zoomFactor);
+    SetSelBackground(true, m_colour);
+    SetSelAlpha(10);
     EventNotifier::Get()->Connect(wxEVT_ZN_SETTINGS_UPDATED, wxCommandEventHandler(ZoomText::OnSettingsChanged), NULL,
                                   this);
     EventNotifier::Get()->Connect(wxEVT_CL_THEME_CHANGED, wxCommandEventHandler(ZoomText::OnThemeChanged), NULL, this);
-    MarkerDefine(1, wxSTC_MARK_BACKGROUND, m_colour, m_colour);
 
 #ifndef __WXMSW__
     SetTwoPhaseDraw(false);
     SetBufferedDraw(false);
     SetLayoutCache(wxSTC_CACHE_DOCUMENT);
 #endif
-    MarkerSetAlpha(1, 10);
-
-    m_timer = new wxTimer(this);
-    Bind(wxEVT_TIMER, &ZoomText::OnTimer, this, m_timer->GetId());
     Show();
 }
 
@@ -99,12 +107,10 @@ ZoomText::~ZoomText()
                                      NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_CL_THEME_CHANGED, wxCommandEventHandler(ZoomText::OnThemeChanged), NULL,
                                      this);
-    Unbind(wxEVT_TIMER, &ZoomText::OnTimer, this, m_timer->GetId());
-
-    if(m_timer->IsRunning()) {
-        m_timer->Stop();
-    }
-    wxDELETE(m_timer);
+    Unbind(wxEVT_CHAR, &ZoomText::OnBlockInput, this);
+    Unbind(wxEVT_KEY_DOWN, &ZoomText::OnBlockInput, this);
+    Unbind(wxEVT_MIDDLE_DOWN, &ZoomText::OnBlockInput, this);
+    Unbind(wxEVT_MIDDLE_UP, &ZoomText::OnBlockInput, this);
 }
 
 void ZoomText::UpdateLexer(IEditor* editor)
@@ -121,25 +127,25 @@ void ZoomText::UpdateLexer(IEditor* editor)
     clConfig conf("zoom-navigator.conf");
     conf.ReadItem(&data);
 
-    m_filename = editor->GetFileName().GetFullPath();
-    LexerConf::Ptr_t lexer = EditorConfigST::Get()->GetLexerForFile(m_filename);
-    if(!lexer) {
-        lexer = EditorConfigST::Get()->GetLexer("Text");
-    }
-    lexer->Apply(this, true);
-
-    if(lexer->IsDark()) {
-        MarkerSetAlpha(1, 10);
-    } else {
-        MarkerSetAlpha(1, 20);
-    }
+    // Don't apply the lexer: the lexer and its keywords belong to the editor's document. Only the styles are
+    // kept by the view
+    DoSyncStyles(editor->GetCtrl());
+    SetSelAlpha(DrawingUtils::IsDark(StyleGetBackground(0)) ? 10 : 20);
 
     SetZoom(m_zoomFactor);
-    SetEditable(false);
     SetUseHorizontalScrollBar(false);
     SetUseVerticalScrollBar(data.IsUseScrollbar());
-    HideSelection(true);
-    MarkerSetBackground(1, m_colour);
+    SetSelBackground(true, m_colour);
+}
+
+void ZoomText::DoSyncStyles(wxStyledTextCtrl* stc)
+{
+    for(int i = 0; i < wxSTC_STYLE_MAX; ++i) {
+        StyleSetFont(i, stc->StyleGetFont(i));
+        StyleSetForeground(i, stc->StyleGetForeground(i));
+        StyleSetBackground(i, stc->StyleGetBackground(i));
+        StyleSetEOLFilled(i, stc->StyleGetEOLFilled(i));
+    }
 }
 
 void ZoomText::OnSettingsChanged(wxCommandEvent& e)
@@ -150,9 +156,8 @@ void ZoomText::OnSettingsChanged(wxCommandEvent& e)
     if(conf.ReadItem(&data)) {
         m_zoomFactor = data.GetZoomFactor();
         m_colour = data.GetHighlightColour();
-        MarkerSetBackground(1, m_colour);
+        SetSelBackground(true, m_colour);
         SetZoom(m_zoomFactor);
-        Colourise(0, wxSTC_INVALID_POSITION);
     }
 }
 
@@ -161,11 +166,11 @@ void ZoomText::UpdateText(IEditor* editor)
     if(!editor) {
         DoClear();
 
-    } else {
-        SetReadOnly(false);
-        SetText(editor->GetEditorText());
-        SetReadOnly(true);
-        SetCurrentPos(editor->GetCurrentPosition());
+    } else if(editor->GetCtrl()->GetDocPointer() != m_document) {
+        // Attach to the editor's document. Scintilla keeps a reference to it, so it remains valid even if the
+        // editor is closed before we move to another one
+        m_document = editor->GetCtrl()->GetDocPointer();
+        SetDocPointer(m_document);
     }
 }
 
@@ -179,49 +184,28 @@ void ZoomText::HighlightLines(int start, int end)
         if(start < 0) start = 0;
     }
 
-    MarkerDeleteAll(1);
-    for(int i = start; i <= end; ++i) {
-        MarkerAdd(i, 1);
-    }
+    // Unlike SetSelection(), these don't scroll the view
+    SetCurrentPos(GetLineEndPosition(end));
+    SetAnchor(PositionFromLine(start));
 }
 
 void ZoomText::OnThemeChanged(wxCommandEvent& e)
 {
     e.Skip();
-    UpdateLexer(NULL);
+    // the styles are copied from the editor, let it apply the new theme first
+    CallAfter(&ZoomText::UpdateLexer, (IEditor*)NULL);
 }
 
-void ZoomText::OnTimer(wxTimerEvent& event)
+void ZoomText::OnBlockInput(wxEvent& event)
 {
-    // sanity
-    if(!m_classes.IsEmpty() || IsEmpty()) {
-        m_timer->Start(1000, true);
-        return;
-    }
-
-    IEditor* editor = clGetManager()->GetActiveEditor();
-    if(!editor) {
-        m_timer->Start(1000, true);
-        return;
-    }
-
-    if(m_classes.IsEmpty() && !editor->GetKeywordClasses().IsEmpty() &&
-       (editor->GetFileName().GetFullPath() == m_filename)) {
-        // Sync between the keywords
-        SetKeyWords(1, editor->GetKeywordClasses()); // classes
-        SetKeyWords(3, editor->GetKeywordLocals());  // locals
-        Colourise(0, GetLength());
-    }
-    m_timer->Start(1000, true);
+    // Don't skip the event: the document belongs to the editor
+    wxUnusedVar(event);
 }
 
 void ZoomText::DoClear()
 {
-    m_classes.clear();
-    m_locals.clear();
-    SetReadOnly(false);
-    SetText("");
-    SetReadOnly(true);
+    // Release the editor's document, Scintilla creates a new (empty) one for us
+    m_document = NULL;
+    SetDocPointer(NULL);
+    SetEditable(false);
 }
-
-void ZoomText::Startup() { m_timer->Start(1000, true); }
@@ -36,20 +36,25 @@
 #include <wx/stc/stc.h>
 #include "ieditor.h"
 
+/**
+ * @class ZoomText
+ * @brief a zoomed out view of the active editor. The view shares the editor's document (text, styling, lexer and
+ * keywords are all kept by the document), so switching editors does not copy or colourise the text again.
+ * Since the markers and the read-only flag are also kept by the document, the visible lines are highlighted
+ * with this view's selection and the user input is blocked by the view itself
+ */
 class ZoomText : public wxStyledTextCtrl
 {
     int m_zoomFactor;
     wxColour m_colour;
-    wxString m_filename;
-    wxString m_classes;
-    wxString m_locals;
-    wxTimer* m_timer;
-    
+    void* m_document;
+
 protected:
     void OnThemeChanged(wxCommandEvent& e);
-    void OnTimer(wxTimerEvent& event);
+    void OnBlockInput(wxEvent& event);
     void DoClear();
-    
+    void DoSyncStyles(wxStyledTextCtrl* stc);
+
 public:
     ZoomText(wxWindow* parent,
              wxWindowID id = wxID_ANY,
@@ -62,8 +67,6 @@ public:
     void OnSettingsChanged(wxCommandEvent& e);
     void UpdateText(IEditor* editor);
     void HighlightLines(int start, int end);
-    
-    void Startup();
 };
 
 #endif // ZOOM_NAV_TEXT
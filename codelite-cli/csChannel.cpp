@@ -0,0 +1,83 @@
+#include "JSON.h"
+#include "csChannel.h"
+#include "file_logger.h"
+#include <iostream>
+
+csChannel::csChannel()
+    : m_completed(false)
+{
+    m_stopWatch.Start();
+}
+
+csChannel::~csChannel() {}
+
+void csChannel::Write(const wxString& output, bool partial)
+{
+    if(m_completed) { return; }
+    DoWrite(output, partial);
+}
+
+void csChannel::Complete(const wxString& errorMessage)
+{
+    if(m_completed) { return; }
+    m_completed = true;
+    DoComplete(errorMessage);
+}
+
+void csStdoutChannel::DoWrite(const wxString& output, bool partial)
+{
+    wxUnusedVar(partial);
+    std::cout << output << std::endl;
+}
+
+void csStdoutChannel::DoComplete(const wxString& errorMessage)
+{
+    if(!errorMessage.IsEmpty()) { clERROR() << errorMessage; }
+    clDEBUG() << "Command completed in" << GetElapsedTime() << "ms";
+}
+
+csSocketChannel::csSocketChannel(clSocketBase::Ptr_t socket, const wxString& requestId)
+    : m_socket(socket)
+    , m_requestId(requestId)
+    , m_closed(false)
+{
+}
+
+csSocketChannel::~csSocketChannel() {}
+
+void csSocketChannel::DoWrite(const wxString& output, bool partial) { DoSend(partial ? "partial" : "result", output); }
+
+void csSocketChannel::DoComplete(const wxString& errorMessage)
+{
+    if(errorMessage.IsEmpty()) {
+        DoSend("done", "");
+    } else {
+        JSON error(cJSON_Object);
+        error.toElement().addProperty("message", errorMessage);
+        DoSend("error", error.toElement().format(false));
+    }
+    clDEBUG() << "Request" << m_requestId << "completed in" << GetElapsedTime() << "ms";
+}
+
+void csSocketChannel::DoSend(const wxString& status, const wxString& output)
+{
+    if(m_closed) { return; }
+
+    JSON envelope(cJSON_Object);
+    envelope.toElement().addProperty("id", m_requestId);
+    envelope.toElement().addProperty("status", status);
+    envelope.toElement().addProperty("elapsed", GetElapsedTime());
+    wxString message = envelope.toElement().format(false);
+    if(!output.IsEmpty()) {
+        // The output is already a JSON string, don't parse it again just to add it to the envelope
+        message.RemoveLast();
+        message << ",\"result\":" << output << "}";
+    }
+    try {
+        m_socket->WriteMessage(message);
+    } catch(clSocketException& e) {
+        // the client went away, drop the rest of the output
+        clDEBUG() << "Failed to send reply for request" << m_requestId << ":" << wxString(e.what());
+        m_closed = true;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef CSCHANNEL_H
+#define CSCHANNEL_H
+
+#include "SocketAPI/clSocketBase.h"
+#include <wx/sharedptr.h>
+#include <wx/stopwatch.h>
+#include <wx/string.h>
+
+/**
+ * @class csChannel
+ * @brief where the output of a single command goes. Every message is expected to be a valid JSON string
+ */
+class csChannel
+{
+protected:
+    bool m_completed;
+    wxStopWatch m_stopWatch;
+
+protected:
+    virtual void DoWrite(const wxString& output, bool partial) = 0;
+    virtual void DoComplete(const wxString& errorMessage) = 0;
+
+public:
+    typedef wxSharedPtr<csChannel> Ptr_t;
+
+    csChannel();
+    virtual ~csChannel();
+
+    /**
+     * @brief does this channel want the results as soon as they are found? (otherwise the handler should output
+     * them all at once)
+     */
+    virtual bool IsStreaming() const = 0;
+
+    /**
+     * @brief write the result of the command (or part of it, if 'partial' is true)
+     */
+    void Write(const wxString& output, bool partial = false);
+    /**
+     * @brief the command is done. Only the first call has an effect
+     */
+    void Complete(const wxString& errorMessage = "");
+    bool IsCompleted() const { return m_completed; }
+    /**
+     * @brief the time since the command was received, in milliseconds
+     */
+    long GetElapsedTime() const { return m_stopWatch.Time(); }
+};
+
+/**
+ * @class csStdoutChannel
+ * @brief the output of a one shot command, printed as is
+ */
+class csStdoutChannel : public csChannel
+{
+protected:
+    virtual void DoWrite(const wxString& output, bool partial);
+    virtual void DoComplete(const wxString& errorMessage);
+
+public:
+    csStdoutChannel() {}
+    virtual ~csStdoutChannel() {}
+    virtual bool IsStreaming() const { return false; }
+};
+
+/**
+ * @class csSocketChannel
+ * @brief the output of a command received by the daemon. Every write is sent to the client as a separate message:
+ * {"id": <request id>, "status": "partial" | "result" | "done" | "error", "elapsed": <ms>, "result": <output>}
+ * so a client can send several requests on the same connection and match the replies
+ */
+class csSocketChannel : public csChannel
+{
+    clSocketBase::Ptr_t m_socket;
+    wxString m_requestId;
+    bool m_closed;
+
+protected:
+    virtual void DoWrite(const wxString& output, bool partial);
+    virtual void DoComplete(const wxString& errorMessage);
+    void DoSend(const wxString& status, const wxString& output);
+
+public:
+    csSocketChannel(clSocketBase::Ptr_t socket, const wxString& requestId);
+    virtual ~csSocketChannel();
+    virtual bool IsStreaming() const { return true; }
+};
+
+#endif // CSCHANNEL_H
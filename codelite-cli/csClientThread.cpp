@@ -0,0 +1,33 @@
+#include "csClientThread.h"
+#include "csManager.h"
+#include "file_logger.h"
+
+csClientThread::csClientThread(csManager* manager, clSocketBase::Ptr_t socket)
+    : csJoinableThread(manager)
+    , m_sink(manager)
+    , m_socket(socket)
+{
+}
+
+csClientThread::~csClientThread() {}
+
+void* csClientThread::Entry()
+{
+    clDEBUG() << "Client thread started";
+    while(!TestDestroy()) {
+        wxString message;
+        try {
+            int rc = m_socket->ReadMessage(message, 1);
+            if(rc == clSocketBase::kTimeout) { continue; }
+            if(rc != clSocketBase::kSuccess) { break; }
+        } catch(clSocketException& e) {
+            clDEBUG() << "Client disconnected:" << wxString(e.what());
+            break;
+        }
+        m_sink->CallAfter(&csManager::OnClientRequest, m_socket, message);
+    }
+    // Let the manager delete us
+    NotifyGoingDown();
+    clDEBUG() << "Client thread is going down";
+    return NULL;
+}
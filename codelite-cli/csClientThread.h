@@ -0,0 +1,26 @@
+#ifndef CSCLIENTTHREAD_H
+#define CSCLIENTTHREAD_H
+
+#include "SocketAPI/clSocketBase.h"
+#include "csJoinableThread.h"
+
+class csManager;
+/**
+ * @class csClientThread
+ * @brief reads the requests sent by a single client of the daemon and pass them to the manager. The replies are
+ * written by the manager (see csSocketChannel), so a slow request does not stop us from reading the next ones
+ */
+class csClientThread : public csJoinableThread
+{
+    csManager* m_sink;
+    clSocketBase::Ptr_t m_socket;
+
+protected:
+    void* Entry();
+
+public:
+    csClientThread(csManager* manager, clSocketBase::Ptr_t socket);
+    virtual ~csClientThread();
+};
+
+#endif // CSCLIENTTHREAD_H
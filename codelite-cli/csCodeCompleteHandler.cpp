@@ -19,7 +19,10 @@ void csCodeCompleteHandler::DoProcessCommand(const JSONItem& options)
     csCommandHandlerBase::Ptr_t handler = m_codeCompleteHandlers.FindHandler(handlerName);
     if(!handler) {
         clERROR() << "I have no handler for:" << handlerName;
+        NotifyCompletion("Unsupported command: " + handlerName);
         return;
     }
-    handler->DoProcessCommand(options);
+    // the handler notifies the completion itself
+    SetNotifyCompletion(false);
+    handler->Process(options, m_channel);
 }
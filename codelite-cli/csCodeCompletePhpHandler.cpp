@@ -13,23 +13,25 @@ csCodeCompletePhpHandler::~csCodeCompletePhpHandler() {}
 
 void csCodeCompletePhpHandler::DoProcessCommand(const JSONItem& options)
 {
+    m_unsavedBufferPath.Clear();
     CHECK_STR_PARAM("path", m_path);
     CHECK_STR_PARAM_OPTIONAL("unsaved-buffer-path", m_unsavedBufferPath);
     CHECK_INT_PARAM("position", m_position);
     CHECK_STR_PARAM("symbols-path", m_symbolsPath);
 
     // Guess the symbols db path
-    PHPLookupTable lookup;
     if(wxFileName::DirExists(m_symbolsPath)) {
         // the provided path is the folder, build the symbols path
         m_symbolsPath << wxFileName::GetPathSeparator() << ".codelite" << wxFileName::GetPathSeparator()
                       << "phpsymbols.db";
     }
     clDEBUG() << "Using symbols db:" << m_symbolsPath;
-    lookup.Open(wxFileName(m_symbolsPath));
-    if(!lookup.IsOpened()) {
+    wxSharedPtr<PHPLookupTable> table = m_manager->GetPHPLookupTable(m_symbolsPath);
+    if(!table) {
+        NotifyCompletion("Could not open symbols db: " + m_symbolsPath);
         return;
     }
+    PHPLookupTable& lookup = *table;
 
     PHPSourceFile sourceFile(wxFileName(m_unsavedBufferPath.IsEmpty() ? m_path : m_unsavedBufferPath), &lookup);
     sourceFile.SetFilename(m_path); // update the file name to the real path
@@ -46,10 +48,10 @@ void csCodeCompletePhpHandler::DoProcessCommand(const JSONItem& options)
         JSONItem arr = root.toElement();
         std::for_each(matches.begin(), matches.end(), [&](PHPEntityBase::Ptr_t e) { arr.arrayAppend(e->ToJSON()); });
         char* result = arr.FormatRawString(m_manager->GetConfig().IsPrettyJSON());
-        std::cout << result << std::endl;
+        m_channel->Write(result);
         free(result);
 
     } else {
-        std::cout << "[]" << std::endl;
+        m_channel->Write("[]");
     }
 }
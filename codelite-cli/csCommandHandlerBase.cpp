@@ -10,17 +10,22 @@ csCommandHandlerBase::csCommandHandlerBase(csManager* manager)
 
 csCommandHandlerBase::~csCommandHandlerBase() {}
 
-void csCommandHandlerBase::NotifyCompletion()
+void csCommandHandlerBase::NotifyCompletion(const wxString& errorMessage)
 {
+    if(m_channel) { m_channel->Complete(errorMessage); }
     clCommandEvent e(wxEVT_COMMAND_PROCESSED);
     m_manager->AddPendingEvent(e);
 }
 
-void csCommandHandlerBase::Process(const JSONItem& options)
+void csCommandHandlerBase::Process(const JSONItem& options, csChannel::Ptr_t channel)
 {
+    // The handler is used for all the requests of the daemon, reset the state left by the previous one
+    m_channel = channel;
+    m_notifyOnExit = true;
     DoProcessCommand(options);
     if(m_notifyOnExit) {
         // Make sure we call 'NotifyCompletion' here if needed
         NotifyCompletion();
     }
+    m_channel.reset();
 }
@@ -3,6 +3,7 @@
 
 #include "file_logger.h"
 #include "JSON.h"
+#include "csChannel.h"
 #include <cl_command_event.h>
 #include <wx/event.h>
 #include <wx/sharedptr.h>
@@ -11,36 +12,36 @@
 class csManager;
 wxDECLARE_EVENT(wxEVT_COMMAND_PROCESSED, clCommandEvent);
 
-#define CHECK_STR_PARAM(str_option, sVal)                       \
-    if(!options.hasNamedObject(str_option)) {                   \
-        clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
-        return;                                                 \
-    }                                                           \
+#define CHECK_STR_PARAM(str_option, sVal)                            \
+    if(!options.hasNamedObject(str_option)) {                        \
+        clERROR() << "Command is missing field:" << str_option;      \
+        NotifyCompletion(wxString("Missing field: ") << str_option); \
+        return;                                                      \
+    }                                                                \
     sVal = options.namedObject(str_option).toString();
 
-#define CHECK_INT_PARAM(str_option, iVal)                       \
-    if(!options.hasNamedObject(str_option)) {                   \
-        clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
-        return;                                                 \
-    }                                                           \
+#define CHECK_INT_PARAM(str_option, iVal)                            \
+    if(!options.hasNamedObject(str_option)) {                        \
+        clERROR() << "Command is missing field:" << str_option;      \
+        NotifyCompletion(wxString("Missing field: ") << str_option); \
+        return;                                                      \
+    }                                                                \
     iVal = options.namedObject(str_option).toInt();
 
-#define CHECK_BOOL_PARAM(str_option, bVal)                      \
-    if(!options.hasNamedObject(str_option)) {                   \
-        clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
-        return;                                                 \
-    }                                                           \
+#define CHECK_BOOL_PARAM(str_option, bVal)                           \
+    if(!options.hasNamedObject(str_option)) {                        \
+        clERROR() << "Command is missing field:" << str_option;      \
+        NotifyCompletion(wxString("Missing field: ") << str_option); \
+        return;                                                      \
+    }                                                                \
     bVal = options.namedObject(str_option).toBool();
 
-#define CHECK_ARRSTR_PARAM(str_option, arrVal)                  \
-    if(!options.hasNamedObject(str_option)) {                   \
-        clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
-        return;                                                 \
-    }                                                           \
+#define CHECK_ARRSTR_PARAM(str_option, arrVal)                       \
+    if(!options.hasNamedObject(str_option)) {                        \
+        clERROR() << "Command is missing field:" << str_option;      \
+        NotifyCompletion(wxString("Missing field: ") << str_option); \
+        return;                                                      \
+    }                                                                \
     arrVal = options.namedObject(str_option).toArrayString();
 
 #define CHECK_STR_PARAM_OPTIONAL(str_option, sVal) \
@@ -60,12 +61,16 @@ class csCommandHandlerBase
 protected:
     csManager* m_manager;
     bool m_notifyOnExit;
+    csChannel::Ptr_t m_channel;
 
 public:
     typedef wxSharedPtr<csCommandHandlerBase> Ptr_t;
 
 protected:
-    void NotifyCompletion();
+    /**
+     * @brief the command is done. A non empty 'errorMessage' is reported to the client as the command's result
+     */
+    void NotifyCompletion(const wxString& errorMessage = "");
     void SetNotifyCompletion(bool b) { m_notifyOnExit = b; }
 
 public:
@@ -82,10 +87,10 @@ public:
     csManager* GetSink() { return m_manager; }
 
     /**
-     * @brief process a request from the command line and print the result to the stdout
+     * @brief process a request and write the result to 'channel'
      * @param the handler options
      */
-    void Process(const JSONItem& options);
+    void Process(const JSONItem& options, csChannel::Ptr_t channel);
 };
 
 #endif // CSCOMMANDHANDLERBASE_H
@@ -19,6 +19,8 @@ void csConfig::Load()
     clDEBUG() << "command =" << m_command;
     ini.Read("options", &m_options, "");
     clDEBUG() << "options =" << m_options;
+    ini.Read("connection_string", &m_connectionString, "");
+    clDEBUG() << "connection_string =" << m_connectionString;
     bool pretty_json = false;
     ini.Read("pretty_json", &pretty_json);
     EnableFlag(kPrettyJSON, pretty_json);
@@ -7,6 +7,7 @@ class csConfig
 {
     wxString m_command;
     wxString m_options;
+    wxString m_connectionString;
     size_t m_flags;
 
 public:
@@ -34,6 +35,11 @@ public:
     void SetOptions(const wxString& options) { this->m_options = options; }
     const wxString& GetCommand() const { return m_command; }
     const wxString& GetOptions() const { return m_options; }
+    void SetConnectionString(const wxString& connectionString) { this->m_connectionString = connectionString; }
+    /**
+     * @brief the address the daemon listens on, e.g. "unix:///tmp/codelite-cli.sock" or "tcp://127.0.0.1:5555"
+     */
+    const wxString& GetConnectionString() const { return m_connectionString; }
     void SetPrettyJSON(bool b) { EnableFlag(kPrettyJSON, b); }
     bool IsPrettyJSON() const { return HasFlag(kPrettyJSON); }
 };
@@ -0,0 +1,69 @@
+#include "csFileListCache.h"
+#include "file_logger.h"
+#include "fileutils.h"
+#include <queue>
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+csFileListCache::csFileListCache() {}
+
+csFileListCache::~csFileListCache() {}
+
+const wxArrayString& csFileListCache::GetFiles(const wxString& folder, const wxString& mask)
+{
+    wxString key;
+    key << folder << "|" << mask;
+    std::unordered_map<wxString, Entry>::iterator iter = m_entries.find(key);
+    if(iter != m_entries.end() && IsValid(iter->second)) {
+        clDEBUG() << "Using cached file list for" << folder << "(" << iter->second.files.size() << "files)";
+        return iter->second.files;
+    }
+
+    Entry& entry = m_entries[key];
+    DoScan(folder, mask, entry);
+    clDEBUG() << "Scanned" << folder << ":" << entry.files.size() << "files," << entry.folders.size() << "folders";
+    return entry.files;
+}
+
+void csFileListCache::DoScan(const wxString& folder, const wxString& mask, Entry& entry)
+{
+    entry.folders.clear();
+    entry.files.clear();
+    entry.scanTime = time(NULL);
+
+    std::queue<wxString> Q;
+    Q.push(folder);
+    while(!Q.empty()) {
+        wxString dirpath = Q.front();
+        Q.pop();
+
+        // Take the time before reading the folder, so a change made while we read it is noticed
+        entry.folders.push_back({ dirpath, FileUtils::GetFileModificationTime(dirpath) });
+        wxDir dir(dirpath);
+        if(!dir.IsOpened()) { continue; }
+
+        wxString filename;
+        bool cont = dir.GetFirst(&filename);
+        while(cont) {
+            wxString fullpath;
+            fullpath << dir.GetNameWithSep() << filename;
+            if(wxFileName::DirExists(fullpath)) {
+                Q.push(fullpath);
+            } else if(FileUtils::WildMatch(mask, filename)) {
+                entry.files.Add(fullpath);
+            }
+            cont = dir.GetNext(&filename);
+        }
+    }
+}
+
+bool csFileListCache::IsValid(const Entry& entry) const
+{
+    for(const std::pair<wxString, time_t>& p : entry.folders) {
+        time_t modified = FileUtils::GetFileModificationTime(p.first);
+        // The modification time has a resolution of one second: a folder that was modified in the same second as
+        // the scan might have been modified again after it
+        if(modified != p.second || modified >= entry.scanTime) { return false; }
+    }
+    return true;
+}
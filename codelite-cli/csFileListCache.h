@@ -0,0 +1,42 @@
+#ifndef CSFILELISTCACHE_H
+#define CSFILELISTCACHE_H
+
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+#include <wxStringHash.h>
+
+/**
+ * @class csFileListCache
+ * @brief the files of a folder tree that match a mask, kept between the daemon requests. Adding or removing a file
+ * changes the modification time of its parent folder, so a cached list is still valid as long as none of the
+ * scanned folders was modified. Checking that costs a stat() per folder instead of reading every folder again
+ */
+class csFileListCache
+{
+    struct Entry {
+        std::vector<std::pair<wxString, time_t> > folders;
+        wxArrayString files;
+        time_t scanTime = 0;
+    };
+    // folder + mask : the scan result
+    std::unordered_map<wxString, Entry> m_entries;
+
+protected:
+    void DoScan(const wxString& folder, const wxString& mask, Entry& entry);
+    bool IsValid(const Entry& entry) const;
+
+public:
+    csFileListCache();
+    virtual ~csFileListCache();
+
+    /**
+     * @brief return the files under 'folder' that match 'mask' (e.g. "*.php;*.inc")
+     */
+    const wxArrayString& GetFiles(const wxString& folder, const wxString& mask);
+    void Clear() { m_entries.clear(); }
+};
+
+#endif // CSFILELISTCACHE_H
@@ -1,6 +1,71 @@
 #include "csFindInFilesCommandHandler.h"
 #include "search_thread.h"
 #include "csManager.h"
+#include <wx/app.h>
+
+csFindInFilesRequest::csFindInFilesRequest(csManager* manager, csChannel::Ptr_t channel)
+    : m_manager(manager)
+    , m_channel(channel)
+    , m_matches(new JSON(cJSON_Array))
+{
+    Bind(wxEVT_SEARCH_THREAD_MATCHFOUND, &csFindInFilesRequest::OnSearchThreadMatch, this);
+    Bind(wxEVT_SEARCH_THREAD_SEARCHSTARTED, &csFindInFilesRequest::OnSearchThreadStarted, this);
+    Bind(wxEVT_SEARCH_THREAD_SEARCHCANCELED, &csFindInFilesRequest::OnSearchThreadCancelled, this);
+    Bind(wxEVT_SEARCH_THREAD_SEARCHEND, &csFindInFilesRequest::OnSearchThreadEneded, this);
+}
+
+csFindInFilesRequest::~csFindInFilesRequest()
+{
+    Unbind(wxEVT_SEARCH_THREAD_MATCHFOUND, &csFindInFilesRequest::OnSearchThreadMatch, this);
+    Unbind(wxEVT_SEARCH_THREAD_SEARCHSTARTED, &csFindInFilesRequest::OnSearchThreadStarted, this);
+    Unbind(wxEVT_SEARCH_THREAD_SEARCHCANCELED, &csFindInFilesRequest::OnSearchThreadCancelled, this);
+    Unbind(wxEVT_SEARCH_THREAD_SEARCHEND, &csFindInFilesRequest::OnSearchThreadEneded, this);
+}
+
+void csFindInFilesRequest::OnSearchThreadMatch(wxCommandEvent& event)
+{
+    SearchResultList* res = reinterpret_cast<SearchResultList*>(event.GetClientData());
+    JSON partial(cJSON_Array);
+    JSONItem arr = m_channel->IsStreaming() ? partial.toElement() : m_matches->toElement();
+    SearchResultList::iterator iter = res->begin();
+    while(iter != res->end()) {
+        arr.arrayAppend(iter->ToJSON());
+        ++iter;
+    }
+    wxDELETE(res);
+
+    // Send the matches found so far, the client does not have to wait for the entire search
+    if(m_channel->IsStreaming()) { m_channel->Write(arr.format(m_manager->GetConfig().IsPrettyJSON()), true); }
+}
+
+void csFindInFilesRequest::OnSearchThreadStarted(wxCommandEvent& event) { clDEBUG() << "Search started"; }
+
+void csFindInFilesRequest::OnSearchThreadCancelled(wxCommandEvent& event)
+{
+    clDEBUG() << "Search cancelled";
+    m_channel->Write(m_matches->toElement().format(m_manager->GetConfig().IsPrettyJSON()));
+    DoComplete();
+}
+
+void csFindInFilesRequest::OnSearchThreadEneded(wxCommandEvent& event)
+{
+    SearchSummary* summary = reinterpret_cast<SearchSummary*>(event.GetClientData());
+    m_matches->toElement().arrayAppend(summary->ToJSON());
+    wxDELETE(summary);
+    wxString output = m_matches->toElement().format(m_manager->GetConfig().IsPrettyJSON());
+    m_channel->Write(output);
+    clDEBUG1() << output;
+    clDEBUG() << "Search completed";
+    DoComplete();
+}
+
+void csFindInFilesRequest::DoComplete()
+{
+    m_channel->Complete();
+    clCommandEvent e(wxEVT_COMMAND_PROCESSED);
+    m_manager->AddPendingEvent(e);
+    wxTheApp->ScheduleForDestruction(this);
+}
 
 csFindInFilesCommandHandler::csFindInFilesCommandHandler(csManager* manager)
     : csCommandHandlerBase(manager)
@@ -20,10 +85,12 @@ void csFindInFilesCommandHandler::DoProcessCommand(const JSONItem& options)
 
     if(m_folder.IsEmpty() || !wxFileName::DirExists(m_folder)) {
         clERROR() << "Invalid input directory:" << m_folder;
+        NotifyCompletion("Invalid input directory: " + m_folder);
         return;
     }
     if(m_what.IsEmpty()) {
         clERROR() << "what field is empty";
+        NotifyCompletion("what field is empty");
         return;
     }
 
@@ -37,9 +104,14 @@ void csFindInFilesCommandHandler::DoProcessCommand(const JSONItem& options)
     req->SetFindString(m_what);
     req->SetMatchCase(m_case);
     req->SetMatchWholeWord(m_word);
-    wxArrayString folders;
-    folders.Add(m_folder);
-    req->SetRootDirs(folders);
-    req->SetOwner(GetSink());
+    if(m_manager->IsDaemon()) {
+        // Scanning the folder is often slower than the search itself, use the list from the previous requests
+        req->SetFiles(m_manager->GetFileListCache().GetFiles(m_folder, m_mask));
+    } else {
+        wxArrayString folders;
+        folders.Add(m_folder);
+        req->SetRootDirs(folders);
+    }
+    req->SetOwner(new csFindInFilesRequest(m_manager, m_channel));
     SearchThreadST::Get()->Add(req);
 }
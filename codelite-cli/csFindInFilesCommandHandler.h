@@ -4,6 +4,30 @@
 #include "csCommandHandlerBase.h" // Base class: csCommandHandlerBase
 #include <wx/string.h>
 
+/**
+ * @class csFindInFilesRequest
+ * @brief receives the search thread events of a single search and writes them to the request channel. A streaming
+ * channel gets the matches as they are found, otherwise they are all written once the search is done.
+ * The object deletes itself when the search ends
+ */
+class csFindInFilesRequest : public wxEvtHandler
+{
+    csManager* m_manager;
+    csChannel::Ptr_t m_channel;
+    wxSharedPtr<JSON> m_matches;
+
+protected:
+    void OnSearchThreadMatch(wxCommandEvent& event);
+    void OnSearchThreadStarted(wxCommandEvent& event);
+    void OnSearchThreadCancelled(wxCommandEvent& event);
+    void OnSearchThreadEneded(wxCommandEvent& event);
+    void DoComplete();
+
+public:
+    csFindInFilesRequest(csManager* manager, csChannel::Ptr_t channel);
+    virtual ~csFindInFilesRequest();
+};
+
 class csFindInFilesCommandHandler : public csCommandHandlerBase
 {
     wxString m_folder;
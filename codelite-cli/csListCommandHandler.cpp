@@ -34,6 +34,6 @@ void csListCommandHandler::DoProcessCommand(const JSONItem& options)
     }
     char* result = arr.FormatRawString(m_manager->GetConfig().IsPrettyJSON());
     clDEBUG() << result;
-    std::cout << result << std::endl;
+    m_channel->Write(result);
     free(result);
 }
@@ -1,4 +1,5 @@
 #include "csCodeCompleteHandler.h"
+#include "csClientThread.h"
 #include "csFindInFilesCommandHandler.h"
 #include "csListCommandHandler.h"
 #include "csManager.h"
@@ -6,14 +7,18 @@
 #include "csParseFolderHandler.h"
 #include "file_logger.h"
 #include "JSON.h"
+#include "PHPLookupTable.h"
 #include "search_thread.h"
 #include <algorithm>
 #include <iostream>
 #include <wx/app.h>
+#include <wx/filename.h>
 
 csManager::csManager()
     : m_startupCalled(false)
     , m_exitNow(false)
+    , m_daemon(false)
+    , m_networkThread(nullptr)
 {
     m_handlers.Register("list", csCommandHandlerBase::Ptr_t(new csListCommandHandler(this)));
     m_handlers.Register("find", csCommandHandlerBase::Ptr_t(new csFindInFilesCommandHandler(this)));
@@ -21,7 +26,6 @@ csManager::csManager()
     m_handlers.Register("code-complete", csCommandHandlerBase::Ptr_t(new csCodeCompleteHandler(this)));
 
     SearchThreadST::Get()->Start();
-    SearchThreadST::Get()->SetNotifyWindow(this);
     m_config.Load();
 }
 
@@ -30,12 +34,15 @@ csManager::~csManager()
     // First unbind all the events
     if(m_startupCalled) {
         Unbind(wxEVT_COMMAND_PROCESSED, &csManager::OnCommandProcessedCompleted, this);
-        // Search thread events
-        Unbind(wxEVT_SEARCH_THREAD_MATCHFOUND, &csManager::OnSearchThreadMatch, this);
-        Unbind(wxEVT_SEARCH_THREAD_SEARCHSTARTED, &csManager::OnSearchThreadStarted, this);
-        Unbind(wxEVT_SEARCH_THREAD_SEARCHCANCELED, &csManager::OnSearchThreadCancelled, this);
-        Unbind(wxEVT_SEARCH_THREAD_SEARCHEND, &csManager::OnSearchThreadEneded, this);
+        Unbind(wxEVT_SOCKET_CONNECTION_READY, &csManager::OnConnectionReady, this);
+        Unbind(wxEVT_SOCKET_SERVER_ERROR, &csManager::OnServerError, this);
+        Unbind(wxEVT_THREAD_GOING_DOWN, &csManager::OnClientGoingDown, this);
     }
+
+    // Stop accepting new clients, then disconnect the current ones
+    wxDELETE(m_networkThread);
+    std::for_each(m_clients.begin(), m_clients.end(), [&](csClientThread* client) { delete client; });
+    m_clients.clear();
     SearchThreadST::Get()->Stop();
 }
 
@@ -47,14 +54,23 @@ bool csManager::Startup()
     }
 
     Bind(wxEVT_COMMAND_PROCESSED, &csManager::OnCommandProcessedCompleted, this);
-    // Search thread events
-    Bind(wxEVT_SEARCH_THREAD_MATCHFOUND, &csManager::OnSearchThreadMatch, this);
-    Bind(wxEVT_SEARCH_THREAD_SEARCHSTARTED, &csManager::OnSearchThreadStarted, this);
-    Bind(wxEVT_SEARCH_THREAD_SEARCHCANCELED, &csManager::OnSearchThreadCancelled, this);
-    Bind(wxEVT_SEARCH_THREAD_SEARCHEND, &csManager::OnSearchThreadEneded, this);
+    Bind(wxEVT_SOCKET_CONNECTION_READY, &csManager::OnConnectionReady, this);
+    Bind(wxEVT_SOCKET_SERVER_ERROR, &csManager::OnServerError, this);
+    Bind(wxEVT_THREAD_GOING_DOWN, &csManager::OnClientGoingDown, this);
 
     m_startupCalled = true;
 
+    if(m_daemon) {
+        if(m_config.GetConnectionString().IsEmpty()) {
+            clERROR() << "Daemon mode requires a connection string";
+            return false;
+        }
+        clDEBUG() << "Starting daemon on:" << m_config.GetConnectionString();
+        m_networkThread = new csNetworkThread(this, m_config);
+        m_networkThread->Start();
+        return true;
+    }
+
     clDEBUG() << "Command:" << GetCommand();
     clDEBUG() << "Options:" << GetOptions();
 
@@ -67,48 +83,91 @@ bool csManager::Startup()
 
     JSON root(m_options);
     JSONItem options = root.toElement();
-    handler->Process(options);
+    handler->Process(options, csChannel::Ptr_t(new csStdoutChannel()));
     return true;
 }
 
-void csManager::OnCommandProcessedCompleted(clCommandEvent& event) { wxExit(); }
+void csManager::OnCommandProcessedCompleted(clCommandEvent& event)
+{
+    // The daemon keeps running until it is killed
+    if(!m_daemon) { wxExit(); }
+}
 
-void csManager::OnSearchThreadMatch(wxCommandEvent& event)
+void csManager::LoadCommandFromINI()
 {
-    SearchResultList* res = reinterpret_cast<SearchResultList*>(event.GetClientData());
-    SearchResultList::iterator iter = res->begin();
-    JSONItem arr = m_findInFilesMatches->toElement();
-    while(iter != res->end()) {
-        arr.arrayAppend(iter->ToJSON());
-        ++iter;
-    }
-    wxDELETE(res);
+    m_command = m_config.GetCommand();
+    m_options = m_config.GetOptions();
+}
+
+void csManager::OnExit() { wxExit(); }
+
+void csManager::SetDaemon(const wxString& connectionString)
+{
+    m_daemon = true;
+    if(!connectionString.IsEmpty()) { m_config.SetConnectionString(connectionString); }
 }
 
-void csManager::OnSearchThreadStarted(wxCommandEvent& event)
+wxSharedPtr<PHPLookupTable> csManager::GetPHPLookupTable(const wxString& dbpath)
 {
-    clDEBUG() << "Search started";
-    m_findInFilesMatches.reset(new JSON(cJSON_Array));
+    wxString key = wxFileName(dbpath).GetFullPath();
+    std::unordered_map<wxString, wxSharedPtr<PHPLookupTable> >::iterator iter = m_phpLookupTables.find(key);
+    if(iter != m_phpLookupTables.end()) { return iter->second; }
+
+    wxSharedPtr<PHPLookupTable> table(new PHPLookupTable());
+    table->Open(wxFileName(key));
+    if(!table->IsOpened()) { return wxSharedPtr<PHPLookupTable>(); }
+    m_phpLookupTables.insert({ key, table });
+    return table;
 }
 
-void csManager::OnSearchThreadCancelled(wxCommandEvent& event) { OnSearchThreadEneded(event); }
+void csManager::OnClientRequest(clSocketBase::Ptr_t socket, const wxString& message)
+{
+    // {"id": "...", "command": "find", "options": {...}}
+    JSON root(message);
+    JSONItem request = root.toElement();
+    wxString requestId = request.namedObject("id").toString();
+    csChannel::Ptr_t channel(new csSocketChannel(socket, requestId));
+    if(!request.isOk() || !request.hasNamedObject("command")) {
+        channel->Complete("Invalid request");
+        return;
+    }
+    DoProcess(request.namedObject("command").toString(), request.namedObject("options"), channel);
+}
 
-void csManager::OnSearchThreadEneded(wxCommandEvent& event)
+void csManager::DoProcess(const wxString& command, const JSONItem& options, csChannel::Ptr_t channel)
 {
-    SearchSummary* summary = reinterpret_cast<SearchSummary*>(event.GetClientData());
-    m_findInFilesMatches->toElement().arrayAppend(summary->ToJSON());
-    wxDELETE(summary);
-    wxString output = m_findInFilesMatches->toElement().format(GetConfig().IsPrettyJSON());
-    std::cout << output << std::endl;
-    clDEBUG1() << output;
-    clDEBUG() << "Search completed";
-    wxExit();
+    clDEBUG() << "Processing command:" << command;
+    csCommandHandlerBase::Ptr_t handler = m_handlers.FindHandler(command);
+    if(handler == nullptr) {
+        clERROR() << "Don't know how to handle command:" << command;
+        channel->Complete("Unsupported command: " + command);
+        return;
+    }
+    handler->Process(options, channel);
 }
 
-void csManager::LoadCommandFromINI()
+void csManager::OnConnectionReady(clCommandEvent& event)
 {
-    m_command = m_config.GetCommand();
-    m_options = m_config.GetOptions();
+    clSocketBase::Ptr_t socket(reinterpret_cast<clSocketBase*>(event.GetClientData()));
+    csClientThread* client = new csClientThread(this, socket);
+    m_clients.insert(client);
+    client->Start();
+    clDEBUG() << "New client connected." << m_clients.size() << "clients";
 }
 
-void csManager::OnExit() { wxExit(); }
+void csManager::OnServerError(clCommandEvent& event)
+{
+    clERROR() << "Network error, exiting";
+    CallAfter(&csManager::OnExit);
+}
+
+void csManager::OnClientGoingDown(clCommandEvent& event)
+{
+    csClientThread* client = reinterpret_cast<csClientThread*>(event.GetClientData());
+    if(m_clients.count(client)) {
+        m_clients.erase(client);
+        // Wait for the thread and delete it
+        delete client;
+    }
+    clDEBUG() << "Client disconnected." << m_clients.size() << "clients";
+}
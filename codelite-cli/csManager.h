@@ -1,14 +1,20 @@
 #ifndef CSMANAGER_H
 #define CSMANAGER_H
 
+#include "SocketAPI/clSocketBase.h"
 #include "codelite_events.h"
 #include "csCommandHandlerManager.h"
 #include "csConfig.h"
+#include "csFileListCache.h"
 #include "file_logger.h"
 #include <cl_command_event.h>
+#include <unordered_map>
 #include <unordered_set>
 #include <wx/event.h>
 
+class PHPLookupTable;
+class csNetworkThread;
+class csClientThread;
 class csManager : public wxEvtHandler
 {
     csConfig m_config;
@@ -17,9 +23,16 @@ class csManager : public wxEvtHandler
     wxString m_command;
     wxString m_options;
     bool m_startupCalled;
-    wxSharedPtr<JSON> m_findInFilesMatches;
     bool m_exitNow;
 
+    // daemon mode
+    bool m_daemon;
+    csNetworkThread* m_networkThread;
+    std::unordered_set<csClientThread*> m_clients;
+    // the state that is kept warm between the requests
+    std::unordered_map<wxString, wxSharedPtr<PHPLookupTable> > m_phpLookupTables;
+    csFileListCache m_fileListCache;
+
 public:
     csManager();
     virtual ~csManager();
@@ -32,18 +45,36 @@ public:
     const csConfig& GetConfig() const { return m_config; }
     void LoadCommandFromINI();
     void SetExitNow(bool b) { m_exitNow = b; }
-    
+
+    /**
+     * @brief run as a daemon listening on 'connectionString' (if empty, the one from the INI file is used)
+     */
+    void SetDaemon(const wxString& connectionString);
+    bool IsDaemon() const { return m_daemon; }
+
+    /**
+     * @brief return the (opened) PHP symbols table stored in 'dbpath'. The table is kept open for the next
+     * requests of the daemon. Return NULL if the database could not be opened
+     */
+    wxSharedPtr<PHPLookupTable> GetPHPLookupTable(const wxString& dbpath);
+    csFileListCache& GetFileListCache() { return m_fileListCache; }
+
+    /**
+     * @brief a request received from a client of the daemon. Called by the client thread (with CallAfter)
+     */
+    void OnClientRequest(clSocketBase::Ptr_t socket, const wxString& message);
+
 protected:
     void OnExit();
-    
+    void DoProcess(const wxString& command, const JSONItem& options, csChannel::Ptr_t channel);
+
     // The handler completed
     void OnCommandProcessedCompleted(clCommandEvent& event);
 
-    // Search events
-    void OnSearchThreadMatch(wxCommandEvent& event);
-    void OnSearchThreadStarted(wxCommandEvent& event);
-    void OnSearchThreadCancelled(wxCommandEvent& event);
-    void OnSearchThreadEneded(wxCommandEvent& event);
+    // Network events
+    void OnConnectionReady(clCommandEvent& event);
+    void OnServerError(clCommandEvent& event);
+    void OnClientGoingDown(clCommandEvent& event);
 };
 
 #endif // CSMANAGER_H
@@ -16,32 +16,36 @@ csNetworkThread::~csNetworkThread() {}
 
 void* csNetworkThread::Entry()
 {
-    // FileLoggerNameRegistrar logName("Network");
-    // clSocketServer server;
-    // clDEBUG() << "Network thread is starting...";
-    //
-    // try {
-    //    server.Start(m_config.GetConnectionString());
-    //} catch(clSocketException& e) {
-    //    clERROR() << "Network thread failed to start on '" << m_config.GetConnectionString() << "'." << e.what();
-    //    clCommandEvent errorEvent(wxEVT_SOCKET_SERVER_ERROR);
-    //    m_manager->AddPendingEvent(errorEvent);
-    //    return NULL;
-    //}
-    //
-    // clDEBUG() << "Waiting for new connection...";
-    // while(true) {
-    //    if(TestDestroy()) { break; }
-    //    clSocketBasePtr_t conn = server.WaitForNewConnectionRaw(1);
-    //    if(conn) {
-    //        clDEBUG() << "Received new connection";
-    //        // Call reset with a dummy Deleter
-    //        // so we can get the raw pointer without destroying it
-    //        clCommandEvent newConnEvent(wxEVT_SOCKET_CONNECTION_READY);
-    //        newConnEvent.SetClientData(static_cast<void*>(conn));
-    //        m_manager->AddPendingEvent(newConnEvent);
-    //    }
-    //}
-    // clDEBUG() << "Network thread is going down";
+    FileLoggerNameRegistrar logName("Network");
+    clSocketServer server;
+    clDEBUG() << "Network thread is starting...";
+
+    try {
+        server.Start(m_config.GetConnectionString());
+    } catch(clSocketException& e) {
+        clERROR() << "Network thread failed to start on '" << m_config.GetConnectionString() << "'."
+                  << wxString(e.what());
+        clCommandEvent errorEvent(wxEVT_SOCKET_SERVER_ERROR);
+        m_manager->AddPendingEvent(errorEvent);
+        return NULL;
+    }
+
+    clDEBUG() << "Waiting for new connection...";
+    while(true) {
+        if(TestDestroy()) { break; }
+        try {
+            clSocketBasePtr_t conn = server.WaitForNewConnectionRaw(1);
+            if(conn) {
+                clDEBUG() << "Received new connection";
+                // The manager takes ownership of the connection
+                clCommandEvent newConnEvent(wxEVT_SOCKET_CONNECTION_READY);
+                newConnEvent.SetClientData(static_cast<void*>(conn));
+                m_manager->AddPendingEvent(newConnEvent);
+            }
+        } catch(clSocketException& e) {
+            clWARNING() << "Failed to accept a new connection." << wxString(e.what());
+        }
+    }
+    clDEBUG() << "Network thread is going down";
     return NULL;
 }
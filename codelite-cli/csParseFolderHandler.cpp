@@ -21,8 +21,11 @@ void csParseFolderHandler::DoProcessCommand(const JSONItem& options)
     csCommandHandlerBase::Ptr_t handler = m_parseHandlers.FindHandler(handlerName);
     if(!handler) {
         clERROR() << "I have no handler for:" << handlerName;
+        NotifyCompletion("Unsupported command: " + handlerName);
         return;
     }
     clDEBUG() << "Using handler:" << handlerName;
-    handler->DoProcessCommand(options);
+    // the handler notifies the completion itself
+    SetNotifyCompletion(false);
+    handler->Process(options, m_channel);
 }
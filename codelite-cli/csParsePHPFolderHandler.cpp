@@ -1,4 +1,5 @@
 #include "PHPLookupTable.h"
+#include "csManager.h"
 #include "csParsePHPFolderHandler.h"
 #include <wx/filename.h>
 
@@ -11,11 +12,11 @@ csParsePHPFolderHandler::~csParsePHPFolderHandler() {}
 
 void csParsePHPFolderHandler::DoProcessCommand(const JSONItem& options)
 {
+    m_dbpath.Clear();
     CHECK_STR_PARAM("path", m_folder);
     CHECK_STR_PARAM("mask", m_mask);
     CHECK_STR_PARAM_OPTIONAL("symbols-path", m_dbpath);
 
-    PHPLookupTable lookup;
     // Build the default symbols db path
     wxFileName dbpath(m_folder, "phpsymbols.db");
     dbpath.AppendDir(".codelite");
@@ -29,11 +30,12 @@ void csParsePHPFolderHandler::DoProcessCommand(const JSONItem& options)
     }
     
     clDEBUG() << "Using symbols db:" << dbpath;
-    lookup.Open(dbpath);
-    if(!lookup.IsOpened()) {
+    wxSharedPtr<PHPLookupTable> lookup = m_manager->GetPHPLookupTable(dbpath.GetFullPath());
+    if(!lookup) {
         clERROR() << "Could not open file:" << dbpath;
+        NotifyCompletion("Could not open symbols db: " + dbpath.GetFullPath());
         return;
     }
-    // Clear any content before we start the parsing
-    lookup.ParseFolder(m_folder, m_mask, PHPLookupTable::kUpdateMode_Fast);
+    // Only the modified files are parsed again
+    lookup->ParseFolder(m_folder, m_mask, PHPLookupTable::kUpdateMode_Fast);
 }
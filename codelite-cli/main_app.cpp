@@ -12,6 +12,12 @@ IMPLEMENT_APP_CONSOLE(MainApp)
 static const wxCmdLineEntryDesc cmdLineDesc[] = {
     { wxCMD_LINE_SWITCH, "v", "version", "Print current version", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_SWITCH, "h", "help", "Print usage", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_SWITCH, "d", "daemon",
+      "Keep running and serve JSON requests from the clients connected to the 'connection_string' of the INI file",
+      wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_OPTION, "s", "connection-string",
+      "The daemon connection string (e.g. unix:///tmp/codelite-cli.sock or tcp://127.0.0.1:5555)",
+      wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_PARAM, "c", "command", "command", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_PARAM, "o", "options", "options", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_NONE }
@@ -77,6 +83,14 @@ bool MainApp::DoParseCommandLine(wxCmdLineParser& parser)
         return true;
     }
 
+    if(parser.Found("d")) {
+        // The commands are received from the clients
+        wxString connectionString;
+        parser.Found("s", &connectionString);
+        m_manager->SetDaemon(connectionString);
+        return true;
+    }
+
     if(m_manager->GetCommand().IsEmpty()) {
         // Try to fetch the options from the INI file
         m_manager->LoadCommandFromINI();
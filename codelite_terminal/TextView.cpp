@@ -169,9 +169,11 @@ void TextView::SetCaretEnd()
 
 int TextView::Truncate()
 {
-    if(GetNumberOfLines() > 1000) {
+    // Lines are removed in chunks of 10%, so we don't pay for a removal on every update once the limit is reached
+    int maxLines = wxTerminalOptions::Get().GetScrollbackLines();
+    if(maxLines > 0 && GetNumberOfLines() > (maxLines + maxLines / 10)) {
         // Start removing lines from the top
-        long linesToRemove = (GetNumberOfLines() - 1000);
+        long linesToRemove = (GetNumberOfLines() - maxLines);
         long startPos = 0;
         long endPos = XYToPosition(0, linesToRemove);
         this->Remove(startPos, endPos);
@@ -0,0 +1,272 @@
+#include "wxTerminalAnsiParser.h"
+#include <algorithm>
+#include <wx/tokenzr.h>
+
+namespace
+{
+enum eAction {
+    kPrint = 0,         // add the char to the current run
+    kIgnore,            // drop the char
+    kNewLine,           // add the LF and start a new line
+    kCarriageReturn,    // found CR
+    kEscape,            // found ESC
+    kCsiStart,          // ESC [
+    kOscStart,          // ESC ]
+    kCsiCollect,        // a CSI parameter or intermediate char
+    kCsiDispatch,       // the CSI final char
+    kOscCollect,        // a char of the OSC string
+    kOscEnd,            // BEL: the OSC string is complete
+    kOscEndEscape,      // ESC inside OSC: the string is complete (ST is "ESC \")
+    kEscapeEnd,         // the final char of an escape sequence that we don't support
+    kEraseAndReprocess, // a CR followed by a char: erase the line and process the char again in the normal state
+};
+
+// all the chars >= 128 share the last column of the table
+const size_t NON_ASCII = 128;
+const size_t MAX_SEQUENCE_LEN = 4096;
+
+struct ActionTable {
+    unsigned char actions[(size_t)eColourHandlerState::kLast][NON_ASCII + 1];
+
+    void Set(eColourHandlerState state, size_t from, size_t to, eAction action)
+    {
+        for(size_t ch = from; ch <= to; ++ch) {
+            actions[(size_t)state][ch] = action;
+        }
+    }
+
+    ActionTable()
+    {
+        // see https://vt100.net/emu/dec_ansi_parser
+        Set(eColourHandlerState::kNormal, 0, NON_ASCII, kPrint);
+        Set(eColourHandlerState::kNormal, 0, 0, kIgnore);
+        Set(eColourHandlerState::kNormal, '\a', '\a', kIgnore);
+        Set(eColourHandlerState::kNormal, '\n', '\n', kNewLine);
+        Set(eColourHandlerState::kNormal, '\r', '\r', kCarriageReturn);
+        Set(eColourHandlerState::kNormal, 0x1B, 0x1B, kEscape);
+
+        Set(eColourHandlerState::kFoundCR, 0, NON_ASCII, kEraseAndReprocess);
+        Set(eColourHandlerState::kFoundCR, '\r', '\r', kIgnore);
+        Set(eColourHandlerState::kFoundCR, '\n', '\n', kNewLine);
+
+        Set(eColourHandlerState::kInEscape, 0, NON_ASCII, kEscapeEnd);
+        Set(eColourHandlerState::kInEscape, 0, 0x1F, kIgnore);
+        Set(eColourHandlerState::kInEscape, 0x20, 0x2F, kIgnore); // intermediate chars, e.g. "ESC ( B"
+        Set(eColourHandlerState::kInEscape, 0x1B, 0x1B, kEscape);
+        Set(eColourHandlerState::kInEscape, '[', '[', kCsiStart);
+        Set(eColourHandlerState::kInEscape, ']', ']', kOscStart);
+
+        Set(eColourHandlerState::kInCsi, 0, NON_ASCII, kIgnore);
+        Set(eColourHandlerState::kInCsi, 0x20, 0x3F, kCsiCollect);
+        Set(eColourHandlerState::kInCsi, 0x40, 0x7E, kCsiDispatch);
+        Set(eColourHandlerState::kInCsi, 0x1B, 0x1B, kEscape);
+
+        Set(eColourHandlerState::kInOsc, 0, NON_ASCII, kOscCollect);
+        Set(eColourHandlerState::kInOsc, '\a', '\a', kOscEnd);
+        Set(eColourHandlerState::kInOsc, 0x1B, 0x1B, kOscEndEscape);
+    }
+
+    eAction Get(eColourHandlerState state, wxChar ch) const
+    {
+        size_t column = ((size_t)ch < NON_ASCII) ? (size_t)ch : NON_ASCII;
+        return (eAction)actions[(size_t)state][column];
+    }
+};
+
+const ActionTable& GetActionTable()
+{
+    static ActionTable table;
+    return table;
+}
+} // namespace
+
+void wxTerminalAnsiParser::Parse(const wxString& buffer, OpVec_t& ops)
+{
+    const ActionTable& table = GetActionTable();
+    m_parseStartOp = ops.size();
+    m_lineStartOp = wxString::npos;
+
+    size_t len = buffer.length();
+    size_t i = 0;
+    while(i < len) {
+        wxChar ch = buffer[i];
+        switch(table.Get(m_state, ch)) {
+        case kPrint: {
+            // add the entire run of printable chars at once
+            size_t start = i;
+            while(i < len && table.Get(eColourHandlerState::kNormal, buffer[i]) == kPrint) {
+                ++i;
+            }
+            AddText(buffer, start, i - start, ops);
+            continue;
+        }
+        case kIgnore:
+            break;
+        case kNewLine:
+            AddText(buffer, i, 1, ops);
+            m_lineStartOp = ops.size() - 1;
+            m_lineStartPos = ops.back().text.length();
+            m_state = eColourHandlerState::kNormal;
+            break;
+        case kCarriageReturn:
+            m_state = eColourHandlerState::kFoundCR;
+            break;
+        case kEraseAndReprocess:
+            // only CR was found, erase everything until the start of the line
+            EraseLine(ops);
+            m_state = eColourHandlerState::kNormal;
+            continue;
+        case kEscape:
+            m_state = eColourHandlerState::kInEscape;
+            break;
+        case kCsiStart:
+            m_escapeSequence.Clear();
+            m_state = eColourHandlerState::kInCsi;
+            break;
+        case kOscStart:
+            m_title.Clear();
+            m_state = eColourHandlerState::kInOsc;
+            break;
+        case kCsiCollect:
+            if(m_escapeSequence.length() < MAX_SEQUENCE_LEN) { m_escapeSequence << ch; }
+            break;
+        case kCsiDispatch:
+            // we only handle the colours and the text attributes
+            if(ch == 'm') { SetStyleFromEscape(m_escapeSequence); }
+            m_state = eColourHandlerState::kNormal;
+            break;
+        case kOscCollect:
+            if(m_title.length() < MAX_SEQUENCE_LEN) { m_title << ch; }
+            break;
+        case kOscEnd:
+            SetTitle(ops);
+            m_state = eColourHandlerState::kNormal;
+            break;
+        case kOscEndEscape:
+            SetTitle(ops);
+            m_state = eColourHandlerState::kInEscape;
+            break;
+        case kEscapeEnd:
+            m_state = eColourHandlerState::kNormal;
+            break;
+        }
+        ++i;
+    }
+}
+
+void wxTerminalAnsiParser::AddText(const wxString& buffer, size_t from, size_t count, OpVec_t& ops)
+{
+    if(count == 0) { return; }
+    if(!ops.empty() && ops.back().type == eTerminalOp::kText && ops.back().style == m_style) {
+        ops.back().text.append(buffer, from, count);
+    } else {
+        ops.push_back(wxTerminalOp());
+        ops.back().style = m_style;
+        ops.back().text = buffer.Mid(from, count);
+    }
+}
+
+void wxTerminalAnsiParser::EraseLine(OpVec_t& ops)
+{
+    size_t first = m_parseStartOp;
+    if(m_lineStartOp != wxString::npos) {
+        ops[m_lineStartOp].text.Truncate(m_lineStartPos);
+        first = m_lineStartOp + 1;
+    }
+
+    // drop the text of the line, but keep the other operations (e.g. title changes)
+    ops.erase(std::remove_if(ops.begin() + first, ops.end(),
+                             [](const wxTerminalOp& op) { return op.type == eTerminalOp::kText; }),
+              ops.end());
+
+    if(m_lineStartOp == wxString::npos) {
+        // the line started in a previous output, let the view erase it
+        ops.push_back(wxTerminalOp());
+        ops.back().type = eTerminalOp::kEraseLine;
+        m_lineStartOp = ops.size() - 1;
+        m_lineStartPos = 0;
+    }
+}
+
+void wxTerminalAnsiParser::SetTitle(OpVec_t& ops)
+{
+    // see https://en.wikipedia.org/wiki/ANSI_escape_code#Escape_sequences
+    if(m_title.StartsWith("0;") || m_title.StartsWith("2;")) {
+        ops.push_back(wxTerminalOp());
+        ops.back().type = eTerminalOp::kSetTitle;
+        ops.back().text = m_title.Mid(2);
+    }
+    m_title.Clear();
+}
+
+void wxTerminalAnsiParser::SetStyleFromEscape(const wxString& escape)
+{
+    // see: https://en.wikipedia.org/wiki/ANSI_escape_code#SGR_(Select_Graphic_Rendition)_parameters
+    wxArrayString attrs = ::wxStringTokenize(escape, ";", wxTOKEN_RET_EMPTY_ALL);
+    if(attrs.IsEmpty()) { attrs.Add("0"); }
+    for(size_t i = 0; i < attrs.size(); ++i) {
+        long number = 0;
+        if(!attrs.Item(i).IsEmpty() && !attrs.Item(i).ToCLong(&number)) { continue; }
+        switch(number) {
+        case 0:
+            // reset attributes
+            m_style = wxTerminalStyle();
+            break;
+        case 1:
+            m_style.weight = 1;
+            break;
+        case 2:
+            m_style.weight = 2;
+            break;
+        case 3:
+            m_style.italic = true;
+            break;
+        case 4:
+            m_style.underlined = true;
+            break;
+        case 22:
+            m_style.weight = 0;
+            break;
+        case 23:
+            m_style.italic = false;
+            break;
+        case 24:
+            m_style.underlined = false;
+            break;
+        case 38:
+        case 48:
+            // 256 colours (38;5;n) or true colours (38;2;r;g;b): not supported, skip the arguments
+            if((i + 1) < attrs.size()) {
+                if(attrs.Item(i + 1) == "5") {
+                    i += 2;
+                } else if(attrs.Item(i + 1) == "2") {
+                    i += 4;
+                }
+            }
+            break;
+        case 39:
+            m_style.textColour = wxNOT_FOUND;
+            break;
+        case 49:
+            m_style.bgColour = wxNOT_FOUND;
+            break;
+        default:
+            if((number >= 30 && number <= 37) || (number >= 90 && number <= 97)) {
+                m_style.textColour = number;
+            } else if((number >= 40 && number <= 47) || (number >= 100 && number <= 107)) {
+                m_style.bgColour = number;
+            }
+            break;
+        }
+    }
+}
+
+void wxTerminalAnsiParser::AddOp(OpVec_t& ops, const wxTerminalOp& op)
+{
+    if(op.type == eTerminalOp::kText && !ops.empty() && ops.back().type == eTerminalOp::kText &&
+       ops.back().style == op.style) {
+        ops.back().text << op.text;
+    } else {
+        ops.push_back(op);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef WXTERMINALANSIPARSER_H
+#define WXTERMINALANSIPARSER_H
+
+#include <vector>
+#include <wx/string.h>
+
+enum class eColourHandlerState {
+    kNormal = 0,
+    kInEscape, // found ESC char
+    kInOsc,    // Operating System Command
+    kInCsi,    // Control Sequence Introducer
+    kFoundCR,  // Found CR
+    kLast,
+};
+
+/**
+ * @brief the text attributes selected with the SGR escape sequences. The colours are kept as their SGR number
+ * (30-37 and 90-97 for the text, 40-47 and 100-107 for the background) so no GUI object is needed to parse the output
+ */
+struct wxTerminalStyle {
+    int textColour = wxNOT_FOUND;
+    int bgColour = wxNOT_FOUND;
+    int weight = 0; // 0: normal, 1: bold, 2: light
+    bool italic = false;
+    bool underlined = false;
+
+    bool operator==(const wxTerminalStyle& other) const
+    {
+        return textColour == other.textColour && bgColour == other.bgColour && weight == other.weight &&
+               italic == other.italic && underlined == other.underlined;
+    }
+    bool operator!=(const wxTerminalStyle& other) const { return !(*this == other); }
+};
+
+enum class eTerminalOp {
+    kText,      // append 'text' using 'style'
+    kEraseLine, // erase the last line of the view (a CR followed by more text)
+    kSetTitle,  // set the terminal title to 'text'
+};
+
+struct wxTerminalOp {
+    eTerminalOp type = eTerminalOp::kText;
+    wxTerminalStyle style;
+    wxString text;
+};
+
+/**
+ * @class wxTerminalAnsiParser
+ * @brief a table driven VT/ANSI state machine. The parser converts the raw process output into a list of operations
+ * (styled text runs, line erase and title changes). Consecutive characters with the same style are merged into a
+ * single run. The parser does not touch any window and can be used from a worker thread
+ */
+class wxTerminalAnsiParser
+{
+public:
+    typedef std::vector<wxTerminalOp> OpVec_t;
+
+protected:
+    eColourHandlerState m_state = eColourHandlerState::kNormal;
+    wxTerminalStyle m_style;
+    wxString m_escapeSequence;
+    wxString m_title;
+    // the first operation added by the current call to Parse()
+    size_t m_parseStartOp = 0;
+    // where the current line starts in the output passed to Parse(). wxString::npos: in a previous output
+    size_t m_lineStartOp = wxString::npos;
+    size_t m_lineStartPos = 0;
+
+protected:
+    void AddText(const wxString& buffer, size_t from, size_t count, OpVec_t& ops);
+    void EraseLine(OpVec_t& ops);
+    void SetStyleFromEscape(const wxString& escape);
+    void SetTitle(OpVec_t& ops);
+
+public:
+    wxTerminalAnsiParser() {}
+    ~wxTerminalAnsiParser() {}
+
+    /**
+     * @brief parse 'buffer' and append the operations to 'ops'. The state is kept between calls, so escape
+     * sequences split between two buffers are handled
+     */
+    void Parse(const wxString& buffer, OpVec_t& ops);
+
+    /**
+     * @brief append 'op' to 'ops', merging it with the last operation when possible
+     */
+    static void AddOp(OpVec_t& ops, const wxTerminalOp& op);
+};
+
+#endif // WXTERMINALANSIPARSER_H
@@ -0,0 +1,68 @@
+#include "wxTerminalAnsiThread.h"
+
+// the maximum number of characters waiting to be displayed
+static const size_t MAX_PENDING_CHARS = 4 * 1024 * 1024;
+
+wxTerminalAnsiThread::wxTerminalAnsiThread(clOutputThrottle* throttle)
+    : m_throttle(throttle)
+{
+}
+
+wxTerminalAnsiThread::~wxTerminalAnsiThread() {}
+
+void wxTerminalAnsiThread::ProcessRequest(ThreadRequest* request)
+{
+    wxTerminalAnsiRequest* req = dynamic_cast<wxTerminalAnsiRequest*>(request);
+    if(!req) { return; }
+
+    wxTerminalAnsiParser::OpVec_t ops;
+    m_parser.Parse(req->m_buffer, ops);
+    if(ops.empty()) { return; }
+
+    {
+        std::lock_guard<std::mutex> lock(m_opsMutex);
+        for(const wxTerminalOp& op : ops) {
+            wxTerminalAnsiParser::AddOp(m_ops, op);
+            m_pendingChars += op.text.length();
+        }
+        if(m_pendingChars > MAX_PENDING_CHARS) { DropOldestText(); }
+    }
+    m_throttle->Notify();
+}
+
+void wxTerminalAnsiThread::DropOldestText()
+{
+    size_t excess = m_pendingChars - MAX_PENDING_CHARS;
+    size_t count = 0;
+    for(; count < m_ops.size() && excess > 0; ++count) {
+        wxTerminalOp& op = m_ops[count];
+        if(op.type != eTerminalOp::kText) { continue; }
+        if(op.text.length() > excess) {
+            // keep the tail of this run
+            op.text.Remove(0, excess);
+            m_pendingChars -= excess;
+            excess = 0;
+            break;
+        }
+        excess -= op.text.length();
+        m_pendingChars -= op.text.length();
+        op.text.Clear();
+    }
+
+    // remove the runs that are now empty, keep the title changes
+    wxTerminalAnsiParser::OpVec_t ops;
+    ops.reserve(m_ops.size());
+    for(size_t i = 0; i < m_ops.size(); ++i) {
+        if(i < count && m_ops[i].type != eTerminalOp::kSetTitle) { continue; }
+        ops.push_back(m_ops[i]);
+    }
+    m_ops.swap(ops);
+}
+
+void wxTerminalAnsiThread::TakeOps(wxTerminalAnsiParser::OpVec_t& ops)
+{
+    std::lock_guard<std::mutex> lock(m_opsMutex);
+    ops.swap(m_ops);
+    m_ops.clear();
+    m_pendingChars = 0;
+}
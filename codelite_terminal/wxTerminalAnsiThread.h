@@ -0,0 +1,50 @@
+#ifndef WXTERMINALANSITHREAD_H
+#define WXTERMINALANSITHREAD_H
+
+#include "clOutputThrottle.h"
+#include "worker_thread.h"
+#include "wxTerminalAnsiParser.h"
+#include <mutex>
+
+class wxTerminalAnsiRequest : public ThreadRequest
+{
+public:
+    wxString m_buffer;
+
+    wxTerminalAnsiRequest(const wxString& buffer)
+        : m_buffer(buffer.c_str()) // make our own copy, the buffer is used by the worker thread
+    {
+    }
+    virtual ~wxTerminalAnsiRequest() {}
+};
+
+/**
+ * @class wxTerminalAnsiThread
+ * @brief parses the process output off the UI thread. The parsed operations are accumulated until the colour
+ * handler takes them, the throttle decides when. If the UI falls behind, the oldest pending text is dropped: it would
+ * be scrolled out of the view anyway
+ */
+class wxTerminalAnsiThread : public WorkerThread
+{
+    clOutputThrottle* m_throttle;
+    wxTerminalAnsiParser m_parser;
+    std::mutex m_opsMutex;
+    wxTerminalAnsiParser::OpVec_t m_ops;
+    size_t m_pendingChars = 0;
+
+protected:
+    void DropOldestText();
+
+public:
+    wxTerminalAnsiThread(clOutputThrottle* throttle);
+    virtual ~wxTerminalAnsiThread();
+
+    virtual void ProcessRequest(ThreadRequest* request);
+
+    /**
+     * @brief move the operations parsed so far into 'ops'. Called from the UI thread
+     */
+    void TakeOps(wxTerminalAnsiParser::OpVec_t& ops);
+};
+
+#endif // WXTERMINALANSITHREAD_H
@@ -1,4 +1,5 @@
 #include "wxTerminalColourHandler.h"
+#include "wxTerminalAnsiThread.h"
 #include "wxTerminalCtrl.h"
 #include "TextView.h"
 
@@ -6,11 +7,15 @@
 #include <windows.h>
 #include <Winuser.h>
 #endif
-#include <wx/tokenzr.h>
 #include <wx/wupdlock.h>
 #include <fileutils.h>
 
+// the minimum time between two updates of the control (~30 frames per second): a chatty process would otherwise keep
+// the UI thread busy repainting it
+static const long FLUSH_INTERVAL_MS = 33;
+
 wxTerminalColourHandler::wxTerminalColourHandler()
+    : m_throttle(FLUSH_INTERVAL_MS, [this]() { Flush(); })
 {
     // we use the Ubuntu colour scheme
 
@@ -49,203 +54,96 @@ wxTerminalColourHandler::wxTerminalColourHandler()
     m_colours.insert({ 105, wxColour(255, 0, 255) });
     m_colours.insert({ 106, wxColour(0, 255, 255) });
     m_colours.insert({ 107, wxColour(255, 255, 255) });
+
+    m_thread = new wxTerminalAnsiThread(&m_throttle);
+    m_thread->Start();
 }
 
-wxTerminalColourHandler::~wxTerminalColourHandler() {}
+wxTerminalColourHandler::~wxTerminalColourHandler()
+{
+    m_throttle.Stop();
+    m_thread->Stop();
+    wxDELETE(m_thread);
+}
 
 void wxTerminalColourHandler::Append(const wxString& buffer)
 {
-    if(buffer == "\n") {
-        // small optimization:
-        // this is usually the case where the user simply hit ENTER after typing a command
-        // No need to do fancy stuff here
-        m_ctrl->AppendText(buffer);
-        return;
-    }
+    // the output is parsed by the worker thread, the throttle calls Flush() when it can be displayed
+    m_thread->Add(new wxTerminalAnsiRequest(buffer));
+}
 
-    wxString curline;
-    // we start were left (at the end of the buffer)
-    long lastPos = m_ctrl->GetLastPosition();
-    if(lastPos > 0) {
-        // test the last char
-        wxChar lastCh = m_ctrl->GetLastChar();
-        if(lastCh != '\n') {
-            // we dont have a complete line here
-            // read the last line into the buffer and clear the line
-            long x, y;
-            m_ctrl->PositionToXY(lastPos, &x, &y);
-            long newpos = m_ctrl->XYToPosition(0, y);
-            curline = m_ctrl->GetRange(newpos, lastPos);
-            m_ctrl->Remove(newpos, lastPos);
-            m_ctrl->SetInsertionPoint(newpos);
-        }
-    }
+void wxTerminalColourHandler::Flush()
+{
+    wxTerminalAnsiParser::OpVec_t ops;
+    m_thread->TakeOps(ops);
+    if(ops.empty() || !m_ctrl) { return; }
 
-    m_ctrl->SelectNone();
-    m_ctrl->SetInsertionPointEnd();
-    for(const wxChar& ch : buffer) {
-        switch(m_state) {
-        case eColourHandlerState::kFoundCR: {
-            switch(ch) {
-            case '\r':
-                // another CR, ignore it and remain in this state
-                curline.Clear();
-                break;
-            case '\n':
-                // Windows style CRLF
-                curline << "\n";
-                FlushBuffer(curline);
-                m_state = eColourHandlerState::kNormal;
-                break;
-            default: {
-                // only CR was found, erase everything until the the first LF found or start of string
-                curline.Clear();
-                curline << ch;
-                m_state = eColourHandlerState::kNormal;
-                break;
-            } // default
-            } // switch
-        } break;
-        case eColourHandlerState::kNormal:
-            switch(ch) {
-            case 0x1B: // ESC
-                m_state = eColourHandlerState::kInEscape;
-                break;
-            case '\r':
-                m_state = eColourHandlerState::kFoundCR;
-                break;
-            case '\n':
-                curline << "\n";
-                FlushBuffer(curline);
-                break;
-            default:
-                curline << ch;
-                break;
-            }
-            break;
-        case eColourHandlerState::kInEscape:
-            switch(ch) {
-            // CSI - Control Sequence Introducer
-            case '[':
-                m_escapeSequence.Clear();
-                m_state = eColourHandlerState::kInCsi;
-                break;
-            case ']':
-                m_state = eColourHandlerState::kInOsc;
-                m_title.Clear();
-                break;
-            default:
-                // Add the current chunk using the current style
-                break;
-            }
-            break;
-        case eColourHandlerState::kInOsc:
-            // ESC ]
-            if(ch == '\a') {
-                // bell, leave the current state
-                m_state = eColourHandlerState::kNormal;
-                if(!m_title.IsEmpty()) {
-                    if(m_title.StartsWith("0;")) {
-                        // see https://en.wikipedia.org/wiki/ANSI_escape_code#Escape_sequences
-                        // OSC
-                        // fire event to set the title SetTitle(m_title.Mid(2)); // Skip the "0;"
-                        if(m_ctrl->GetSink()) {
-                            clCommandEvent eventTitle(wxEVT_TERMINAL_CTRL_SET_TITLE);
-                            eventTitle.SetString(m_title.Mid(2));
-                            eventTitle.SetEventObject(m_ctrl->GetSink());
-                            m_ctrl->GetSink()->AddPendingEvent(eventTitle);
-                        }
-                    }
-                    m_title.Clear();
+    {
+        wxWindowUpdateLocker locker(m_ctrl);
+        m_ctrl->SelectNone();
+        m_ctrl->SetInsertionPointEnd();
+        for(const wxTerminalOp& op : ops) {
+            switch(op.type) {
+            case eTerminalOp::kText:
+                m_ctrl->SetDefaultStyle(GetTextAttr(op.style));
+                m_ctrl->AppendText(op.text);
+                break;
+            case eTerminalOp::kEraseLine:
+                EraseLastLine();
+                break;
+            case eTerminalOp::kSetTitle:
+                if(m_ctrl->GetSink()) {
+                    clCommandEvent eventTitle(wxEVT_TERMINAL_CTRL_SET_TITLE);
+                    eventTitle.SetString(op.text);
+                    eventTitle.SetEventObject(m_ctrl->GetSink());
+                    m_ctrl->GetSink()->AddPendingEvent(eventTitle);
                 }
-            } else {
-                m_title << ch;
-            }
-            break;
-        case eColourHandlerState::kInCsi:
-            // found ESC[
-            switch(ch) {
-            case 'K':
-            case 'A':
-            case 'B':
-            case 'C':
-            case 'D':
-            case 'E':
-            case 'F':
-            case 'G':
-            case 'H':
-            case 'J':
-            case 'S':
-            case 'T':
-            case 'f':
-            case 'i':
-            case 'n':
-            case 'u':
-            case 's':
-                // exit the CSI mode back to normal mode
-                m_state = eColourHandlerState::kNormal;
-                break;
-            case 'm':
-                // update the style
-                FlushBuffer(curline);
-                SetStyleFromEscape(m_escapeSequence);
-                m_state = eColourHandlerState::kNormal;
-                break;
-            default:
-                m_escapeSequence << ch;
                 break;
             }
         }
+
+        // keep the scrollback bounded
+        m_ctrl->Truncate();
     }
 
-    // Write whatever left in the buffer into the control
-    FlushBuffer(curline);
+    if(m_ctrl->GetSink()) {
+        clCommandEvent eventDisplayed(wxEVT_TERMINAL_CTRL_OUTPUT_DISPLAYED);
+        eventDisplayed.SetEventObject(m_ctrl->GetSink());
+        m_ctrl->GetSink()->ProcessEvent(eventDisplayed);
+    }
     SetCaretEnd();
 }
 
-void wxTerminalColourHandler::SetStyleFromEscape(const wxString& escape)
+void wxTerminalColourHandler::EraseLastLine()
 {
-    if(escape == "0") {
-        // reset to normal
-        m_ctrl->SetDefaultStyle(m_defaultAttr);
-    } else {
-        // see: https://en.wikipedia.org/wiki/ANSI_escape_code#SGR_(Select_Graphic_Rendition)_parameters
-        wxArrayString attrs = ::wxStringTokenize(escape, ";", wxTOKEN_RET_EMPTY);
-        wxTextAttr textAttr = m_defaultAttr;
-        for(const wxString& attr : attrs) {
-            long number;
-            if(!attr.ToCLong(&number)) { continue; }
-            switch(number) {
-            case 0:
-                // reset attributes
-                textAttr = m_defaultAttr;
-                break;
-            case 1:
-                textAttr.SetFontWeight(wxFONTWEIGHT_BOLD);
-                break;
-            case 2:
-                textAttr.SetFontWeight(wxFONTWEIGHT_LIGHT);
-                break;
-            case 3:
-                textAttr.SetFontStyle(wxFONTSTYLE_ITALIC);
-                break;
-            case 4:
-                textAttr.SetFontUnderlined(true);
-                break;
-            default:
-                if((number >= 30 && number <= 37) || (number >= 90 && number <= 97)) {
-                    // use colour table to set the text colour
-                    wxColour c = GetColour(number);
-                    if(c.IsOk()) { textAttr.SetTextColour(c); }
-                } else if((number >= 40 && number <= 47) || (number >= 100 && number <= 107)) {
-                    wxColour c = GetColour(number);
-                    if(c.IsOk()) { textAttr.SetBackgroundColour(c); }
-                }
-                break;
-            }
-        }
-        m_ctrl->SetDefaultStyle(textAttr);
+    long lastPos = m_ctrl->GetLastPosition();
+    long x, y;
+    if(!m_ctrl->PositionToXY(lastPos, &x, &y)) { return; }
+    long lineStart = m_ctrl->XYToPosition(0, y);
+    if(lineStart < lastPos) { m_ctrl->Remove(lineStart, lastPos); }
+    m_ctrl->SetInsertionPointEnd();
+}
+
+wxTextAttr wxTerminalColourHandler::GetTextAttr(const wxTerminalStyle& style)
+{
+    wxTextAttr textAttr = m_defaultAttr;
+    if(style.weight == 1) {
+        textAttr.SetFontWeight(wxFONTWEIGHT_BOLD);
+    } else if(style.weight == 2) {
+        textAttr.SetFontWeight(wxFONTWEIGHT_LIGHT);
+    }
+    if(style.italic) { textAttr.SetFontStyle(wxFONTSTYLE_ITALIC); }
+    if(style.underlined) { textAttr.SetFontUnderlined(true); }
+    if(style.textColour != wxNOT_FOUND) {
+        // use colour table to set the text colour
+        wxColour c = GetColour(style.textColour);
+        if(c.IsOk()) { textAttr.SetTextColour(c); }
     }
+    if(style.bgColour != wxNOT_FOUND) {
+        wxColour c = GetColour(style.bgColour);
+        if(c.IsOk()) { textAttr.SetBackgroundColour(c); }
+    }
+    return textAttr;
 }
 
 wxColour wxTerminalColourHandler::GetColour(long colour_number)
@@ -262,21 +160,10 @@ wxTerminalColourHandler& wxTerminalColourHandler::operator<<(const wxString& buf
 
 void wxTerminalColourHandler::SetCtrl(TextView* ctrl)
 {
-    Clear();
     m_ctrl = ctrl;
     m_defaultAttr = m_ctrl->GetDefaultStyle();
 }
 
-void wxTerminalColourHandler::Clear() { m_escapeSequence.Clear(); }
-
-void wxTerminalColourHandler::FlushBuffer(wxString& line)
-{
-    if(!line.empty()) {
-        m_ctrl->AppendText(line);
-        line.clear();
-    }
-}
-
 void wxTerminalColourHandler::SetDefaultStyle(const wxTextAttr& attr)
 {
     if(m_ctrl) {
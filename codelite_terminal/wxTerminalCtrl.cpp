@@ -20,6 +20,7 @@ wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_OUTPUT, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_STDERR, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_DONE, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_SET_TITLE, clCommandEvent);
+wxDEFINE_EVENT(wxEVT_TERMINAL_CTRL_OUTPUT_DISPLAYED, clCommandEvent);
 
 ///---------------------------------------------------------------
 /// Helper methods
@@ -51,6 +52,7 @@ wxTerminalCtrl::wxTerminalCtrl(wxWindow* parent, wxWindowID winid, const wxExecu
     Bind(wxEVT_ASYNC_PROCESS_OUTPUT, &wxTerminalCtrl::OnProcessOutput, this);
     Bind(wxEVT_ASYNC_PROCESS_STDERR, &wxTerminalCtrl::OnProcessStderr, this);
     Bind(wxEVT_ASYNC_PROCESS_TERMINATED, &wxTerminalCtrl::OnProcessTerminated, this);
+    Bind(wxEVT_TERMINAL_CTRL_OUTPUT_DISPLAYED, &wxTerminalCtrl::OnOutputDisplayed, this);
 
     Bind(wxEVT_CHAR_HOOK, &wxTerminalCtrl::OnKeyDown, this);
     GetSizer()->Fit(this);
@@ -72,6 +74,7 @@ wxTerminalCtrl::~wxTerminalCtrl()
     Unbind(wxEVT_ASYNC_PROCESS_OUTPUT, &wxTerminalCtrl::OnProcessOutput, this);
     Unbind(wxEVT_ASYNC_PROCESS_STDERR, &wxTerminalCtrl::OnProcessStderr, this);
     Unbind(wxEVT_ASYNC_PROCESS_TERMINATED, &wxTerminalCtrl::OnProcessTerminated, this);
+    Unbind(wxEVT_TERMINAL_CTRL_OUTPUT_DISPLAYED, &wxTerminalCtrl::OnOutputDisplayed, this);
     Unbind(wxEVT_CHAR_HOOK, &wxTerminalCtrl::OnKeyDown, this);
 }
 
@@ -145,7 +148,7 @@ void wxTerminalCtrl::OnProcessOutput(clProcessEvent& event)
         outputEvent.SetEventObject(this);
         GetEventHandler()->AddPendingEvent(outputEvent);
     }
-    AppendText(event.GetOutput());
+    AppendProcessOutput(event);
 }
 
 void wxTerminalCtrl::OnProcessStderr(clProcessEvent& event)
@@ -156,7 +159,7 @@ void wxTerminalCtrl::OnProcessStderr(clProcessEvent& event)
         outputEvent.SetEventObject(this);
         GetEventHandler()->AddPendingEvent(outputEvent);
     }
-    AppendText(event.GetOutput());
+    AppendProcessOutput(event);
 }
 
 void wxTerminalCtrl::OnProcessTerminated(clProcessEvent& event)
@@ -175,7 +178,24 @@ void wxTerminalCtrl::AppendText(const wxString& text)
         m_log.Write(text);
         m_log.Flush();
     }
+    // The text is displayed asynchronously, see OnOutputDisplayed
     m_textCtrl->StyleAndAppend(text);
+}
+
+void wxTerminalCtrl::AppendProcessOutput(const clProcessEvent& event)
+{
+    if(m_log.IsOpened()) {
+        // log the bytes as the process wrote them, there is no need to decode and re-encode them
+        std::string raw = event.GetOutputRaw();
+        m_log.Write(raw.c_str(), raw.length());
+        m_log.Flush();
+    }
+    m_textCtrl->StyleAndAppend(event.GetOutput());
+}
+
+void wxTerminalCtrl::OnOutputDisplayed(clCommandEvent& event)
+{
+    wxUnusedVar(event);
     m_commandOffset = m_textCtrl->GetLastPosition();
     CallAfter(&wxTerminalCtrl::SetFocus);
 }
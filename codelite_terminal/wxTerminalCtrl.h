@@ -77,6 +77,8 @@ wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_TERMINAL_CTRL_STDERR, clCommandE
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_TERMINAL_CTRL_DONE, clCommandEvent);
 // Set the terminal title
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_TERMINAL_CTRL_SET_TITLE, clCommandEvent);
+// Internal: the process output was written into the text view
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_TERMINAL_CTRL_OUTPUT_DISPLAYED, clCommandEvent);
 
 class WXDLLIMPEXP_SDK wxTerminalCtrl : public wxPanel
 {
@@ -103,6 +105,7 @@ protected:
 protected:
     void PostCreate();
     void AppendText(const wxString& text);
+    void AppendProcessOutput(const clProcessEvent& event);
     wxString GetShellCommand() const;
     void SetShellCommand(const wxString& command);
     void SetCaretAtEnd();
@@ -112,6 +115,7 @@ protected:
     void OnProcessOutput(clProcessEvent& event);
     void OnProcessStderr(clProcessEvent& event);
     void OnProcessTerminated(clProcessEvent& event);
+    void OnOutputDisplayed(clCommandEvent& event);
     void OnKeyDown(wxKeyEvent& event);
     void OnLeftDown(wxMouseEvent& event);
     void SetEchoOff();
@@ -29,6 +29,7 @@ void wxTerminalOptions::FromJSON(const JSONItem& json)
     m_bgColour = json.namedObject("bgColour").toColour(m_bgColour);
     m_textColour = json.namedObject("textColour").toColour(m_textColour);
     m_history = json.namedObject("history").toArrayString();
+    m_scrollbackLines = json.namedObject("scrollbackLines").toInt(m_scrollbackLines);
 }
 
 JSONItem wxTerminalOptions::ToJSON() const
@@ -38,6 +39,7 @@ JSONItem wxTerminalOptions::ToJSON() const
     json.addProperty("bgColour", m_bgColour);
     json.addProperty("textColour", m_textColour);
     json.addProperty("history", m_history);
+    json.addProperty("scrollbackLines", m_scrollbackLines);
     return json;
 }
 
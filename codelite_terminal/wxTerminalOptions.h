@@ -22,6 +22,7 @@ class wxTerminalOptions
     wxColour m_bgColour;
     wxColour m_textColour;
     wxArrayString m_history;
+    int m_scrollbackLines = 10000;
 
 protected:
     void EnableFlag(bool b, eTerminalOptions flag)
@@ -86,6 +87,12 @@ public:
     
     void SetHistory(const wxArrayString& history) ;
     const wxArrayString& GetHistory() const { return m_history; }
+
+    /**
+     * @brief the number of lines kept by the terminal. 0 means unlimited
+     */
+    void SetScrollbackLines(int scrollbackLines) { this->m_scrollbackLines = scrollbackLines; }
+    int GetScrollbackLines() const { return m_scrollbackLines; }
 };
 
 #endif // WXTERMINALOPTIONS_H
@@ -0,0 +1,6 @@
+<?php
+
+namespace ParallelIndex;
+
+// Base is declared in test_parallel_index_helper.php
+function use_base(Base $b) {}
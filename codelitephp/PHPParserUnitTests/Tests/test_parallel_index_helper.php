@@ -0,0 +1,7 @@
+<?php
+
+namespace ParallelIndex;
+
+class Base {
+    public function foo() {}
+}
@@ -6,6 +6,9 @@
 #include "PHPExpression.h"
 #include "PHPEntityFunction.h"
 #include "tester.h"
+#include "PHPEntityVariable.h"
+#include "clFilesCollector.h"
+#include <wx/stopwatch.h>
 
 #ifdef __WXMSW__
 #define SYMBOLS_DB_PATH "%TEMP%"
@@ -856,6 +859,68 @@ TEST_FUNC(test_func_arg_in_lambda_in_assignment)
     return true;
 }
 
+// The files are parsed in parallel: a type hint must be resolved to the class declared in another file of the
+// same namespace, even when that file is parsed after the one using it
+TEST_FUNC(test_parallel_index)
+{
+    wxFileName user("../Tests/test_parallel_index.php");
+    wxFileName helper("../Tests/test_parallel_index_helper.php");
+    user.MakeAbsolute();
+    helper.MakeAbsolute();
+
+    wxArrayString files;
+    files.Add(user.GetFullPath());
+    files.Add(helper.GetFullPath());
+    lookup.RecreateSymbolsDatabase(files, PHPLookupTable::kUpdateMode_Full, []() { return false; }, false);
+
+    PHPEntityBase::Ptr_t func = lookup.FindFunction("\\ParallelIndex\\use_base");
+    CHECK_BOOL(func);
+
+    PHPEntityBase::List_t args = lookup.FindChildren(func->GetDbId());
+    CHECK_SIZE(args.size(), 1);
+    CHECK_WXSTRING((*args.begin())->Cast<PHPEntityVariable>()->GetTypeHint(), "\\ParallelIndex\\Base");
+    return true;
+}
+
+//======================-------------------------------------------------
+// Benchmark
+//======================-------------------------------------------------
+
+/**
+ * @brief index all the PHP files under 'folder' (e.g. a Symfony or Laravel vendor tree) into a new database and
+ * report the time it took. Run with: PHPParserUnitTests --benchmark <folder>
+ */
+static void BenchmarkIndexing(const wxString& folder)
+{
+    clFilesScanner scanner;
+    std::vector<wxString> allFiles;
+    scanner.Scan(folder, allFiles, "*.php");
+
+    wxArrayString files;
+    for(size_t i = 0; i < allFiles.size(); ++i) {
+        files.Add(allFiles[i]);
+    }
+
+    wxFileName benchmarkDBPath(SYMBOLS_DB_PATH, "phpsymbols.db");
+    benchmarkDBPath.AppendDir("php_benchmark");
+    benchmarkDBPath.Normalize();
+    benchmarkDBPath.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    PHPLookupTable table;
+    table.Open(benchmarkDBPath.GetPath());
+    table.ClearAll();
+
+    wxStopWatch sw;
+    table.RecreateSymbolsDatabase(files, PHPLookupTable::kUpdateMode_Full, []() { return false; }, true);
+    long fullIndex = sw.Time();
+
+    // nothing changed, the fast update only compares the timestamps
+    sw.Start();
+    table.RecreateSymbolsDatabase(files, PHPLookupTable::kUpdateMode_Fast, []() { return false; }, true);
+    long fastUpdate = sw.Time();
+
+    printf("Indexed %u files in %ldms (fast update: %ldms)\n", (unsigned)files.GetCount(), fullIndex, fastUpdate);
+}
 
 //======================-------------------------------------------------
 // Main
@@ -869,6 +934,11 @@ static const wxString PERFORMANCE_CODE =
 int main(int argc, char** argv)
 {
     wxInitialize(argc, argv);
+    if(argc == 3 && wxString(argv[1]) == "--benchmark") {
+        BenchmarkIndexing(argv[2]);
+        wxUninitialize();
+        return 0;
+    }
 #if 0
     PHPLookupTable table;
     table.Open("/home/eran/laravel-test/");